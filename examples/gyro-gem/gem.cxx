@@ -15,6 +15,8 @@
 #include <gyro_average.hxx>
 #include <invert_laplace.hxx>
 
+#include <memory>
+
 /// Fundamental constants
 
 const BoutReal e0 = 8.854e-12; // Permittivity of free space
@@ -68,6 +70,10 @@ class GEM : public PhysicsModel {
   BoutReal beta_e; // Electron dynamical beta
 
   BoutReal rho_e, rho_i; // Electron, ion gyroradius
+
+  // Gyro-averaging of densities and temperatures, and of the potential
+  std::unique_ptr<GyroPade> gyro_e, gyro_i;
+  std::unique_ptr<GyroPade> gyrophi_e, gyrophi_i;
   BoutReal rho_s, delta;
 
   // Collisional transport coefficients
@@ -326,6 +332,11 @@ class GEM : public PhysicsModel {
     
     output << "\tNormalised rho_e = " << rho_e << endl;
     output << "\tNormalised rho_i = " << rho_i << endl;
+
+    gyro_e.reset(new GyroPade(rho_e));
+    gyro_i.reset(new GyroPade(rho_i));
+    gyrophi_e.reset(new GyroPade(rho_e, INVERT_IN_RHS | INVERT_OUT_RHS));
+    gyrophi_i.reset(new GyroPade(rho_i, INVERT_IN_RHS | INVERT_OUT_RHS));
     
     //////////////////////////////////
     // Metric tensor components
@@ -549,13 +560,13 @@ class GEM : public PhysicsModel {
     if (small_rho_e) {
       // Neglect electron Larmor radius
       
-      Field3D dn = Ne - gyroPade1(Ni, rho_i) - gyroPade2(Tiperp, rho_i);
+      Field3D dn = Ne - gyro_i->pade1(Ni) - gyro_i->pade2(Tiperp);
       
       phi = invert_laplace(tau_i * dn / SQ(rho_i), phi_flags);
       phi -= tau_i * dn;
     } else {
-      Field3D dn = gyroPade1(Ne, rho_e) + gyroPade2(Teperp, rho_e)
-        - gyroPade1(Ni, rho_i) - gyroPade2(Tiperp, rho_i);
+      Field3D dn = gyro_e->pade1(Ne) + gyro_e->pade2(Teperp)
+        - gyro_i->pade1(Ni) - gyro_i->pade2(Tiperp);
       
       // Neglect electron gyroscreening
       phi = invert_laplace(tau_i * dn / (rho_i * rho_i), phi_flags);
@@ -619,8 +630,7 @@ class GEM : public PhysicsModel {
         Phi_G = 0.0;
       } else {
         // Gyro-reduced potentials
-        phi_G = gyroPade1(phi, rho_e, INVERT_IN_RHS | INVERT_OUT_RHS);
-        Phi_G = gyroPade2(phi, rho_e, INVERT_IN_RHS | INVERT_OUT_RHS);
+        gyrophi_e->pade12(phi, phi_G, Phi_G);
         
         mesh->communicate(phi_G, Phi_G);
       }
@@ -776,8 +786,7 @@ class GEM : public PhysicsModel {
     // Ion equations
   
     // Calculate gyroreduced potentials
-    phi_G = gyroPade1(phi, rho_i, INVERT_IN_RHS | INVERT_OUT_RHS);
-    Phi_G = gyroPade2(phi, rho_i, INVERT_IN_RHS | INVERT_OUT_RHS);
+    gyrophi_i->pade12(phi, phi_G, Phi_G);
     
     mesh->communicate(phi_G, Phi_G);
     
@@ -959,8 +968,7 @@ class GEM : public PhysicsModel {
         Phi_G = 0.0;
       } else {
         // Gyro-reduced potentials
-        phi_G = gyroPade1(phi, rho_e, INVERT_IN_RHS | INVERT_OUT_RHS);
-        Phi_G = gyroPade2(phi, rho_e, INVERT_IN_RHS | INVERT_OUT_RHS);
+        gyrophi_e->pade12(phi, phi_G, Phi_G);
         
         mesh->communicate(phi_G, Phi_G);
       }
@@ -1008,8 +1016,7 @@ class GEM : public PhysicsModel {
     // Ion equations
     
     // Calculate gyroreduced potentials
-    phi_G = gyroPade1(phi, rho_i, INVERT_IN_RHS | INVERT_OUT_RHS);
-    Phi_G = gyroPade2(phi, rho_i, INVERT_IN_RHS | INVERT_OUT_RHS);
+    gyrophi_i->pade12(phi, phi_G, Phi_G);
     
     mesh->communicate(phi_G, Phi_G);
     
@@ -89,6 +89,17 @@ int main(int argc, char **argv) {
 
     ITERATOR_TEST_BLOCK("Bracket [3D,3D] DEFAULT",
                         result = bracket(a, b, BRACKET_STD););
+
+    // Several fields advected by the same potential
+    Field3D d = b, e = b;
+    ITERATOR_TEST_BLOCK("Bracket [3D,3D] ARAKAWA x3",
+                        result = bracket(a, b, BRACKET_ARAKAWA);
+                        result = bracket(a, d, BRACKET_ARAKAWA);
+                        result = bracket(a, e, BRACKET_ARAKAWA););
+
+    std::vector<Field3D> results;
+    ITERATOR_TEST_BLOCK("Bracket [3D,3D] ARAKAWA multi x3",
+                        results = bracket(a, {b, d, e}, BRACKET_ARAKAWA););
   }
 
   // Uncomment below for a "correctness" check
@@ -0,0 +1,91 @@
+/*
+ * Timing of the finite volume operators in the FV namespace
+ *
+ * Each operator is run NUM_LOOPS times, and the average time per
+ * call printed. To see the effect of threading, compare runs with
+ * different values of OMP_NUM_THREADS
+ */
+
+#include <bout.hxx>
+#include <bout/fv_ops.hxx>
+#include <initialprofiles.hxx>
+
+#include <chrono>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+typedef std::chrono::time_point<std::chrono::steady_clock> SteadyClock;
+typedef std::chrono::duration<double> Duration;
+using namespace std::chrono;
+
+#define FV_TEST_BLOCK(NAME, ...)                                                         \
+  {                                                                                      \
+    __VA_ARGS__                                                                          \
+    names.push_back(NAME);                                                               \
+    SteadyClock start = steady_clock::now();                                             \
+    for (int repetitionIndex = 0; repetitionIndex < NUM_LOOPS; repetitionIndex++) {      \
+      __VA_ARGS__;                                                                       \
+    }                                                                                    \
+    times.push_back(steady_clock::now() - start);                                        \
+  }
+
+int main(int argc, char **argv) {
+  BoutInitialise(argc, argv);
+  std::vector<std::string> names;
+  std::vector<Duration> times;
+
+  Options *modelOpts = Options::getRoot()->getSection("performance");
+  int NUM_LOOPS;
+  OPTION(modelOpts, NUM_LOOPS, 100);
+
+  ConditionalOutput time_output(Output::getInstance());
+  time_output.enable(true);
+
+  Field3D f, v, a;
+  initial_profile("f", f);
+  initial_profile("v", v);
+  initial_profile("a", a);
+  mesh->communicate(f, v, a);
+
+  // Maximum wave speed
+  Field3D wave_speed = abs(v) + 0.1;
+
+  Vector3D vec;
+  vec.covariant = false;
+  vec.x = v;
+  vec.y = a;
+  vec.z = v;
+
+  Field3D result;
+
+  FV_TEST_BLOCK("Div_par Upwind", result = FV::Div_par<FV::Upwind>(f, v, wave_speed););
+  FV_TEST_BLOCK("Div_par MinMod", result = FV::Div_par<FV::MinMod>(f, v, wave_speed););
+  FV_TEST_BLOCK("Div_par MC", result = FV::Div_par<FV::MC>(f, v, wave_speed););
+
+  FV_TEST_BLOCK("Div_f_v Upwind", result = FV::Div_f_v<FV::Upwind>(f, vec, true););
+  FV_TEST_BLOCK("Div_f_v MinMod", result = FV::Div_f_v<FV::MinMod>(f, vec, true););
+  FV_TEST_BLOCK("Div_f_v MC", result = FV::Div_f_v<FV::MC>(f, vec, true););
+
+  FV_TEST_BLOCK("Div_a_Laplace_perp", result = FV::Div_a_Laplace_perp(a, f););
+  FV_TEST_BLOCK("Div_par_K_Grad_par", result = FV::Div_par_K_Grad_par(a, f););
+  FV_TEST_BLOCK("D4DY4", result = FV::D4DY4(a, f););
+  FV_TEST_BLOCK("D4DY4_Index", result = FV::D4DY4_Index(f););
+
+  int width = 0;
+  for (const auto &name : names) {
+    width = name.size() > width ? name.size() : width;
+  }
+  width = width + 5;
+  time_output << std::setw(width) << "Case name"
+              << "\t"
+              << "Time per iteration (s)"
+              << "\n";
+  for (int i = 0; i < names.size(); i++) {
+    time_output << std::setw(width) << names[i] << "\t" << times[i].count() / NUM_LOOPS
+                << "\n";
+  }
+
+  BoutFinalise();
+  return 0;
+}
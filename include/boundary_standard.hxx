@@ -7,8 +7,10 @@
 #include "bout_types.hxx"
 #include <field_factory.hxx>
 #include "unused.hxx"
+#include "bout/array.hxx"
 
 #include <utility>
+#include <vector>
 
 /// Dirichlet boundary condition set half way between guard cell and grid cell at 2nd order accuracy
 class BoundaryDirichlet_2ndOrder : public BoundaryOp {
@@ -29,6 +31,37 @@ class BoundaryDirichlet_2ndOrder : public BoundaryOp {
   BoutReal val;
 };
 
+/// Values of a FieldGenerator at the points of a boundary region, used
+/// when applying Dirichlet conditions to 3D fields. Values from generators
+/// which don't depend on time are only calculated once
+class BoundaryValueCache {
+public:
+  /// Calculate the values of \p fg at time \p t, half way between the
+  /// boundary and the first grid cell, unless they are already known.
+  /// If \p guards is true then values at the centres of the remaining
+  /// guard cells are also calculated. A null \p fg is treated as zero
+  void update(BoundaryRegion *region, const std::shared_ptr<FieldGenerator> &fg,
+              BoutReal t, bool guards);
+
+  /// (x,y) indices of the boundary points, in the order of next1d()
+  const std::vector<std::pair<int, int>> &getPoints() const { return points; }
+
+  /// Z line of values at boundary point \p p and guard cell \p i
+  const BoutReal *operator()(int p, int i) const {
+    return &values[(p * nguards + i) * nz];
+  }
+
+private:
+  std::vector<std::pair<int, int>> points;
+  bool have_points{false};
+
+  std::shared_ptr<FieldGenerator> generator; ///< Generator used for the values
+  std::shared_ptr<ExpressionProgram> program; ///< Compiled generator
+  bool valid{false}; ///< Can the values be reused?
+  int nz{0}, nguards{0};
+  Array<BoutReal> values;
+};
+
 /// Dirichlet (set to zero) boundary condition
 class BoundaryDirichlet : public BoundaryOp {
  public:
@@ -48,6 +81,7 @@ class BoundaryDirichlet : public BoundaryOp {
   void apply_ddt(Field3D &f) override;
  private:
   std::shared_ptr<FieldGenerator>  gen; // Generator
+  BoundaryValueCache cache; // Boundary values for 3D fields
 };
 
 BoutReal default_func(BoutReal t, int x, int y, int z);
@@ -71,6 +105,7 @@ class BoundaryDirichlet_O3 : public BoundaryOp {
   void apply_ddt(Field3D &f) override;
  private:
   std::shared_ptr<FieldGenerator>  gen; // Generator
+  BoundaryValueCache cache; // Boundary values for 3D fields
 };
 
 /// 4th-order boundary condition
@@ -92,6 +127,7 @@ class BoundaryDirichlet_O4 : public BoundaryOp {
   void apply_ddt(Field3D &f) override;
  private:
   std::shared_ptr<FieldGenerator>  gen; // Generator
+  BoundaryValueCache cache; // Boundary values for 3D fields
 };
 
 /// Dirichlet boundary condition set half way between guard cell and grid cell at 4th order accuracy
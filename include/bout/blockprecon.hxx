@@ -0,0 +1,151 @@
+/*!
+ * \file blockprecon.hxx
+ *
+ * \brief Preconditioners built from the stiff terms in a model
+ *
+ **************************************************************************
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class BlockPreconditioner;
+
+#ifndef __BLOCKPRECON_H__
+#define __BLOCKPRECON_H__
+
+#include "bout/monitor.hxx"
+#include "field2d.hxx"
+#include "field3d.hxx"
+#include "options.hxx"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class InvertPar;
+class Laplacian;
+class LaplaceXY;
+
+/*!
+ * Approximately inverts (I - gamma * J), where J is the Jacobian of
+ * the stiff terms declared by the model, so that models don't need to
+ * write their own preconditioner.
+ *
+ * Each term is a block, inverted using an existing solver:
+ *   - Parallel diffusion  ddt(f) = D * Grad2_par2(f)     InvertPar
+ *   - Perpendicular diffusion  ddt(f) = D * Delp2(f)     Laplacian, or
+ *                                                        LaplaceXY for Field2D
+ *   - Parallel wave coupling  ddt(f) = a * Grad_par(g)   InvertPar on the
+ *                             ddt(g) = b * Grad_par(f)   Schur complement
+ *
+ * Blocks are applied one after the other, in the order added, so
+ * blocks acting on different variables form a block-Jacobi
+ * preconditioner. Coefficients are only passed to the inverters
+ * again when gamma changes by more than gamma_rtol, and the inverters
+ * keep their factorised matrices until then.
+ *
+ * Example
+ * -------
+ *
+ *     class MyModel : public PhysicsModel {
+ *       BlockPreconditioner precon;
+ *
+ *       int init(bool restarting) {
+ *         SOLVE_FOR2(vort, psi);
+ *         precon.addParallelWave(vort, psi, 1.0, 1.0 / beta);
+ *         precon.addPerpDiffusion(vort, viscosity);
+ *         setPrecon(precon);
+ *       }
+ *     };
+ *
+ * and run with solver:use_precon = true
+ *
+ * Options in the "blockprecon" section:
+ *   - bndry     Boundary condition applied to vectors before taking
+ *               parallel derivatives (default "neumann")
+ *   - diagnose  Print the number and cost of applications at each output
+ *   - gamma_rtol  Relative change in gamma below which the inverters
+ *               are not updated (default 0, update on any change)
+ *   - laplace, laplacexy  Sections for the perpendicular inverters.
+ *               Parallel inversions use the "parderiv" section
+ */
+class BlockPreconditioner : public Monitor {
+public:
+  /// @param[in] opt  Options section. By default "blockprecon"
+  BlockPreconditioner(Options *opt = nullptr);
+  ~BlockPreconditioner();
+
+  /// ddt(f) contains D * Grad2_par2(f)
+  void addParallelDiffusion(Field3D &f, const Field2D &D);
+
+  /// ddt(f) contains D * Delp2(f)
+  void addPerpDiffusion(Field3D &f, const Field2D &D);
+
+  /// ddt(f) contains Div(D * Grad_perp(f)). Needs PETSc
+  void addPerpDiffusion(Field2D &f, const Field2D &D);
+
+  /// ddt(f) contains a * Grad_par(g), and ddt(g) contains b * Grad_par(f).
+  /// a * b should be positive, as for a wave
+  void addParallelWave(Field3D &f, Field3D &g, const Field2D &a, const Field2D &b);
+
+  /// Number of blocks added
+  int size() const { return static_cast<int>(blocks.size()); }
+
+  /// Apply the preconditioner. The state is in the evolving variables
+  /// and the vector to be inverted in their time derivatives, which
+  /// are replaced by the result. Same arguments as a model's
+  /// preconditioner function
+  int apply(BoutReal t, BoutReal gamma, BoutReal delta);
+
+  /// Print statistics, if diagnose is set
+  int call(Solver *solver, BoutReal time, int iter, int nout) override;
+
+  /// Number of times apply() has been called since the last output
+  int getApplications() const { return napply; }
+
+private:
+  enum class BlockType { ParallelDiffusion, PerpDiffusion, PerpDiffusion2D, ParallelWave };
+
+  struct Block {
+    BlockType type;
+    Field3D *f3d = nullptr, *g3d = nullptr; ///< Variables, for 3D blocks
+    Field2D *f2d = nullptr;                 ///< Variable, for 2D blocks
+    Field2D a, b;                           ///< Coefficients
+    BoutReal last_gamma = -1.0;             ///< Gamma when coefficients last set
+
+    std::unique_ptr<InvertPar> invpar;
+    std::unique_ptr<Laplacian> laplace;
+    std::unique_ptr<LaplaceXY> laplacexy;
+
+    Block(BlockType type);
+    Block(Block &&);
+    ~Block();
+  };
+
+  Options *options;
+  std::string bndry; ///< Boundary condition before parallel derivatives
+  bool diagnose;
+  BoutReal gamma_rtol; ///< Lag inverters until gamma changes by this fraction
+
+  std::vector<Block> blocks;
+
+  int napply = 0;   ///< Applications since last output
+  int nupdates = 0; ///< Times coefficients were set since last output
+
+  void applyBlock(Block &block, BoutReal gamma);
+};
+
+#endif // __BLOCKPRECON_H__
@@ -0,0 +1,112 @@
+/*!
+ * \file checkpoint.hxx
+ *
+ * \brief Writes restart files atomically, optionally staged on node-local storage
+ *
+ **************************************************************************
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class Checkpoint;
+
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include "bout/monitor.hxx"
+#include "datafile.hxx"
+#include "options.hxx"
+
+#include <string>
+#include <thread>
+
+/*!
+ * Monitor which writes the restart Datafile as a checkpoint
+ *
+ * Rather than rewriting the open restart file in place, each
+ * checkpoint is written to a new temporary file which then replaces
+ * the previous checkpoint with a rename. A crash during a write
+ * therefore leaves the last complete restart file intact. Before each
+ * write the solver copies its multistep history into the restart
+ * variables (Solver::saveHistory), so the checkpoint is a snapshot
+ * of the whole solver state.
+ *
+ * Checkpoints can be written to a different (e.g. node-local)
+ * directory, set by option "stagedir". In that case, the staged
+ * file is copied to the restart directory by a background thread
+ * while the simulation continues, again replacing the previous
+ * restart file atomically. Only one copy is in flight at a time: the
+ * next checkpoint waits for the previous copy to finish.
+ *
+ * Limitation: only the copy is asynchronous. The checkpoint file is
+ * always written synchronously by the calling thread, with or without
+ * "stagedir", so the simulation stops for as long as the write takes.
+ * It can't be moved to a background thread, because the netCDF and
+ * HDF5 libraries are not thread-safe here and the dump files are
+ * written at the same time. A fast "stagedir" keeps the stop short.
+ *
+ * Options in the "checkpoint" section:
+ *   - enabled   Use this instead of writing restart files at every output
+ *   - interval  Simulation time between checkpoints. Must be a multiple or
+ *               a divisor of the output timestep. Default is every output
+ *   - stagedir  Directory to write checkpoints to. Default is the restart dir
+ *   - drain     Copy staged checkpoints to the restart directory (default true)
+ */
+class Checkpoint : public Monitor {
+public:
+  /*!
+   * @param[in] restart      The Datafile containing the variables to write
+   * @param[in] restart_dir  The directory where restart files are read from
+   * @param[in] ext          The file extension, which sets the format
+   * @param[in] opt          Options section. By default "checkpoint"
+   */
+  Checkpoint(Datafile &restart, std::string restart_dir, std::string ext,
+             Options *opt = nullptr);
+  ~Checkpoint() override;
+
+  /// Are checkpoints enabled in options section \p opt?
+  /// By default checks the "checkpoint" section
+  static bool isEnabled(Options *opt = nullptr);
+
+  int call(Solver *solver, BoutReal time, int iter, int nout) override;
+
+  /// Wait for any background copy to finish
+  void cleanup() override;
+
+  /// Write a checkpoint now
+  void write();
+
+private:
+  Datafile &restart; ///< Variables to write
+
+  std::string restart_dir; ///< Directory where the simulation will restart from
+  std::string stage_dir;   ///< Directory where checkpoints are written
+  std::string ext;         ///< File extension
+  bool drain;              ///< Copy from stage_dir to restart_dir?
+
+  int mype; ///< This processor's rank, used in file names
+
+  std::thread drain_thread; ///< Copies the last checkpoint to restart_dir
+  bool drain_failed;        ///< Set by drain_thread if the copy failed
+
+  /// Name of this processor's file in directory \p dir
+  std::string fileName(const std::string &dir, const std::string &base) const;
+
+  /// Wait for the background copy, reporting any failure
+  void finishDrain();
+};
+
+#endif // __CHECKPOINT_H__
@@ -34,6 +34,7 @@
 #define __COORDINATES_H__
 
 #include "datafile.hxx"
+#include "dcomplex.hxx"
 #include "utils.hxx"
 #include <bout_types.hxx>
 
@@ -97,6 +98,16 @@ public:
   int calcContravariant(); ///< Invert covariant metric to get contravariant
   int jacobian(); ///< Calculate J and Bxy
 
+  /// Clear the cached coefficients which are derived from the metric.
+  /// This is done by geometry(), calcCovariant(), calcContravariant()
+  /// and jacobian(), but must be called if the metric or dz are
+  /// changed in any other way
+  void invalidateCache();
+
+  /// Incremented by invalidateCache(), so that solvers which keep
+  /// matrices calculated from the metric can tell when to recalculate
+  int getGeometryVersion() const { return geometry_version; }
+
   // Operators
 
   const Field2D DDX(const Field2D &f, CELL_LOC outloc = CELL_DEFAULT,
@@ -131,6 +142,13 @@ public:
   const Field2D Delp2(const Field2D &f, CELL_LOC outloc=CELL_DEFAULT);
   const Field3D Delp2(const Field3D &f, CELL_LOC outloc=CELL_DEFAULT);
   const FieldPerp Delp2(const FieldPerp &f, CELL_LOC outloc=CELL_DEFAULT);
+
+  // Delp2 in Fourier space, without the inverse FFT, for callers which
+  // use the Z Fourier modes directly, for example in a Laplacian inversion.
+  // Results are indexed (y, x, kz) and (x, kz) for kz = 0 ... LocalNz/2,
+  // and are zero in the X boundaries
+  const Tensor<dcomplex> Delp2Fourier(const Field3D &f);
+  const Matrix<dcomplex> Delp2Fourier(const FieldPerp &f);
   
   // Full parallel Laplacian operator on scalar field
   // Laplace_par(f) = Div( b (b dot Grad(f)) ) 
@@ -145,6 +163,31 @@ private:
   int nz; // Size of mesh in Z. This is mesh->ngz-1
   Mesh * localmesh;
   CELL_LOC location;
+
+  // Combinations of metric components used by the operators. These
+  // are calculated when first needed, and cleared by invalidateCache().
+  // Operators which only multiply by metric components or connection
+  // terms (g11, G1, G3, ..., as in Laplace and Grad_perp) use the
+  // fields directly, so there is nothing else to clear
+
+  int geometry_version{0}; ///< Number of calls to invalidateCache()
+
+  /// Tridiagonal coefficients for Delp2, indexed by (y, x, kz)
+  Tensor<dcomplex> delp2_a, delp2_b, delp2_c;
+  void calcDelp2Coefs();
+
+  /// Delp2 in Fourier space of the X-Z slice at \p jy, made of LocalNx
+  /// Z lines starting \p dist apart from \p f. \p ft is workspace, and
+  /// \p delft the result; both are LocalNx by (LocalNz/2 + 1)
+  void delp2Slice(const BoutReal *f, int dist, int jy, dcomplex *ft, dcomplex *delft);
+
+  Field2D sqrt_g_22; ///< sqrt(g_22), used in the parallel derivatives
+  bool sqrt_g_22_valid{false};
+  const Field2D &getSqrtG22();
+
+  Field2D dJ_g_22_dy; ///< DDY(J / g_22), used in Laplace_par
+  bool dJ_g_22_dy_valid{false};
+  const Field2D &getDJg22DY();
 };
 
 /*
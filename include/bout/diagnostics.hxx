@@ -0,0 +1,116 @@
+/*!
+ * \file diagnostics.hxx
+ *
+ * \brief In-situ reduced diagnostics of 3D fields
+ *
+ **************************************************************************
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class Diagnostics;
+
+#ifndef __DIAGNOSTICS_H__
+#define __DIAGNOSTICS_H__
+
+#include "bout/monitor.hxx"
+#include "bout/surfaceaverage.hxx"
+#include "datafile.hxx"
+#include "field2d.hxx"
+#include "field3d.hxx"
+#include "options.hxx"
+
+#include <list>
+#include <string>
+#include <vector>
+
+/*!
+ * Monitor which writes reductions of 3D fields, rather than the
+ * fields themselves, to a separate output file "BOUT.diag.*"
+ *
+ * For each field added, the following can be calculated:
+ *   - Z (toroidal) average, "<name>_dc"
+ *   - RMS of the fluctuations about the Z average, "<name>_rms"
+ *   - Flux-surface average, weighted by the Jacobian, "<name>_fsa"
+ *   - Power in each Z Fourier mode, averaged over the domain,
+ *     "<name>_kz0", "<name>_kz1", ...
+ *   - Time traces at probe points, "<name>_probe0", "<name>_probe1", ...
+ *
+ * Options in the "diagnostics" section:
+ *   - enabled   Write diagnostics (default false)
+ *   - timestep  Simulation time between diagnostics. Must be a multiple or
+ *               a divisor of the output timestep. Default is every output
+ *   - fields    Comma-separated list of evolving 3D variables to add
+ *   - average, rms, fsa, spectrum  Switch each reduction on or off
+ *   - probes    List of x,y,z global indices, e.g. "(10,4,0), (20,8,16)".
+ *               X includes guard cells, Y does not
+ *
+ * The output file takes the usual Datafile options (e.g. "floats")
+ * from the "diagnostics:output" section.
+ */
+class Diagnostics : public Monitor {
+public:
+  /// @param[in] opt  Options section. By default "diagnostics"
+  Diagnostics(Options *opt = nullptr);
+
+  /// Are diagnostics enabled in options section \p opt?
+  /// By default checks the "diagnostics" section
+  static bool isEnabled(Options *opt = nullptr);
+
+  /// Names of evolving variables to add, from option "fields"
+  const std::vector<std::string> &getFieldNames() const { return field_names; }
+
+  /// Calculate diagnostics of \p f, which must not be destroyed
+  /// while the diagnostics are in use
+  void add(Field3D &f, const std::string &name);
+
+  /// Open the output file \p filename, appending if \p append is true.
+  /// Must be called after all fields have been added
+  void open(const std::string &filename, bool append);
+
+  int call(Solver *solver, BoutReal time, int iter, int nout) override;
+
+  /// Calculate all diagnostics and write them to the output file
+  void write(BoutReal time);
+
+private:
+  /// The reduced outputs for one field
+  struct Entry {
+    Field3D *var;
+    std::string name;
+    Field2D dc, rms, fsa;
+    std::vector<BoutReal> spectrum; ///< Domain-averaged power in each kz
+    std::vector<BoutReal> probes;   ///< Values at each probe point
+  };
+  std::list<Entry> entries; ///< List, so outputs stay at fixed addresses
+
+  Datafile file;  ///< Reduced output file
+  BoutReal t_out; ///< Time of the last diagnostic
+
+  std::vector<std::string> field_names;
+  bool average, rms, fsa, spectrum;
+
+  SurfaceAverage surface; ///< Calculates the flux-surface averages
+
+  /// A probe point, in local indices if on this processor
+  struct Probe {
+    int x, y, z;
+    bool local;
+  };
+  std::vector<Probe> probe_points;
+};
+
+#endif // __DIAGNOSTICS_H__
@@ -0,0 +1,139 @@
+/*!
+ * \file ensemble.hxx
+ *
+ * \brief Several copies of a physics model evolved together
+ *
+ **************************************************************************
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class EnsembleModel;
+
+#ifndef __ENSEMBLE_H__
+#define __ENSEMBLE_H__
+
+#include "bout/physicsmodel.hxx"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class EnsembleMemberSolver;
+class EnsembleMonitor;
+
+/*!
+ * Evolves several independent copies (members) of a physics model in
+ * one simulation, for example to scan a parameter of a small model.
+ * The members share the mesh, coordinates and FFT plans, which are
+ * only set up once, and are advanced by one solver. Each member has
+ * its own instance of the model, so its own fields and inverters.
+ *
+ * Member i's evolving variables are given to the solver with suffix
+ * "_i", so "T" becomes "T_0", "T_1", ... in the output and restart
+ * files. Their initial profiles and boundary conditions are taken from
+ * sections [T_1] etc. if set, otherwise from [T]. Variables saved in
+ * init() with SAVE_ONCE, SAVE_REPEAT or dump.add() have the same suffix.
+ *
+ * Options in the "ensemble" section:
+ *   - members    Number of members (default 1, no ensemble)
+ *   - parameter  Name of an option which is different in each member,
+ *                e.g. "conduction:chi". Set before each member's init()
+ *   - start, end  Value of the parameter in the first and last member.
+ *                Other members are evenly spaced
+ *
+ *   - groups     Number of processor groups (default 1). Each group has
+ *                a copy of the mesh, and evolves every groups'th member
+ *
+ * Models created with BOUTMAIN are ensembles if ensemble:members > 1.
+ * The members' RHS functions are called in turn, and their output
+ * monitors at each output. Preconditioners and Jacobians of the
+ * members are not used. Members with the same Laplacian coefficients
+ * share the factorised matrices, if the solver supports it.
+ *
+ * If ensemble:groups > 1 the processors are split with BoutComm::split,
+ * and member i is evolved by group i % groups, so the members are
+ * advanced in parallel. Every group initialises all members, and each
+ * output the members' variables are broadcast from the group which
+ * evolves them. The first group then runs the RHS of the other members
+ * once, so that quantities they save are up to date, and writes the
+ * output and restart files. Members' output monitors are called in the
+ * group which evolves them and in the first group; timestep monitors
+ * only in the group which evolves them. Constraints can't be used.
+ * Only the first group saves solver history (see Solver::saveHistory)
+ * in restart files, so other groups' members restart without it.
+ */
+class EnsembleModel : public PhysicsModel {
+public:
+  ~EnsembleModel();
+
+  /// Create a ModelClass, or an ensemble of them if ensemble:members > 1
+  template <class ModelClass>
+  static PhysicsModel *create() {
+    int members;
+    Options::getRoot()->getSection("ensemble")->get("members", members, 1);
+    if (members <= 1) {
+      return new ModelClass();
+    }
+
+    EnsembleModel *ensemble = new EnsembleModel();
+    for (int i = 0; i < members; i++) {
+      ensemble->members.emplace_back(new ModelClass());
+    }
+    return ensemble;
+  }
+
+  /// Number of members
+  int size() const { return static_cast<int>(members.size()); }
+
+protected:
+  int init(bool restarting) override;
+  int postInit(bool restarting) override;
+
+  int rhs(BoutReal t) override;
+  int convective(BoutReal t) override;
+  int diffusive(BoutReal t, bool linear) override;
+
+  int outputMonitor(BoutReal simtime, int iter, int NOUT) override;
+  int timestepMonitor(BoutReal simtime, BoutReal dt) override;
+
+private:
+  friend class EnsembleMonitor;
+
+  EnsembleModel();
+
+  std::vector<std::unique_ptr<PhysicsModel>> members;
+
+  int groups = 1; ///< Number of processor groups the members are shared between
+  int group = 0;  ///< The group of this processor
+
+  /// Index of the group which evolves member \p i
+  int owner(int i) const { return i % groups; }
+
+  /// Broadcast each member's variables from the group which evolves
+  /// it, and calculate the other members' output quantities in the
+  /// first group
+  int shareMembers(BoutReal time);
+
+  /// Calls shareMembers each output
+  std::unique_ptr<EnsembleMonitor> monitor;
+
+  /// Solvers given to the members, which pass their variables to the
+  /// real solver with the member suffix
+  std::vector<std::unique_ptr<EnsembleMemberSolver>> member_solvers;
+};
+
+#endif // __ENSEMBLE_H__
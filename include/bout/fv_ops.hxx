@@ -11,6 +11,8 @@
 
 #include "../utils.hxx"
 
+#include <vector>
+
 namespace FV {
   /*!
    * Div ( a Laplace_perp(x) )  -- Vorticity
@@ -38,6 +40,10 @@ namespace FV {
    *    f_2 | f_1 | f_0 |
    *                   f_b
    *
+   * There is no flux through Y domain boundaries. On periodic
+   * surfaces the flux across the periodic boundary is calculated
+   * from the guard cells, which need MYG >= 2.
+   *
    * NB: Uses to/from FieldAligned coordinates
    */
   const Field3D D4DY4(const Field3D &d, const Field3D &f);
@@ -76,7 +82,7 @@ namespace FV {
    * First order upwind for testing
    */ 
   struct Upwind {
-    void operator()(Stencil1D &n) {
+    void operator()(Stencil1D &n) const {
       n.L = n.R = n.c;
     }
   };
@@ -85,7 +91,7 @@ namespace FV {
    * Fromm method
    */
   struct Fromm {
-    void operator()(Stencil1D &n) {
+    void operator()(Stencil1D &n) const {
       n.L = n.c - 0.25*(n.p - n.m);
       n.R = n.c + 0.25*(n.p - n.m);
     }
@@ -100,7 +106,7 @@ namespace FV {
    * to first order upwinding
    */ 
   struct MinMod {
-    void operator()(Stencil1D &n) {
+    void operator()(Stencil1D &n) const {
       // Choose the gradient within the cell
       // as the minimum (smoothest) solution
       BoutReal slope = _minmod(n.p - n.c, n.c - n.m);
@@ -115,7 +121,7 @@ namespace FV {
      * returns zero, otherwise chooses the value
      * with the minimum magnitude.
      */
-    BoutReal _minmod(BoutReal a, BoutReal b) {
+    BoutReal _minmod(BoutReal a, BoutReal b) const {
       if( a*b <= 0.0 )
         return 0.0;
       
@@ -134,7 +140,7 @@ namespace FV {
    * then the slope reverts to zero (i.e. 1st-order upwinding).
    */
   struct MC {
-    void operator()(Stencil1D &n) {
+    void operator()(Stencil1D &n) const {
       BoutReal slope = minmod(2. * (n.p - n.c),  // 2*right difference
                               0.5 * (n.p - n.m), // Central difference
                               2. * (n.c - n.m) ); // 2*left difference
@@ -144,7 +150,7 @@ namespace FV {
   private:
     // Return zero if any signs are different
     // otherwise return the value with the minimum magnitude
-    BoutReal minmod(BoutReal a, BoutReal b, BoutReal c) {
+    BoutReal minmod(BoutReal a, BoutReal b, BoutReal c) const {
       // if any of the signs are different, return zero gradient
       if ((a * b <= 0.0) || (a * c <= 0.0)) {
         return 0.0;
@@ -161,6 +167,14 @@ namespace FV {
    */
   void communicateFluxes(Field3D &f);
 
+
+  /*!
+   * Find which X indices have a boundary at the lower (upper) end
+   * of the Y domain on this processor, rather than a neighbouring
+   * processor or a periodic domain
+   */
+  void yBoundaries(Mesh *mesh, std::vector<bool> &lower, std::vector<bool> &upper);
+
   /// Finite volume parallel divergence
   ///
   /// Preserves the sum of f*J*dx*dy*dz over the domain
@@ -182,146 +196,131 @@ namespace FV {
 
     ASSERT2(f_in.getLocation() == v_in.getLocation());
 
-    CellEdges cellboundary;
+    Mesh *mesh = f_in.getMesh();
+
+    const CellEdges cellboundary;
     
-    Field3D f = mesh->toFieldAligned(f_in);
-    Field3D v = mesh->toFieldAligned(v_in);
+    const Field3D f = mesh->toFieldAligned(f_in);
+    const Field3D v = mesh->toFieldAligned(v_in);
 
     Coordinates *coord = f_in.getCoordinates();
 
-    Field3D result = 0.0;
-    
-    // Only need one guard cell, so no need to communicate fluxes
-    // Instead calculate in guard cells to preserve fluxes
-    int ys = mesh->ystart-1;
-    int ye = mesh->yend+1;
-
-    for (int i = mesh->xstart; i <= mesh->xend; i++) {
-
-      if (!mesh->firstY(i) || mesh->periodicY(i)) {
-        // Calculate in guard cell to get fluxes consistent between processors
-        ys = mesh->ystart - 1;
-      } else {
-        // Don't include the boundary cell. Note that this implies special
-        // handling of boundaries later
-        ys = mesh->ystart;
-      }
-
-      if (!mesh->lastY(i) || mesh->periodicY(i)) {
-        // Calculate in guard cells
-        ye = mesh->yend + 1;
-      } else {
-        // Not in boundary cells
-        ye = mesh->yend;
-      }
+    std::vector<bool> lower_boundary, upper_boundary;
+    yBoundaries(mesh, lower_boundary, upper_boundary);
+
+    // Flux through the face between i and i.yp() at each z, multiplied
+    // by the area of the face.
+    // The cell below the face gives the flux in the +y direction, and
+    // the cell above the flux in the -y direction. At a boundary only
+    // the cell in the domain is used
+    auto face_flux = [&](const Ind2D &i, BoutReal *flux) {
+      const int x = i.x(), y = i.y();
+      const auto ip = i.yp();
+
+      // Last and first points in the domain
+      const bool last = upper_boundary[x] && (y == mesh->yend);
+      const bool first = lower_boundary[x] && (y == mesh->ystart - 1);
+
+      // The cell below the face is not used at the first face, and the
+      // cell above is not used at the last face, so only read the
+      // points beyond the face when they are in the domain
+      const BoutReal *fc = f(x, y), *fp = f(x, y + 1);
+      const BoutReal *fm = first ? nullptr : f(x, y - 1);
+      const BoutReal *fpp = last ? nullptr : f(x, y + 2);
+      const BoutReal *vc = v(x, y), *vp = v(x, y + 1);
+      const BoutReal *wc = wave_speed(x, y), *wp = wave_speed(x, y + 1);
+
+      const BoutReal area = (coord->J[i] + coord->J[ip]) /
+                            (sqrt(coord->g_22[i]) + sqrt(coord->g_22[ip]));
+
+      for (int k = 0; k < mesh->LocalNz; k++) {
+        // Reconstruct f at the cell faces, in the cells
+        // below (sc) and above (sp) this face
+        // The unused points at the first and last faces are filled in
+        // with the cell values, so that the stencils are initialised
+        Stencil1D sc, sp;
+        sc.c = fc[k];
+        sc.m = first ? fc[k] : fm[k];
+        sc.p = fp[k];
+        sp.c = fp[k];
+        sp.m = fc[k];
+        sp.p = last ? fp[k] : fpp[k];
+
+        // Velocity at the face (y+1/2)
+        const BoutReal vpar = 0.5 * (vc[k] + vp[k]);
+        BoutReal fout;
+
+        if (last) {
+          cellboundary(sc); // Calculate sc.R and sc.L
+
+          BoutReal bndryval = 0.5 * (sc.c + sc.p);
+          if (fixflux) {
+            // Use mid-point to be consistent with boundary conditions
+            fout = bndryval * vpar;
+          } else {
+            // Add flux due to difference in boundary values
+            fout = sc.R * vpar + wc[k] * (sc.R - bndryval);
+          }
+        } else if (first) {
+          cellboundary(sp);
 
-      for (int j = ys; j <= ye; j++) {
-        // Pre-calculate factors which multiply fluxes
-
-        // For right cell boundaries
-        BoutReal common_factor = (coord->J(i, j) + coord->J(i, j + 1)) /
-          (sqrt(coord->g_22(i, j)) + sqrt(coord->g_22(i, j + 1)));
-        
-        BoutReal flux_factor_rc = common_factor / (coord->dy(i, j) * coord->J(i, j));
-        BoutReal flux_factor_rp = common_factor / (coord->dy(i, j + 1) * coord->J(i, j + 1));
-
-        // For left cell boundaries
-        common_factor = (coord->J(i, j) + coord->J(i, j - 1)) /
-          (sqrt(coord->g_22(i, j)) + sqrt(coord->g_22(i, j - 1)));
-
-        BoutReal flux_factor_lc = common_factor / (coord->dy(i, j) * coord->J(i, j));
-        BoutReal flux_factor_lm = common_factor / (coord->dy(i, j - 1) * coord->J(i, j - 1));
-        
-        for (int k = 0; k < mesh->LocalNz; k++) {
-
-          ////////////////////////////////////////////
-          // Reconstruct f at the cell faces
-          // This calculates s.R and s.L for the Right and Left
-          // face values on this cell
-          
-          // Reconstruct f at the cell faces
-          Stencil1D s;
-          s.c = f(i, j, k);
-          s.m = f(i, j - 1, k);
-          s.p = f(i, j + 1, k);
-
-          cellboundary(s); // Calculate s.R and s.L
-
-          ////////////////////////////////////////////
-          // Right boundary
-
-          // Calculate velocity at right boundary (y+1/2)
-          BoutReal vpar = 0.5 * (v(i, j, k) + v(i, j + 1, k));
-          BoutReal flux;
-
-          if (mesh->lastY(i) && (j == mesh->yend) && !mesh->periodicY(i)) {
-            // Last point in domain
-
-            BoutReal bndryval = 0.5 * (s.c + s.p);
-            if (fixflux) {
-              // Use mid-point to be consistent with boundary conditions
-              flux = bndryval * vpar;
-            } else {
-              // Add flux due to difference in boundary values
-              flux = s.R * vpar + wave_speed(i, j, k) * (s.R - bndryval);
-            }
+          BoutReal bndryval = 0.5 * (sp.c + sp.m);
+          if (fixflux) {
+            // Use mid-point to be consistent with boundary conditions
+            fout = bndryval * vpar;
           } else {
-            
-            // Maximum wave speed in the two cells
-            BoutReal amax = BOUTMAX(wave_speed(i, j, k), wave_speed(i, j + 1, k));
-
-            if (vpar > amax) {
-              // Supersonic flow out of this cell
-              flux = s.R * vpar;
-            } else if (vpar < -amax) {
-              // Supersonic flow into this cell
-              flux = 0.0;
-            } else {
-              // Subsonic flow, so a mix of right and left fluxes
-              flux = s.R * 0.5 * (vpar + amax);
-            }
+            // Add flux due to difference in boundary values
+            fout = sp.L * vpar - wp[k] * (sp.L - bndryval);
           }
-          
-          result(i, j, k) += flux * flux_factor_rc;
-          result(i, j + 1, k) -= flux * flux_factor_rp;
-
-          ////////////////////////////////////////////
-          // Calculate at left boundary
-          
-          vpar = 0.5 * (v(i, j, k) + v(i, j - 1, k));
-
-          if (mesh->firstY(i) && (j == mesh->ystart) && !mesh->periodicY(i)) {
-            // First point in domain
-            BoutReal bndryval = 0.5 * (s.c + s.m);
-            if (fixflux) {
-              // Use mid-point to be consistent with boundary conditions
-              flux = bndryval * vpar;
-            } else {
-              // Add flux due to difference in boundary values
-              flux = s.L * vpar - wave_speed(i, j, k) * (s.L - bndryval);
-            }
+        } else {
+          cellboundary(sc);
+          cellboundary(sp);
+
+          // Maximum wave speed in the two cells
+          BoutReal amax = BOUTMAX(wc[k], wp[k]);
+
+          if (vpar > amax) {
+            // Supersonic flow in the +y direction
+            fout = sc.R * vpar;
+          } else if (vpar < -amax) {
+            // Supersonic flow in the -y direction
+            fout = sp.L * vpar;
           } else {
-            
-            // Maximum wave speed in the two cells
-            BoutReal amax = BOUTMAX(wave_speed(i, j, k), wave_speed(i, j - 1, k));
-
-            if (vpar < -amax) {
-              // Supersonic out of this cell
-              flux = s.L * vpar;
-            } else if (vpar > amax) {
-              // Supersonic into this cell
-              flux = 0.0;
-            } else {
-              flux = s.L * 0.5 * (vpar - amax);
-            }
+            // Subsonic flow, so a mix of right and left fluxes
+            fout = sc.R * 0.5 * (vpar + amax) + sp.L * 0.5 * (vpar - amax);
           }
-          
-          result(i, j, k) -= flux * flux_factor_lc;
-          result(i, j - 1, k) += flux * flux_factor_lm;
-          
         }
+        flux[k] = fout * area;
+      }
+    };
+
+    const auto &region = mesh->getRegion2D("RGN_NOBNDRY");
+
+    // Calculate each face flux once. flux(x,y) is the flux through the
+    // upper face of cell (x,y). The lower face of the domain is
+    // calculated in the guard cell
+    Field3D flux(mesh);
+    flux.allocate();
+
+    BOUT_FOR(i, region) {
+      face_flux(i, flux(i.x(), i.y()));
+      if (i.y() == mesh->ystart) {
+        face_flux(i.ym(), flux(i.x(), i.y() - 1));
       }
     }
+
+    Field3D result(0.0, mesh);
+
+    BOUT_FOR(i, region) {
+      const BoutReal *up = flux(i.x(), i.y()), *down = flux(i.x(), i.y() - 1);
+      BoutReal *r = result(i.x(), i.y());
+
+      const BoutReal dyJ = coord->dy[i] * coord->J[i];
+      for (int k = 0; k < mesh->LocalNz; k++) {
+        r[k] = (up[k] - down[k]) / dyJ;
+      }
+    }
+
     return mesh->fromFieldAligned(result);
   }
   
@@ -341,7 +340,9 @@ namespace FV {
   const Field3D Div_f_v(const Field3D &n_in, const Vector3D &v, bool bndry_flux) {
     ASSERT2(n_in.getLocation() == v.getLocation());
 
-    CellEdges cellboundary;
+    Mesh *mesh = n_in.getMesh();
+
+    const CellEdges cellboundary;
     
     Coordinates *coord = n_in.getCoordinates();
     
@@ -350,138 +351,212 @@ namespace FV {
       throw BoutException("Div_f_v_XPPM passed a covariant v");
     }
     
-    Field3D result = 0.0;
-    
-    Field3D vx = v.x;
-    Field3D vz = v.z;
-    Field3D n  = n_in;
-    
+    const Field3D &vx = v.x;
+    const Field3D &vz = v.z;
+    const Field3D &n = n_in;
+
+    const int ncz = mesh->LocalNz;
+    const auto &region = mesh->getRegion2D("RGN_NOBNDRY");
+
+    ////////////////////////////////////////////
     // X-Z advection
-    for(int i=mesh->xstart;i<=mesh->xend;i++)
-      for(int j=mesh->ystart;j<=mesh->yend;j++)
-        for(int k=0;k<mesh->LocalNz;k++) {
-          int kp = (k+1) % (mesh->LocalNz);
-          int kpp = (kp+1) % (mesh->LocalNz);
-          int km = (k-1+mesh->LocalNz) % (mesh->LocalNz);
-          int kmm = (km-1+mesh->LocalNz) % (mesh->LocalNz);
-          
-          // Calculate velocities
-          BoutReal vU = 0.5*(vz(i,j,kp) + vz(i,j,k))*coord->J(i,j);
-          BoutReal vD = 0.5*(vz(i,j,km) + vz(i,j,k))*coord->J(i,j);
-          BoutReal vL = 0.25*(vx(i-1,j,k) + vx(i,j,k))*(coord->J(i-1,j) + coord->J(i,j));
-          BoutReal vR = 0.25*(vx(i+1,j,k) + vx(i,j,k))*(coord->J(i+1,j) + coord->J(i,j));
-          
-          // X direction
-          Stencil1D s;
-          s.c  = n(i,  j,k);
-          s.m  = n(i-1,j,k);
-          s.mm = n(i-2,j,k);
-          s.p  = n(i+1,j,k);
-          s.pp = n(i+2,j,k);
-          
-          cellboundary(s);
-        
-          if((i==mesh->xend) && (mesh->lastX())) {
-            // At right boundary in X
-          
-            if(bndry_flux) {
-              BoutReal flux;
-              if(vR > 0.0) {
-                // Flux to boundary
-                flux = vR * s.R;
-              }else {
-                // Flux in from boundary
-                flux = vR * 0.5*(n(i+1,j,k) + n(i,j,k));
-              }
-              result(i,j,k)   += flux / (coord->dx(i,j) * coord->J(i,j));
-              result(i+1,j,k) -= flux / (coord->dx(i+1,j) * coord->J(i+1,j));
-            }
-          }else {
-            // Not at a boundary
-            if(vR > 0.0) {
-              // Flux out into next cell
-              BoutReal flux = vR * s.R;
-              result(i,j,k)   += flux / (coord->dx(i,j) * coord->J(i,j));
-              result(i+1,j,k) -= flux / (coord->dx(i+1,j) * coord->J(i+1,j));
-            }
-          }
-        
-          // Left side
-          
-          if((i==mesh->xstart) && (mesh->firstX())) {
-            // At left boundary in X
-            
-            if(bndry_flux) {
-              BoutReal flux;
-              
-              if(vL < 0.0) {
-                // Flux to boundary
-                flux = vL * s.L;
-                
-              }else {
-                // Flux in from boundary
-                flux = vL * 0.5*(n(i-1,j,k) + n(i,j,k));
-              }
-              result(i,j,k)   -= flux / (coord->dx(i,j) * coord->J(i,j));
-              result(i-1,j,k) += flux / (coord->dx(i-1,j) * coord->J(i-1,j));
-            }
-          }else {
-            // Not at a boundary
-            
-            if(vL < 0.0) {
-              BoutReal flux = vL * s.L;
-              result(i,j,k)   -= flux / (coord->dx(i,j) * coord->J(i,j));
-              result(i-1,j,k) += flux / (coord->dx(i-1,j) * coord->J(i-1,j));
+    //
+    // Fluxes are upwinded, so are calculated from
+    // the cell which the flow is coming from
+
+    // Flux through the face between i and i.xp() at each z
+    auto x_flux = [&](const Ind2D &i, BoutReal *flux) {
+      const int x = i.x(), y = i.y();
+      const auto ip = i.xp();
+
+      const BoutReal *n_xm = n(x - 1, y), *n_x = n(x, y), *n_xp = n(x + 1, y),
+                     *n_xpp = n(x + 2, y);
+      const BoutReal *vxc = vx(x, y), *vxp = vx(x + 1, y);
+      const BoutReal Jsum = coord->J[ip] + coord->J[i];
+
+      // At a boundary in X
+      const bool last = (x == mesh->xend) && mesh->lastX();
+      const bool first = (x == mesh->xstart - 1) && mesh->firstX();
+
+      // Fluxes into this processor's domain are calculated by the
+      // neighbouring processor, and added by communicateFluxes
+      const bool from_below = (x >= mesh->xstart);
+      const bool from_above = (x < mesh->xend);
+
+      // Reconstruct n at the faces of the cells below (x) and above (x+1)
+      auto below = [&](int k) {
+        Stencil1D s;
+        s.c = n_x[k];
+        s.m = n_xm[k];
+        s.mm = n(x - 2, y)[k];
+        s.p = n_xp[k];
+        s.pp = n_xpp[k];
+        cellboundary(s);
+        return s;
+      };
+      auto above = [&](int k) {
+        Stencil1D s;
+        s.c = n_xp[k];
+        s.m = n_x[k];
+        s.mm = n_xm[k];
+        s.p = n_xpp[k];
+        s.pp = n(x + 3, y)[k];
+        cellboundary(s);
+        return s;
+      };
+
+      for (int k = 0; k < ncz; k++) {
+        // Velocity at the face
+        const BoutReal vR = 0.25 * (vxp[k] + vxc[k]) * Jsum;
+
+        BoutReal fout = 0.0;
+        if (last || first) {
+          if (bndry_flux) {
+            if (last && (vR > 0.0)) {
+              // Flux to boundary
+              fout = vR * below(k).R;
+            } else if (first && (vR < 0.0)) {
+              // Flux to boundary
+              fout = vR * above(k).L;
+            } else {
+              // Flux in from boundary
+              fout = vR * 0.5 * (n_xp[k] + n_x[k]);
             }
           }
-          
-          /// NOTE: Need to communicate fluxes
-          
-          // Z direction
-          s.m  = n(i,j,km);
-          s.mm = n(i,j,kmm);
-          s.p  = n(i,j,kp);
-          s.pp = n(i,j,kpp);
-          
-          cellboundary(s);
-          
-          if(vU > 0.0) {
-            BoutReal flux = vU * s.R / (coord->J(i,j)*coord->dz);
-            result(i,j,k)   += flux;
-            result(i,j,kp)  -= flux;
-          }
-          if(vD < 0.0) {
-            BoutReal flux = vD * s.L / (coord->J(i,j)*coord->dz);
-            result(i,j,k)   -= flux;
-            result(i,j,km)  += flux;
-          }
-          
+        } else if ((vR > 0.0) && from_below) {
+          fout = vR * below(k).R;
+        } else if ((vR < 0.0) && from_above) {
+          fout = vR * above(k).L;
+        }
+        flux[k] = fout;
+      }
+    };
+
+    // Flux through the face between k and k+1, divided by J*dz
+    auto z_flux = [&](const Ind2D &i, BoutReal *flux) {
+      const BoutReal *nc = n(i.x(), i.y());
+      const BoutReal *vzc = vz(i.x(), i.y());
+      const BoutReal J = coord->J[i];
+
+      // Reconstruct n at the faces of cell k
+      auto reconstruct = [&](int k) {
+        Stencil1D s;
+        s.c = nc[k];
+        s.m = nc[(k - 1 + ncz) % ncz];
+        s.mm = nc[(k - 2 + 2 * ncz) % ncz];
+        s.p = nc[(k + 1) % ncz];
+        s.pp = nc[(k + 2) % ncz];
+        cellboundary(s);
+        return s;
+      };
+
+      for (int k = 0; k < ncz; k++) {
+        const int kp = (k + 1) % ncz;
+
+        // Velocity at the face
+        const BoutReal vU = 0.5 * (vzc[kp] + vzc[k]) * J;
+
+        BoutReal fout = 0.0;
+        if (vU > 0.0) {
+          fout = vU * reconstruct(k).R / (J * coord->dz);
+        } else if (vU < 0.0) {
+          fout = vU * reconstruct(kp).L / (J * coord->dz);
         }
+        flux[k] = fout;
+      }
+    };
+
+    // Calculate each face flux once. The X flux through the inner
+    // face of the domain is calculated in the guard cell
+    Field3D xflux(mesh), zflux(mesh);
+    xflux.allocate();
+    zflux.allocate();
+
+    BOUT_FOR(i, region) {
+      x_flux(i, xflux(i.x(), i.y()));
+      if (i.x() == mesh->xstart) {
+        x_flux(i.xm(), xflux(i.x() - 1, i.y()));
+      }
+      z_flux(i, zflux(i.x(), i.y()));
+    }
+
+    Field3D result(0.0, mesh);
+
+    BOUT_FOR(i, region) {
+      const int x = i.x(), y = i.y();
+      const BoutReal *up = xflux(x, y), *down = xflux(x - 1, y), *fz = zflux(x, y);
+      BoutReal *r = result(x, y);
+
+      const BoutReal dxJ = coord->dx[i] * coord->J[i];
+      for (int k = 0; k < ncz; k++) {
+        r[k] = (up[k] - down[k]) / dxJ + (fz[k] - fz[(k - 1 + ncz) % ncz]);
+      }
+
+      // Fluxes out of the domain are put in the X guard cells
+      if (x == mesh->xstart) {
+        const auto im = i.xm();
+        const BoutReal dxJm = coord->dx[im] * coord->J[im];
+        BoutReal *rm = result(x - 1, y);
+        for (int k = 0; k < ncz; k++) {
+          rm[k] = down[k] / dxJm;
+        }
+      }
+      if (x == mesh->xend) {
+        const auto ip = i.xp();
+        const BoutReal dxJp = coord->dx[ip] * coord->J[ip];
+        BoutReal *rp = result(x + 1, y);
+        for (int k = 0; k < ncz; k++) {
+          rp[k] = -up[k] / dxJp;
+        }
+      }
+    }
     communicateFluxes(result);
     
+    ////////////////////////////////////////////
     // Y advection
     // Currently just using simple centered differences
     // so no fluxes need to be exchanged
     
-    n = mesh->toFieldAligned(n_in);
-    Field3D vy = mesh->toFieldAligned(v.y);
-    
-    Field3D yresult = 0.0;    
-    for(int i=mesh->xstart;i<=mesh->xend;i++)
-      for(int j=mesh->ystart;j<=mesh->yend;j++)
-        for(int k=0;k<mesh->LocalNz;k++) {
-          
-          // Y velocities on y boundaries
-          BoutReal vU = 0.25*(vy(i,j,k) + vy(i,j+1,k))*(coord->J(i,j) + coord->J(i,j+1));
-          BoutReal vD = 0.25*(vy(i,j,k) + vy(i,j-1,k))*(coord->J(i,j) + coord->J(i,j-1));
-          
-          // n (advected quantity) on y boundaries
-          // Note: Use unshifted n_in variable
-          BoutReal nU = 0.5*(n(i,j,k) + n(i,j+1,k));
-          BoutReal nD = 0.5*(n(i,j,k) + n(i,j-1,k));
-          
-          yresult(i,j,k) = (nU*vU - nD*vD) / (coord->J(i,j)*coord->dy(i,j));
-        }
+    const Field3D na = mesh->toFieldAligned(n_in);
+    const Field3D vy = mesh->toFieldAligned(v.y);
+
+    // Flux through the face between i and i.yp() at each z
+    auto y_flux = [&](const Ind2D &i, BoutReal *flux) {
+      const auto ip = i.yp();
+      const BoutReal *nc = na(i.x(), i.y()), *np = na(i.x(), i.y() + 1);
+      const BoutReal *vc = vy(i.x(), i.y()), *vp = vy(i.x(), i.y() + 1);
+      const BoutReal Jsum = coord->J[i] + coord->J[ip];
+
+      for (int k = 0; k < ncz; k++) {
+        // Y velocity on y boundary
+        BoutReal vU = 0.25 * (vc[k] + vp[k]) * Jsum;
+        // n (advected quantity) on y boundary
+        BoutReal nU = 0.5 * (nc[k] + np[k]);
+        flux[k] = nU * vU;
+      }
+    };
+
+    Field3D yflux(mesh);
+    yflux.allocate();
+
+    BOUT_FOR(i, region) {
+      y_flux(i, yflux(i.x(), i.y()));
+      if (i.y() == mesh->ystart) {
+        y_flux(i.ym(), yflux(i.x(), i.y() - 1));
+      }
+    }
+
+    Field3D yresult(0.0, mesh);
+
+    BOUT_FOR(i, region) {
+      const BoutReal *up = yflux(i.x(), i.y()), *down = yflux(i.x(), i.y() - 1);
+      BoutReal *r = yresult(i.x(), i.y());
+
+      const BoutReal Jdy = coord->J[i] * coord->dy[i];
+      for (int k = 0; k < ncz; k++) {
+        r[k] = (up[k] - down[k]) / Jdy;
+      }
+    }
     
     return result + mesh->fromFieldAligned(yresult);
   }
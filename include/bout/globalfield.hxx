@@ -22,7 +22,7 @@ public:
   GlobalField() = delete;
   virtual ~GlobalField();
   virtual bool valid() const = 0;  ///< Is the data valid on any processor?
-  bool dataIsLocal() const {return valid() && (data_on_proc == mype);} ///< Data is on this processor
+  bool dataIsLocal() const {return valid() && data_is_local;} ///< Data is on this processor
 
   /*!
    * Data access by index. This doesn't perform any checks,
@@ -53,6 +53,7 @@ protected:
   Mesh *mesh; ///< The mesh we're gathering/scattering over
 
   int data_on_proc; ///< Which processor is this data on?  
+  bool data_is_local; ///< Is the data on this processor after the last gather?
   int nx, ny, nz; ///< Global field sizes
   Array<BoutReal> data; ///< The global data, if on this processor
 
@@ -64,6 +65,59 @@ protected:
   void proc_origin(int proc, int *x, int *y, int *z = nullptr) const;
   /// Return the array size of processor proc
   void proc_size(int proc, int *lx, int *ly, int *lz = nullptr) const;
+
+  /// The length of message (in BoutReals) to
+  /// be sent to or from processor \p proc
+  ///
+  /// @param[in] proc  MPI processor index
+  int msg_len(int proc) const;
+
+  /// Gather the local data onto processor data_on_proc
+  ///
+  /// @param[in] local  The start of the local (LocalNx, LocalNy, nz) array
+  void gatherData(const BoutReal *local);
+
+  /// Gather the local data onto every processor
+  void allGatherData(const BoutReal *local);
+
+  /// Gather the local data onto the first processor on each node
+  void nodeGatherData(const BoutReal *local);
+
+  /// Scatter from processor data_on_proc into the local array
+  void scatterData(BoutReal *local) const;
+
+private:
+  /// The part of the local array which is sent and received,
+  /// as an MPI subarray type of the whole local array
+  MPI_Datatype local_block;
+
+  /// Message length and offset in the packed buffer for each processor
+  std::vector<int> counts, displs;
+
+  /// Packed data from all processors, reused between calls
+  mutable Array<BoutReal> buffer;
+
+  /// Communicators between processors on the same node, and between
+  /// the first processor on each node. Created on first nodeGatherData
+  MPI_Comm node_comm, leader_comm;
+
+  /// Message lengths and offsets within node_comm and leader_comm
+  std::vector<int> node_counts, node_displs, leader_counts, leader_displs;
+
+  /// Processor indices in the order their data arrives at node leaders
+  std::vector<int> leader_procs;
+
+  /// Create node_comm, leader_comm and the message sizes
+  void createNodeComms();
+
+  /// Make sure that the global data is allocated on this processor
+  void allocateData();
+
+  /// Copy packed data into the global array.
+  ///
+  /// @param[in] buf    Packed data from processors
+  /// @param[in] procs  Processor indices, in the order they appear in \p buf
+  void unpack(const BoutReal *buf, const std::vector<int> &procs);
 };
 
 /*!
@@ -94,6 +148,13 @@ protected:
  * Note that both gather and scatter are collective operations, 
  * which must be performed by all processors.
  *
+ * To gather the data onto every processor, or onto the first
+ * processor on each node (e.g. for serial solvers which need
+ * whole X lines), use:
+ *
+ *     g2d.allGather(localdata);
+ *     g2d.gatherToNodes(localdata);
+ *
  * To test if the data is available on a processor, use:
  *
  *     if(g2d.dataIsLocal()) {
@@ -128,6 +189,14 @@ public:
 
   /// Gather all data onto one processor
   void gather(const Field2D &f);
+
+  /// Gather all data onto every processor
+  void allGather(const Field2D &f);
+
+  /// Gather all data onto the first processor on each node
+  /// (every processor if MPI-3 is not available)
+  void gatherToNodes(const Field2D &f);
+
   /// Scatter data back from one to many processors
   const Field2D scatter() const;
   
@@ -145,17 +214,6 @@ public:
 protected:
   
 private:
-
-  /// Buffer for sending and receiving. First index
-  /// is the processor index, and second is the data
-  BoutReal** buffer;
-  
-  /// The length of message (in BoutReals) to
-  /// be sent to or from processor \p proc
-  ///
-  /// @param[in] proc  MPI processor index
-  int msg_len(int proc) const;
-
   /// Is the data valid and on this processor?
   bool data_valid;
 };
@@ -188,6 +246,13 @@ private:
  * Note that both gather and scatter are collective operations, 
  * which must be performed by all processors.
  *
+ * To gather the data onto every processor, or onto the first
+ * processor on each node (e.g. for serial solvers which need
+ * whole X lines), use:
+ *
+ *     g3d.allGather(localdata);
+ *     g3d.gatherToNodes(localdata);
+ *
  * To test if the data is available on a processor, use:
  *
  *     if(g3d.dataIsLocal()) {
@@ -224,6 +289,14 @@ public:
 
   /// Gather all data onto one processor
   void gather(const Field3D &f);
+
+  /// Gather all data onto every processor
+  void allGather(const Field3D &f);
+
+  /// Gather all data onto the first processor on each node
+  /// (every processor if MPI-3 is not available)
+  void gatherToNodes(const Field3D &f);
+
   /// Scatter data back from one to many processors
   const Field3D scatter() const;
   
@@ -237,17 +310,6 @@ public:
 protected:
   
 private:
-
-  /// Buffer for sending and receiving. First index
-  /// is the processor index, and second is the data
-  BoutReal** buffer; 
-
-  /// The length of message (in BoutReals) to
-  /// be sent to or from processor \p proc
-  ///
-  /// @param[in] proc  MPI processor index
-  int msg_len(int proc) const;
-
   /// Is the data valid and on this processor?
   bool data_valid;
 };
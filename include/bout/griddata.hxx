@@ -39,6 +39,7 @@ class GridDataSource;
 #include <field3d.hxx>
 
 #include <list>
+#include <map>
 
 /// Interface class to serve grid data
 /*!
@@ -69,11 +70,28 @@ public:
 /*!
  * This is a thin wrapper around a DataFormat object. Only needs to implement
  * reading routines.
+ *
+ * Each field is read with a single hyperslab read, and variable sizes
+ * are cached so the file is only queried once per variable.
+ *
+ * If the option "shared_read" is true (and MPI-3 is available), then
+ * only one processor on each node reads from the file. It reads the
+ * bounding box of the blocks needed by all processors on the node
+ * into an MPI shared memory window, from which each processor copies
+ * its own block. In this case reading fields is collective over the
+ * processors on each node, so every processor must read the same
+ * variables in the same order.
  */
 class GridFile : public GridDataSource {
 public:
   GridFile() = delete;
-  GridFile(std::unique_ptr<DataFormat> format, string gridfilename);
+  /*!
+   * @param[in] format        The file format to read with. Owned by GridFile
+   * @param[in] gridfilename  The name of the file to open
+   * @param[in] opt           Options section. By default the "mesh" section
+   */
+  GridFile(std::unique_ptr<DataFormat> format, string gridfilename,
+           Options *opt = nullptr);
   ~GridFile() override;
 
   bool hasVar(const string &name) override;
@@ -93,6 +111,21 @@ private:
   std::unique_ptr<DataFormat> file;
   string filename;
 
+  /// Sizes of variables in the file, indexed by name
+  std::map<string, vector<int>> var_sizes;
+
+  /// Communicator between processors on the same node, used if
+  /// reading through shared memory. MPI_COMM_NULL otherwise.
+  MPI_Comm node_comm;
+
+  /// Get the size of a variable, querying the file only the first time
+  const vector<int> &getSize(const string &name);
+
+  /// Read a block of (nx, ny, nz) values starting at global index
+  /// (x0, y0, z0) into \p data. For 2D variables nz should be 0.
+  bool readBlock(const string &name, int x0, int y0, int z0, int nx, int ny, int nz,
+                 BoutReal *data);
+
   bool readgrid_3dvar_fft(Mesh *m, const string &name, int yread, int ydest, int ysize,
                           int xge, int xlt, Field3D &var);
 
@@ -667,6 +667,15 @@ class Mesh {
   // Can be set in the input file and the global default is set by,
   // MAXREGIONBLOCKSIZE in include/bout/region.hxx
   int maxregionblocksize;
+
+  // If true, maxregionblocksize is chosen by timing a simple loop
+  // with a range of block sizes, before creating the default regions
+  bool tune_regionblocksize{false};
+
+  /// The maxregionblocksize to use for the region \p region_name.
+  /// This can be set for each region in the [mesh:regionblocksize]
+  /// section of the input, and otherwise is maxregionblocksize
+  int getRegionBlockSize(const std::string &region_name);
   
   /// Get the named region from the region_map for the data iterator
   ///
@@ -718,6 +727,11 @@ class Mesh {
   ///
   /// Creates RGN_{ALL,NOBNDRY,NOX,NOY}
   void createDefaultRegions();
+
+  /// Time a simple loop over RGN_NOBNDRY with a range of block sizes,
+  /// and return the fastest. Timings are summed over all processors,
+  /// so that every processor chooses the same size
+  int tuneRegionBlockSize();
   
   /*!
    * Return the parallel transform, setting it if need be
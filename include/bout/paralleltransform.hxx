@@ -10,6 +10,7 @@
 #include <boutexception.hxx>
 #include <dcomplex.hxx>
 #include <unused.hxx>
+#include <utils.hxx>
 
 class Mesh;
 
@@ -98,6 +99,8 @@ public:
   /*!
    * Calculates the yup() and ydown() fields of f
    * by taking FFTs in Z and applying a phase shift.
+   * Each Z line is transformed once, and both the yup and
+   * ydown phase shifts applied to it.
    */ 
   void calcYUpDown(Field3D &f) override;
   
@@ -121,22 +124,22 @@ public:
     return true;
   }
 
-  /// A 3D array, implemented as nested vectors
-  typedef std::vector<std::vector<std::vector<dcomplex>>> arr3Dvec;
 private:
   Mesh &mesh; ///< The mesh this paralleltransform is part of
 
   /// This is the shift in toroidal angle (z) which takes a point from
   /// X-Z orthogonal to field-aligned along Y.
   Field2D zShift;
-  std::vector<dcomplex> cmplx; ///< A temporary array, used for input/output to fft routines
-  std::vector<dcomplex> cmplxLoc; ///< A temporary array, used for input/output to fft routines
 
-  arr3Dvec toAlignedPhs; ///< Cache of phase shifts for transforming from X-Z orthogonal coordinates to field-aligned coordinates
-  arr3Dvec fromAlignedPhs; ///< Cache of phase shifts for transforming from field-aligned coordinates to X-Z orthogonal coordinates
+  /// Number of Z Fourier modes, LocalNz/2 + 1
+  int nmodes;
 
-  arr3Dvec yupPhs; ///< Cache of phase shifts for calculating yup fields
-  arr3Dvec ydownPhs; ///< Cache of phase shifts for calculating ydown fields
+  /// Phase shifts are stored contiguously, indexed by (x, y, mode)
+  Tensor<dcomplex> toAlignedPhs; ///< Cache of phase shifts for transforming from X-Z orthogonal coordinates to field-aligned coordinates
+  Tensor<dcomplex> fromAlignedPhs; ///< Cache of phase shifts for transforming from field-aligned coordinates to X-Z orthogonal coordinates
+
+  Tensor<dcomplex> yupPhs; ///< Cache of phase shifts for calculating yup fields
+  Tensor<dcomplex> ydownPhs; ///< Cache of phase shifts for calculating ydown fields
 
   /*!
    * Shift a 2D field in Z. 
@@ -156,32 +159,27 @@ private:
   /*!
    * Shift a 3D field \p f by the given phase \p phs in Z
    *
-   * Calculates FFT in Z, multiplies by the complex phase
-   * and inverse FFTS.
+   * Calculates FFTs in Z of all lines in each X plane together,
+   * multiplies by the complex phase and inverse FFTS. X is divided
+   * between OpenMP threads.
    *
    * @param[in] f  The field to shift
    * @param[in] phs  The phase to shift by
    */
-  const Field3D shiftZ(const Field3D &f, const arr3Dvec &phs);
-
-  /*!
-   * Shift a given 1D array, assumed to be in Z, by the given \p zangle
-   *
-   * @param[in] in  A 1D array of length \p len
-   * @param[in] len  Length of the in and out arrays
-   * @param[in] zangle  The angle (z coordinate) to shift by
-   * @param[out] out  A 1D array of length \p len, already allocated
-   */
-  void shiftZ(const BoutReal *in, int len, BoutReal zangle,  BoutReal *out);
+  const Field3D shiftZ(const Field3D &f, const Tensor<dcomplex> &phs);
 
   /*!
-   * Shift a given 1D array, assumed to be in Z, by the given \p zangle
+   * Apply phases \p phs to the Fourier modes \p in of \p nlines
+   * consecutive Z lines, and inverse transform them into \p out
    *
-   * @param[in] in  A 1D array of length mesh.LocalNz
-   * @param[in] phs Phase shift, assumed to have length (mesh.LocalNz/2 + 1) i.e. the number of modes
-   * @param[out] out  A 1D array of length mesh.LocalNz, already allocated
+   * @param[in] in   Fourier modes, nmodes for each line
+   * @param[in] phs  Phase shifts, nmodes for each line
+   * @param[in] nlines  Number of lines
+   * @param[out] out  Lines of length mesh.LocalNz, already allocated
+   * @param[inout] cmplx  Work array of length at least nlines * nmodes
    */
-  void shiftZ(const BoutReal *in, const std::vector<dcomplex> &phs, BoutReal *out);
+  void applyPhase(const dcomplex *in, const dcomplex *phs, int nlines, BoutReal *out,
+                  Array<dcomplex> &cmplx);
 };
 
 
@@ -43,6 +43,11 @@ class PhysicsModel;
 #include "solver.hxx"
 #include "unused.hxx"
 #include "bout/macro_for_each.hxx"
+#include "bout/blockprecon.hxx"
+#include "bout/checkpoint.hxx"
+#include "bout/diagnostics.hxx"
+
+#include <memory>
 /*!
   Base class for physics models
  */
@@ -147,6 +152,13 @@ public:
   int runJacobian(BoutReal t);
 
   int runTimestepMonitor(BoutReal simtime, BoutReal dt) {return timestepMonitor(simtime, dt);}
+
+  /*!
+   * Set the parameter being varied in an eigenvalue scan
+   *
+   * Note: this is usually only called by the Solver
+   */
+  int runScanParameter(BoutReal value) { return scanParameter(value); }
   
 protected:
   
@@ -207,6 +219,14 @@ protected:
    */
   virtual int timestepMonitor(BoutReal UNUSED(simtime), BoutReal UNUSED(dt)) {return 0;}
 
+  /*!
+   * Eigenvalue scans. If solver:nscan is set, the eigenvalue solver
+   * calls this with each value of the scanned parameter (for example
+   * a toroidal mode number) before solving. Should return non-zero
+   * if the model doesn't support scans, which is the default.
+   */
+  virtual int scanParameter(BoutReal UNUSED(value)) {return 1;}
+
   
 
   // Functions called by the user to set callback functions
@@ -217,6 +237,11 @@ protected:
   /// Specify a preconditioner function
   void setPrecon(preconfunc pset) {userprecon = pset;}
 
+  /// Use a preconditioner built from the model's stiff terms. Only used
+  /// if no preconditioner function has been set. \p precon must not be
+  /// destroyed while the solver is running, and should be set in init()
+  void setPrecon(BlockPreconditioner &precon);
+
   /// Specify a Jacobian-vector multiply function
   void setJacobian(jacobianfunc jset) {userjacobian = jset;}
 
@@ -243,6 +268,14 @@ protected:
   /// Stores the state for restarting
   Datafile restart; 
 
+  /// If enabled, writes the restart file as atomic checkpoints
+  /// instead of at every output
+  std::unique_ptr<Checkpoint> checkpoint;
+
+  /// In-situ reduced diagnostics, if enabled in the "diagnostics"
+  /// section. Other 3D fields can be added in init()
+  std::unique_ptr<Diagnostics> diagnostics;
+
   /*!
    * Specify a constrained variable \p var, which will be
    * adjusted to make \p F_var equal to zero.
@@ -262,12 +295,8 @@ protected:
   public:
     PhysicsModelMonitor() = delete;
     PhysicsModelMonitor(PhysicsModel *model) : model(model) {}
-    int call(Solver* UNUSED(solver), BoutReal simtime, int iter, int nout) {
-      // Save state to restart file
-      model->restart.write();
-      // Call user output monitor
-      return model->outputMonitor(simtime, iter, nout);
-    }
+    /// Writes the restart file and calls the user output monitor
+    int call(Solver* solver, BoutReal simtime, int iter, int nout);
   private:
     PhysicsModel *model;
   };
@@ -275,18 +304,23 @@ protected:
   /// write restarts and pass outputMonitor method inside a Monitor subclass
   PhysicsModelMonitor modelMonitor;
 private:
+  friend class EnsembleModel; ///< Calls the members' init() and monitors
+
   bool splitop; ///< Split operator model?
   preconfunc   userprecon; ///< Pointer to user-supplied preconditioner function
+  BlockPreconditioner *blockprecon; ///< Preconditioner from stiff terms, used if no userprecon
   jacobianfunc userjacobian; ///< Pointer to user-supplied Jacobian-vector multiply function
   
   bool initialised; ///< True if model already initialised
 };
 
+#include "bout/ensemble.hxx"
+
 /*!
  * Macro to define a simple main() which creates
- * the given model and runs it. This should be sufficient
- * for most use cases, but a user can define their own
- * main() function if needed.
+ * the given model (or an ensemble of them, see EnsembleModel)
+ * and runs it. This should be sufficient for most use cases,
+ * but a user can define their own main() function if needed.
  *
  * Example
  * -------
@@ -305,7 +339,8 @@ private:
     else if (init_err > 0) 			      \
       return init_err;				      \
     try {                                             \
-      ModelClass *model = new ModelClass();           \
+      PhysicsModel *model =                           \
+          EnsembleModel::create<ModelClass>();        \
       Solver *solver = Solver::create();              \
       solver->setModel(model);                        \
       Monitor * bout_monitor = new BoutMonitor();     \
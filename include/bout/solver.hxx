@@ -92,6 +92,9 @@ typedef std::string SolverType;
 #define SOLVERIMEXBDF2    "imexbdf2"
 #define SOLVERSNES        "snes"
 #define SOLVERRKGENERIC   "rkgeneric"
+#define SOLVERBDF         "bdf"
+#define SOLVERPARAREAL    "parareal"
+#define SOLVERMULTIRATE   "multirate"
 
 enum SOLVER_VAR_OP {LOAD_VARS, LOAD_DERIVS, SET_ID, SAVE_VARS, SAVE_DERIVS};
 
@@ -267,12 +270,21 @@ class Solver {
   virtual void resetInternalFields(){
     throw BoutException("resetInternalFields not supported by this Solver");}
 
+  /// Set the simulation time, for example before restarting from a
+  /// different state with resetInternalFields()
+  void setTime(BoutReal t) { simtime = t; }
+  /// Current simulation time
+  BoutReal getTime() const { return simtime; }
+
   // Solver status. Optional functions used to query the solver
   /// Number of 2D variables. Vectors count as 3
   virtual int n2Dvars() const {return f2d.size();}
   /// Number of 3D variables. Vectors count as 3
   virtual int n3Dvars() const {return f3d.size();}
 
+  /// Get an evolving 3D variable by name. Returns nullptr if not found
+  Field3D *getField3D(const std::string &name);
+
   /// Get and reset the number of calls to the RHS function
   int resetRHSCounter();
   /// Same but for explicit timestep counter - for IMEX
@@ -293,6 +305,21 @@ class Solver {
   /// @param[in] save_repeat    If true, add variables with time dimension
   void outputVars(Datafile &outputfile, bool save_repeat=true);
 
+  /// Add the solver's internal state, such as the history of a
+  /// multistep scheme, to restart file \p outputfile, so that a
+  /// restarted run takes the same steps. This includes the number of
+  /// steps of history, "history_steps"
+  void outputHistory(Datafile &outputfile);
+
+  /// Copy the internal state into the variables added by
+  /// outputHistory. Called before each restart file is written
+  virtual void saveHistory() {}
+
+  /// Read the internal state from restart file \p filename, before
+  /// init() is called. Files without the state, for example written
+  /// by another solver, are read without error and no history is used
+  void readHistory(const std::string &filename);
+
   /*!
    * Create a Solver object. This uses the "type" option
    * in the given Option section to determine which solver
@@ -357,6 +384,7 @@ protected:
   int run_rhs(BoutReal t); ///< Run the user's RHS function
   int run_convective(BoutReal t); ///< Calculate only the convective parts
   int run_diffusive(BoutReal t, bool linear=true); ///< Calculate only the diffusive parts
+  void set_scan_parameter(BoutReal value); ///< Set the parameter of an eigenvalue scan
   
   int call_monitors(BoutReal simtime, int iter, int NOUT); ///< Calls all monitor functions
   
@@ -373,6 +401,31 @@ protected:
   void save_derivs(BoutReal *dudata);
   void set_id(BoutReal *udata);
   
+  /// Add the variables which hold the internal state to \p outputfile.
+  /// Solvers with a history override this and saveHistory(), and
+  /// restore the history in init() if history_steps > 0
+  virtual void outputHistoryVars(Datafile &UNUSED(outputfile)) {}
+
+  /// Number of steps in the history of the internal state, which may
+  /// be all the steps taken. Zero if there is none, e.g. before the
+  /// first step. Set by saveHistory() or run(), and by readHistory()
+  int history_steps = 0;
+
+  /// Fields with the same shape as the evolving variables, so that
+  /// state arrays can be saved in restart files
+  struct StateFields {
+    vector<Field2D> f2d;
+    vector<Field3D> f3d;
+  };
+
+  /// Add \p fields to \p outputfile, with names "<variable>_<suffix>".
+  /// The fields are created the first time
+  void add_state(StateFields &fields, Datafile &outputfile, const std::string &suffix);
+  /// Copy state array \p udata into \p fields, as load_vars would
+  void load_state(StateFields &fields, BoutReal *udata);
+  /// Copy \p fields into state array \p udata, as save_vars would
+  void save_state(StateFields &fields, BoutReal *udata);
+
   // 
   const Field3D globalIndex(int localStart);
   
@@ -405,6 +458,8 @@ private:
   // Loading data from BOUT++ to/from solver
   void loop_vars_op(Ind2D i2d, BoutReal *udata, int &p, SOLVER_VAR_OP op, bool bndry);
   void loop_vars(BoutReal *udata, SOLVER_VAR_OP op);
+  /// loop_vars with the evolving variables replaced by \p fields
+  void loop_state(StateFields &fields, BoutReal *udata, SOLVER_VAR_OP op);
 
   bool varAdded(const string &name); // Check if a variable has already been added
 };
@@ -0,0 +1,131 @@
+/*!
+ * \file surfaceaverage.hxx
+ *
+ * \brief Averages over Y, and flux-surface averages
+ *
+ **************************************************************************
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class SurfaceAverage;
+
+#ifndef __SURFACEAVERAGE_H__
+#define __SURFACEAVERAGE_H__
+
+#include "mpi.h"
+
+#include "bout/array.hxx"
+#include "bout/mesh.hxx"
+#include "field2d.hxx"
+#include "field3d.hxx"
+
+#include <vector>
+
+/*!
+ * Averages over Y (and Z) on each surface of constant X
+ *
+ * The communicator for each X index is taken from Mesh::getYcomm
+ * when the object is created, so that surfaces in the core, SOL and
+ * private flux regions are each averaged over their own processors.
+ * Neighbouring X indices with the same communicator are reduced
+ * together, in one message. The number of points (or the volume) on
+ * each surface is reduced with the sums, so processors may have
+ * different numbers of Y points.
+ *
+ * averageY gives the mean of the values in Y. fluxAverage is
+ * weighted by the volume element J dy dz, and also averages over Z:
+ *
+ * \f[
+ *    \left<f\right> = \frac{\oint f J dy dz}{\oint J dy dz}
+ * \f]
+ *
+ * The start functions begin the reductions without waiting for them
+ * to finish, so that other work can be done while communicating.
+ * The results are set by wait():
+ *
+ *     SurfaceAverage surface(mesh);
+ *     Field2D n_avg, T_avg;
+ *     surface.startFlux(n, n_avg);
+ *     surface.startFlux(T, T_avg);
+ *     ... // Other calculations
+ *     surface.wait();
+ *
+ * Results passed to the start functions must not be destroyed or
+ * used before wait() is called.
+ */
+class SurfaceAverage {
+public:
+  /// @param[in] mesh  The mesh to average over. Default is the global mesh
+  SurfaceAverage(Mesh *mesh = nullptr);
+  ~SurfaceAverage();
+
+  /// Average over Y, not including boundaries
+  const Field2D averageY(const Field2D &f);
+  const Field3D averageY(const Field3D &f);
+
+  /// Flux-surface average, weighted by the volume element
+  const Field2D fluxAverage(const Field2D &f);
+  const Field2D fluxAverage(const Field3D &f);
+
+  /// Start averaging \p f over Y, putting the average in \p result
+  void startY(const Field2D &f, Field2D &result);
+  void startY(const Field3D &f, Field3D &result);
+
+  /// Start a flux-surface average of \p f, putting the average in \p result
+  void startFlux(const Field2D &f, Field2D &result);
+  void startFlux(const Field3D &f, Field2D &result);
+
+  /// Wait for all averages which have been started, and set the results
+  void wait();
+
+private:
+  Mesh *localmesh;
+
+  /// Neighbouring X indices which share a communicator in Y
+  struct Surfaces {
+    MPI_Comm comm;
+    int xs, xe;
+  };
+  std::vector<Surfaces> groups;
+
+  /// Local sums of J*dy over Y for each X, calculated when first needed
+  Array<BoutReal> volume;
+
+  /// An average which has been started. For each X there are nvals
+  /// sums followed by the weight, in both local and global
+  struct Reduction {
+    int nvals;
+    Array<BoutReal> local, global;
+    std::vector<MPI_Request> requests;
+    Field2D *result2d;
+    Field3D *result3d;
+  };
+  std::vector<Reduction> pending;
+
+  /// Sums over Y of \p f for each X and Z. If \p weighted, each point
+  /// is multiplied by J*dy and the sum is over Z as well
+  Reduction sumY(const Field3D &f, bool weighted);
+  Reduction sumY(const Field2D &f, bool weighted);
+
+  /// Start the reductions of \p r over each group of surfaces
+  void start(Reduction &r);
+
+  /// Local sums of J*dy over Y for each X
+  const Array<BoutReal> &getVolume();
+};
+
+#endif // __SURFACEAVERAGE_H__
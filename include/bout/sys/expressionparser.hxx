@@ -26,6 +26,7 @@
 
 class FieldGenerator;
 class ExpressionParser;
+class ExpressionProgram;
 class ParseException;
 
 #ifndef __EXPRESSION_PARSER_H__
@@ -68,6 +69,16 @@ public:
   /// This should be deterministic, always returning the same value given the same inputs
   virtual double generate(double x, double y, double z, double t) = 0;
 
+  /// Can the result of generate() change with t? Used to decide whether
+  /// values can be cached. The default is conservative: generators
+  /// which are not known to be time-independent are assumed to depend on t
+  virtual bool dependsOnTime() { return true; }
+
+  /// Add instructions which evaluate this generator to \p program,
+  /// returning the register which will contain the result.
+  /// By default the program calls generate() at each point
+  virtual int compile(ExpressionProgram &program);
+
   /// Create a string representation of the generator, for debugging output
   virtual const std::string str() {return std::string("?");}
 };
@@ -159,6 +170,8 @@ public:
       : lhs(std::move(l)), rhs(std::move(r)), op(o) {}
   FieldGeneratorPtr clone(const std::list<FieldGeneratorPtr> args) override;
   double generate(double x, double y, double z, double t) override;
+  bool dependsOnTime() override { return lhs->dependsOnTime() || rhs->dependsOnTime(); }
+  int compile(ExpressionProgram &program) override;
 
   const std::string str() override {
     return std::string("(") + lhs->str() + std::string(1, op) + rhs->str() +
@@ -183,6 +196,8 @@ public:
                   double UNUSED(t)) override {
     return value;
   }
+  bool dependsOnTime() override { return false; }
+  int compile(ExpressionProgram &program) override;
   const std::string str() override {
     std::stringstream ss;
     ss << value;
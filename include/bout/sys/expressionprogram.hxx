@@ -0,0 +1,138 @@
+/*!************************************************************************
+ * \file expressionprogram.hxx
+ *
+ * Compiles a tree of generators into a flat list of instructions,
+ * which can be evaluated over many points at once
+ *
+ **************************************************************************
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class ExpressionProgram;
+
+#ifndef __EXPRESSION_PROGRAM_H__
+#define __EXPRESSION_PROGRAM_H__
+
+#include "bout/sys/expressionparser.hxx"
+
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+/*!
+ * A FieldGenerator tree compiled into a list of instructions, rather
+ * than a virtual generate() call per node per point.
+ *
+ * Each instruction operates on a whole block of points, so the inner
+ * loops can be vectorised. When instructions are added, operations on
+ * constants are evaluated immediately (constant folding), and repeated
+ * instructions with the same inputs are only added once (common
+ * subexpression elimination). Results are identical to generate(),
+ * since the same operations are performed in the same order.
+ *
+ * Generators which don't override FieldGenerator::compile are called
+ * through generate() at each point, so any tree can be compiled.
+ *
+ * Example
+ * -------
+ *
+ *     ExpressionProgram program(FieldFactory::get()->parse("sin(x) + t"));
+ *     std::vector<double> work;
+ *     program.evaluate(n, x, y, z, t, result, work);
+ */
+class ExpressionProgram {
+public:
+  using UnaryFunction = double (*)(double);
+  using BinaryFunction = double (*)(double, double);
+
+  /// Compile the tree of generators \p gen. A reference to the tree
+  /// is kept, as generators may be called during evaluation
+  explicit ExpressionProgram(FieldGeneratorPtr gen);
+
+  /// Evaluate at \p n points, with coordinates \p x, \p y, \p z and
+  /// time \p t, putting the results in \p result
+  ///
+  /// @param[inout] work  Workspace, resized if needed. Can be reused
+  ///                     between calls, but not shared between threads
+  void evaluate(int n, const double *x, const double *y, const double *z, double t,
+                double *result, std::vector<double> &work) const;
+
+  /// Number of instructions, after constant folding and eliminating
+  /// common subexpressions
+  int size() const { return static_cast<int>(instructions.size()); }
+
+  /// Is the result the same at every point and time?
+  bool isConstant() const {
+    return instructions[result_register].op == Op::Constant;
+  }
+
+  // Used by FieldGenerator::compile to add instructions. Each of these
+  // returns the register which will contain the result
+
+  /// A fixed value
+  int constant(double value);
+  /// One of the coordinates 'x', 'y', 'z' or time 't'
+  int variable(char name);
+  /// Arithmetic operator '+', '-', '*' or '/'
+  int binary(char op, int a, int b);
+  /// The smaller (larger) of two values, b if b < a (b > a) otherwise a
+  int min(int a, int b);
+  int max(int a, int b);
+  /// Call a function of one or two arguments
+  int call(UnaryFunction func, int a);
+  int call(BinaryFunction func, int a, int b);
+  /// Call gen->generate(x,y,z,t) at each point
+  int generate(FieldGenerator *gen);
+
+private:
+  enum class Op {
+    Constant, X, Y, Z, T, Add, Sub, Mul, Div, Min, Max, Call1, Call2, Generate
+  };
+
+  struct Instruction {
+    Op op;
+    int a, b;                       ///< Input registers, or -1
+    double value;                   ///< Constant value
+    UnaryFunction func1;
+    BinaryFunction func2;
+    FieldGenerator *gen;
+    int slot;                       ///< Storage for the result
+  };
+
+  /// Instruction i puts its result in register i
+  std::vector<Instruction> instructions;
+  int result_register;
+
+  /// Number of storage slots. Registers which are no longer needed
+  /// share storage, so this can be less than the number of instructions
+  int nslots;
+
+  /// Instructions already added, to find common subexpressions
+  using Key = std::tuple<int, int, int, std::uint64_t, std::uintptr_t>;
+  std::map<Key, int> lookup;
+
+  FieldGeneratorPtr root; ///< Keeps generators used in Op::Generate alive
+
+  /// Add an instruction, folding constants and eliminating duplicates
+  int add(Instruction ins);
+
+  /// Remove unused instructions, and assign storage slots to registers
+  void allocateSlots();
+};
+
+#endif // __EXPRESSION_PROGRAM_H__
@@ -49,6 +49,18 @@ public:
   static int rank(); ///< Rank: my processor number
   static int size(); ///< Size: number of processors
 
+  /// Split the processors into \p ngroups groups of equal size, each
+  /// of which then works independently: get() returns the communicator
+  /// of this processor's group. Must be called before the mesh is created
+  static void split(int ngroups);
+
+  static int group();  ///< Index of this processor's group, 0 if not split
+  static int groups(); ///< Number of groups, 1 if not split
+
+  /// Communicator between the processors with the same rank in every
+  /// group, ordered by group. MPI_COMM_SELF if not split
+  static MPI_Comm acrossGroups();
+
   // Setting options
   void setComm(MPI_Comm c);
 
@@ -62,6 +74,9 @@ public:
   int *pargc; char ***pargv; ///< Command-line arguments. These can be modified by MPI init, so pointers are used
   bool hasBeenSet;
   MPI_Comm comm;
+
+  int ngroups, mygroup; ///< Number of groups, and the group of this processor
+  MPI_Comm across;      ///< Communicator between groups
   
   static BoutComm* instance; ///< The only instance of this class (Singleton)
 
@@ -79,6 +79,7 @@ public:
     MPI_Comm_rank(c, &myp);
     if ((size != N) || (np != nprocs) || (myp != myproc))
       Nsys = 0; // Need to re-size
+    factored = false;
     N = size;
     periodic = false;
     nprocs = np;
@@ -161,6 +162,9 @@ public:
         coefs(j, 4 * i + 2) = c(j, i);
         // 4*i + 3 will contain RHS
       }
+
+    // Factorise again at the next solve
+    factored = false;
   }
 
   /// Solve a single triadiagonal system
@@ -253,9 +257,15 @@ public:
         coefs(j, 4 * i + 3) = rhs(j, i);
       }
 
+    if (!factored) {
+      // Only depends on the coefficients, so is reused by following
+      // solves until setCoefs is called again
+      factorise();
+    }
+
     ///////////////////////////////////////
     // Reduce local part of the matrix to interface equations
-    reduce(Nsys, N, coefs, myif);
+    reduceRHS();
 
     ///////////////////////////////////////
     // Gather all interface equations onto single processor
@@ -496,7 +506,7 @@ public:
 
     ///////////////////////////////////////
     // Solve local equations
-    back_solve(Nsys, N, coefs, x1, xn, x);
+    backSolveRHS(x);
     delete[] req;
   }
 
@@ -510,6 +520,7 @@ private:
   int sys0; ///< Starting system index for interface solve
 
   bool periodic; ///< Is the domain periodic?
+  bool factored = false; ///< Is the factorisation of coefs up to date?
 
   Matrix<T> coefs; ///< Starting coefficients, rhs [Nsys, {3*coef,rhs}*N]
   Matrix<T> myif;  ///< Interface equations for this processor
@@ -521,6 +532,9 @@ private:
   Array<T> ifp;         ///< Interface equations returned to processor p
   Array<T> x1, xn;      ///< Interface solutions for back-solving
 
+  Matrix<T> upper_beta, lower_alpha; ///< Multipliers used in reduce [Nsys, N]
+  Matrix<T> thomas_gam, thomas_bet;  ///< Thomas algorithm factors used in back_solve
+
   /// Allocate memory arrays
   /// @param[in] np   Number of processors
   /// @param[in] nsys  Number of independent systems to solve
@@ -548,6 +562,12 @@ private:
 
     coefs = Matrix<T>(Nsys, 4 * N);
     myif = Matrix<T>(Nsys, 8);
+    factored = false;
+
+    upper_beta = Matrix<T>(Nsys, N);
+    lower_alpha = Matrix<T>(Nsys, N);
+    thomas_gam = Matrix<T>(Nsys, N);
+    thomas_bet = Matrix<T>(Nsys, N);
 
     // Note: The recvbuffer is used to receive data in both stages of the solve:
     //  1. In the gather step, this processor will receive myns interface equations
@@ -686,6 +706,114 @@ private:
       }
     }
   }
+
+  /// Calculate the parts of reduce and back_solve for the local
+  /// equations which only depend on the coefficients, so that
+  /// solving with a new RHS only needs one forward and one backward
+  /// sweep through the local rows.
+  ///
+  /// Sets the coefficients (but not the RHS) of the interface
+  /// equations in myif, the multipliers upper_beta and lower_alpha
+  /// used in reduce, and the factors used in back_solve.
+  void factorise() {
+    TRACE("CyclicReduce::factorise");
+
+#ifdef DIAGNOSE
+    if (N < 2)
+      throw BoutException("CyclicReduce::factorise N < 2");
+#endif
+
+    myif.ensureUnique();
+    upper_beta.ensureUnique();
+    lower_alpha.ensureUnique();
+    thomas_gam.ensureUnique();
+    thomas_bet.ensureUnique();
+
+    BOUT_OMP(parallel for)
+    for (int j = 0; j < Nsys; j++) {
+      // Upper interface equation, as in reduce
+      for (int i = 0; i < 3; i++) {
+        myif(j, i) = coefs(j, 4 * (N - 2) + i);
+      }
+      for (int i = N - 3; i >= 0; i--) {
+        if (abs(myif(j, 1)) < 1e-10)
+          throw BoutException("Zero pivot in CyclicReduce::factorise");
+
+        T beta = coefs(j, 4 * i + 2) / myif(j, 1);
+        upper_beta(j, i) = beta;
+
+        myif(j, 1) = coefs(j, 4 * i + 1) - beta * myif(j, 0);
+        myif(j, 0) = coefs(j, 4 * i);
+        myif(j, 2) *= -beta;
+      }
+
+      // Lower interface equation
+      for (int i = 0; i < 3; i++) {
+        myif(j, 4 + i) = coefs(j, 4 + i);
+      }
+      for (int i = 2; i < N; i++) {
+        if (abs(myif(j, 4 + 1)) < 1e-10)
+          throw BoutException("Zero pivot in CyclicReduce::factorise");
+
+        T alpha = coefs(j, 4 * i) / myif(j, 4 + 1);
+        lower_alpha(j, i) = alpha;
+
+        myif(j, 4 + 0) *= -alpha;
+        myif(j, 4 + 1) = coefs(j, 4 * i + 1) - alpha * myif(j, 4 + 2);
+        myif(j, 4 + 2) = coefs(j, 4 * i + 2);
+      }
+
+      // Thomas algorithm for the rows between the interface values
+      thomas_gam(j, 1) = 0.;
+      for (int i = 1; i < N - 1; i++) {
+        T bet = coefs(j, 4 * i + 1) - coefs(j, 4 * i) * thomas_gam(j, i);
+        thomas_bet(j, i) = bet;
+        thomas_gam(j, i + 1) = coefs(j, 4 * i + 2) / bet;
+      }
+    }
+    factored = true;
+  }
+
+  /// Calculate the RHS of the interface equations in myif, using
+  /// the multipliers from factorise. Equivalent to reduce(Nsys, N, coefs, myif)
+  void reduceRHS() {
+    myif.ensureUnique();
+
+    BOUT_OMP(parallel for)
+    for (int j = 0; j < Nsys; j++) {
+      T bu = coefs(j, 4 * (N - 2) + 3);
+      for (int i = N - 3; i >= 0; i--) {
+        bu = coefs(j, 4 * i + 3) - upper_beta(j, i) * bu;
+      }
+      myif(j, 3) = bu;
+
+      T bl = coefs(j, 4 + 3);
+      for (int i = 2; i < N; i++) {
+        bl = coefs(j, 4 * i + 3) - lower_alpha(j, i) * bl;
+      }
+      myif(j, 4 + 3) = bl;
+    }
+  }
+
+  /// Back-solve the local equations using the factors from factorise.
+  /// Equivalent to back_solve(Nsys, N, coefs, x1, xn, xa)
+  void backSolveRHS(Matrix<T> &xa) {
+    xa.ensureUnique();
+
+    BOUT_OMP(parallel for)
+    for (int i = 0; i < Nsys; i++) {
+      xa(i, 0) = x1[i];
+      for (int j = 1; j < N - 1; j++) {
+        xa(i, j) = (coefs(i, 4 * j + 3) - coefs(i, 4 * j) * xa(i, j - 1)) /
+                   thomas_bet(i, j);
+      }
+      xa(i, N - 1) = xn[i];
+
+      for (int j = N - 2; j > 0; j--) {
+        xa(i, j) = xa(i, j) - thomas_gam(i, j + 1) * xa(i, j + 1);
+      }
+    }
+  }
 };
 
 #endif // __CYCLIC_REDUCE_H__
@@ -72,10 +72,30 @@ class Datafile {
   void add(Field3D &f, const char *name, bool save_repeat = false);
   void add(Vector2D &f, const char *name, bool save_repeat = false);
   void add(Vector3D &f, const char *name, bool save_repeat = false);
+
+  /// Add \p suffix to the names of variables added from now on, until
+  /// it is set back to an empty string. Used to save the variables of
+  /// several copies of a model, whose names would otherwise clash
+  void setNameSuffix(const std::string &suffix) { name_suffix = suffix; }
   
   bool read();  ///< Read data into added variables 
   bool write(); ///< Write added variables
 
+  /// Check whether the per-processor files \p filename were written
+  /// with a different number of processors in X or Y than the
+  /// current mesh. Always false for parallel files. Must be called
+  /// on all processors.
+  bool decompositionChanged(const char *filename, ...)
+    BOUT_FORMAT_ARGS( 2, 3);
+
+  /// Read data into added variables from per-processor files which were
+  /// written with a different processor layout. Each processor reads only
+  /// the parts of the old files which overlap its own domain. Y guard
+  /// cells at branch cuts and targets are read from the old guard
+  /// cells there. Must be called on all processors.
+  bool readRedistributed(const char *filename, ...)
+    BOUT_FORMAT_ARGS( 2, 3);
+
   bool write(const char *filename, ...) const
     BOUT_FORMAT_ARGS( 2, 3); ///< Opens, writes, closes file
   
@@ -129,6 +149,12 @@ class Datafile {
   vector< VarStr<Vector2D> > v2d_arr;
   vector< VarStr<Vector3D> > v3d_arr;
 
+  /// Added to the names of variables when they are added
+  string name_suffix;
+
+  /// Read int and BoutReal variables from the open file
+  void read_scalars();
+
   bool read_f2d(const string &name, Field2D *f, bool save_repeat);
   bool read_f3d(const string &name, Field3D *f, bool save_repeat);
 
@@ -43,6 +43,8 @@
 
 #include "bout/solver.hxx"
 
+#include <vector>
+
 /*!
  * Parallel derivative (central differencing) in Y
  * along unperturbed field 
@@ -316,4 +318,24 @@ const Field3D bracket(const Field3D &f, const Field3D &g,
                       BRACKET_METHOD method = BRACKET_STD, CELL_LOC outloc = CELL_DEFAULT,
                       Solver *solver = nullptr);
 
+/*!
+ * Poisson brackets of one potential with several fields, for example
+ *
+ *     auto ddt_terms = bracket(phi, {n, vort, T}, BRACKET_ARAKAWA);
+ *
+ * With the Arakawa method the differences of \p f are shared between
+ * all the fields, otherwise each bracket is calculated separately.
+ *
+ * @param[in] f  The potential
+ * @param[in] gs The fields being advected
+ * @param[in] method   The method to use
+ * @param[in] outloc   The cell location where the result is defined. Default is the same as gs
+ * @param[in] solver   Pointer to the time integration solver
+ *
+ * @returns [f, g] for each g in \p gs, in the same order
+ */
+std::vector<Field3D> bracket(const Field3D &f, const std::vector<Field3D> &gs,
+                             BRACKET_METHOD method = BRACKET_STD,
+                             CELL_LOC outloc = CELL_DEFAULT, Solver *solver = nullptr);
+
 #endif /* __DIFOPS_H__ */
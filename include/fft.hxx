@@ -64,6 +64,31 @@ void rfft(const BoutReal *in, int length, dcomplex *out);
  */
 void irfft(const dcomplex *in, int length, BoutReal *out);
 
+/*!
+ * Take the fft of \p howmany real signals at once. This is equivalent to
+ * calling rfft on each in turn, but faster.
+ *
+ * \param[in] in      Signal i is in[i*in_dist] ... in[i*in_dist + length - 1]
+ * \param[in] length  Number of points in each signal
+ * \param[in] howmany Number of signals
+ * \param[in] in_dist Distance between the start of each signal in \p in
+ * \param[out] out    The FFT of signal i, out[i*(length/2 + 1)] ...
+ *                    out[i*(length/2 + 1) + length/2]
+ */
+void rfft(const BoutReal *in, int length, int howmany, int in_dist, dcomplex *out);
+
+/*!
+ * Take the inverse fft of \p howmany signals at once. This is equivalent to
+ * calling irfft on each in turn, but faster.
+ *
+ * \param[in] in       Input i is in[i*(length/2 + 1)] ... in[i*(length/2 + 1) + length/2]
+ * \param[in] length   Number of points in each output signal
+ * \param[in] howmany  Number of signals
+ * \param[out] out     Output i is out[i*out_dist] ... out[i*out_dist + length - 1]
+ * \param[in] out_dist Distance between the start of each signal in \p out
+ */
+void irfft(const dcomplex *in, int length, int howmany, BoutReal *out, int out_dist);
+
 /*!
  * Discrete Sine Transform
  *
@@ -33,6 +33,7 @@ class FieldFactory;
 #include "bout/mesh.hxx"
 
 #include "bout/sys/expressionparser.hxx"
+#include "bout/sys/expressionprogram.hxx"
 
 #include "field2d.hxx"
 #include "field3d.hxx"
@@ -82,6 +83,12 @@ private:
   
   // Cache parsed strings
   std::map<std::string, FieldGeneratorPtr > cache;
+
+  /// Compiled versions of generators, used to create fields
+  std::map<FieldGenerator *, std::shared_ptr<ExpressionProgram>> programs;
+
+  /// Compile \p gen, or return the existing program if already compiled
+  const ExpressionProgram &compile(const FieldGeneratorPtr &gen);
   
   const Options* findOption(const Options *opt, const std::string &name, std::string &val);
 };
@@ -109,6 +116,8 @@ public:
                   double UNUSED(t)) override {
     return 0.0;
   }
+  bool dependsOnTime() override { return false; }
+  int compile(ExpressionProgram &program) override { return program.constant(0.0); }
   FieldGeneratorPtr clone(const std::list<FieldGeneratorPtr> UNUSED(args)) override {
     return get();
   }
@@ -33,6 +33,10 @@
 #define __GYRO_AVERAGE_H__
 
 #include "field3d.hxx"
+#include "invert_laplace.hxx"
+
+#include <memory>
+#include <vector>
 
 const int GYRO_FLAGS = 64 + 16384 + 32768; ///< = INVERT_BNDRY_ONE | INVERT_IN_RHS | INVERT_OUT_RHS; uses old-style Laplacian inversion flags
 
@@ -96,4 +100,72 @@ const Field3D gyroPade2(const Field3D &f, const Field2D &rho,
 const Field3D gyroPade2(const Field3D &f, BoutReal rho, 
                         int flags=GYRO_FLAGS);
 
+/// Pade approximation gyro-averages for a given gyro-radius
+///
+/// Unlike gyroPade0/1/2, which set the coefficients of the default
+/// Laplacian solver at every call, this keeps its own Laplacian
+/// solvers with the coefficients set once. Solvers which store their
+/// matrices (e.g. cyclic) therefore only factorise them again if the
+/// gyro-radius is changed.
+///
+/// \f$\Gamma_2\f$ is calculated from
+///
+/// \f[
+///    \Gamma_2(f) = (1 - \frac{1}{2} \rho^2 \nabla_\perp^2)^{-2}f - \Gamma_1(f)
+/// \f]
+///
+/// which is equal to the gyroPade2 expression, but doesn't need the
+/// Delp2 or the communication. pade12 returns both \f$\Gamma_1\f$ and
+/// \f$\Gamma_2\f$ for the cost of \f$\Gamma_2\f$ alone.
+///
+/// Example
+/// -------
+///
+///     GyroPade gyro(rho_i, INVERT_IN_RHS | INVERT_OUT_RHS);
+///     gyro.pade12(phi, phi_G, Phi_G);
+///
+/// The versions taking a vector of fields solve for all of them
+/// together, which for the cyclic solver combines the communications.
+class GyroPade {
+public:
+  /// @param[in] rho    Gyro-radius. Z average is used if a Field3D
+  /// @param[in] flags  Flags to be passed to the Laplacian inversion operator
+  /// @param[in] opt    Options for the Laplacian solvers. Default is "laplace"
+  GyroPade(BoutReal rho, int flags = GYRO_FLAGS, Options *opt = nullptr);
+  GyroPade(const Field2D &rho, int flags = GYRO_FLAGS, Options *opt = nullptr);
+  GyroPade(const Field3D &rho, int flags = GYRO_FLAGS, Options *opt = nullptr);
+  ~GyroPade();
+
+  /// Change the gyro-radius, setting the solvers' coefficients
+  void setRho(BoutReal rho);
+  void setRho(const Field2D &rho);
+  void setRho(const Field3D &rho) { setRho(DC(rho)); }
+
+  /// \f$ \Gamma_0 = (1 - \rho^2 \nabla_\perp^2)^{-1} f\f$
+  const Field3D pade0(const Field3D &f);
+  /// \f$ \Gamma_1 = (1 - \frac{1}{2} \rho^2 \nabla_\perp^2)^{-1} f\f$
+  const Field3D pade1(const Field3D &f);
+  /// \f$\Gamma_2\f$, as in gyroPade2
+  const Field3D pade2(const Field3D &f);
+
+  /// Calculate both \f$\Gamma_1\f$ and \f$\Gamma_2\f$ of \p f
+  void pade12(const Field3D &f, Field3D &gamma1, Field3D &gamma2);
+
+  std::vector<Field3D> pade0(const std::vector<Field3D> &f);
+  std::vector<Field3D> pade1(const std::vector<Field3D> &f);
+  std::vector<Field3D> pade2(const std::vector<Field3D> &f);
+
+private:
+  Field2D rho2;  ///< Square of the gyro-radius
+  int flags;     ///< Inversion flags
+  Options *opt;  ///< Options for the Laplacian solvers
+
+  /// Solvers for 1 - rho^2 Delp2 and 1 - rho^2/2 Delp2, created when
+  /// first used
+  std::unique_ptr<Laplacian> lap0, lap1;
+
+  /// Return the solver for 1 + d Delp2, creating it if needed
+  Laplacian *getSolver(std::unique_ptr<Laplacian> &lap, BoutReal factor);
+};
+
 #endif // __GYRO_AVERAGE_H__
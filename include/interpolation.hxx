@@ -31,6 +31,9 @@
 #include "mask.hxx"
 #include "utils.hxx"
 
+#include <utility>
+#include <vector>
+
 /// Interpolate to a give cell location
 const Field3D interp_to(const Field3D &var, CELL_LOC loc, REGION region = RGN_ALL);
 const Field2D interp_to(const Field2D &var, CELL_LOC loc, REGION region = RGN_ALL);
@@ -110,6 +113,29 @@ protected:
   Field3D h10_z;
   Field3D h11_z;
 
+  // Optional precomputed sparse operator, with the derivative stencils
+  // folded into the weights. Each interpolated point (row) is a weighted
+  // sum of sparse_width values of f, stored contiguously in ELL format.
+  // Indices are into the field data, followed by the halo lines
+
+  bool sparse; // Use the sparse operator? Option "interpolation:sparse"
+  static constexpr int sparse_width = 16; // 4x4 points in X-Z
+  Array<int> sparse_rows;                 // Index of each interpolated point
+  Array<int> sparse_cols;                 // Indices of the points used
+  Array<BoutReal> sparse_weights;         // Weight for each point used
+
+  // Points outside the local X range, including guard cells, can be
+  // read from a halo of Z lines, supplied by the caller
+
+  bool halo; // Allow points outside the local X range?
+  std::vector<std::pair<int, int>> halo_lines; // (x, y) local index of each line
+
+  /// Assemble the sparse operator from the basis functions and corners
+  void calcSparse();
+
+  /// Apply the sparse operator to \p f, with \p halo values if needed
+  Field3D applySparse(const Field3D &f, const BoutReal *halo) const;
+
 public:
   HermiteSpline(Mesh *mesh = nullptr) : HermiteSpline(0, mesh) {}
   HermiteSpline(int y_offset = 0, Mesh *mesh = nullptr);
@@ -134,6 +160,22 @@ public:
                       const Field3D &delta_z) override;
   Field3D interpolate(const Field3D &f, const Field3D &delta_x, const Field3D &delta_z,
                       const BoutMask &mask) override;
+
+  /// Allow points outside the local X range, for example on other
+  /// processors. This uses the sparse operator, and must be set before
+  /// the weights are calculated
+  virtual void setHalo(bool allow) {
+    halo = allow;
+    sparse |= allow;
+  }
+
+  /// The Z lines outside the local X range needed by the current
+  /// weights, as (x, y) local indices
+  const std::vector<std::pair<int, int>> &getHaloLines() const { return halo_lines; }
+
+  /// Interpolate using precalculated weights, with the values of each
+  /// line in getHaloLines() stored contiguously in \p halo_values
+  Field3D interpolate(const Field3D &f, const std::vector<BoutReal> &halo_values) const;
 };
 
 
@@ -147,16 +189,30 @@ public:
 /// problems most obviously occur.
 class MonotonicHermiteSpline : public HermiteSpline {
 public:
-  MonotonicHermiteSpline(Mesh *mesh = nullptr) : HermiteSpline(0, mesh) {}
+  // The sparse operator is not used, as limiting needs the corner values
+  MonotonicHermiteSpline(Mesh *mesh = nullptr) : HermiteSpline(0, mesh) {
+    sparse = false;
+  }
   MonotonicHermiteSpline(int y_offset = 0, Mesh *mesh = nullptr)
-      : HermiteSpline(y_offset, mesh) {}
+      : HermiteSpline(y_offset, mesh) {
+    sparse = false;
+  }
   MonotonicHermiteSpline(const BoutMask &mask, int y_offset = 0, Mesh *mesh = nullptr)
-      : HermiteSpline(mask, y_offset, mesh) {}
+      : HermiteSpline(mask, y_offset, mesh) {
+    sparse = false;
+  }
 
   /// Callback function for InterpolationFactory
   static Interpolation *CreateMonotonicHermiteSpline(Mesh *mesh) {
     return new MonotonicHermiteSpline(mesh);
   }
+
+  void setHalo(bool allow) override {
+    if (allow) {
+      throw BoutException("MonotonicHermiteSpline does not support points outside "
+                          "the local X range");
+    }
+  }
   
   /// Interpolate using precalculated weights.
   /// This function is called by the other interpolate functions
@@ -47,6 +47,8 @@ class Laplacian;
 #include "dcomplex.hxx"
 #include "options.hxx"
 
+#include <vector>
+
 // Inversion flags for each boundary
 const int INVERT_DC_GRAD  = 1; ///< Zero-gradient for DC (constant in Z) component. Default is zero value
 const int INVERT_AC_GRAD  = 2; ///< Zero-gradient for AC (non-constant in Z) component. Default is zero value
@@ -182,6 +184,10 @@ public:
   virtual const Field3D solve(const Field3D &b, const Field3D &x0);
   virtual const Field2D solve(const Field2D &b, const Field2D &x0);
 
+  /// Solve for several right-hand sides with the same coefficients.
+  /// Implementations may solve them together, combining communications
+  virtual std::vector<Field3D> solve(const std::vector<Field3D> &b);
+
   /// Coefficients in tridiagonal inversion
   void tridagCoefs(int jx, int jy, int jz, dcomplex &a, dcomplex &b, dcomplex &c,
                    const Field2D *ccoef = nullptr, const Field2D *d = nullptr,
@@ -39,34 +39,16 @@ const Field3D smooth_y(const Field3D &f);
 /// Smooth using a stencil in X and Y
 const Field3D smoothXY(const Field3D &f);
 
-/*! 
- * Average over Y
- *
- * Issues
- * ======
- * 
- * Important: Only works if there are no branch cuts
+/*!
+ * Average over Y, not including boundaries
  *
- * Assumes every processor has the same domain shape
- * 
+ * Each X index is averaged over the processors on its surface, so
+ * this works with branch cuts. For repeated averages, or to overlap
+ * the communication with other work, use SurfaceAverage
  */
 const Field2D averageY(const Field2D &f);
 
-/*!
- * Average in Y
- * 
- * Issues
- * ======
- * 
- * Important: Only works if there are no branch cuts
- *
- * Creates static arrays
- * 
- * Not thread safe
- *
- * Assumes every processor has the same domain shape
- * 
- */
+/// Average in Y at each X and Z, as for Field2D
 const Field3D averageY(const Field3D &f);
 
 /// Average over X
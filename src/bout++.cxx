@@ -413,7 +413,38 @@ int BoutInitialise(int &argc, char **&argv) {
 
   try {
     /////////////////////////////////////////////
-    
+    /// Parallel-in-time solvers, eigenvalue scans and ensembles split
+    /// the processors into groups, each with its own copy of the mesh.
+    /// Only the first group writes output and restart files
+    string solver_type;
+    Options *solver_options = options->getSection("solver");
+    solver_options->get("type", solver_type, "");
+    string split_source = solver_type; ///< What the groups are for
+    int groups = 1;
+    if (solver_type == SOLVERPARAREAL) {
+      solver_options->get("time_slices", groups, 1);
+    } else if (solver_type == SOLVERPOWER) {
+      solver_options->get("scan_groups", groups, 1);
+    } else {
+      Options *ensemble_options = options->getSection("ensemble");
+      int members;
+      ensemble_options->get("members", members, 1);
+      if (members > 1) {
+        ensemble_options->get("groups", groups, 1);
+        split_source = "ensemble";
+      }
+    }
+    if (groups > 1) {
+      BoutComm::split(groups);
+      output_info.write("Split processors into %d groups\n", groups);
+      if (BoutComm::group() != 0) {
+        options->getSection("output")->set("enabled", false, split_source);
+        options->getSection("restart")->set("enabled", false, split_source);
+      }
+    }
+
+    /////////////////////////////////////////////
+
     mesh = Mesh::create();  ///< Create the mesh
     mesh->load();           ///< Load from sources. Required for Field initialisation
     mesh->setParallelTransform(); ///< Set the parallel transform from options
@@ -23,7 +23,9 @@
 
 #include <field_factory.hxx>
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 #include <output.hxx>
 #include <bout/constants.hxx>
@@ -121,35 +123,31 @@ const Field2D FieldFactory::create2D(const string &value, const Options *opt,
     return result;
   }
 
-  switch(loc)  {
-  case CELL_XLOW: {
-    BOUT_FOR(i, localmesh->getRegion2D("RGN_ALL")) {
-      BoutReal xpos = 0.5 * (localmesh->GlobalX(i.x() - 1) + localmesh->GlobalX(i.x()));
-      result[i] = gen->generate(xpos, TWOPI * localmesh->GlobalY(i.y()),
-                                0.0, // Z
-                                t);  // T
-    }
-    break;
-  }
-  case CELL_YLOW: {
-    BOUT_FOR(i, localmesh->getRegion2D("RGN_ALL")) {
-      BoutReal ypos =
-          TWOPI * 0.5 * (localmesh->GlobalY(i.y() - 1) + localmesh->GlobalY(i.y()));
-      result[i] = gen->generate(localmesh->GlobalX(i.x()), ypos,
-                                0.0, // Z
-                                t);  // T
-    }
-    break;
-  }
-  default: {// CELL_CENTRE or CELL_ZLOW
-    BOUT_FOR(i, localmesh->getRegion2D("RGN_ALL")) {
-      result[i] =
-          gen->generate(localmesh->GlobalX(i.x()), TWOPI * localmesh->GlobalY(i.y()),
-                        0.0, // Z
-                        t);  // T
+  // Evaluate the compiled expression one line in Y at a time
+  const ExpressionProgram &program = compile(gen);
+  const int ny = localmesh->LocalNy;
+
+  BOUT_OMP(parallel) {
+    std::vector<BoutReal> xpos(ny), ypos(ny), zpos(ny, 0.0), work;
+    BOUT_OMP(for)
+    for (int x = 0; x < localmesh->LocalNx; x++) {
+      if (loc == CELL_XLOW) {
+        std::fill(xpos.begin(), xpos.end(),
+                  0.5 * (localmesh->GlobalX(x - 1) + localmesh->GlobalX(x)));
+      } else {
+        std::fill(xpos.begin(), xpos.end(), localmesh->GlobalX(x));
+      }
+      for (int y = 0; y < ny; y++) {
+        if (loc == CELL_YLOW) {
+          ypos[y] = TWOPI * 0.5 * (localmesh->GlobalY(y - 1) + localmesh->GlobalY(y));
+        } else {
+          ypos[y] = TWOPI * localmesh->GlobalY(y);
+        }
+      }
+      program.evaluate(ny, xpos.data(), ypos.data(), zpos.data(), t, &result(x, 0),
+                       work);
     }
   }
-  };
 
   // Don't delete the generator, as will be cached
 
@@ -179,48 +177,39 @@ const Field3D FieldFactory::create3D(const string &value, const Options *opt,
     throw BoutException("FieldFactory error: Couldn't create 3D field from '%s'", value.c_str());
   }
 
-  switch(loc)  {
-  case CELL_XLOW: {
-    BOUT_FOR(i, localmesh->getRegion3D("RGN_ALL")) {
-      BoutReal xpos = 0.5 * (localmesh->GlobalX(i.x() - 1) + localmesh->GlobalX(i.x()));
-      result[i] = gen->generate(xpos, TWOPI * localmesh->GlobalY(i.y()),
-                                TWOPI * static_cast<BoutReal>(i.z()) /
-                                    static_cast<BoutReal>(localmesh->LocalNz), // Z
-                                t);                                            // T
-    }
-    break;
-  }
-  case CELL_YLOW: {
-    BOUT_FOR(i, localmesh->getRegion3D("RGN_ALL")) {
-      BoutReal ypos =
-          TWOPI * 0.5 * (localmesh->GlobalY(i.y() - 1) + localmesh->GlobalY(i.y()));
-      result[i] = gen->generate(localmesh->GlobalX(i.x()), ypos,
-                                TWOPI * static_cast<BoutReal>(i.z()) /
-                                    static_cast<BoutReal>(localmesh->LocalNz), // Z
-                                t);                                            // T
-    }
-    break;
-  }
-  case CELL_ZLOW: {
-    BOUT_FOR(i, localmesh->getRegion3D("RGN_ALL")) {
-      result[i] =
-          gen->generate(localmesh->GlobalX(i.x()), TWOPI * localmesh->GlobalY(i.y()),
-                        TWOPI * (static_cast<BoutReal>(i.z()) - 0.5) /
-                            static_cast<BoutReal>(localmesh->LocalNz), // Z
-                        t);                                            // T
+  // Evaluate the compiled expression one line in Z at a time
+  const ExpressionProgram &program = compile(gen);
+  const int nz = localmesh->LocalNz;
+
+  BOUT_OMP(parallel) {
+    std::vector<BoutReal> xpos(nz), ypos(nz), zpos(nz), work;
+    for (int z = 0; z < nz; z++) {
+      if (loc == CELL_ZLOW) {
+        zpos[z] = TWOPI * (static_cast<BoutReal>(z) - 0.5) / static_cast<BoutReal>(nz);
+      } else {
+        zpos[z] = TWOPI * static_cast<BoutReal>(z) / static_cast<BoutReal>(nz);
+      }
     }
-    break;
-  }
-  default: {// CELL_CENTRE
-    BOUT_FOR(i, localmesh->getRegion3D("RGN_ALL")) {
-      result[i] =
-          gen->generate(localmesh->GlobalX(i.x()), TWOPI * localmesh->GlobalY(i.y()),
-                        TWOPI * static_cast<BoutReal>(i.z()) /
-                            static_cast<BoutReal>(localmesh->LocalNz), // Z
-                        t);                                            // T
+    BOUT_OMP(for collapse(2))
+    for (int x = 0; x < localmesh->LocalNx; x++) {
+      for (int y = 0; y < localmesh->LocalNy; y++) {
+        if (loc == CELL_XLOW) {
+          std::fill(xpos.begin(), xpos.end(),
+                    0.5 * (localmesh->GlobalX(x - 1) + localmesh->GlobalX(x)));
+        } else {
+          std::fill(xpos.begin(), xpos.end(), localmesh->GlobalX(x));
+        }
+        if (loc == CELL_YLOW) {
+          std::fill(ypos.begin(), ypos.end(),
+                    TWOPI * 0.5 * (localmesh->GlobalY(y - 1) + localmesh->GlobalY(y)));
+        } else {
+          std::fill(ypos.begin(), ypos.end(), TWOPI * localmesh->GlobalY(y));
+        }
+        program.evaluate(nz, xpos.data(), ypos.data(), zpos.data(), t, &result(x, y, 0),
+                         work);
+      }
     }
   }
-  };
 
   // Don't delete generator
   
@@ -377,4 +366,14 @@ FieldFactory* FieldFactory::get() {
 
 void FieldFactory::cleanCache() {
   cache.clear();
+  programs.clear();
+}
+
+const ExpressionProgram &FieldFactory::compile(const FieldGeneratorPtr &gen) {
+  auto it = programs.find(gen.get());
+  if (it == programs.end()) {
+    // The program keeps the generator alive, so the key stays valid
+    it = programs.emplace(gen.get(), std::make_shared<ExpressionProgram>(gen)).first;
+  }
+  return *it->second;
 }
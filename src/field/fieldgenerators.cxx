@@ -20,6 +20,11 @@ BoutReal FieldSin::generate(double x, double y, double z, double t) {
   return sin(gen->generate(x, y, z, t));
 }
 
+int FieldSin::compile(ExpressionProgram &program) {
+  return program.call(static_cast<ExpressionProgram::UnaryFunction>(sin),
+                      gen->compile(program));
+}
+
 FieldGeneratorPtr FieldCos::clone(const list<FieldGeneratorPtr> args) {
   if (args.size() != 1) {
     throw ParseException(
@@ -34,6 +39,11 @@ BoutReal FieldCos::generate(double x, double y, double z, double t) {
   return cos(gen->generate(x, y, z, t));
 }
 
+int FieldCos::compile(ExpressionProgram &program) {
+  return program.call(static_cast<ExpressionProgram::UnaryFunction>(cos),
+                      gen->compile(program));
+}
+
 FieldGeneratorPtr FieldSinh::clone(const list<FieldGeneratorPtr> args) {
   if (args.size() != 1) {
     throw ParseException(
@@ -48,6 +58,11 @@ BoutReal FieldSinh::generate(double x, double y, double z, double t) {
   return sinh(gen->generate(x, y, z, t));
 }
 
+int FieldSinh::compile(ExpressionProgram &program) {
+  return program.call(static_cast<ExpressionProgram::UnaryFunction>(sinh),
+                      gen->compile(program));
+}
+
 FieldGeneratorPtr FieldCosh::clone(const list<FieldGeneratorPtr> args) {
   if (args.size() != 1) {
     throw ParseException(
@@ -62,6 +77,11 @@ BoutReal FieldCosh::generate(double x, double y, double z, double t) {
   return cosh(gen->generate(x, y, z, t));
 }
 
+int FieldCosh::compile(ExpressionProgram &program) {
+  return program.call(static_cast<ExpressionProgram::UnaryFunction>(cosh),
+                      gen->compile(program));
+}
+
 FieldGeneratorPtr FieldTanh::clone(const list<FieldGeneratorPtr> args) {
   if (args.size() != 1) {
     throw ParseException(
@@ -75,6 +95,11 @@ BoutReal FieldTanh::generate(double x, double y, double z, double t) {
   return tanh(gen->generate(x, y, z, t));
 }
 
+int FieldTanh::compile(ExpressionProgram &program) {
+  return program.call(static_cast<ExpressionProgram::UnaryFunction>(tanh),
+                      gen->compile(program));
+}
+
 FieldGeneratorPtr FieldGaussian::clone(const list<FieldGeneratorPtr> args) {
   if ((args.size() < 1) || (args.size() > 2)) {
     throw ParseException(
@@ -97,6 +122,19 @@ BoutReal FieldGaussian::generate(double x, double y, double z, double t) {
   return exp(-SQ(X->generate(x,y,z,t)/sigma)/2.) / (sqrt(TWOPI) * sigma);
 }
 
+int FieldGaussian::compile(ExpressionProgram &program) {
+  // Same operations as generate()
+  int sigma = s->compile(program);
+  int scaled = program.binary('/', X->compile(program), sigma);
+  int arg = program.binary('*', program.constant(-1.0),
+                           program.binary('*', scaled, scaled));
+  arg = program.binary('/', arg, program.constant(2.));
+  return program.binary('/',
+                        program.call(static_cast<ExpressionProgram::UnaryFunction>(exp),
+                                     arg),
+                        program.binary('*', program.constant(sqrt(TWOPI)), sigma));
+}
+
 FieldGeneratorPtr FieldAbs::clone(const list<FieldGeneratorPtr> args) {
   if (args.size() != 1) {
     throw ParseException(
@@ -111,6 +149,11 @@ BoutReal FieldAbs::generate(double x, double y, double z, double t) {
   return fabs(gen->generate(x, y, z, t));
 }
 
+int FieldAbs::compile(ExpressionProgram &program) {
+  return program.call(static_cast<ExpressionProgram::UnaryFunction>(fabs),
+                      gen->compile(program));
+}
+
 FieldGeneratorPtr FieldSqrt::clone(const list<FieldGeneratorPtr> args) {
   if (args.size() != 1) {
     throw ParseException(
@@ -125,6 +168,11 @@ BoutReal FieldSqrt::generate(double x, double y, double z, double t) {
   return sqrt(gen->generate(x, y, z, t));
 }
 
+int FieldSqrt::compile(ExpressionProgram &program) {
+  return program.call(static_cast<ExpressionProgram::UnaryFunction>(sqrt),
+                      gen->compile(program));
+}
+
 FieldGeneratorPtr FieldHeaviside::clone(const list<FieldGeneratorPtr> args) {
   if (args.size() != 1) {
     throw ParseException(
@@ -139,6 +187,11 @@ BoutReal FieldHeaviside::generate(double x, double y, double z, double t) {
   return (gen->generate(x, y, z, t) > 0.0) ? 1.0 : 0.0;
 }
 
+int FieldHeaviside::compile(ExpressionProgram &program) {
+  return program.call([](double val) -> double { return (val > 0.0) ? 1.0 : 0.0; },
+                      gen->compile(program));
+}
+
 FieldGeneratorPtr FieldErf::clone(const list<FieldGeneratorPtr> args) {
   if (args.size() != 1) {
     throw ParseException(
@@ -153,6 +206,11 @@ BoutReal FieldErf::generate(double x, double y, double z, double t) {
   return erf(gen->generate(x,y,z,t));
 }
 
+int FieldErf::compile(ExpressionProgram &program) {
+  return program.call(static_cast<ExpressionProgram::UnaryFunction>(erf),
+                      gen->compile(program));
+}
+
 //////////////////////////////////////////////////////////
 // Ballooning transform
 // Use a truncated Ballooning transform to enforce periodicity in y and z
@@ -9,6 +9,7 @@
 
 #include <field_factory.hxx>
 #include <boutexception.hxx>
+#include <bout/sys/expressionprogram.hxx>
 #include <unused.hxx>
 
 #include <cmath>
@@ -40,6 +41,8 @@ public:
   FieldGeneratorPtr clone(const list<FieldGeneratorPtr > args);
   BoutReal generate(double x, double y, double z, double t);
   const std::string str() {return std::string("sin(")+gen->str()+std::string(")");}
+  bool dependsOnTime() { return gen->dependsOnTime(); }
+  int compile(ExpressionProgram &program);
 private:
   FieldGeneratorPtr gen;
 };
@@ -53,6 +56,8 @@ public:
   BoutReal generate(double x, double y, double z, double t);
 
   const std::string str() {return std::string("cos(")+gen->str()+std::string(")");}
+  bool dependsOnTime() { return gen->dependsOnTime(); }
+  int compile(ExpressionProgram &program);
 private:
   FieldGeneratorPtr gen;
 };
@@ -75,6 +80,10 @@ public:
     return Op(gen->generate(x,y,z,t));
   }
   const std::string str() {return std::string("func(")+gen->str()+std::string(")");}
+  bool dependsOnTime() { return gen->dependsOnTime(); }
+  int compile(ExpressionProgram &program) {
+    return program.call(Op, gen->compile(program));
+  }
 private:
   FieldGeneratorPtr gen;
 };
@@ -100,6 +109,10 @@ public:
     return std::string("cos(") + A->str() + "," + B->str() + std::string(")");
   }
 
+  bool dependsOnTime() { return A->dependsOnTime() || B->dependsOnTime(); }
+  int compile(ExpressionProgram &program) {
+    return program.call(Op, A->compile(program), B->compile(program));
+  }
 private:
   FieldGeneratorPtr A, B;
 };
@@ -123,6 +136,17 @@ public:
       return atan(A->generate(x,y,z,t));
     return atan2(A->generate(x,y,z,t), B->generate(x,y,z,t));
   }
+  bool dependsOnTime() {
+    return A->dependsOnTime() || ((B != nullptr) && B->dependsOnTime());
+  }
+  int compile(ExpressionProgram &program) {
+    if (B == nullptr) {
+      return program.call(static_cast<ExpressionProgram::UnaryFunction>(atan),
+                          A->compile(program));
+    }
+    return program.call(static_cast<ExpressionProgram::BinaryFunction>(atan2),
+                        A->compile(program), B->compile(program));
+  }
 private:
   FieldGeneratorPtr A, B;
 };
@@ -134,6 +158,8 @@ public:
 
   FieldGeneratorPtr clone(const list<FieldGeneratorPtr > args);
   BoutReal generate(double x, double y, double z, double t);
+  bool dependsOnTime() { return gen->dependsOnTime(); }
+  int compile(ExpressionProgram &program);
 private:
   FieldGeneratorPtr gen;
 };
@@ -145,6 +171,8 @@ public:
 
   FieldGeneratorPtr clone(const list<FieldGeneratorPtr > args);
   BoutReal generate(double x, double y, double z, double t);
+  bool dependsOnTime() { return gen->dependsOnTime(); }
+  int compile(ExpressionProgram &program);
 private:
   FieldGeneratorPtr gen;
 };
@@ -156,6 +184,8 @@ public:
 
   FieldGeneratorPtr clone(const list<FieldGeneratorPtr > args);
   BoutReal generate(double x, double y, double z, double t);
+  bool dependsOnTime() { return gen->dependsOnTime(); }
+  int compile(ExpressionProgram &program);
 private:
   FieldGeneratorPtr gen;
 };
@@ -167,6 +197,8 @@ public:
 
   FieldGeneratorPtr clone(const list<FieldGeneratorPtr > args);
   BoutReal generate(double x, double y, double z, double t);
+  bool dependsOnTime() { return X->dependsOnTime() || s->dependsOnTime(); }
+  int compile(ExpressionProgram &program);
 private:
   FieldGeneratorPtr X, s;
 };
@@ -178,6 +210,8 @@ public:
 
   FieldGeneratorPtr clone(const list<FieldGeneratorPtr > args);
   BoutReal generate(double x, double y, double z, double t);
+  bool dependsOnTime() { return gen->dependsOnTime(); }
+  int compile(ExpressionProgram &program);
 private:
   FieldGeneratorPtr gen;
 };
@@ -189,6 +223,8 @@ public:
 
   FieldGeneratorPtr clone(const list<FieldGeneratorPtr > args);
   BoutReal generate(double x, double y, double z, double t);
+  bool dependsOnTime() { return gen->dependsOnTime(); }
+  int compile(ExpressionProgram &program);
 private:
   FieldGeneratorPtr gen;
 };
@@ -201,6 +237,8 @@ public:
   FieldGeneratorPtr clone(const list<FieldGeneratorPtr > args);
   BoutReal generate(double x, double y, double z, double t);
   const std::string str() {return std::string("H(")+gen->str()+std::string(")");}
+  bool dependsOnTime() { return gen->dependsOnTime(); }
+  int compile(ExpressionProgram &program);
 private:
   FieldGeneratorPtr gen;
 };
@@ -212,6 +250,8 @@ public:
 
   FieldGeneratorPtr clone(const list<FieldGeneratorPtr > args);
   BoutReal generate(double x, double y, double z, double t);
+  bool dependsOnTime() { return gen->dependsOnTime(); }
+  int compile(ExpressionProgram &program);
 private:
   FieldGeneratorPtr gen;
 };
@@ -237,6 +277,21 @@ public:
     }
     return result;
   }
+  bool dependsOnTime() {
+    for (const auto &it : input) {
+      if (it->dependsOnTime()) {
+        return true;
+      }
+    }
+    return false;
+  }
+  int compile(ExpressionProgram &program) {
+    int result = input.front()->compile(program);
+    for (auto it = std::next(input.begin()); it != input.end(); it++) {
+      result = program.min(result, (*it)->compile(program));
+    }
+    return result;
+  }
 private:
   list<FieldGeneratorPtr > input;
 };
@@ -262,6 +317,21 @@ public:
     }
     return result;
   }
+  bool dependsOnTime() {
+    for (const auto &it : input) {
+      if (it->dependsOnTime()) {
+        return true;
+      }
+    }
+    return false;
+  }
+  int compile(ExpressionProgram &program) {
+    int result = input.front()->compile(program);
+    for (auto it = std::next(input.begin()); it != input.end(); it++) {
+      result = program.max(result, (*it)->compile(program));
+    }
+    return result;
+  }
 private:
   list<FieldGeneratorPtr > input;
 };
@@ -283,6 +353,17 @@ public:
     }
     return static_cast<int>(val - 0.5);
   }
+  bool dependsOnTime() { return gen->dependsOnTime(); }
+  int compile(ExpressionProgram &program) {
+    return program.call(
+        [](double val) -> double {
+          if (val > 0.0) {
+            return static_cast<int>(val + 0.5);
+          }
+          return static_cast<int>(val - 0.5);
+        },
+        gen->compile(program));
+  }
 private:
   FieldGeneratorPtr gen;
 };
@@ -299,6 +380,7 @@ public:
   FieldBallooning(Mesh *m, FieldGeneratorPtr a = nullptr, int n = 3) : mesh(m), arg(a), ball_n(n) {}
   FieldGeneratorPtr clone(const list<FieldGeneratorPtr > args);
   BoutReal generate(double x, double y, double z, double t);
+  bool dependsOnTime() { return (arg != nullptr) && arg->dependsOnTime(); }
 private:
   Mesh *mesh;
   FieldGeneratorPtr arg;
@@ -314,6 +396,7 @@ public:
   FieldMixmode(FieldGeneratorPtr a = nullptr, BoutReal seed = 0.5);
   FieldGeneratorPtr clone(const list<FieldGeneratorPtr > args);
   BoutReal generate(double x, double y, double z, double t);
+  bool dependsOnTime() { return (arg != nullptr) && arg->dependsOnTime(); }
 private:
   /// Generate a random number between 0 and 1 (exclusive)
   /// given an arbitrary seed value
@@ -339,6 +422,10 @@ public:
   // Clone containing the list of arguments
   FieldGeneratorPtr clone(const list<FieldGeneratorPtr > args);
   BoutReal generate(double x, double y, double z, double t);
+  bool dependsOnTime() {
+    return X->dependsOnTime() || width->dependsOnTime() || center->dependsOnTime() ||
+           steepness->dependsOnTime();
+  }
 private:
   // The (x,y,z,t) field
   FieldGeneratorPtr X;
@@ -1,10 +1,12 @@
-
 #include <bout/globalfield.hxx>
 #include <boutexception.hxx>
 #include <boutcomm.hxx>
 
+#include <algorithm>
+
 GlobalField::GlobalField(Mesh *m, int proc, int xsize, int ysize, int zsize) 
-  : mesh(m), data_on_proc(proc), nx(xsize), ny(ysize), nz(zsize) {
+  : mesh(m), data_on_proc(proc), data_is_local(false), nx(xsize), ny(ysize), nz(zsize),
+    node_comm(MPI_COMM_NULL), leader_comm(MPI_COMM_NULL) {
   
   comm = BoutComm::get(); // This should come from Mesh
   
@@ -14,13 +16,52 @@ GlobalField::GlobalField(Mesh *m, int proc, int xsize, int ysize, int zsize)
   if(nx*ny*nz <= 0)
     throw BoutException("GlobalField data must have non-zero size");
 
+  if((proc < 0) || (proc >= npes))
+    throw BoutException("Processor out of range");
+
   if(mype == proc) {
     // Allocate memory
     data = Array<BoutReal>(nx * ny * nz);
   }
+
+  // Message sizes and offsets into the packed buffer
+  counts.resize(npes);
+  displs.resize(npes);
+  int offset = 0;
+  for(int p=0;p<npes;p++) {
+    counts[p] = msg_len(p);
+    displs[p] = offset;
+    offset += counts[p];
+  }
+
+  // The block of the local array which this processor sends and receives.
+  // Note nz is 1 for 2D fields
+  int local_xorig, local_yorig;
+  proc_local_origin(mype, &local_xorig, &local_yorig);
+  int xsize_local, ysize_local;
+  proc_size(mype, &xsize_local, &ysize_local);
+
+  int sizes[3] = {mesh->LocalNx, mesh->LocalNy, nz};
+  int subsizes[3] = {xsize_local, ysize_local, nz};
+  int starts[3] = {local_xorig, local_yorig, 0};
+  MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE,
+                           &local_block);
+  MPI_Type_commit(&local_block);
 }
 
 GlobalField::~GlobalField() {
+  int finalized;
+  MPI_Finalized(&finalized);
+  if (finalized) {
+    return;
+  }
+  MPI_Type_free(&local_block);
+  if (node_comm != MPI_COMM_NULL) {
+    MPI_Comm_free(&node_comm);
+  }
+  if (leader_comm != MPI_COMM_NULL) {
+    MPI_Comm_free(&leader_comm);
+  }
 }
 
 void GlobalField::proc_local_origin(int proc, int *x, int *y, int *z) const {
@@ -78,340 +119,261 @@ void GlobalField::proc_size(int proc, int *lx, int *ly, int *lz) const {
     *lx += mesh->xstart;
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////
-
-GlobalField2D::GlobalField2D(Mesh *m, int proc) : GlobalField(m, proc, m->GlobalNx, m->GlobalNy-2*m->ystart, 1), 
-  data_valid(false) {
-  
-  if((proc < 0) || (proc >= npes))
-    throw BoutException("Processor out of range");
-  
-  if(mype == data_on_proc) {
-    // Gathering onto this processor
-    buffer = new BoutReal*[npes];
-    for(int p=0;p<npes;p++)
-      buffer[p] = new BoutReal[msg_len(p)];
-  }else {
-    buffer = new BoutReal*[1];
-    buffer[0] = new BoutReal[msg_len(mype)];
-  }
+int GlobalField::msg_len(int proc) const {
+  int xsize, ysize;
+  proc_size(proc, &xsize, &ysize);
+  return xsize * ysize * nz;
 }
 
-GlobalField2D::~GlobalField2D() {
-  if(mype == data_on_proc) {
-    for(int p=0;p<npes;p++)
-      delete[] buffer[p];
-  }else
-    delete[] buffer[0];
-  delete[] buffer;
+void GlobalField::allocateData() {
+  if (data.empty()) {
+    data = Array<BoutReal>(nx * ny * nz);
+  }
 }
 
-void GlobalField2D::gather(const Field2D &f) {
-  // Gather all data onto processor 'proc'
-  
-  if(mype == data_on_proc) {
-    // This processor will receive the data
-    
-    MPI_Request* req = new MPI_Request[npes]; // Array of receive handles
-
-    // Post receives
-    for(int p = 0; p < npes; p++) {
-      if( p != mype ) {
-        // Check size of the array
-        MPI_Irecv(buffer[p], msg_len(p), MPI_DOUBLE, p, 3141, comm, &req[p]);
-      }
-    }
-    
-    req[mype] = MPI_REQUEST_NULL; // Mark as not used
-    
-    // Copy data from this processor
-    int local_xorig, local_yorig;
-    proc_local_origin(mype, &local_xorig, &local_yorig);
+void GlobalField::unpack(const BoutReal *buf, const std::vector<int> &procs) {
+  for (int p : procs) {
     int xorig, yorig;
-    proc_origin(mype, &xorig, &yorig);
+    proc_origin(p, &xorig, &yorig);
     int xsize, ysize;
-    proc_size(mype, &xsize, &ysize);
-    
-    for(int x=0;x<xsize;x++)
-      for(int y=0;y<ysize;y++) {
-        (*this)(x+xorig,y+yorig) =  f(local_xorig+x, local_yorig+y);
+    proc_size(p, &xsize, &ysize);
+
+    // Each X-Y point has a contiguous block of nz values,
+    // both in the buffer and in the global array
+    for (int x = 0; x < xsize; x++) {
+      for (int y = 0; y < ysize; y++) {
+        std::copy(buf, buf + nz, &(*this)(x + xorig, y + yorig, 0));
+        buf += nz;
       }
-    
-    if(npes > 1) {
-      // Wait for receives, process as they arrive
-      int pe;
-      MPI_Status status;
-      do {
-        MPI_Waitany(npes, req, &pe, &status);
-
-        if(pe != MPI_UNDEFINED) {
-          // Unpack data from processor 'pe'
-          int remote_xorig, remote_yorig;
-          proc_origin(pe, &remote_xorig, &remote_yorig);
-          int remote_xsize, remote_ysize;
-          proc_size(pe, &remote_xsize, &remote_ysize);
-          
-          for(int x=0;x<remote_xsize;x++)
-            for(int y=0;y<remote_ysize;y++) {
-              (*this)(x+remote_xorig,y+remote_yorig) =  buffer[pe][x*remote_ysize + y];
-            }
-          
-          req[pe] = MPI_REQUEST_NULL;
-        }
-      }while(pe != MPI_UNDEFINED);
     }
-    delete[] req;
-  }else {
-    // Sending data to proc
-    
-    int local_xorig, local_yorig;
-    proc_local_origin(mype, &local_xorig, &local_yorig);
-    int xsize, ysize;
-    proc_size(mype, &xsize, &ysize);
-    
-    for(int x=0;x<xsize;x++)
-      for(int y=0;y<ysize;y++) {
-        buffer[0][x*ysize + y] = f(local_xorig+x, local_yorig+y);
-      }
+  }
+}
 
-    MPI_Send(buffer[0], msg_len(mype), MPI_DOUBLE, data_on_proc, 3141, comm);
+void GlobalField::gatherData(const BoutReal *local) {
+  // Gather all data onto processor 'data_on_proc'
+  if (mype == data_on_proc) {
+    if (buffer.empty()) {
+      buffer = Array<BoutReal>(nx * ny * nz);
+    }
+  }
+
+  MPI_Gatherv(const_cast<BoutReal *>(local), 1, local_block, std::begin(buffer),
+              counts.data(), displs.data(), MPI_DOUBLE, data_on_proc, comm);
+
+  data_is_local = (mype == data_on_proc);
+  if (data_is_local) {
+    std::vector<int> procs(npes);
+    for (int p = 0; p < npes; p++) {
+      procs[p] = p;
+    }
+    unpack(std::begin(buffer), procs);
   }
-  data_valid = true;
 }
 
-const Field2D GlobalField2D::scatter() const {
-  Field2D result(mesh);
-  result.allocate();
-  
-  MPI_Status status;
-  if(mype == data_on_proc) {
-    // Data is on this processor. Send to other processors
-    
-    for(int p = 0; p < npes; p++) {
-      if(p == mype) continue;
-      
+void GlobalField::allGatherData(const BoutReal *local) {
+  // Every processor needs the whole buffer
+  if (buffer.empty()) {
+    buffer = Array<BoutReal>(nx * ny * nz);
+  }
+  allocateData();
+
+  MPI_Allgatherv(const_cast<BoutReal *>(local), 1, local_block, std::begin(buffer),
+                 counts.data(), displs.data(), MPI_DOUBLE, comm);
+
+  std::vector<int> procs(npes);
+  for (int p = 0; p < npes; p++) {
+    procs[p] = p;
+  }
+  unpack(std::begin(buffer), procs);
+  data_is_local = true;
+}
+
+void GlobalField::createNodeComms() {
+#if MPI_VERSION >= 3
+  // Processors which share memory. Ordering by global rank means that
+  // node ranks are in the same order as global ranks
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, mype, MPI_INFO_NULL, &node_comm);
+  int node_rank, node_size;
+  MPI_Comm_rank(node_comm, &node_rank);
+  MPI_Comm_size(node_comm, &node_size);
+
+  // The first processor on each node
+  MPI_Comm_split(comm, (node_rank == 0) ? 0 : MPI_UNDEFINED, mype, &leader_comm);
+
+  // Which processors are on this node
+  std::vector<int> node_procs(node_size);
+  MPI_Allgather(&mype, 1, MPI_INT, node_procs.data(), 1, MPI_INT, node_comm);
+
+  node_counts.resize(node_size);
+  node_displs.resize(node_size);
+  int offset = 0;
+  for (int i = 0; i < node_size; i++) {
+    node_counts[i] = msg_len(node_procs[i]);
+    node_displs[i] = offset;
+    offset += node_counts[i];
+  }
+
+  if (leader_comm == MPI_COMM_NULL) {
+    return;
+  }
+
+  // Leaders exchange the list of processors on each node,
+  // and the total size of the data from each node
+  int nnodes;
+  MPI_Comm_size(leader_comm, &nnodes);
+
+  std::vector<int> node_sizes(nnodes), node_offsets(nnodes);
+  MPI_Allgather(&node_size, 1, MPI_INT, node_sizes.data(), 1, MPI_INT, leader_comm);
+  offset = 0;
+  for (int n = 0; n < nnodes; n++) {
+    node_offsets[n] = offset;
+    offset += node_sizes[n];
+  }
+  leader_procs.resize(npes);
+  MPI_Allgatherv(node_procs.data(), node_size, MPI_INT, leader_procs.data(),
+                 node_sizes.data(), node_offsets.data(), MPI_INT, leader_comm);
+
+  leader_counts.assign(nnodes, 0);
+  leader_displs.resize(nnodes);
+  offset = 0;
+  for (int n = 0; n < nnodes; n++) {
+    for (int i = node_offsets[n]; i < node_offsets[n] + node_sizes[n]; i++) {
+      leader_counts[n] += msg_len(leader_procs[i]);
+    }
+    leader_displs[n] = offset;
+    offset += leader_counts[n];
+  }
+#endif
+}
+
+void GlobalField::nodeGatherData(const BoutReal *local) {
+#if MPI_VERSION >= 3
+  if (node_comm == MPI_COMM_NULL) {
+    createNodeComms();
+  }
+
+  // Gather onto the first processor on this node
+  Array<BoutReal> node_buffer;
+  int node_total = 0;
+  if (leader_comm != MPI_COMM_NULL) {
+    for (int len : node_counts) {
+      node_total += len;
+    }
+    node_buffer = Array<BoutReal>(node_total);
+  }
+  MPI_Gatherv(const_cast<BoutReal *>(local), 1, local_block, std::begin(node_buffer),
+              node_counts.data(), node_displs.data(), MPI_DOUBLE, 0, node_comm);
+
+  data_is_local = (leader_comm != MPI_COMM_NULL);
+  if (!data_is_local) {
+    return;
+  }
+
+  // Exchange between nodes
+  if (buffer.empty()) {
+    buffer = Array<BoutReal>(nx * ny * nz);
+  }
+  allocateData();
+
+  MPI_Allgatherv(std::begin(node_buffer), node_total, MPI_DOUBLE, std::begin(buffer),
+                 leader_counts.data(), leader_displs.data(), MPI_DOUBLE, leader_comm);
+
+  unpack(std::begin(buffer), leader_procs);
+#else
+  // Without shared memory communicators every processor is a node
+  allGatherData(local);
+#endif
+}
+
+void GlobalField::scatterData(BoutReal *local) const {
+  if (mype == data_on_proc) {
+    if (buffer.empty()) {
+      buffer = Array<BoutReal>(nx * ny * nz);
+    }
+
+    // Pack the data for each processor
+    BoutReal *buf = std::begin(buffer);
+    for (int p = 0; p < npes; p++) {
       int xorig, yorig;
       proc_origin(p, &xorig, &yorig);
       int xsize, ysize;
       proc_size(p, &xsize, &ysize);
-      
-      // Send to processor p
-      for(int x=0;x<xsize;x++)
-        for(int y=0;y<ysize;y++) {
-          buffer[p][x*ysize + y] = (*this)(x+xorig,y+yorig);
-        }
-      
-      MPI_Send(buffer[p], xsize*ysize, MPI_DOUBLE, p, 1413, comm);
-    }
 
-    int local_xorig, local_yorig;
-    proc_local_origin(mype, &local_xorig, &local_yorig);
-    int xorig, yorig;
-    proc_origin(mype, &xorig, &yorig);
-    int xsize, ysize;
-    proc_size(mype, &xsize, &ysize);
-    
-    // Copy to result
-    for(int x=0;x<xsize;x++)
-      for(int y=0;y<ysize;y++) {
-        result(local_xorig+x,local_yorig+y) = (*this)(x+xorig,y+yorig);
-      }
-  }else {
-    // Receive data
-    MPI_Recv(buffer[0], msg_len(mype), MPI_DOUBLE, data_on_proc, 1413, comm, &status);
-    
-    int local_xorig, local_yorig;
-    proc_local_origin(mype, &local_xorig, &local_yorig);
-    int xorig, yorig;
-    proc_origin(mype, &xorig, &yorig);
-    int xsize, ysize;
-    proc_size(mype, &xsize, &ysize);
-    
-    for(int x=0;x<xsize;x++)
-      for(int y=0;y<ysize;y++) {
-        result(local_xorig+x,local_yorig+y) = buffer[0][x*ysize + y];
+      for (int x = 0; x < xsize; x++) {
+        for (int y = 0; y < ysize; y++) {
+          const BoutReal *val = &(*this)(x + xorig, y + yorig, 0);
+          std::copy(val, val + nz, buf);
+          buf += nz;
+        }
       }
+    }
   }
-  return result;
+
+  MPI_Scatterv(std::begin(buffer), const_cast<int *>(counts.data()),
+               const_cast<int *>(displs.data()), MPI_DOUBLE, local, 1, local_block,
+               data_on_proc, comm);
 }
 
-int GlobalField2D::msg_len(int proc) const {
-  int xsize, ysize;
-  proc_size(proc, &xsize, &ysize);
-  return xsize * ysize;
+///////////////////////////////////////////////////////////////////////////////////////////
+
+GlobalField2D::GlobalField2D(Mesh *m, int proc) : GlobalField(m, proc, m->GlobalNx, m->GlobalNy-2*m->ystart, 1), 
+  data_valid(false) {
+}
+
+GlobalField2D::~GlobalField2D() {
+}
+
+void GlobalField2D::gather(const Field2D &f) {
+  gatherData(&f(0, 0));
+  data_valid = true;
+}
+
+void GlobalField2D::allGather(const Field2D &f) {
+  allGatherData(&f(0, 0));
+  data_valid = true;
+}
+
+void GlobalField2D::gatherToNodes(const Field2D &f) {
+  nodeGatherData(&f(0, 0));
+  data_valid = true;
+}
+
+const Field2D GlobalField2D::scatter() const {
+  Field2D result(mesh);
+  result.allocate();
+
+  scatterData(&result(0, 0));
+  return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 
 GlobalField3D::GlobalField3D(Mesh *m, int proc) : GlobalField(m, proc, m->GlobalNx, m->GlobalNy-2*m->ystart, m->LocalNz), 
   data_valid(false) {
-  
-  if((proc < 0) || (proc >= npes))
-    throw BoutException("Processor out of range");
-  
-  if(mype == data_on_proc) {
-    // Gathering onto this processor
-    buffer = new BoutReal*[npes];
-    for(int p=0;p<npes;p++)
-      buffer[p] = new BoutReal[msg_len(p)];
-  }else {
-    buffer = new BoutReal*[1];
-    buffer[0] = new BoutReal[msg_len(mype)];
-  }
 }
 
 GlobalField3D::~GlobalField3D() {
-  if(mype == data_on_proc) {
-    for(int p=0;p<npes;p++)
-      delete[] buffer[p];
-  }else
-    delete[] buffer[0];
-  delete[] buffer;
 }
 
 void GlobalField3D::gather(const Field3D &f) {
-  // Gather all data onto processor 'proc'
-  
-  if(mype == data_on_proc) {
-    // This processor will receive the data
-    
-    MPI_Request* req = new MPI_Request[npes]; // Array of receive handles
-
-    // Post receives
-    for(int p = 0; p < npes; p++) {
-      if( p != mype ) {
-        // Check size of the array
-        MPI_Irecv(buffer[p], msg_len(p), MPI_DOUBLE, p, 3141, comm, &req[p]);
-      }
-    }
-    
-    req[mype] = MPI_REQUEST_NULL; // Mark as not used
-    
-    // Copy data from this processor
-    int local_xorig, local_yorig;
-    proc_local_origin(mype, &local_xorig, &local_yorig);
-    int xorig, yorig;
-    proc_origin(mype, &xorig, &yorig);
-    int xsize, ysize;
-    proc_size(mype, &xsize, &ysize);
-    
-    for(int x=0;x<xsize;x++)
-      for(int y=0;y<ysize;y++) 
-        for(int z=0;z<mesh->LocalNz;z++) {
-          (*this)(x+xorig,y+yorig,z) =  f(local_xorig+x, local_yorig+y, z);
-        }
-    
-    if(npes > 1) {
-      // Wait for receives, process as they arrive
-      int pe;
-      MPI_Status status;
-      do {
-        MPI_Waitany(npes, req, &pe, &status);
-
-        if(pe != MPI_UNDEFINED) {
-          // Unpack data from processor 'pe'
-          int remote_xorig, remote_yorig;
-          proc_origin(pe, &remote_xorig, &remote_yorig);
-          int remote_xsize, remote_ysize;
-          proc_size(pe, &remote_xsize, &remote_ysize);
-          int zsize = mesh->LocalNz;
-          
-          for(int x=0;x<remote_xsize;x++)
-            for(int y=0;y<remote_ysize;y++)
-              for(int z=0;z<mesh->LocalNz;z++) {
-                (*this)(x+remote_xorig,y+remote_yorig,z) =  buffer[pe][x*remote_ysize*zsize + y*zsize + z];
-              }
-          
-          req[pe] = MPI_REQUEST_NULL;
-        }
-      }while(pe != MPI_UNDEFINED);
-    }
-    delete[] req;
-  }else {
-    // Sending data to proc
-    
-    int local_xorig, local_yorig;
-    proc_local_origin(mype, &local_xorig, &local_yorig);
-    int xsize, ysize;
-    proc_size(mype, &xsize, &ysize);
-    int zsize = mesh->LocalNz;
-    
-    for(int x=0;x<xsize;x++)
-      for(int y=0;y<ysize;y++)
-        for(int z=0;z<mesh->LocalNz;z++) {
-          buffer[0][x*ysize*zsize + y*zsize + z] = f(local_xorig+x, local_yorig+y, z);
-        }
-    
-    MPI_Send(buffer[0], msg_len(mype), MPI_DOUBLE, data_on_proc, 3141, comm);
-  }
+  gatherData(&f(0, 0, 0));
+  data_valid = true;
+}
+
+void GlobalField3D::allGather(const Field3D &f) {
+  allGatherData(&f(0, 0, 0));
+  data_valid = true;
+}
+
+void GlobalField3D::gatherToNodes(const Field3D &f) {
+  nodeGatherData(&f(0, 0, 0));
   data_valid = true;
 }
 
 const Field3D GlobalField3D::scatter() const {
   Field3D result(mesh);
   result.allocate();
-  
-  MPI_Status status;
-  if(mype == data_on_proc) {
-    // Data is on this processor. Send to other processors
-    
-    for(int p = 0; p < npes; p++) {
-      if(p == mype) continue;
-      
-      int xorig, yorig;
-      proc_origin(p, &xorig, &yorig);
-      int xsize, ysize;
-      proc_size(p, &xsize, &ysize);
-      int zsize = mesh->LocalNz;
-      
-      // Send to processor p
-      for(int x=0;x<xsize;x++)
-        for(int y=0;y<ysize;y++) 
-          for(int z=0;z<zsize;z++) {
-            buffer[p][x*ysize*zsize + y*zsize + z] = (*this)(x+xorig,y+yorig,z);
-          }
-      
-      MPI_Send(buffer[p], xsize*ysize*zsize, MPI_DOUBLE, p, 1413, comm);
-    }
 
-    int local_xorig, local_yorig;
-    proc_local_origin(mype, &local_xorig, &local_yorig);
-    int xorig, yorig;
-    proc_origin(mype, &xorig, &yorig);
-    int xsize, ysize;
-    proc_size(mype, &xsize, &ysize);
-    int zsize = mesh->LocalNz;
-    
-    // Copy to result
-    for(int x=0;x<xsize;x++)
-      for(int y=0;y<ysize;y++)
-        for(int z=0;z<zsize;z++) {
-          result(local_xorig+x,local_yorig+y,z) = (*this)(x+xorig,y+yorig,z);
-        }
-  }else {
-    // Receive data
-    MPI_Recv(buffer[0], msg_len(mype), MPI_DOUBLE, data_on_proc, 1413, comm, &status);
-    
-    int local_xorig, local_yorig;
-    proc_local_origin(mype, &local_xorig, &local_yorig);
-    int xorig, yorig;
-    proc_origin(mype, &xorig, &yorig);
-    int xsize, ysize;
-    proc_size(mype, &xsize, &ysize);
-    int zsize = mesh->LocalNz;
-    
-    for(int x=0;x<xsize;x++)
-      for(int y=0;y<ysize;y++) 
-        for(int z=0;z<zsize;z++) {
-          result(local_xorig+x,local_yorig+y,z) = buffer[0][x*ysize*zsize + y*zsize + z];
-        }
-  }
+  scatterData(&result(0, 0, 0));
   return result;
 }
-
-int GlobalField3D::msg_len(int proc) const {
-  int xsize, ysize;
-  proc_size(proc, &xsize, &ysize);
-  int zsize = mesh->LocalNz;
-  return xsize * ysize * zsize;
-}
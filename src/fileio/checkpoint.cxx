@@ -0,0 +1,135 @@
+#include <bout/checkpoint.hxx>
+
+#include <boutcomm.hxx>
+#include <boutexception.hxx>
+#include <msg_stack.hxx>
+#include <output.hxx>
+#include <utils.hxx>
+#include <bout/solver.hxx>
+#include <bout/sys/timer.hxx>
+
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+namespace {
+/// Copy file \p from to \p to, replacing \p to atomically by
+/// first writing to \p tmp in the same directory.
+/// This only uses standard file I/O, so can safely be run
+/// on a separate thread from netCDF or HDF5 calls.
+bool copyAndReplace(const std::string &from, const std::string &tmp,
+                    const std::string &to) {
+  {
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!in || !out) {
+      return false;
+    }
+    out << in.rdbuf();
+    out.close();
+    if (!out) {
+      return false;
+    }
+  }
+  return std::rename(tmp.c_str(), to.c_str()) == 0;
+}
+} // namespace
+
+Checkpoint::Checkpoint(Datafile &restart, std::string restart_dir, std::string ext,
+                       Options *opt)
+    : restart(restart), restart_dir(std::move(restart_dir)), ext(std::move(ext)),
+      drain_failed(false) {
+  TRACE("Checkpoint::Checkpoint");
+
+  if (opt == nullptr) {
+    opt = Options::getRoot()->getSection("checkpoint");
+  }
+
+  BoutReal interval;
+  OPTION(opt, interval, -1.0);
+  if (interval > 0.0) {
+    setTimestep(interval);
+  }
+
+  opt->get("stagedir", stage_dir, this->restart_dir);
+  OPTION(opt, drain, true);
+
+  bool parallel;
+  Options::getRoot()->getSection("restart")->get("parallel", parallel, false);
+  if (parallel) {
+    throw BoutException("Checkpoints are not implemented for parallel restart files");
+  }
+
+  MPI_Comm_rank(BoutComm::get(), &mype);
+}
+
+Checkpoint::~Checkpoint() { finishDrain(); }
+
+bool Checkpoint::isEnabled(Options *opt) {
+  if (opt == nullptr) {
+    opt = Options::getRoot()->getSection("checkpoint");
+  }
+  bool enabled;
+  OPTION(opt, enabled, false);
+
+  // Nothing to do if restart files are disabled
+  bool restart_enabled;
+  Options::getRoot()->getSection("restart")->get("enabled", restart_enabled, true);
+
+  return enabled && restart_enabled;
+}
+
+int Checkpoint::call(Solver *solver, BoutReal UNUSED(time), int UNUSED(iter),
+                     int UNUSED(nout)) {
+  // Copy the solver's multistep history into the restart variables
+  solver->saveHistory();
+  write();
+  return 0;
+}
+
+void Checkpoint::cleanup() { finishDrain(); }
+
+std::string Checkpoint::fileName(const std::string &dir, const std::string &base) const {
+  return dir + "/" + base + "." + toString(mype) + "." + ext;
+}
+
+void Checkpoint::write() {
+  TRACE("Checkpoint::write");
+  Timer timer("io");
+
+  // The previous checkpoint must have been copied before it is replaced
+  finishDrain();
+
+  // Datafile inserts the processor number before the extension
+  if (!restart.write("%s/BOUT.restart_tmp.%s", stage_dir.c_str(), ext.c_str())) {
+    throw BoutException("Could not write checkpoint to %s", stage_dir.c_str());
+  }
+
+  const std::string staged = fileName(stage_dir, "BOUT.restart");
+  if (std::rename(fileName(stage_dir, "BOUT.restart_tmp").c_str(), staged.c_str()) != 0) {
+    throw BoutException("Could not replace checkpoint %s", staged.c_str());
+  }
+
+  if ((stage_dir == restart_dir) || !drain) {
+    return;
+  }
+
+  // Copy to the restart directory in the background
+  std::string tmp = fileName(restart_dir, "BOUT.restart_tmp");
+  std::string final_name = fileName(restart_dir, "BOUT.restart");
+  drain_thread = std::thread([this, staged, tmp, final_name]() {
+    drain_failed = !copyAndReplace(staged, tmp, final_name);
+  });
+}
+
+void Checkpoint::finishDrain() {
+  if (!drain_thread.joinable()) {
+    return;
+  }
+  drain_thread.join();
+  if (drain_failed) {
+    output_warn.write("\tWARNING: Could not copy checkpoint from %s to %s\n",
+                      stage_dir.c_str(), restart_dir.c_str());
+    drain_failed = false;
+  }
+}
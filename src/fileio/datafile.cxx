@@ -43,6 +43,8 @@
 #include <boutcomm.hxx>
 #include <utils.hxx>
 #include <msg_stack.hxx>
+#include <bout/array.hxx>
+#include <algorithm>
 #include <cstring>
 #include "formatfactory.hxx"
 
@@ -82,7 +84,8 @@ Datafile::Datafile(Datafile &&other) noexcept
       writable(other.writable), appending(other.appending), first_time(other.first_time),
       int_arr(std::move(other.int_arr)), BoutReal_arr(std::move(other.BoutReal_arr)),
       f2d_arr(std::move(other.f2d_arr)), f3d_arr(std::move(other.f3d_arr)),
-      v2d_arr(std::move(other.v2d_arr)), v3d_arr(std::move(other.v3d_arr)) {
+      v2d_arr(std::move(other.v2d_arr)), v3d_arr(std::move(other.v3d_arr)),
+      name_suffix(std::move(other.name_suffix)) {
   filenamelen = other.filenamelen;
   filename = other.filename;
   other.filenamelen = 0;
@@ -97,7 +100,7 @@ Datafile::Datafile(const Datafile &other) :
   file(nullptr), writable(other.writable), appending(other.appending), first_time(other.first_time),
   int_arr(other.int_arr), BoutReal_arr(other.BoutReal_arr),
   f2d_arr(other.f2d_arr), f3d_arr(other.f3d_arr), v2d_arr(other.v2d_arr),
-  v3d_arr(other.v3d_arr)
+  v3d_arr(other.v3d_arr), name_suffix(other.name_suffix)
 {
   filenamelen=other.filenamelen;
   filename=new char[filenamelen];
@@ -127,6 +130,7 @@ Datafile& Datafile::operator=(Datafile &&rhs) noexcept {
   f3d_arr      = std::move(rhs.f3d_arr);
   v2d_arr      = std::move(rhs.v2d_arr);
   v3d_arr      = std::move(rhs.v3d_arr);
+  name_suffix  = std::move(rhs.name_suffix);
   if (filenamelen < rhs.filenamelen){
     delete[] filename;
     filenamelen=rhs.filenamelen;
@@ -412,6 +416,9 @@ void Datafile::setLowPrecision() {
 
 void Datafile::add(int &i, const char *name, bool save_repeat) {
   TRACE("DataFile::add(int)");
+  // Name in the file, with the suffix if set
+  const string full_name = string(name) + name_suffix;
+  name = full_name.c_str();
   if (!enabled)
     return;
   if (varAdded(string(name))) {
@@ -462,6 +469,9 @@ void Datafile::add(int &i, const char *name, bool save_repeat) {
 
 void Datafile::add(BoutReal &r, const char *name, bool save_repeat) {
   TRACE("DataFile::add(BoutReal)");
+  // Name in the file, with the suffix if set
+  const string full_name = string(name) + name_suffix;
+  name = full_name.c_str();
   if (!enabled)
     return;
   if (varAdded(string(name))) {
@@ -514,6 +524,9 @@ void Datafile::add(BoutReal &r, const char *name, bool save_repeat) {
 
 void Datafile::add(Field2D &f, const char *name, bool save_repeat) {
   TRACE("DataFile::add(Field2D)");
+  // Name in the file, with the suffix if set
+  const string full_name = string(name) + name_suffix;
+  name = full_name.c_str();
   if (!enabled)
     return;
   if (varAdded(string(name))) {
@@ -566,6 +579,9 @@ void Datafile::add(Field2D &f, const char *name, bool save_repeat) {
 
 void Datafile::add(Field3D &f, const char *name, bool save_repeat) {
   TRACE("DataFile::add(Field3D)");
+  // Name in the file, with the suffix if set
+  const string full_name = string(name) + name_suffix;
+  name = full_name.c_str();
   if (!enabled)
     return;
   if (varAdded(string(name))) {
@@ -618,6 +634,9 @@ void Datafile::add(Field3D &f, const char *name, bool save_repeat) {
 
 void Datafile::add(Vector2D &f, const char *name, bool save_repeat) {
   TRACE("DataFile::add(Vector2D)");
+  // Name in the file, with the suffix if set
+  const string full_name = string(name) + name_suffix;
+  name = full_name.c_str();
   if (!enabled)
     return;
   if (varAdded(string(name))) {
@@ -676,6 +695,9 @@ void Datafile::add(Vector2D &f, const char *name, bool save_repeat) {
 
 void Datafile::add(Vector3D &f, const char *name, bool save_repeat) {
   TRACE("DataFile::add(Vector3D)");
+  // Name in the file, with the suffix if set
+  const string full_name = string(name) + name_suffix;
+  name = full_name.c_str();
   if (!enabled)
     return;
   if (varAdded(string(name))) {
@@ -748,52 +770,8 @@ bool Datafile::read() {
 
   file->setRecord(-1); // Read the latest record
 
-  // Read integers
-  for(const auto& var : int_arr) {
-    if(var.save_repeat) {
-      if(!file->read_rec(var.ptr, var.name.c_str())) {
-        if(!init_missing) {
-          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
-        }
-        output_warn.write("\tWARNING: Could not read integer %s. Setting to zero\n", var.name.c_str());
-        *(var.ptr) = 0;
-        continue;
-      }
-    } else {
-      if(!file->read(var.ptr, var.name.c_str())) {
-        if(!init_missing) {
-          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
-        }
-        output_warn.write("\tWARNING: Could not read integer %s. Setting to zero\n", var.name.c_str());
-        *(var.ptr) = 0;
-        continue;
-      }
-    }
-  }
+  read_scalars();
 
-  // Read BoutReals
-  for(const auto& var : BoutReal_arr) {
-    if(var.save_repeat) {
-      if(!file->read_rec(var.ptr, var.name)) {
-        if(!init_missing) {
-          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
-        }
-        output_warn.write("\tWARNING: Could not read BoutReal %s. Setting to zero\n", var.name.c_str());
-        *(var.ptr) = 0;
-        continue;
-      }
-    } else {
-      if(!file->read(var.ptr, var.name)) {
-        if(!init_missing) {
-          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
-        }
-        output_warn.write("\tWARNING: Could not read BoutReal %s. Setting to zero\n", var.name.c_str());
-        *(var.ptr) = 0;
-        continue;
-      }
-    }
-  }
-  
   // Read 2D fields
   for(const auto& var : f2d_arr) {
     read_f2d(var.name, var.ptr, var.save_repeat);
@@ -844,6 +822,224 @@ bool Datafile::read() {
   return true;
 }
 
+bool Datafile::decompositionChanged(const char *format, ...) {
+  if (parallel) {
+    return false; // Parallel files do not depend on the processor layout
+  }
+
+  if (format == nullptr) {
+    throw BoutException("Datafile::decompositionChanged: No argument given for file name!");
+  }
+
+  bout_vsnprintf(filename, filenamelen, format);
+
+  // Processor 0 reads the layout, since all layouts have a processor 0
+  int MYPE;
+  MPI_Comm_rank(BoutComm::get(), &MYPE);
+  int layout[2] = {-1, -1};
+  if (MYPE == 0) {
+    auto first = FormatFactory::getInstance()->createDataFormat(filename, false);
+    if (!first)
+      throw BoutException("Datafile::decompositionChanged: Factory failed to create a DataFormat!");
+
+    if (!first->openr(filename, 0))
+      throw BoutException("Datafile::decompositionChanged: Failed to open file!");
+    first->setGlobalOrigin(0, 0, 0);
+
+    if (!(first->read(&layout[0], "NXPE") && first->read(&layout[1], "NYPE"))) {
+      layout[0] = layout[1] = -1;
+    }
+    first->close();
+  }
+  MPI_Bcast(layout, 2, MPI_INT, 0, BoutComm::get());
+  int nxpe = layout[0], nype = layout[1];
+
+  if (nxpe < 0) {
+    // No layout information, so assume that it matches
+    return false;
+  }
+
+  return (nxpe != mesh->getNXPE()) || (nype != mesh->getNYPE());
+}
+
+bool Datafile::readRedistributed(const char *format, ...) {
+  Timer timer("io");
+  TRACE("Datafile::readRedistributed");
+
+  if (format == nullptr) {
+    throw BoutException("Datafile::readRedistributed: No argument given for file name!");
+  }
+
+  bout_vsnprintf(filename, filenamelen, format);
+
+  file = FormatFactory::getInstance()->createDataFormat(filename, false);
+  if (!file)
+    throw BoutException("Datafile::readRedistributed: Factory failed to create a DataFormat!");
+
+  // Layout of the old files, and scalars, are read from processor 0
+  int oldpe = 0;
+  if (!file->openr(filename, oldpe))
+    throw BoutException("Datafile::readRedistributed: Failed to open file!");
+  file->setGlobalOrigin(0, 0, 0);
+  file->setRecord(-1); // Read the latest record
+
+  int nxpe, nype, mxsub, mysub, mxg, myg, mz;
+  if (!(file->read(&nxpe, "NXPE") && file->read(&nype, "NYPE") &&
+        file->read(&mxsub, "MXSUB") && file->read(&mysub, "MYSUB") &&
+        file->read(&mxg, "MXG") && file->read(&myg, "MYG") && file->read(&mz, "MZ"))) {
+    throw BoutException("Datafile::readRedistributed: %s does not contain the processor layout",
+                        filename);
+  }
+
+  if ((mxg != mesh->xstart) || (myg != mesh->ystart) || (mz != mesh->LocalNz) ||
+      (nxpe * mxsub + 2 * mxg != mesh->GlobalNx) ||
+      (nype * mysub + 2 * myg != mesh->GlobalNy)) {
+    throw BoutException("Datafile::readRedistributed: Grid in %s does not match the mesh",
+                        filename);
+  }
+
+  read_scalars();
+
+  for (const auto &var : f2d_arr) {
+    var.ptr->allocate();
+  }
+  for (const auto &var : f3d_arr) {
+    var.ptr->allocate();
+  }
+  for (const auto &var : v2d_arr) {
+    var.ptr->x.allocate();
+    var.ptr->y.allocate();
+    var.ptr->z.allocate();
+    var.ptr->covariant = var.covar;
+  }
+  for (const auto &var : v3d_arr) {
+    var.ptr->x.allocate();
+    var.ptr->y.allocate();
+    var.ptr->z.allocate();
+    var.ptr->covariant = var.covar;
+  }
+
+  // Global index range of this processor, including guard cells.
+  // X index 0 is the first guard cell, Y index 0 the first non-guard cell
+  const int gx0 = mesh->OffsetX, gx1 = gx0 + mesh->LocalNx;
+  const int gy0 = mesh->OffsetY - myg;
+
+  // Old processor holding a global X index, guard cells belonging to the edge processors
+  auto xproc = [&](int gx) { return std::min(std::max((gx - mxg) / mxsub, 0), nxpe - 1); };
+
+  // Old Y processor to read local Y index y from. Global Y indices
+  // are only neighbours within a region: Y guard cells can be across
+  // a branch cut or a target. Processor edges are always at these, so
+  // guard cells at an edge which was also an edge in the old layout
+  // are read from the old processor's guard cells, which were filled
+  // through the same topology. Other guard cells are in the same
+  // region as the interior, so are read from the old interior
+  auto yproc = [&](int y) {
+    int pey = (gy0 + y) / mysub;
+    if ((y < mesh->ystart) && ((gy0 + mesh->ystart) % mysub == 0)) {
+      pey = (gy0 + mesh->ystart) / mysub;
+    } else if ((y > mesh->yend) && ((gy0 + mesh->yend + 1) % mysub == 0)) {
+      pey = (gy0 + mesh->yend + 1) / mysub - 1;
+    }
+    return std::min(std::max(pey, 0), nype - 1);
+  };
+
+  Array<BoutReal> buffer(mesh->LocalNx * mesh->LocalNy * mesh->LocalNz);
+
+  // Local Y indices [ly0, ly1) are read from the same old Y processor
+  int ly1;
+  for (int ly0 = 0; ly0 < mesh->LocalNy; ly0 = ly1) {
+    const int pey = yproc(ly0);
+    ly1 = ly0 + 1;
+    while ((ly1 < mesh->LocalNy) && (yproc(ly1) == pey)) {
+      ly1++;
+    }
+
+    for (int pex = xproc(gx0); pex <= xproc(gx1 - 1); pex++) {
+      // Part of the domain in X which old processor pex is responsible for
+      int ox0 = (pex == 0) ? 0 : mxg + pex * mxsub;
+      int ox1 = (pex == nxpe - 1) ? nxpe * mxsub + 2 * mxg : mxg + (pex + 1) * mxsub;
+
+      int x0 = std::max(gx0, ox0), x1 = std::min(gx1, ox1);
+      if (x0 >= x1) {
+        continue;
+      }
+      int nx = x1 - x0, ny = ly1 - ly0;
+
+      if (pey * nxpe + pex != oldpe) {
+        file->close();
+        oldpe = pey * nxpe + pex;
+        if (!file->openr(filename, oldpe))
+          throw BoutException("Datafile::readRedistributed: Failed to open file for processor %d",
+                              oldpe);
+        file->setRecord(-1);
+      }
+      // Origin of the overlap in the old processor's local indices
+      file->setGlobalOrigin(x0 - pex * mxsub, gy0 + ly0 + myg - pey * mysub, 0);
+
+      // Read the overlap of one variable, copying into the local data
+      auto readPart = [&](const string &name, BoutReal *data, bool is3d, bool save_repeat) {
+        int nz = is3d ? mesh->LocalNz : 1;
+        int lz = is3d ? nz : 0;
+        bool ok = save_repeat ? file->read_rec(buffer.begin(), name, nx, ny, lz)
+                              : file->read(buffer.begin(), name, nx, ny, lz);
+        if (!ok) {
+          if (!init_missing) {
+            throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", name.c_str());
+          }
+          output_warn.write("\tWARNING: Could not read %s. Setting to zero\n", name.c_str());
+          std::fill(buffer.begin(), buffer.begin() + nx * ny * nz, 0.0);
+        }
+        for (int x = 0; x < nx; x++) {
+          for (int y = 0; y < ny; y++) {
+            std::copy(buffer.begin() + (x * ny + y) * nz,
+                      buffer.begin() + (x * ny + y + 1) * nz,
+                      data + ((x0 - gx0 + x) * mesh->LocalNy + (ly0 + y)) * nz);
+          }
+        }
+      };
+
+      for (const auto &var : f2d_arr) {
+        readPart(var.name, &(*var.ptr)(0, 0), false, var.save_repeat);
+      }
+      for (const auto &var : f3d_arr) {
+        readPart(var.name, &(*var.ptr)(0, 0, 0), true, var.save_repeat);
+      }
+      for (const auto &var : v2d_arr) {
+        string sep = var.covar ? "_" : "";
+        readPart(var.name + sep + "x", &(var.ptr->x(0, 0)), false, var.save_repeat);
+        readPart(var.name + sep + "y", &(var.ptr->y(0, 0)), false, var.save_repeat);
+        readPart(var.name + sep + "z", &(var.ptr->z(0, 0)), false, var.save_repeat);
+      }
+      for (const auto &var : v3d_arr) {
+        string sep = var.covar ? "_" : "";
+        readPart(var.name + sep + "x", &(var.ptr->x(0, 0, 0)), true, var.save_repeat);
+        readPart(var.name + sep + "y", &(var.ptr->y(0, 0, 0)), true, var.save_repeat);
+        readPart(var.name + sep + "z", &(var.ptr->z(0, 0, 0)), true, var.save_repeat);
+      }
+    }
+  }
+  file->close();
+  file = nullptr;
+
+  // Old files must not be overwritten until every processor has read them
+  MPI_Barrier(BoutComm::get());
+
+  if (shiftInput) {
+    // Input files are in field-aligned coordinates
+    for (const auto &var : f3d_arr) {
+      *var.ptr = mesh->fromFieldAligned(*var.ptr);
+    }
+    for (const auto &var : v3d_arr) {
+      var.ptr->x = mesh->fromFieldAligned(var.ptr->x);
+      var.ptr->y = mesh->fromFieldAligned(var.ptr->y);
+      var.ptr->z = mesh->fromFieldAligned(var.ptr->z);
+    }
+  }
+
+  return true;
+}
+
 bool Datafile::write() {
   if(!enabled)
     return true; // Just pretend it worked
@@ -1081,6 +1277,54 @@ void Datafile::setAttribute(const string &varname, const string &attrname, int v
 
 /////////////////////////////////////////////////////////////
 
+void Datafile::read_scalars() {
+  // Read integers
+  for(const auto& var : int_arr) {
+    if(var.save_repeat) {
+      if(!file->read_rec(var.ptr, var.name.c_str())) {
+        if(!init_missing) {
+          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
+        }
+        output_warn.write("\tWARNING: Could not read integer %s. Setting to zero\n", var.name.c_str());
+        *(var.ptr) = 0;
+        continue;
+      }
+    } else {
+      if(!file->read(var.ptr, var.name.c_str())) {
+        if(!init_missing) {
+          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
+        }
+        output_warn.write("\tWARNING: Could not read integer %s. Setting to zero\n", var.name.c_str());
+        *(var.ptr) = 0;
+        continue;
+      }
+    }
+  }
+
+  // Read BoutReals
+  for(const auto& var : BoutReal_arr) {
+    if(var.save_repeat) {
+      if(!file->read_rec(var.ptr, var.name)) {
+        if(!init_missing) {
+          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
+        }
+        output_warn.write("\tWARNING: Could not read BoutReal %s. Setting to zero\n", var.name.c_str());
+        *(var.ptr) = 0;
+        continue;
+      }
+    } else {
+      if(!file->read(var.ptr, var.name)) {
+        if(!init_missing) {
+          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
+        }
+        output_warn.write("\tWARNING: Could not read BoutReal %s. Setting to zero\n", var.name.c_str());
+        *(var.ptr) = 0;
+        continue;
+      }
+    }
+  }
+}
+
 bool Datafile::read_f2d(const string &name, Field2D *f, bool save_repeat) {
   f->allocate();
   
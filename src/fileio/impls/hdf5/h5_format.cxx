@@ -614,12 +614,16 @@ bool H5Format::read_rec(void *data, hid_t hdf5_type, const char *name, int lx, i
   if (lz != 0) {
     nd = 4;
   }
+  int nd_local = nd - 1; // The record dimension is not in memory
   hsize_t counts[4], offset[4];
-  hsize_t offset_local[3], init_size_local[3];
+  hsize_t counts_local[3], offset_local[3], init_size_local[3];
   counts[0] = 1;
   counts[1] = lx;
   counts[2] = ly;
   counts[3] = lz;
+  counts_local[0] = lx;
+  counts_local[1] = ly;
+  counts_local[2] = lz;
   offset[0] = t0;
   offset[1] = x0;
   offset[2] = y0;
@@ -631,19 +635,19 @@ bool H5Format::read_rec(void *data, hid_t hdf5_type, const char *name, int lx, i
   init_size_local[1] = mesh->LocalNy;
   init_size_local[2] = mesh->LocalNz;
 
-  if (nd == 1) {
-    // Need to write a time-series of scalars
-    nd = 1;
-    counts[1] = 1;
-    offset[1] = 0;
+  if (nd_local == 0) {
+    // Need to read a time-series of scalars
+    nd_local = 1;
+    counts_local[0] = 1;
+    offset_local[0] = 0;
     init_size_local[0] = 1;
   }
 
-  hid_t mem_space = H5Screate_simple(nd, init_size_local, init_size_local);
+  hid_t mem_space = H5Screate_simple(nd_local, init_size_local, init_size_local);
   if (mem_space < 0)
     throw BoutException("Failed to create mem_space");
   if (H5Sselect_hyperslab(mem_space, H5S_SELECT_SET, offset_local, /*stride=*/nullptr,
-                          counts, /*block=*/nullptr) < 0)
+                          counts_local, /*block=*/nullptr) < 0)
     throw BoutException("Failed to select hyperslab");
 
   hid_t dataSet = H5Dopen(dataFile, name, H5P_DEFAULT);
@@ -653,6 +657,15 @@ bool H5Format::read_rec(void *data, hid_t hdf5_type, const char *name, int lx, i
   hid_t dataSpace = H5Dget_space(dataSet);
   if (dataSpace < 0)
     throw BoutException("Failed to create dataSpace");
+  if (t0 == -1) {
+    // Read the last record
+    hsize_t dims[4] = {};
+    if (H5Sget_simple_extent_dims(dataSpace, dims, /*maxdims=*/nullptr) < 0)
+      throw BoutException("Failed to get dims");
+    if (dims[0] == 0)
+      throw BoutException("No records of '%s' to read", name);
+    offset[0] = dims[0] - 1;
+  }
   if (H5Sselect_hyperslab(dataSpace, H5S_SELECT_SET, offset, /*stride=*/nullptr, counts,
                           /*block=*/nullptr) < 0)
     throw BoutException("Failed to select hyperslab");
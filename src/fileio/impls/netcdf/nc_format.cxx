@@ -694,10 +694,10 @@ bool NcFormat::read_rec(int *data, const char *name, int lx, int ly, int lz) {
   if(!(var = dataFile->get_var(name)))
     return false;
   
-  // NOTE: Probably should do something here to check t0
-
   long cur[4], counts[4];
-  cur[0] = t0; cur[1] = x0;    cur[2] = y0;    cur[3] = z0;
+  // A record of -1 reads the last record
+  cur[0] = (t0 == -1) ? var->get_dim(0)->size() - 1 : t0;
+  cur[1] = x0;    cur[2] = y0;    cur[3] = z0;
   counts[0] = 1; counts[1] = lx; counts[2] = ly; counts[3] = lz;
   
   if(!(var->set_cur(cur)))
@@ -735,10 +735,10 @@ bool NcFormat::read_rec(BoutReal *data, const char *name, int lx, int ly, int lz
   if(!(var = dataFile->get_var(name)))
     return false;
   
-  // NOTE: Probably should do something here to check t0
-
   long cur[4], counts[4];
-  cur[0] = t0; cur[1] = x0;    cur[2] = y0;    cur[3] = z0;
+  // A record of -1 reads the last record
+  cur[0] = (t0 == -1) ? var->get_dim(0)->size() - 1 : t0;
+  cur[1] = x0;    cur[2] = y0;    cur[3] = z0;
   counts[0] = 1; counts[1] = lx; counts[2] = ly; counts[3] = lz;
   
   if(!(var->set_cur(cur)))
@@ -592,10 +592,10 @@ bool Ncxx4::read_rec(int *data, const char *name, int lx, int ly, int lz) {
   if(var.isNull())
     return false;
   
-  // NOTE: Probably should do something here to check t0
-
   vector<size_t> start(4);
-  start[0] = t0; start[1] = x0; start[2] = y0; start[3] = z0;
+  // A record of -1 reads the last record
+  start[0] = (t0 == -1) ? var.getDim(0).getSize() - 1 : t0;
+  start[1] = x0; start[2] = y0; start[3] = z0;
   vector<size_t> counts(4);
   counts[0] = 1; counts[1] = lx; counts[2] = ly; counts[3] = lz;
   
@@ -623,10 +623,10 @@ bool Ncxx4::read_rec(BoutReal *data, const char *name, int lx, int ly, int lz) {
   if(var.isNull())
     return false;
   
-  // NOTE: Probably should do something here to check t0
-
   vector<size_t> start(4);
-  start[0] = t0; start[1] = x0; start[2] = y0; start[3] = z0;
+  // A record of -1 reads the last record
+  start[0] = (t0 == -1) ? var.getDim(0).getSize() - 1 : t0;
+  start[1] = x0; start[2] = y0; start[3] = z0;
   vector<size_t> counts(4);
   counts[0] = 1; counts[1] = lx; counts[2] = ly; counts[3] = lz;
   
@@ -32,7 +32,9 @@
 #include <bout/openmpwrap.hxx>
 
 #include <fftw3.h>
+#include <map>
 #include <math.h>
+#include <tuple>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -326,6 +328,85 @@ void irfft(const dcomplex *in, int length, BoutReal *out) {
 }
 #endif
 
+/***********************************************************
+ * Batched real FFTs
+ *
+ * Plans are created for each combination of length, number of
+ * signals and spacing, and executed on the caller's arrays. Executing
+ * a plan is thread safe, but creating one is not.
+ ***********************************************************/
+
+namespace {
+/// Plans for rfft and irfft, keyed by (length, howmany, dist)
+using PlanKey = std::tuple<int, int, int>;
+
+fftw_plan getPlan(std::map<PlanKey, fftw_plan> &plans, bool forward, int length,
+                  int howmany, int dist) {
+  fftw_plan plan = nullptr;
+  BOUT_OMP(critical(fft_many))
+  {
+    const PlanKey key{length, howmany, dist};
+    auto it = plans.find(key);
+    if (it != plans.end()) {
+      plan = it->second;
+    } else {
+      fft_init();
+
+      // Planning may overwrite the arrays, so plan on temporary ones.
+      // Arrays passed later may not have the same alignment
+      const int nmodes = length / 2 + 1;
+      const int nreal = (howmany - 1) * dist + length;
+      double *real = static_cast<double *>(fftw_malloc(sizeof(double) * nreal));
+      fftw_complex *cmplx =
+          static_cast<fftw_complex *>(fftw_malloc(sizeof(fftw_complex) * nmodes * howmany));
+
+      unsigned int flags = FFTW_ESTIMATE | FFTW_UNALIGNED;
+      if (fft_measure)
+        flags = FFTW_MEASURE | FFTW_UNALIGNED;
+
+      if (forward) {
+        plan = fftw_plan_many_dft_r2c(1, &length, howmany, real, nullptr, 1, dist,
+                                      cmplx, nullptr, 1, nmodes, flags);
+      } else {
+        // The inverse transform must not modify its input
+        plan = fftw_plan_many_dft_c2r(1, &length, howmany, cmplx, nullptr, 1, nmodes,
+                                      real, nullptr, 1, dist,
+                                      flags | FFTW_PRESERVE_INPUT);
+      }
+      fftw_free(real);
+      fftw_free(cmplx);
+
+      plans[key] = plan;
+    }
+  }
+  return plan;
+}
+} // namespace
+
+void rfft(const BoutReal *in, int length, int howmany, int in_dist, dcomplex *out) {
+  static std::map<PlanKey, fftw_plan> plans;
+  fftw_plan plan = getPlan(plans, true, length, howmany, in_dist);
+
+  // FFTW doesn't modify the input of a real to complex transform
+  fftw_execute_dft_r2c(plan, const_cast<BoutReal *>(in),
+                       reinterpret_cast<fftw_complex *>(out));
+
+  // Normalise, as in rfft above
+  const BoutReal fac = 1.0 / static_cast<BoutReal>(length);
+  const int nout = (length / 2 + 1) * howmany;
+  for (int i = 0; i < nout; i++)
+    out[i] *= fac;
+}
+
+void irfft(const dcomplex *in, int length, int howmany, BoutReal *out, int out_dist) {
+  static std::map<PlanKey, fftw_plan> plans;
+  fftw_plan plan = getPlan(plans, false, length, howmany, out_dist);
+
+  fftw_execute_dft_c2r(plan,
+                       reinterpret_cast<fftw_complex *>(const_cast<dcomplex *>(in)),
+                       out);
+}
+
 //  Discrete sine transforms (B Shanahan)
 
 void DST(const BoutReal *in, int length, dcomplex *out) {
@@ -44,17 +44,23 @@
 #include "cyclic_laplace.hxx"
 
 LaplaceCyclic::LaplaceCyclic(Options *opt, const CELL_LOC loc)
-    : Laplacian(opt, loc), Acoef(0.0), Ccoef(1.0), Dcoef(1.0) {
+    : Laplacian(opt, loc), Acoef(0.0), Ccoef(1.0), Dcoef(1.0), localmesh(mesh) {
   Acoef.setLocation(location);
   Ccoef.setLocation(location);
   Dcoef.setLocation(location);
 
+  if (opt == nullptr) {
+    opt = Options::getRoot()->getSection("laplace");
+  }
+  options = opt;
+  coords = localmesh->getCoordinates(location);
+
   // Get options
 
   OPTION(opt, dst, false);
 
   if(dst) {
-    nmode = mesh->LocalNz-2;
+    nmode = localmesh->LocalNz-2;
   }else
     nmode = maxmode+1; // Number of Z modes. maxmode set in invert_laplace.cxx from options
 
@@ -62,13 +68,13 @@ LaplaceCyclic::LaplaceCyclic(Options *opt, const CELL_LOC loc)
 
   // Allocate arrays
 
-  xs = mesh->xstart; // Starting X index
-  if(mesh->firstX() && !mesh->periodicX){ // Only want to include guard cells at boundaries (unless periodic in x)
+  xs = localmesh->xstart; // Starting X index
+  if(localmesh->firstX() && !localmesh->periodicX){ // Only want to include guard cells at boundaries (unless periodic in x)
 	  xs = 0;
   }
-  xe = mesh->xend;   // Last X index
-  if(mesh->lastX() && !mesh->periodicX){ // Only want to include guard cells at boundaries (unless periodic in x)
-	  xe = mesh->LocalNx-1;
+  xe = localmesh->xend;   // Last X index
+  if(localmesh->lastX() && !localmesh->periodicX){ // Only want to include guard cells at boundaries (unless periodic in x)
+	  xe = localmesh->LocalNx-1;
   }
   int n = xe - xs + 1;  // Number of X points on this processor,
                         // including boundaries but not guard cells
@@ -79,22 +85,110 @@ LaplaceCyclic::LaplaceCyclic(Options *opt, const CELL_LOC loc)
   xcmplx = Matrix<dcomplex>(nmode, n);
   bcmplx = Matrix<dcomplex>(nmode, n);
 
+  newFactors();
+}
+
+LaplaceCyclic::~LaplaceCyclic() {}
+
+std::vector<std::weak_ptr<LaplaceCyclic::Factors>> LaplaceCyclic::all_factors;
+
+void LaplaceCyclic::newFactors() {
+  factors = std::make_shared<Factors>();
+
   // Create a cyclic reduction object, operating on dcomplex values
-  cr = new CyclicReduce<dcomplex>(mesh->getXcomm(), n);
-  cr->setPeriodic(mesh->periodicX);
+  factors->cr.reset(new CyclicReduce<dcomplex>(localmesh->getXcomm(), xe - xs + 1));
+  factors->cr->setPeriodic(localmesh->periodicX);
+  factors->localmesh = localmesh;
+  factors->coords = coords;
+  factors->options = options;
+  factors->location = location;
+
+  all_factors.push_back(factors);
+}
+
+/// True if \p a and \p b have the same values everywhere
+static bool sameValues(const Field2D &a, const Field2D &b) {
+  for (const auto &i : a.getMesh()->getRegion2D("RGN_ALL")) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LaplaceCyclic::matrixChanged(int index) {
+  // True if f has matrices for this solver's mesh, metric, options and
+  // flags at this index
+  auto sameSettings = [&](const Factors &f) {
+    return f.set && (f.localmesh == localmesh) && (f.coords == coords) &&
+           (f.geometry_version == coords->getGeometryVersion()) &&
+           (f.options == options) && (f.location == location) && (f.index == index) &&
+           (f.flags[0] == global_flags) && (f.flags[1] == inner_boundary_flags) &&
+           (f.flags[2] == outer_boundary_flags);
+  };
+
+  if ((coef_version == factor_version) && sameSettings(*factors)) {
+    // Nothing has changed since the matrices were set
+    return false;
+  }
+  factor_version = coef_version;
+
+  // Share the factors of another solver with the same matrices, if any.
+  // Factors which are no longer used are removed from the list
+  for (auto it = all_factors.begin(); it != all_factors.end();) {
+    auto other = it->lock();
+    if (!other) {
+      it = all_factors.erase(it);
+      continue;
+    }
+    if (sameSettings(*other) && sameValues(other->A, Acoef) &&
+        sameValues(other->C, Ccoef) && sameValues(other->D, Dcoef)) {
+      factors = other;
+      return false;
+    }
+    ++it;
+  }
+
+  // The matrices are calculated again. Factors used by other solvers
+  // must not be changed
+  if (factors.use_count() > 1) {
+    newFactors();
+  }
+  factors->set = true;
+  factors->index = index;
+  factors->geometry_version = coords->getGeometryVersion();
+  factors->flags[0] = global_flags;
+  factors->flags[1] = inner_boundary_flags;
+  factors->flags[2] = outer_boundary_flags;
+  factors->A = copy(Acoef);
+  factors->C = copy(Ccoef);
+  factors->D = copy(Dcoef);
+  return true;
 }
 
-LaplaceCyclic::~LaplaceCyclic() {
-  // Delete tridiagonal solver
-  delete cr;
+void LaplaceCyclic::setBoundaryRHS(dcomplex *bk, int inbndry, int outbndry) {
+  if (localmesh->periodicX) {
+    return;
+  }
+  int n = xe - xs + 1;
+  if (localmesh->firstX() && !(inner_boundary_flags & (INVERT_RHS | INVERT_SET))) {
+    for (int ix = 0; ix < inbndry; ix++) {
+      bk[ix] = 0.;
+    }
+  }
+  if (localmesh->lastX() && !(outer_boundary_flags & (INVERT_RHS | INVERT_SET))) {
+    for (int ix = 0; ix < outbndry; ix++) {
+      bk[n - 1 - ix] = 0.;
+    }
+  }
 }
 
 const FieldPerp LaplaceCyclic::solve(const FieldPerp &rhs, const FieldPerp &x0) {
-  Mesh *mesh = rhs.getMesh();
-  FieldPerp x(mesh); // Result
+  ASSERT1(rhs.getMesh() == localmesh);
+  FieldPerp x(localmesh); // Result
   x.allocate();
 
-  Coordinates *coord = mesh->getCoordinates(location);
+  Coordinates *coord = coords;
 
   int jy = rhs.getIndex();  // Get the Y index
   x.setIndex(jy);
@@ -102,8 +196,8 @@ const FieldPerp LaplaceCyclic::solve(const FieldPerp &rhs, const FieldPerp &x0)
   // Get the width of the boundary
 
   // If the flags to assign that only one guard cell should be used is set
-  int inbndry = mesh->xstart, outbndry=mesh->xstart;
-  if((global_flags & INVERT_BOTH_BNDRY_ONE) || (mesh->xstart < 2))  {
+  int inbndry = localmesh->xstart, outbndry=localmesh->xstart;
+  if((global_flags & INVERT_BOTH_BNDRY_ONE) || (localmesh->xstart < 2))  {
     inbndry = outbndry = 1;
   }
   if(inner_boundary_flags & INVERT_BNDRY_ONE)
@@ -111,11 +205,14 @@ const FieldPerp LaplaceCyclic::solve(const FieldPerp &rhs, const FieldPerp &x0)
   if(outer_boundary_flags & INVERT_BNDRY_ONE)
     outbndry = 1;
 
+  // Only need to calculate the matrices if they have changed
+  const bool update = matrixChanged(jy);
+
   if(dst) {
     BOUT_OMP(parallel) {
       /// Create a local thread-scope working array
       auto k1d =
-          Array<dcomplex>(mesh->LocalNz); // ZFFT routine expects input of this length
+          Array<dcomplex>(localmesh->LocalNz); // ZFFT routine expects input of this length
 
       // Loop over X indices, including boundaries but not guard cells. (unless periodic
       // in x)
@@ -123,13 +220,13 @@ const FieldPerp LaplaceCyclic::solve(const FieldPerp &rhs, const FieldPerp &x0)
       for (int ix = xs; ix <= xe; ix++) {
         // Take DST in Z direction and put result in k1d
 
-        if (((ix < inbndry) && (inner_boundary_flags & INVERT_SET) && mesh->firstX()) ||
+        if (((ix < inbndry) && (inner_boundary_flags & INVERT_SET) && localmesh->firstX()) ||
             ((xe - ix < outbndry) && (outer_boundary_flags & INVERT_SET) &&
-             mesh->lastX())) {
+             localmesh->lastX())) {
           // Use the values in x0 in the boundary
-          DST(x0[ix] + 1, mesh->LocalNz - 2, std::begin(k1d));
+          DST(x0[ix] + 1, localmesh->LocalNz - 2, std::begin(k1d));
         } else {
-          DST(rhs[ix] + 1, mesh->LocalNz - 2, std::begin(k1d));
+          DST(rhs[ix] + 1, localmesh->LocalNz - 2, std::begin(k1d));
         }
 
         // Copy into array, transposing so kz is first index
@@ -139,50 +236,60 @@ const FieldPerp LaplaceCyclic::solve(const FieldPerp &rhs, const FieldPerp &x0)
 
       // Get elements of the tridiagonal matrix
       // including boundary conditions
-      BOUT_OMP(for nowait)
-      for (int kz = 0; kz < nmode; kz++) {
-        BoutReal zlen = coord->dz * (mesh->LocalNz - 3);
-        BoutReal kwave =
-            kz * 2.0 * PI / (2. * zlen); // wave number is 1/[rad]; DST has extra 2.
-
-        tridagMatrix(&a(kz, 0), &b(kz, 0), &c(kz, 0), &bcmplx(kz, 0), jy,
-                     kz,    // wave number index
-                     kwave, // kwave (inverse wave length)
-                     global_flags, inner_boundary_flags, outer_boundary_flags, &Acoef,
-                     &Ccoef, &Dcoef,
-                     false); // Don't include guard cells in arrays
+      if (update) {
+        BOUT_OMP(for nowait)
+        for (int kz = 0; kz < nmode; kz++) {
+          BoutReal zlen = coord->dz * (localmesh->LocalNz - 3);
+          BoutReal kwave =
+              kz * 2.0 * PI / (2. * zlen); // wave number is 1/[rad]; DST has extra 2.
+
+          tridagMatrix(&a(kz, 0), &b(kz, 0), &c(kz, 0), &bcmplx(kz, 0), jy,
+                       kz,    // wave number index
+                       kwave, // kwave (inverse wave length)
+                       global_flags, inner_boundary_flags, outer_boundary_flags, &Acoef,
+                       &Ccoef, &Dcoef,
+                       false); // Don't include guard cells in arrays
+        }
+      } else {
+        // Matrices unchanged since the last solve
+        BOUT_OMP(for nowait)
+        for (int kz = 0; kz < nmode; kz++) {
+          setBoundaryRHS(&bcmplx(kz, 0), inbndry, outbndry);
+        }
       }
     }
 
     // Solve tridiagonal systems
-    cr->setCoefs(a, b, c);
-    cr->solve(bcmplx, xcmplx);
+    if (update) {
+      factors->cr->setCoefs(a, b, c);
+    }
+    factors->cr->solve(bcmplx, xcmplx);
 
     // FFT back to real space
     BOUT_OMP(parallel) {
       /// Create a local thread-scope working array
       auto k1d =
-          Array<dcomplex>(mesh->LocalNz); // ZFFT routine expects input of this length
+          Array<dcomplex>(localmesh->LocalNz); // ZFFT routine expects input of this length
 
       BOUT_OMP(for nowait)
       for (int ix = xs; ix <= xe; ix++) {
         for (int kz = 0; kz < nmode; kz++)
           k1d[kz] = xcmplx(kz, ix - xs);
 
-        for (int kz = nmode; kz < (mesh->LocalNz); kz++)
+        for (int kz = nmode; kz < (localmesh->LocalNz); kz++)
           k1d[kz] = 0.0; // Filtering out all higher harmonics
 
-        DST_rev(std::begin(k1d), mesh->LocalNz - 2, x[ix] + 1);
+        DST_rev(std::begin(k1d), localmesh->LocalNz - 2, x[ix] + 1);
 
         x(ix, 0) = -x(ix, 2);
-        x(ix, mesh->LocalNz - 1) = -x(ix, mesh->LocalNz - 3);
+        x(ix, localmesh->LocalNz - 1) = -x(ix, localmesh->LocalNz - 3);
       }
     }
   }else {
     BOUT_OMP(parallel)
     {
       /// Create a local thread-scope working array
-      auto k1d = Array<dcomplex>((mesh->LocalNz) / 2 +
+      auto k1d = Array<dcomplex>((localmesh->LocalNz) / 2 +
                                  1); // ZFFT routine expects input of this length
 
       // Loop over X indices, including boundaries but not guard cells (unless periodic in
@@ -191,13 +298,13 @@ const FieldPerp LaplaceCyclic::solve(const FieldPerp &rhs, const FieldPerp &x0)
       for (int ix = xs; ix <= xe; ix++) {
         // Take FFT in Z direction, apply shift, and put result in k1d
 
-        if (((ix < inbndry) && (inner_boundary_flags & INVERT_SET) && mesh->firstX()) ||
+        if (((ix < inbndry) && (inner_boundary_flags & INVERT_SET) && localmesh->firstX()) ||
             ((xe - ix < outbndry) && (outer_boundary_flags & INVERT_SET) &&
-             mesh->lastX())) {
+             localmesh->lastX())) {
           // Use the values in x0 in the boundary
-          rfft(x0[ix], mesh->LocalNz, std::begin(k1d));
+          rfft(x0[ix], localmesh->LocalNz, std::begin(k1d));
         } else {
-          rfft(rhs[ix], mesh->LocalNz, std::begin(k1d));
+          rfft(rhs[ix], localmesh->LocalNz, std::begin(k1d));
         }
 
         // Copy into array, transposing so kz is first index
@@ -207,27 +314,37 @@ const FieldPerp LaplaceCyclic::solve(const FieldPerp &rhs, const FieldPerp &x0)
 
       // Get elements of the tridiagonal matrix
       // including boundary conditions
-      BOUT_OMP(for nowait)
-      for (int kz = 0; kz < nmode; kz++) {
-        BoutReal kwave = kz * 2.0 * PI / (coord->zlength()); // wave number is 1/[rad]
-        tridagMatrix(&a(kz, 0), &b(kz, 0), &c(kz, 0), &bcmplx(kz, 0), jy,
-                     kz,    // True for the component constant (DC) in Z
-                     kwave, // Z wave number
-                     global_flags, inner_boundary_flags, outer_boundary_flags, &Acoef,
-                     &Ccoef, &Dcoef,
-                     false); // Don't include guard cells in arrays
+      if (update) {
+        BOUT_OMP(for nowait)
+        for (int kz = 0; kz < nmode; kz++) {
+          BoutReal kwave = kz * 2.0 * PI / (coord->zlength()); // wave number is 1/[rad]
+          tridagMatrix(&a(kz, 0), &b(kz, 0), &c(kz, 0), &bcmplx(kz, 0), jy,
+                       kz,    // True for the component constant (DC) in Z
+                       kwave, // Z wave number
+                       global_flags, inner_boundary_flags, outer_boundary_flags, &Acoef,
+                       &Ccoef, &Dcoef,
+                       false); // Don't include guard cells in arrays
+        }
+      } else {
+        // Matrices unchanged since the last solve
+        BOUT_OMP(for nowait)
+        for (int kz = 0; kz < nmode; kz++) {
+          setBoundaryRHS(&bcmplx(kz, 0), inbndry, outbndry);
+        }
       }
     }
 
     // Solve tridiagonal systems
-    cr->setCoefs(a, b, c);
-    cr->solve(bcmplx, xcmplx);
+    if (update) {
+      factors->cr->setCoefs(a, b, c);
+    }
+    factors->cr->solve(bcmplx, xcmplx);
 
     // FFT back to real space
     BOUT_OMP(parallel)
     {
       /// Create a local thread-scope working array
-      auto k1d = Array<dcomplex>((mesh->LocalNz) / 2 +
+      auto k1d = Array<dcomplex>((localmesh->LocalNz) / 2 +
                                  1); // ZFFT routine expects input of this length
 
       BOUT_OMP(for nowait)
@@ -235,36 +352,78 @@ const FieldPerp LaplaceCyclic::solve(const FieldPerp &rhs, const FieldPerp &x0)
         for (int kz = 0; kz < nmode; kz++)
           k1d[kz] = xcmplx(kz, ix - xs);
 
-        for (int kz = nmode; kz < (mesh->LocalNz) / 2 + 1; kz++)
+        for (int kz = nmode; kz < (localmesh->LocalNz) / 2 + 1; kz++)
           k1d[kz] = 0.0; // Filtering out all higher harmonics
 
-        irfft(std::begin(k1d), mesh->LocalNz, x[ix]);
+        irfft(std::begin(k1d), localmesh->LocalNz, x[ix]);
       }
     }
   }
   return x;
 }
 
+/// Copy the first \p nsys rows of the matrices into the following
+/// blocks of rows, so that all fields in a batch use the same matrices
+static void copyMatrices(Matrix<dcomplex> &a, Matrix<dcomplex> &b, Matrix<dcomplex> &c,
+                         int nsys) {
+  const int ntotal = std::get<0>(a.shape());
+  const int nx = std::get<1>(a.shape());
+
+  BOUT_OMP(parallel for)
+  for (int ind = nsys; ind < ntotal; ind++) {
+    for (int ix = 0; ix < nx; ix++) {
+      a(ind, ix) = a(ind % nsys, ix);
+      b(ind, ix) = b(ind % nsys, ix);
+      c(ind, ix) = c(ind % nsys, ix);
+    }
+  }
+}
+
 const Field3D LaplaceCyclic::solve(const Field3D &rhs, const Field3D &x0) {
   TRACE("LaplaceCyclic::solve(Field3D, Field3D)");
 
-  ASSERT1(rhs.getLocation() == location);
-  ASSERT1(x0.getLocation() == location);
+  return solveFields({&rhs}, {&x0})[0];
+}
+
+std::vector<Field3D> LaplaceCyclic::solve(const std::vector<Field3D> &rhs) {
+  TRACE("LaplaceCyclic::solve(vector<Field3D>)");
+
+  std::vector<const Field3D *> b;
+  for (const auto &f : rhs) {
+    b.push_back(&f);
+  }
+  return solveFields(b, b);
+}
+
+std::vector<Field3D> LaplaceCyclic::solveFields(const std::vector<const Field3D *> &rhs,
+                                                const std::vector<const Field3D *> &x0) {
+  ASSERT1(rhs.size() == x0.size());
+
+  const int nf = rhs.size(); // Number of fields to solve for
+  if (nf == 0) {
+    return {};
+  }
 
   Timer timer("invert");
 
-  Mesh *mesh = rhs.getMesh();
-  Field3D x(mesh); // Result
-  x.allocate();
-  x.setLocation(location);
+  std::vector<Field3D> x; // Results
+  for (int fi = 0; fi < nf; fi++) {
+    ASSERT1(rhs[fi]->getMesh() == localmesh);
+    ASSERT1(rhs[fi]->getLocation() == location);
+    ASSERT1(x0[fi]->getLocation() == location);
+
+    x.emplace_back(localmesh);
+    x.back().allocate();
+    x.back().setLocation(location);
+  }
 
-  Coordinates *coord = rhs.getCoordinates();
+  Coordinates *coord = coords;
 
   // Get the width of the boundary
 
   // If the flags to assign that only one guard cell should be used is set
-  int inbndry = mesh->xstart, outbndry = mesh->xstart;
-  if ((global_flags & INVERT_BOTH_BNDRY_ONE) || (mesh->xstart < 2)) {
+  int inbndry = localmesh->xstart, outbndry = localmesh->xstart;
+  if ((global_flags & INVERT_BOTH_BNDRY_ONE) || (localmesh->xstart < 2)) {
     inbndry = outbndry = 1;
   }
   if (inner_boundary_flags & INVERT_BNDRY_ONE)
@@ -275,184 +434,229 @@ const Field3D LaplaceCyclic::solve(const Field3D &rhs, const Field3D &x0) {
   int nx = xe - xs + 1; // Number of X points on this processor
 
   // Get range of Y indices
-  int ys = mesh->ystart, ye = mesh->yend;
+  int ys = localmesh->ystart, ye = localmesh->yend;
 
-  if (mesh->hasBndryLowerY()) {
+  if (localmesh->hasBndryLowerY()) {
     if (include_yguards)
       ys = 0; // Mesh contains a lower boundary and we are solving in the guard cells
 
     ys += extra_yguards_lower;
   }
-  if (mesh->hasBndryUpperY()) {
+  if (localmesh->hasBndryUpperY()) {
     if (include_yguards)
-      ye = mesh->LocalNy -
+      ye = localmesh->LocalNy -
            1; // Contains upper boundary and we are solving in the guard cells
 
     ye -= extra_yguards_upper;
   }
 
   const int ny = (ye - ys + 1); // Number of Y points
-  const int nsys = nmode * ny;  // Number of systems of equations to solve
+  const int nsys = nmode * ny;  // Number of systems of equations for each field
   const int nxny = nx * ny;     // Number of points in X-Y
+  const int ntotal = nf * nsys; // Number of systems of equations to solve
+
+  // Only need to calculate the matrices if they have changed.
+  // The systems for all fields are solved together, so the matrices
+  // also depend on the number of fields
+  const bool update = matrixChanged(-nf);
+
+  Matrix<dcomplex> a3D, b3D, c3D;
+  if (update) {
+    a3D = Matrix<dcomplex>(ntotal, nx);
+    b3D = Matrix<dcomplex>(ntotal, nx);
+    c3D = Matrix<dcomplex>(ntotal, nx);
+  }
 
-  auto a3D = Matrix<dcomplex>(nsys, nx);
-  auto b3D = Matrix<dcomplex>(nsys, nx);
-  auto c3D = Matrix<dcomplex>(nsys, nx);
-
-  auto xcmplx3D = Matrix<dcomplex>(nsys, nx);
-  auto bcmplx3D = Matrix<dcomplex>(nsys, nx);
+  auto xcmplx3D = Matrix<dcomplex>(ntotal, nx);
+  auto bcmplx3D = Matrix<dcomplex>(ntotal, nx);
 
   if (dst) {
     BOUT_OMP(parallel) {
       /// Create a local thread-scope working array
       auto k1d =
-          Array<dcomplex>(mesh->LocalNz); // ZFFT routine expects input of this length
+          Array<dcomplex>(localmesh->LocalNz); // ZFFT routine expects input of this length
 
       // Loop over X and Y indices, including boundaries but not guard cells.
       // (unless periodic in x)
       BOUT_OMP(for)
-      for (int ind = 0; ind < nxny; ++ind) {
-        // ind = (ix - xs)*(ye - ys + 1) + (iy - ys)
-        int ix = xs + ind / ny;
+      for (int ind = 0; ind < nf * nxny; ++ind) {
+        // ind = fi*nxny + (ix - xs)*(ye - ys + 1) + (iy - ys)
+        int fi = ind / nxny;
+        int ix = xs + (ind % nxny) / ny;
         int iy = ys + ind % ny;
 
         // Take DST in Z direction and put result in k1d
 
-        if (((ix < inbndry) && (inner_boundary_flags & INVERT_SET) && mesh->firstX()) ||
+        if (((ix < inbndry) && (inner_boundary_flags & INVERT_SET) && localmesh->firstX()) ||
             ((xe - ix < outbndry) && (outer_boundary_flags & INVERT_SET) &&
-             mesh->lastX())) {
+             localmesh->lastX())) {
           // Use the values in x0 in the boundary
-          DST(x0(ix, iy) + 1, mesh->LocalNz - 2, std::begin(k1d));
+          DST((*x0[fi])(ix, iy) + 1, localmesh->LocalNz - 2, std::begin(k1d));
         } else {
-          DST(rhs(ix, iy) + 1, mesh->LocalNz - 2, std::begin(k1d));
+          DST((*rhs[fi])(ix, iy) + 1, localmesh->LocalNz - 2, std::begin(k1d));
         }
 
         // Copy into array, transposing so kz is first index
         for (int kz = 0; kz < nmode; kz++)
-          bcmplx((iy - ys) * nmode + kz, ix - xs) = k1d[kz];
+          bcmplx3D(fi * nsys + (iy - ys) * nmode + kz, ix - xs) = k1d[kz];
       }
 
       // Get elements of the tridiagonal matrix
       // including boundary conditions
-      BOUT_OMP(for nowait)
-      for (int ind = 0; ind < nsys; ind++) {
-        // ind = (iy - ys) * nmode + kz
-        int iy = ys + ind / nmode;
-        int kz = ind % nmode;
-
-        BoutReal zlen = coord->dz * (mesh->LocalNz - 3);
-        BoutReal kwave =
-            kz * 2.0 * PI / (2. * zlen); // wave number is 1/[rad]; DST has extra 2.
-
-        tridagMatrix(&a3D(ind, 0), &b3D(ind, 0), &c3D(ind, 0), &bcmplx3D(ind, 0), iy,
-                     kz,    // wave number index
-                     kwave, // kwave (inverse wave length)
-                     global_flags, inner_boundary_flags, outer_boundary_flags, &Acoef,
-                     &Ccoef, &Dcoef,
-                     false); // Don't include guard cells in arrays
+      if (update) {
+        BOUT_OMP(for nowait)
+        for (int ind = 0; ind < nsys; ind++) {
+          // ind = (iy - ys) * nmode + kz
+          int iy = ys + ind / nmode;
+          int kz = ind % nmode;
+
+          BoutReal zlen = coord->dz * (localmesh->LocalNz - 3);
+          BoutReal kwave =
+              kz * 2.0 * PI / (2. * zlen); // wave number is 1/[rad]; DST has extra 2.
+
+          tridagMatrix(&a3D(ind, 0), &b3D(ind, 0), &c3D(ind, 0), &bcmplx3D(ind, 0), iy,
+                       kz,    // wave number index
+                       kwave, // kwave (inverse wave length)
+                       global_flags, inner_boundary_flags, outer_boundary_flags, &Acoef,
+                       &Ccoef, &Dcoef,
+                       false); // Don't include guard cells in arrays
+        }
+        // Other fields use the same matrices
+        BOUT_OMP(for nowait)
+        for (int ind = nsys; ind < ntotal; ind++) {
+          setBoundaryRHS(&bcmplx3D(ind, 0), inbndry, outbndry);
+        }
+      } else {
+        // Matrices unchanged since the last solve
+        BOUT_OMP(for nowait)
+        for (int ind = 0; ind < ntotal; ind++) {
+          setBoundaryRHS(&bcmplx3D(ind, 0), inbndry, outbndry);
+        }
       }
     }
 
     // Solve tridiagonal systems
-    cr->setCoefs(a3D, b3D, c3D);
-    cr->solve(bcmplx3D, xcmplx3D);
+    if (update) {
+      copyMatrices(a3D, b3D, c3D, nsys);
+      factors->cr->setCoefs(a3D, b3D, c3D);
+    }
+    factors->cr->solve(bcmplx3D, xcmplx3D);
 
     // FFT back to real space
     BOUT_OMP(parallel) {
       /// Create a local thread-scope working array
       auto k1d =
-          Array<dcomplex>(mesh->LocalNz); // ZFFT routine expects input of this length
+          Array<dcomplex>(localmesh->LocalNz); // ZFFT routine expects input of this length
 
       BOUT_OMP(for nowait)
-      for (int ind = 0; ind < nxny; ++ind) { // Loop over X and Y
-        // ind = (ix - xs)*(ye - ys + 1) + (iy - ys)
-        int ix = xs + ind / ny;
+      for (int ind = 0; ind < nf * nxny; ++ind) { // Loop over fields, X and Y
+        // ind = fi*nxny + (ix - xs)*(ye - ys + 1) + (iy - ys)
+        int fi = ind / nxny;
+        int ix = xs + (ind % nxny) / ny;
         int iy = ys + ind % ny;
 
         for (int kz = 0; kz < nmode; kz++)
-          k1d[kz] = xcmplx3D((iy - ys) * nmode + kz, ix - xs);
+          k1d[kz] = xcmplx3D(fi * nsys + (iy - ys) * nmode + kz, ix - xs);
 
-        for (int kz = nmode; kz < mesh->LocalNz; kz++)
+        for (int kz = nmode; kz < localmesh->LocalNz; kz++)
           k1d[kz] = 0.0; // Filtering out all higher harmonics
 
-        DST_rev(std::begin(k1d), mesh->LocalNz - 2, &x(ix, iy, 1));
+        DST_rev(std::begin(k1d), localmesh->LocalNz - 2, &x[fi](ix, iy, 1));
 
-        x(ix, iy, 0) = -x(ix, iy, 2);
-        x(ix, iy, mesh->LocalNz - 1) = -x(ix, iy, mesh->LocalNz - 3);
+        x[fi](ix, iy, 0) = -x[fi](ix, iy, 2);
+        x[fi](ix, iy, localmesh->LocalNz - 1) = -x[fi](ix, iy, localmesh->LocalNz - 3);
       }
     }
   } else {
     BOUT_OMP(parallel) {
       /// Create a local thread-scope working array
-      auto k1d = Array<dcomplex>(mesh->LocalNz / 2 +
+      auto k1d = Array<dcomplex>(localmesh->LocalNz / 2 +
                                  1); // ZFFT routine expects input of this length
 
       // Loop over X and Y indices, including boundaries but not guard cells
       // (unless periodic in x)
 
       BOUT_OMP(for)
-      for (int ind = 0; ind < nxny; ++ind) {
-        // ind = (ix - xs)*(ye - ys + 1) + (iy - ys)
-        int ix = xs + ind / ny;
+      for (int ind = 0; ind < nf * nxny; ++ind) {
+        // ind = fi*nxny + (ix - xs)*(ye - ys + 1) + (iy - ys)
+        int fi = ind / nxny;
+        int ix = xs + (ind % nxny) / ny;
         int iy = ys + ind % ny;
 
         // Take FFT in Z direction, apply shift, and put result in k1d
 
-        if (((ix < inbndry) && (inner_boundary_flags & INVERT_SET) && mesh->firstX()) ||
+        if (((ix < inbndry) && (inner_boundary_flags & INVERT_SET) && localmesh->firstX()) ||
             ((xe - ix < outbndry) && (outer_boundary_flags & INVERT_SET) &&
-             mesh->lastX())) {
+             localmesh->lastX())) {
           // Use the values in x0 in the boundary
-          rfft(x0(ix, iy), mesh->LocalNz, std::begin(k1d));
+          rfft((*x0[fi])(ix, iy), localmesh->LocalNz, std::begin(k1d));
         } else {
-          rfft(rhs(ix, iy), mesh->LocalNz, std::begin(k1d));
+          rfft((*rhs[fi])(ix, iy), localmesh->LocalNz, std::begin(k1d));
         }
 
         // Copy into array, transposing so kz is first index
         for (int kz = 0; kz < nmode; kz++)
-          bcmplx3D((iy - ys) * nmode + kz, ix - xs) = k1d[kz];
+          bcmplx3D(fi * nsys + (iy - ys) * nmode + kz, ix - xs) = k1d[kz];
       }
 
       // Get elements of the tridiagonal matrix
       // including boundary conditions
-      BOUT_OMP(for nowait)
-      for (int ind = 0; ind < nsys; ind++) {
-        // ind = (iy - ys) * nmode + kz
-        int iy = ys + ind / nmode;
-        int kz = ind % nmode;
-
-        BoutReal kwave = kz * 2.0 * PI / (coord->zlength()); // wave number is 1/[rad]
-        tridagMatrix(&a3D(ind, 0), &b3D(ind, 0), &c3D(ind, 0), &bcmplx3D(ind, 0), iy,
-                     kz,    // True for the component constant (DC) in Z
-                     kwave, // Z wave number
-                     global_flags, inner_boundary_flags, outer_boundary_flags, &Acoef,
-                     &Ccoef, &Dcoef,
-                     false); // Don't include guard cells in arrays
+      if (update) {
+        BOUT_OMP(for nowait)
+        for (int ind = 0; ind < nsys; ind++) {
+          // ind = (iy - ys) * nmode + kz
+          int iy = ys + ind / nmode;
+          int kz = ind % nmode;
+
+          BoutReal kwave = kz * 2.0 * PI / (coord->zlength()); // wave number is 1/[rad]
+          tridagMatrix(&a3D(ind, 0), &b3D(ind, 0), &c3D(ind, 0), &bcmplx3D(ind, 0), iy,
+                       kz,    // True for the component constant (DC) in Z
+                       kwave, // Z wave number
+                       global_flags, inner_boundary_flags, outer_boundary_flags, &Acoef,
+                       &Ccoef, &Dcoef,
+                       false); // Don't include guard cells in arrays
+        }
+        // Other fields use the same matrices
+        BOUT_OMP(for nowait)
+        for (int ind = nsys; ind < ntotal; ind++) {
+          setBoundaryRHS(&bcmplx3D(ind, 0), inbndry, outbndry);
+        }
+      } else {
+        // Matrices unchanged since the last solve
+        BOUT_OMP(for nowait)
+        for (int ind = 0; ind < ntotal; ind++) {
+          setBoundaryRHS(&bcmplx3D(ind, 0), inbndry, outbndry);
+        }
       }
     }
 
     // Solve tridiagonal systems
-    cr->setCoefs(a3D, b3D, c3D);
-    cr->solve(bcmplx3D, xcmplx3D);
+    if (update) {
+      copyMatrices(a3D, b3D, c3D, nsys);
+      factors->cr->setCoefs(a3D, b3D, c3D);
+    }
+    factors->cr->solve(bcmplx3D, xcmplx3D);
 
     // FFT back to real space
     BOUT_OMP(parallel) {
       /// Create a local thread-scope working array
-      auto k1d = Array<dcomplex>((mesh->LocalNz) / 2 +
+      auto k1d = Array<dcomplex>((localmesh->LocalNz) / 2 +
                                  1); // ZFFT routine expects input of this length
 
       BOUT_OMP(for nowait)
-      for (int ind = 0; ind < nxny; ++ind) { // Loop over X and Y
-        // ind = (ix - xs)*(ye - ys + 1) + (iy - ys)
-        int ix = xs + ind / ny;
+      for (int ind = 0; ind < nf * nxny; ++ind) { // Loop over fields, X and Y
+        // ind = fi*nxny + (ix - xs)*(ye - ys + 1) + (iy - ys)
+        int fi = ind / nxny;
+        int ix = xs + (ind % nxny) / ny;
         int iy = ys + ind % ny;
 
         for (int kz = 0; kz < nmode; kz++)
-          k1d[kz] = xcmplx3D((iy - ys) * nmode + kz, ix - xs);
+          k1d[kz] = xcmplx3D(fi * nsys + (iy - ys) * nmode + kz, ix - xs);
 
-        for (int kz = nmode; kz < mesh->LocalNz / 2 + 1; kz++)
+        for (int kz = nmode; kz < localmesh->LocalNz / 2 + 1; kz++)
           k1d[kz] = 0.0; // Filtering out all higher harmonics
 
-        irfft(std::begin(k1d), mesh->LocalNz, x(ix, iy));
+        irfft(std::begin(k1d), localmesh->LocalNz, x[fi](ix, iy));
       }
     }
   }
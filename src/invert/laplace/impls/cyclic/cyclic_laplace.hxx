@@ -38,9 +38,24 @@ class LaplaceCyclic;
 
 #include "utils.hxx"
 
+#include <memory>
+#include <vector>
+
 /// Solves the 2D Laplacian equation using the CyclicReduce class
 /*!
- * 
+ * The tridiagonal matrices are only calculated and factorised again
+ * when a coefficient or the boundary flags change, or when switching
+ * between Field3D and FieldPerp solves (or between Y indices), so
+ * repeated solves with the same coefficients cost one forward and
+ * backward substitution.
+ *
+ * Several Field3Ds can be solved for together, which combines the
+ * communications of the tridiagonal solves.
+ *
+ * Solvers created on the same mesh with the same options, which have
+ * the same coefficients and flags, share the factorised matrices, so
+ * that for example the members of an ensemble (see EnsembleModel) only
+ * calculate and factorise them once.
  */
 class LaplaceCyclic : public Laplacian {
 public:
@@ -51,16 +66,19 @@ public:
   void setCoefA(const Field2D &val) override {
     ASSERT1(val.getLocation() == location);
     Acoef = val;
+    coef_version++;
   }
   using Laplacian::setCoefC;
   void setCoefC(const Field2D &val) override {
     ASSERT1(val.getLocation() == location);
     Ccoef = val;
+    coef_version++;
   }
   using Laplacian::setCoefD;
   void setCoefD(const Field2D &val) override {
     ASSERT1(val.getLocation() == location);
     Dcoef = val;
+    coef_version++;
   }
   using Laplacian::setCoefEx;
   void setCoefEx(const Field2D &UNUSED(val)) override {
@@ -77,6 +95,9 @@ public:
 
   const Field3D solve(const Field3D &b) override {return solve(b,b);}
   const Field3D solve(const Field3D &b, const Field3D &x0) override;
+
+  /// Solves for all the fields together, in one set of tridiagonal solves
+  std::vector<Field3D> solve(const std::vector<Field3D> &b) override;
 private:
   Field2D Acoef, Ccoef, Dcoef;
   
@@ -85,8 +106,53 @@ private:
   Matrix<dcomplex> a, b, c, bcmplx, xcmplx;
   
   bool dst;
-  
-  CyclicReduce<dcomplex> *cr; ///< Tridiagonal solver
+
+  Options *options; ///< Options this solver was created with
+
+  Mesh *localmesh;     ///< Mesh this solver was created with
+  Coordinates *coords; ///< Coordinates of the mesh at this solver's location
+
+  /// A tridiagonal solver, and what its matrices were calculated from
+  struct Factors {
+    std::unique_ptr<CyclicReduce<dcomplex>> cr; ///< Tridiagonal solver
+    Mesh *localmesh;     ///< Mesh of the Laplacian solvers using cr
+    Coordinates *coords; ///< Coordinates the matrices were calculated with
+    int geometry_version; ///< Geometry version of coords for the matrices
+    Options *options;  ///< Options of the Laplacian solvers using cr
+    CELL_LOC location; ///< Location of the Laplacian solvers
+    bool set = false;  ///< True once the matrices have been set
+    int index;         ///< Y index of the matrices, or -(number of Field3Ds)
+    int flags[3];      ///< Global, inner and outer flags of the matrices
+    Field2D A, C, D;   ///< Copies of the coefficients of the matrices
+  };
+
+  /// The tridiagonal solver used by this Laplacian solver, which may
+  /// be shared with other Laplacian solvers
+  std::shared_ptr<Factors> factors;
+
+  /// All the Factors in use, which can be shared between solvers
+  static std::vector<std::weak_ptr<Factors>> all_factors;
+
+  int coef_version = 0;    ///< Incremented when a coefficient is set
+  int factor_version = -1; ///< coef_version when factors was last set
+
+  /// Create new Factors, not shared with any other solver
+  void newFactors();
+
+  /// Returns true if the matrices in factors need to be set again for
+  /// a solve at Y index \p index (-n for n Field3Ds), and records that
+  /// they will be. If another solver has factors with the same
+  /// matrices, they are shared and false is returned
+  bool matrixChanged(int index);
+
+  /// Solve for each right-hand side in \p rhs, with boundary values
+  /// from the corresponding field in \p x0
+  std::vector<Field3D> solveFields(const std::vector<const Field3D *> &rhs,
+                                   const std::vector<const Field3D *> &x0);
+
+  /// Zero the boundary rows of \p bk as tridagMatrix does, for use
+  /// when the matrices are not calculated again
+  void setBoundaryRHS(dcomplex *bk, int inbndry, int outbndry);
 };
 
 #endif // __SPT_H__
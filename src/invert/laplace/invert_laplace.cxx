@@ -184,6 +184,16 @@ const Field2D Laplacian::solve(const Field2D &b) {
   return DC(f);
 }
 
+std::vector<Field3D> Laplacian::solve(const std::vector<Field3D> &b) {
+  TRACE("Laplacian::solve(vector<Field3D>)");
+
+  std::vector<Field3D> x;
+  for (const auto &f : b) {
+    x.push_back(solve(f));
+  }
+  return x;
+}
+
 /*!
  * Performs the laplacian inversion y-slice by y-slice
  *
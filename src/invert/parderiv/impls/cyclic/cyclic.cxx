@@ -9,6 +9,9 @@
  *
  * Author: Ben Dudson, University of York, Oct 2011
  * 
+ * The factorised matrix on each flux surface is kept between solves
+ * until a coefficient is set again.
+ *
  * Known issues:
  * ------------
  *
@@ -49,6 +52,8 @@
 #include <cmath>
 
 InvertParCR::InvertParCR(Options *opt) : InvertPar(opt), A(1.0), B(0.0), C(0.0), D(0.0), E(0.0) {
+  OPTION(opt, cache_factors, true);
+
   // Number of k equations to solve for each x location
   nsys = 1 + (mesh->LocalNz)/2; 
 
@@ -91,13 +96,20 @@ const Field3D InvertParCR::solve(const Field3D &f) {
   
   Coordinates *coord = f.getCoordinates();
   
-  // Create cyclic reduction object
-  CyclicReduce<dcomplex> *cr = 
-    new CyclicReduce<dcomplex>();
-  
+  // Coefficients only need to be put into the solvers when they, the
+  // location or the metric have changed since the last solve
+  bool update = !cache_factors || (coef_version != factor_version) ||
+                (f.getLocation() != factor_location) || (coord != factor_coords) ||
+                (coord->getGeometryVersion() != factor_geometry_version);
+  factor_version = coef_version;
+  factor_location = f.getLocation();
+  factor_coords = coord;
+  factor_geometry_version = coord->getGeometryVersion();
+
   // Loop over flux-surfaces
   SurfaceIter surf(mesh);
-  for(surf.first(); !surf.isDone(); surf.next()) {
+  int isurf = 0;
+  for(surf.first(); !surf.isDone(); surf.next(), isurf++) {
     int x = surf.xpos;
     
     // Test if open or closed field-lines
@@ -114,89 +126,115 @@ const Field3D InvertParCR::solve(const Field3D &f) {
       if(surf.lastY())
         size += 2;
     }
-      
-    // Setup CyclicReduce object
-    cr->setup(surf.communicator(), size);
-    cr->setPeriodic(closed);
-    
-    // Take Fourier transform 
-    for(int y=0;y<mesh->LocalNy-4;y++)
-      rfft(f(x, y + 2), mesh->LocalNz, &rhs(y + y0, 0));
 
-    // Set up tridiagonal system
-    for(int k=0; k<nsys; k++) {
-      BoutReal kwave=k*2.0*PI/coord->zlength(); // wave number is 1/[rad]
-      for(int y=0;y<mesh->LocalNy-4;y++) {
+    // Cyclic reduction object for this surface
+    int icr = cache_factors ? isurf : 0;
+    if (icr >= static_cast<int>(surface_cr.size())) {
+      surface_cr.emplace_back(new CyclicReduce<dcomplex>());
+    }
+    CyclicReduce<dcomplex> &cr = *surface_cr[icr];
+
+    if (update) {
+      // Setup CyclicReduce object
+      cr.setup(surf.communicator(), size);
+      cr.setPeriodic(closed);
+
+      // Set up tridiagonal system
+      for(int k=0; k<nsys; k++) {
+        BoutReal kwave=k*2.0*PI/coord->zlength(); // wave number is 1/[rad]
+        for(int y=0;y<mesh->LocalNy-4;y++) {
         
-	BoutReal acoef = A(x, y+2);                     // Constant
-	BoutReal bcoef = B(x, y+2) / coord->g_22(x,y+2); // d2dy2
-        BoutReal ccoef = C(x, y+2);                     // d2dydz
-        BoutReal dcoef = D(x, y+2);                     // d2dz2
-        BoutReal ecoef = E(x, y+2);                     // ddy
+          BoutReal acoef = A(x, y+2);                     // Constant
+          BoutReal bcoef = B(x, y+2) / coord->g_22(x,y+2); // d2dy2
+          BoutReal ccoef = C(x, y+2);                     // d2dydz
+          BoutReal dcoef = D(x, y+2);                     // d2dz2
+          BoutReal ecoef = E(x, y+2);                     // ddy
 	
-        bcoef /= SQ(coord->dy(x, y+2));
-        ccoef /= coord->dy(x,y+2)*coord->dz;
-        dcoef /= SQ(coord->dz);
-        ecoef /= coord->dy(x,y+2);
+          bcoef /= SQ(coord->dy(x, y+2));
+          ccoef /= coord->dy(x,y+2)*coord->dz;
+          dcoef /= SQ(coord->dz);
+          ecoef /= coord->dy(x,y+2);
         
-        //           const       d2dy2        d2dydz              d2dz2           ddy
-        //           -----       -----        ------              -----           ---
-        a(k, y + y0) =           bcoef - 0.5 * Im * kwave * ccoef          - 0.5 * ecoef;
-        b(k, y + y0) = acoef - 2. * bcoef           - SQ(kwave) * dcoef;
-        c(k, y + y0) =           bcoef + 0.5 * Im * kwave * ccoef          + 0.5 * ecoef;
-
-        rhsk(k, y + y0) = rhs(y + y0, k); // Transpose
+          //           const       d2dy2        d2dydz              d2dz2           ddy
+          //           -----       -----        ------              -----           ---
+          a(k, y + y0) =           bcoef - 0.5 * Im * kwave * ccoef          - 0.5 * ecoef;
+          b(k, y + y0) = acoef - 2. * bcoef           - SQ(kwave) * dcoef;
+          c(k, y + y0) =           bcoef + 0.5 * Im * kwave * ccoef          + 0.5 * ecoef;
+        }
       }
-    }
 
-    if(closed) {
-      // Twist-shift
-      int rank, np;
-      MPI_Comm_rank(surf.communicator(), &rank);
-      MPI_Comm_size(surf.communicator(), &np);
-      if(rank == 0) {
-        for(int k=0; k<nsys; k++) {
-          BoutReal kwave=k*2.0*PI/coord->zlength(); // wave number is 1/[rad]
-          dcomplex phase(cos(kwave*ts) , -sin(kwave*ts));
-          a(k, 0) *= phase;
+      if(closed) {
+        // Twist-shift
+        int rank, np;
+        MPI_Comm_rank(surf.communicator(), &rank);
+        MPI_Comm_size(surf.communicator(), &np);
+        if(rank == 0) {
+          for(int k=0; k<nsys; k++) {
+            BoutReal kwave=k*2.0*PI/coord->zlength(); // wave number is 1/[rad]
+            dcomplex phase(cos(kwave*ts) , -sin(kwave*ts));
+            a(k, 0) *= phase;
+          }
         }
-      }
-      if(rank == np-1) {
-        for(int k=0; k<nsys; k++) {
-          BoutReal kwave=k*2.0*PI/coord->zlength(); // wave number is 1/[rad]
-          dcomplex phase(cos(kwave*ts) , sin(kwave*ts));
-          c(k, mesh->LocalNy - 5) *= phase;
+        if(rank == np-1) {
+          for(int k=0; k<nsys; k++) {
+            BoutReal kwave=k*2.0*PI/coord->zlength(); // wave number is 1/[rad]
+            dcomplex phase(cos(kwave*ts) , sin(kwave*ts));
+            c(k, mesh->LocalNy - 5) *= phase;
+          }
+        }
+      }else {
+        // Open surface, so may have boundaries
+        if(surf.firstY()) {
+          for(int k=0; k<nsys; k++) {
+            for(int y=0;y<2;y++) {
+              a(k, y) = 0.;
+              b(k, y) = 1.;
+              c(k, y) = -1.;
+            }
+          }
+        }
+        if(surf.lastY()) {
+          for(int k=0; k<nsys; k++) {
+            for(int y=size-2;y<size;y++) {
+              a(k, y) = -1.;
+              b(k, y) = 1.;
+              c(k, y) = 0.;
+            }
+          }
         }
       }
-    }else {
-      // Open surface, so may have boundaries
+
+      // Factorised in the next solve
+      cr.setCoefs(a, b, c);
+    }
+    
+    // Take Fourier transform 
+    for(int y=0;y<mesh->LocalNy-4;y++)
+      rfft(f(x, y + 2), mesh->LocalNz, &rhs(y + y0, 0));
+
+    for(int k=0; k<nsys; k++) {
+      for(int y=0;y<mesh->LocalNy-4;y++)
+        rhsk(k, y + y0) = rhs(y + y0, k); // Transpose
+    }
+
+    if(!closed) {
+      // Boundary rows
       if(surf.firstY()) {
         for(int k=0; k<nsys; k++) {
-          for(int y=0;y<2;y++) {
-            a(k, y) = 0.;
-            b(k, y) = 1.;
-            c(k, y) = -1.;
-
+          for(int y=0;y<2;y++)
             rhsk(k, y) = 0.;
-          }
         }
       }
       if(surf.lastY()) {
         for(int k=0; k<nsys; k++) {
-          for(int y=size-2;y<size;y++) {
-            a(k, y) = -1.;
-            b(k, y) = 1.;
-            c(k, y) = 0.;
-
+          for(int y=size-2;y<size;y++)
             rhsk(k, y) = 0.;
-          }
         }
       }
     }
     
     // Solve cyclic tridiagonal system for each k
-    cr->setCoefs(a, b, c);
-    cr->solve(rhsk, xk);
+    cr.solve(rhsk, xk);
 
     // Put back into rhs array
     for(int k=0;k<nsys;k++) {
@@ -208,9 +246,6 @@ const Field3D InvertParCR::solve(const Field3D &f) {
     for(int y=0;y<size;y++)
       irfft(&rhs(y, 0), mesh->LocalNz, result(x, y + 2 - y0));
   }
-  
-  // Delete cyclic reduction object
-  delete cr;
 
   return result;
 }
@@ -9,6 +9,12 @@
  *
  * Author: Ben Dudson, University of York, Oct 2011
  * 
+ * The tridiagonal matrix on each flux surface is factorised when the
+ * coefficients change, and reused until they are set again or the
+ * metric changes (see Coordinates::getGeometryVersion). This
+ * uses memory for every flux surface; set cache_factors = false in
+ * the options to use a single solver instead.
+ *
  * Known issues:
  * ------------
  *
@@ -40,9 +46,13 @@
 #define __INV_PAR_CR_H__
 
 #include "invert_parderiv.hxx"
+#include "cyclic_reduction.hxx"
 #include "dcomplex.hxx"
 #include "utils.hxx"
 
+#include <memory>
+#include <vector>
+
 class InvertParCR : public InvertPar {
 public:
   InvertParCR(Options *opt);
@@ -52,15 +62,15 @@ public:
   const Field3D solve(const Field3D &f) override;
 
   using InvertPar::setCoefA;
-  void setCoefA(const Field2D &f) override { A = f; }
+  void setCoefA(const Field2D &f) override { A = f; coef_version++; }
   using InvertPar::setCoefB;
-  void setCoefB(const Field2D &f) override { B = f; }
+  void setCoefB(const Field2D &f) override { B = f; coef_version++; }
   using InvertPar::setCoefC;
-  void setCoefC(const Field2D &f) override { C = f; }
+  void setCoefC(const Field2D &f) override { C = f; coef_version++; }
   using InvertPar::setCoefD;
-  void setCoefD(const Field2D &f) override { D = f; }
+  void setCoefD(const Field2D &f) override { D = f; coef_version++; }
   using InvertPar::setCoefE;
-  void setCoefE(const Field2D &f) override { E = f; }
+  void setCoefE(const Field2D &f) override { E = f; coef_version++; }
 
 private:
   Field2D A, B, C, D, E;
@@ -71,6 +81,16 @@ private:
   Matrix<dcomplex>rhsk;
   Matrix<dcomplex>xk;
   Matrix<dcomplex> a, b, c; // Matrix coefficients
+
+  bool cache_factors; ///< Keep a factorised solver for each flux surface?
+  int coef_version = 0;    ///< Incremented when a coefficient is set
+  int factor_version = -1; ///< coef_version when the solvers were last set up
+  CELL_LOC factor_location = CELL_DEFAULT; ///< Location of the last solve
+  Coordinates *factor_coords = nullptr; ///< Coordinates of the last solve
+  int factor_geometry_version = -1; ///< Geometry version of factor_coords
+
+  /// Tridiagonal solvers, one for each flux surface if cache_factors is set
+  std::vector<std::unique_ptr<CyclicReduce<dcomplex>>> surface_cr;
 };
 
 
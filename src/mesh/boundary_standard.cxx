@@ -103,6 +103,69 @@ void verifyNumPoints(BoundaryRegion *region, int ptsRequired) {
 void verifyNumPoints(BoundaryRegion*, int) {}
 #endif
 
+void BoundaryValueCache::update(BoundaryRegion *region,
+                                const std::shared_ptr<FieldGenerator> &fg, BoutReal t,
+                                bool guards) {
+  if (!have_points) {
+    // The points in a region don't change, so only need to be found once
+    for (region->first(); !region->isDone(); region->next1d()) {
+      points.emplace_back(region->x, region->y);
+    }
+    have_points = true;
+  }
+
+  const int ng = guards ? region->width : 1;
+  if (valid && (fg == generator) && (ng == nguards) && (nz == mesh->LocalNz)) {
+    return;
+  }
+
+  nz = mesh->LocalNz;
+  nguards = ng;
+  const int npoints = points.size();
+  if (values.size() != npoints * nguards * nz) {
+    values = Array<BoutReal>(npoints * nguards * nz);
+  }
+
+  if (fg != generator) {
+    program = fg ? std::make_shared<ExpressionProgram>(fg) : nullptr;
+  }
+
+  if (!program) {
+    std::fill(values.begin(), values.end(), 0.0);
+  } else {
+    const int bx = region->bx, by = region->by;
+    BOUT_OMP(parallel) {
+      // Coordinates of one line in Z, and workspace for the program
+      std::vector<BoutReal> xpos(nz), ypos(nz), zpos(nz), work;
+      for (int zk = 0; zk < nz; zk++) {
+        zpos[zk] = TWOPI * zk / nz;
+      }
+      BOUT_OMP(for)
+      for (int p = 0; p < npoints; p++) {
+        const int x = points[p].first, y = points[p].second;
+        for (int i = 0; i < nguards; i++) {
+          BoutReal xnorm, ynorm;
+          if (i == 0) {
+            // Half-way between the guard cell and grid cell
+            xnorm = 0.5 * (mesh->GlobalX(x) + mesh->GlobalX(x - bx));
+            ynorm = 0.5 * (mesh->GlobalY(y) + mesh->GlobalY(y - by));
+          } else {
+            xnorm = mesh->GlobalX(x + i * bx);
+            ynorm = mesh->GlobalY(y + i * by);
+          }
+          std::fill(xpos.begin(), xpos.end(), xnorm);
+          std::fill(ypos.begin(), ypos.end(), TWOPI * ynorm);
+          program->evaluate(nz, xpos.data(), ypos.data(), zpos.data(), t,
+                            &values[(p * nguards + i) * nz], work);
+        }
+      }
+    }
+  }
+
+  generator = fg;
+  valid = !fg || !fg->dependsOnTime();
+}
+
 ///////////////////////////////////////////////////////////////
 
 BoundaryOp* BoundaryDirichlet::clone(BoundaryRegion *region, const list<string> &args){
@@ -478,62 +541,36 @@ void BoundaryDirichlet::apply(Field3D &f,BoutReal t) {
     }
   }
   else {
-    // Standard (non-staggered) case
-    for(; !bndry->isDone(); bndry->next1d()) {
-      // Calculate the X and Y normalised values half-way between the guard cell and grid cell 
-      BoutReal xnorm = 0.5*(   mesh->GlobalX(bndry->x)  // In the guard cell
-			       + mesh->GlobalX(bndry->x - bndry->bx) ); // the grid cell
-
-      BoutReal ynorm = 0.5*(   mesh->GlobalY(bndry->y)  // In the guard cell
-			       + mesh->GlobalY(bndry->y - bndry->by) ); // the grid cell
-      
-      for(int zk=0;zk<mesh->LocalNz;zk++) {
-	if(fg){
-	  val = fg->generate(xnorm,TWOPI*ynorm,TWOPI*zk/(mesh->LocalNz), t);
-	}
-	f(bndry->x,bndry->y,zk) = 2*val - f(bndry->x-bndry->bx, bndry->y-bndry->by, zk);
-
-        // We've set the first boundary point using extrapolation in
-        // the line above.  The below block of code is attempting to
-        // set the rest of the boundary cells also using
-        // extrapolation. Whilst this choice doesn't impact 2nd order
-        // methods it has been observed that with higher order
-        // methods, which actually use these points, the use of
-        // extrapolation can be unstable. For this reason we have
-        // commented out the below block and replaced it with the loop
-        // several lines below, which just sets all the rest of the
-        // boundary points to be the specified value.  We've not
-        // removed the commented out code as we may wish to revisit
-        // this in the future, however it may be that this is
-        // eventually removed.  It can be noted that we *don't* apply
-        // this treatment for other boundary treatments,
-        // i.e. elsewhere we tend to extrapolate.
-
-        // // Need to set second guard cell, as may be used for interpolation or upwinding derivatives
-        // for(int i=1;i<bndry->width;i++) {
-        //   int xi = bndry->x + i*bndry->bx;
-        //   int yi = bndry->y + i*bndry->by;
-
-        //   f(xi, yi, zk) = 2*f(xi - bndry->bx, yi - bndry->by, zk) - f(xi - 2*bndry->bx, yi - 2*bndry->by, zk);
-        //   // f(xi, yi, zk) = 3.0*f(xi - bndry->bx, yi - bndry->by, zk) - 3.0*f(xi - 2*bndry->bx, yi - 2*bndry->by, zk) + f(xi - 3*bndry->bx, yi - 3*bndry->by, zk);
-
-        // }
-      }
-
-      // This loop is our alternative approach to setting the rest of the boundary
-      // points. Instead of extrapolating we just use the generated values. This
-      // can help with the stability of higher order methods.
-      for (int i = 1; i < bndry->width; i++) {
-        // Set any other guard cells using the values on the cells
-        int xi = bndry->x + i*bndry->bx;
-        int yi = bndry->y + i*bndry->by;
-        xnorm = mesh->GlobalX(xi);
-        ynorm = mesh->GlobalY(yi);
-        for(int zk=0;zk<mesh->LocalNz;zk++) {
-          if(fg) {
-            val = fg->generate(xnorm,TWOPI*ynorm,TWOPI*zk/(mesh->LocalNz), t);
-          }
-          f(xi, yi, zk) = val;
+    // Standard (non-staggered) case. The values are only recalculated
+    // if the generator changes or depends on time
+    cache.update(bndry, fg, t, true);
+
+    const auto &points = cache.getPoints();
+    const int npoints = points.size();
+    const int nz = mesh->LocalNz;
+    const int bx = bndry->bx, by = bndry->by;
+    const int width = bndry->width;
+
+    // Each point only sets its own guard cells
+    BOUT_OMP(parallel for)
+    for (int p = 0; p < npoints; p++) {
+      const int x = points[p].first, y = points[p].second;
+
+      const BoutReal *bval = cache(p, 0);
+      const BoutReal *f1 = &f(x - bx, y - by, 0);
+      BoutReal *fb = &f(x, y, 0);
+      for (int zk = 0; zk < nz; zk++) {
+        fb[zk] = 2 * bval[zk] - f1[zk];
+      }
+
+      // Set the rest of the guard cells to the generated values rather than
+      // extrapolating, as extrapolation has been observed to be unstable
+      // with higher order methods which use these points
+      for (int i = 1; i < width; i++) {
+        bval = cache(p, i);
+        fb = &f(x + i * bx, y + i * by, 0);
+        for (int zk = 0; zk < nz; zk++) {
+          fb[zk] = bval[zk];
         }
       }
     }
@@ -926,33 +963,46 @@ void BoundaryDirichlet_O3::apply(Field3D &f,BoutReal t) {
     }
   }
   else {
-    // Standard (non-staggered) case
-    for(; !bndry->isDone(); bndry->next1d()) {
-      // Calculate the X and Y normalised values half-way between the guard cell and grid cell 
-      BoutReal xnorm = 0.5*(   mesh->GlobalX(bndry->x)  // In the guard cell
-			       + mesh->GlobalX(bndry->x - bndry->bx) ); // the grid cell
-
-      BoutReal ynorm = 0.5*(   mesh->GlobalY(bndry->y)  // In the guard cell
-			       + mesh->GlobalY(bndry->y - bndry->by) ); // the grid cell
-      
-      for(int zk=0;zk<mesh->LocalNz;zk++) {
-	if(fg)
-	  val = fg->generate(xnorm,TWOPI*ynorm,TWOPI*zk/(mesh->LocalNz), t);
-	
-	f(bndry->x,bndry->y,zk) = (8./3)*val - 2.*f(bndry->x-bndry->bx, bndry->y-bndry->by,zk) + f(bndry->x-2*bndry->bx, bndry->y-2*bndry->by,zk)/3.;
-				
-	// Need to set remaining guard cells, as may be used for interpolation or upwinding derivatives
-	for(int i=1;i<bndry->width;i++) {
-	  int xi = bndry->x + i*bndry->bx;
-	  int yi = bndry->y + i*bndry->by;
-	  f(xi, yi, zk) = 3.0*f(xi - bndry->bx, yi - bndry->by, zk) - 3.0*f(xi - 2*bndry->bx, yi - 2*bndry->by, zk) 
-	    + f(xi - 3*bndry->bx, yi - 3*bndry->by, zk);
-	}
+    // Standard (non-staggered) case. The values are only recalculated
+    // if the generator changes or depends on time
+    cache.update(bndry, fg, t, false);
+
+    const auto &points = cache.getPoints();
+    const int npoints = points.size();
+    const int nz = mesh->LocalNz;
+    const int bx = bndry->bx, by = bndry->by;
+    const int width = bndry->width;
+
+    // Each point only sets its own guard cells
+    BOUT_OMP(parallel for)
+    for (int p = 0; p < npoints; p++) {
+      const int x = points[p].first, y = points[p].second;
+
+      const BoutReal *bval = cache(p, 0);
+      const BoutReal *f1 = &f(x - bx, y - by, 0);
+      const BoutReal *f2 = &f(x - 2 * bx, y - 2 * by, 0);
+      BoutReal *fb = &f(x, y, 0);
+      for (int zk = 0; zk < nz; zk++) {
+        fb[zk] = (8. / 3) * bval[zk] - 2. * f1[zk] + f2[zk] / 3.;
+      }
+
+      // Need to set remaining guard cells, as may be used for interpolation
+      // or upwinding derivatives
+      for (int i = 1; i < width; i++) {
+        const int xi = x + i * bx, yi = y + i * by;
+        const BoutReal *f1 = &f(xi - bx, yi - by, 0);
+        const BoutReal *f2 = &f(xi - 2 * bx, yi - 2 * by, 0);
+        const BoutReal *f3 = &f(xi - 3 * bx, yi - 3 * by, 0);
+        BoutReal *fb = &f(xi, yi, 0);
+        for (int zk = 0; zk < nz; zk++) {
+          fb[zk] = 3.0 * f1[zk] - 3.0 * f2[zk] + f3[zk];
+        }
       }
     }
   }
 }
 
+
 void BoundaryDirichlet_O3::apply_ddt(Field2D &f) {
   Field2D *dt = f.timeDeriv();
   for(bndry->first(); !bndry->isDone(); bndry->next())
@@ -1358,33 +1408,48 @@ void BoundaryDirichlet_O4::apply(Field3D &f,BoutReal t) {
     }
   }
   else {
-    // Standard (non-staggered) case
-    for(; !bndry->isDone(); bndry->next1d()) {
-      // Calculate the X and Y normalised values half-way between the guard cell and grid cell 
-      BoutReal xnorm = 0.5*(   mesh->GlobalX(bndry->x)  // In the guard cell
-			       + mesh->GlobalX(bndry->x - bndry->bx) ); // the grid cell
-
-      BoutReal ynorm = 0.5*(   mesh->GlobalY(bndry->y)  // In the guard cell
-			       + mesh->GlobalY(bndry->y - bndry->by) ); // the grid cell
-      
-      for(int zk=0;zk<mesh->LocalNz;zk++) {
-	if(fg)
-	  val = fg->generate(xnorm,TWOPI*ynorm,TWOPI*zk/(mesh->LocalNz), t);
-	
-	f(bndry->x,bndry->y,zk) = (16./5)*val - 3.*f(bndry->x-bndry->bx, bndry->y-bndry->by,zk) + f(bndry->x-2*bndry->bx, bndry->y-2*bndry->by,zk) - (1./5)*f(bndry->x-3*bndry->bx, bndry->y-3*bndry->by,zk);
-				
-	// Need to set remaining guard cells, as may be used for interpolation or upwinding derivatives
-	for(int i=1;i<bndry->width;i++) {
-	  int xi = bndry->x + i*bndry->bx;
-	  int yi = bndry->y + i*bndry->by;
-	  f(xi, yi, zk) = 4.0*f(xi - bndry->bx, yi - bndry->by, zk) - 6.0*f(xi - 2*bndry->bx, yi - 2*bndry->by, zk) 
-	    + 4.0*f(xi - 3*bndry->bx, yi - 3*bndry->by, zk) - f(xi - 4*bndry->bx, yi - 4*bndry->by, zk);
-	}
+    // Standard (non-staggered) case. The values are only recalculated
+    // if the generator changes or depends on time
+    cache.update(bndry, fg, t, false);
+
+    const auto &points = cache.getPoints();
+    const int npoints = points.size();
+    const int nz = mesh->LocalNz;
+    const int bx = bndry->bx, by = bndry->by;
+    const int width = bndry->width;
+
+    // Each point only sets its own guard cells
+    BOUT_OMP(parallel for)
+    for (int p = 0; p < npoints; p++) {
+      const int x = points[p].first, y = points[p].second;
+
+      const BoutReal *bval = cache(p, 0);
+      const BoutReal *f1 = &f(x - bx, y - by, 0);
+      const BoutReal *f2 = &f(x - 2 * bx, y - 2 * by, 0);
+      const BoutReal *f3 = &f(x - 3 * bx, y - 3 * by, 0);
+      BoutReal *fb = &f(x, y, 0);
+      for (int zk = 0; zk < nz; zk++) {
+        fb[zk] = (16. / 5) * bval[zk] - 3. * f1[zk] + f2[zk] - (1. / 5) * f3[zk];
+      }
+
+      // Need to set remaining guard cells, as may be used for interpolation
+      // or upwinding derivatives
+      for (int i = 1; i < width; i++) {
+        const int xi = x + i * bx, yi = y + i * by;
+        const BoutReal *f1 = &f(xi - bx, yi - by, 0);
+        const BoutReal *f2 = &f(xi - 2 * bx, yi - 2 * by, 0);
+        const BoutReal *f3 = &f(xi - 3 * bx, yi - 3 * by, 0);
+        const BoutReal *f4 = &f(xi - 4 * bx, yi - 4 * by, 0);
+        BoutReal *fb = &f(xi, yi, 0);
+        for (int zk = 0; zk < nz; zk++) {
+          fb[zk] = 4.0 * f1[zk] - 6.0 * f2[zk] + 4.0 * f3[zk] - f4[zk];
+        }
       }
     }
   }
 }
 
+
 void BoundaryDirichlet_O4::apply_ddt(Field2D &f) {
   Field2D *dt = f.timeDeriv();
   for(bndry->first(); !bndry->isDone(); bndry->next())
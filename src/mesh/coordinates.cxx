@@ -311,6 +311,8 @@ void Coordinates::outputVars(Datafile &file) {
 int Coordinates::geometry() {
   TRACE("Coordinates::geometry");
 
+  invalidateCache();
+
   output_progress.write("Calculating differential geometry terms\n");
 
   if (min(abs(dx)) < 1e-8)
@@ -481,6 +483,8 @@ int Coordinates::geometry() {
 int Coordinates::calcCovariant() {
   TRACE("Coordinates::calcCovariant");
 
+  invalidateCache();
+
   // Make sure metric elements are allocated
   g_11.allocate();
   g_22.allocate();
@@ -548,6 +552,8 @@ int Coordinates::calcCovariant() {
 int Coordinates::calcContravariant() {
   TRACE("Coordinates::calcContravariant");
 
+  invalidateCache();
+
   // Make sure metric elements are allocated
   g11.allocate();
   g22.allocate();
@@ -606,6 +612,8 @@ int Coordinates::calcContravariant() {
 
 int Coordinates::jacobian() {
   TRACE("Coordinates::jacobian");
+
+  invalidateCache();
   // calculate Jacobian using g^-1 = det[g^ij], J = sqrt(g)
 
   Field2D g = g11 * g22 * g33 + 2.0 * g12 * g13 * g23 - g11 * g23 * g23 -
@@ -633,6 +641,21 @@ int Coordinates::jacobian() {
   return 0;
 }
 
+void Coordinates::invalidateCache() {
+  delp2_a = delp2_b = delp2_c = Tensor<dcomplex>();
+  sqrt_g_22_valid = false;
+  dJ_g_22_dy_valid = false;
+  geometry_version++;
+}
+
+const Field2D &Coordinates::getSqrtG22() {
+  if (!sqrt_g_22_valid) {
+    sqrt_g_22 = sqrt(g_22);
+    sqrt_g_22_valid = true;
+  }
+  return sqrt_g_22;
+}
+
 /*******************************************************************************
  * Operators
  *
@@ -667,7 +690,7 @@ const Field2D Coordinates::Grad_par(const Field2D &var, MAYBE_UNUSED(CELL_LOC ou
   TRACE("Coordinates::Grad_par( Field2D )");
   ASSERT1(location == outloc || (outloc == CELL_DEFAULT && location == var.getLocation()));
 
-  return DDY(var) / sqrt(g_22);
+  return DDY(var) / getSqrtG22();
 }
 
 const Field3D Coordinates::Grad_par(const Field3D &var, CELL_LOC outloc,
@@ -675,7 +698,7 @@ const Field3D Coordinates::Grad_par(const Field3D &var, CELL_LOC outloc,
   TRACE("Coordinates::Grad_par( Field3D )");
   ASSERT1(location == outloc || outloc == CELL_DEFAULT);
 
-  return ::DDY(var, outloc, method) / sqrt(g_22);
+  return ::DDY(var, outloc, method) / getSqrtG22();
 }
 
 /////////////////////////////////////////////////////////
@@ -686,13 +709,13 @@ const Field2D Coordinates::Vpar_Grad_par(const Field2D &v, const Field2D &f,
                                          MAYBE_UNUSED(CELL_LOC outloc),
                                          DIFF_METHOD UNUSED(method)) {
   ASSERT1(location == outloc || (outloc == CELL_DEFAULT && location == f.getLocation()));
-  return VDDY(v, f) / sqrt(g_22);
+  return VDDY(v, f) / getSqrtG22();
 }
 
 const Field3D Coordinates::Vpar_Grad_par(const Field3D &v, const Field3D &f, CELL_LOC outloc,
                                          DIFF_METHOD method) {
   ASSERT1(location == outloc || outloc == CELL_DEFAULT);
-  return VDDY(v, f, outloc, method) / sqrt(g_22);
+  return VDDY(v, f, outloc, method) / getSqrtG22();
 }
 
 /////////////////////////////////////////////////////////
@@ -747,7 +770,7 @@ const Field2D Coordinates::Grad2_par2(const Field2D &f, CELL_LOC outloc, DIFF_ME
   TRACE("Coordinates::Grad2_par2( Field2D )");
   ASSERT1(location == outloc || (outloc == CELL_DEFAULT && location == f.getLocation()));
 
-  Field2D sg = sqrt(g_22);
+  const Field2D &sg = getSqrtG22();
   Field2D result = DDY(1. / sg, outloc, method) * DDY(f, outloc, method) / sg + D2DY2(f, outloc, method) / g_22;
 
   return result;
@@ -763,8 +786,8 @@ const Field3D Coordinates::Grad2_par2(const Field3D &f, CELL_LOC outloc, DIFF_ME
   Field2D sg(localmesh);
   Field3D result(localmesh), r2(localmesh);
 
-  sg = sqrt(g_22);
-  sg = DDY(1. / sg, outloc, method) / sg;
+  const Field2D &sqrt_g = getSqrtG22();
+  sg = DDY(1. / sqrt_g, outloc, method) / sqrt_g;
 
 
   result = ::DDY(f, outloc, method);
@@ -792,6 +815,59 @@ const Field2D Coordinates::Delp2(const Field2D &f, CELL_LOC outloc) {
   return result;
 }
 
+void Coordinates::calcDelp2Coefs() {
+  if (!delp2_a.empty()) {
+    return;
+  }
+  TRACE("Coordinates::calcDelp2Coefs");
+
+  const int nkz = localmesh->LocalNz / 2 + 1;
+  delp2_a = Tensor<dcomplex>(localmesh->LocalNy, localmesh->LocalNx, nkz);
+  delp2_b = Tensor<dcomplex>(localmesh->LocalNy, localmesh->LocalNx, nkz);
+  delp2_c = Tensor<dcomplex>(localmesh->LocalNy, localmesh->LocalNx, nkz);
+
+  for (int jy = 0; jy < localmesh->LocalNy; jy++) {
+    for (int jx = 0; jx < localmesh->LocalNx; jx++) {
+      dcomplex *a = &delp2_a(jy, jx, 0);
+      dcomplex *b = &delp2_b(jy, jx, 0);
+      dcomplex *c = &delp2_c(jy, jx, 0);
+      for (int jz = 0; jz < nkz; jz++) {
+        laplace_tridag_coefs(jx, jy, jz, a[jz], b[jz], c[jz], nullptr, nullptr,
+                             location);
+      }
+    }
+  }
+}
+
+void Coordinates::delp2Slice(const BoutReal *f, int dist, int jy, dcomplex *ft,
+                             dcomplex *delft) {
+  const int ncz = localmesh->LocalNz;
+  const int nkz = ncz / 2 + 1;
+
+  // Take forward FFT of all X lines together
+  rfft(f, ncz, localmesh->LocalNx, dist, ft);
+
+  // No smoothing in the x direction
+  for (int jx = localmesh->xstart; jx <= localmesh->xend; jx++) {
+    // Perform x derivative
+    const dcomplex *a = &delp2_a(jy, jx, 0);
+    const dcomplex *b = &delp2_b(jy, jx, 0);
+    const dcomplex *c = &delp2_c(jy, jx, 0);
+    const dcomplex *fm = ft + (jx - 1) * nkz;
+    const dcomplex *fc = ft + jx * nkz;
+    const dcomplex *fp = ft + (jx + 1) * nkz;
+    dcomplex *out = delft + jx * nkz;
+
+    for (int jz = 0; jz < nkz; jz++) {
+      out[jz] = a[jz] * fm[jz] + b[jz] * fc[jz] + c[jz] * fp[jz];
+    }
+  }
+
+  // Boundaries
+  std::fill(delft, delft + localmesh->xstart * nkz, 0.0);
+  std::fill(delft + (localmesh->xend + 1) * nkz, delft + localmesh->LocalNx * nkz, 0.0);
+}
+
 const Field3D Coordinates::Delp2(const Field3D &f, CELL_LOC outloc) {
   TRACE("Coordinates::Delp2( Field3D )");
   if (outloc == CELL_DEFAULT) {
@@ -811,47 +887,35 @@ const Field3D Coordinates::Delp2(const Field3D &f, CELL_LOC outloc) {
   result.allocate();
   result.setLocation(f.getLocation());
 
-  int ncz = localmesh->LocalNz;
+  const int ncz = localmesh->LocalNz;
+  const int nkz = ncz / 2 + 1;
+  // Distance between X lines in a Field3D
+  const int dist = localmesh->LocalNy * ncz;
+  const int nxinner = localmesh->xend - localmesh->xstart + 1;
 
-  // Allocate memory
-  auto ft = Matrix<dcomplex>(localmesh->LocalNx, ncz / 2 + 1);
-  auto delft = Matrix<dcomplex>(localmesh->LocalNx, ncz / 2 + 1);
+  // Not thread safe, so calculate before the parallel region
+  calcDelp2Coefs();
 
-  // Loop over all y indices
-  for (int jy = 0; jy < localmesh->LocalNy; jy++) {
-
-    // Take forward FFT
-
-    for (int jx = 0; jx < localmesh->LocalNx; jx++)
-      rfft(&f(jx, jy, 0), ncz, &ft(jx, 0));
-
-    // Loop over kz
-    for (int jz = 0; jz <= ncz / 2; jz++) {
-      dcomplex a, b, c;
+  BOUT_OMP(parallel) {
+    // Thread-local workspace, reused from the Array store
+    auto ft = Matrix<dcomplex>(localmesh->LocalNx, nkz);
+    auto delft = Matrix<dcomplex>(localmesh->LocalNx, nkz);
 
-      // No smoothing in the x direction
-      for (int jx = localmesh->xstart; jx <= localmesh->xend; jx++) {
-        // Perform x derivative
-
-        laplace_tridag_coefs(jx, jy, jz, a, b, c, nullptr, nullptr, outloc);
-
-        delft(jx, jz) = a * ft(jx - 1, jz) + b * ft(jx, jz) + c * ft(jx + 1, jz);
-      }
-    }
-
-    // Reverse FFT
-    for (int jx = localmesh->xstart; jx <= localmesh->xend; jx++) {
+    // Loop over all y indices
+    BOUT_OMP(for)
+    for (int jy = 0; jy < localmesh->LocalNy; jy++) {
+      delp2Slice(&f(0, jy, 0), dist, jy, &ft(0, 0), &delft(0, 0));
 
-      irfft(&delft(jx, 0), ncz, &result(jx, jy, 0));
-    }
+      // Reverse FFT
+      irfft(&delft(localmesh->xstart, 0), ncz, nxinner, &result(localmesh->xstart, jy, 0),
+            dist);
 
-    // Boundaries
-    for (int jz = 0; jz < ncz; jz++) {
+      // Boundaries
       for (int jx = 0; jx < localmesh->xstart; jx++) {
-        result(jx, jy, jz) = 0.0;
+        std::fill(&result(jx, jy, 0), &result(jx, jy, 0) + ncz, 0.0);
       }
       for (int jx = localmesh->xend + 1; jx < localmesh->LocalNx; jx++) {
-        result(jx, jy, jz) = 0.0;
+        std::fill(&result(jx, jy, 0), &result(jx, jy, 0) + ncz, 0.0);
       }
     }
   }
@@ -876,52 +940,83 @@ const FieldPerp Coordinates::Delp2(const FieldPerp &f, CELL_LOC outloc) {
   int jy = f.getIndex();
   result.setIndex(jy);
 
-  int ncz = localmesh->LocalNz;
+  const int ncz = localmesh->LocalNz;
 
-  // Allocate memory
-  auto ft = Matrix<dcomplex>(localmesh->LocalNx, ncz / 2 + 1);
-  auto delft = Matrix<dcomplex>(localmesh->LocalNx, ncz / 2 + 1);
+  auto delft = Delp2Fourier(f);
+
+  // Reverse FFT
+  irfft(&delft(localmesh->xstart, 0), ncz, localmesh->xend - localmesh->xstart + 1,
+        &result(localmesh->xstart, 0), ncz);
+
+  // Boundaries
+  for (int jx = 0; jx < localmesh->xstart; jx++) {
+    std::fill(&result(jx, 0), &result(jx, 0) + ncz, 0.0);
+  }
+  for (int jx = localmesh->xend + 1; jx < localmesh->LocalNx; jx++) {
+    std::fill(&result(jx, 0), &result(jx, 0) + ncz, 0.0);
+  }
+
+  return result;
+}
+
+const Tensor<dcomplex> Coordinates::Delp2Fourier(const Field3D &f) {
+  TRACE("Coordinates::Delp2Fourier( Field3D )");
+  ASSERT1(f.getLocation() == location);
+  ASSERT2(localmesh->xstart > 0); // Need at least one guard cell
 
-  // Take forward FFT
-  for (int jx = 0; jx < localmesh->LocalNx; jx++)
-    rfft(&f(jx, 0), ncz, &ft(jx, 0));
+  const int ncz = localmesh->LocalNz;
+  const int nkz = ncz / 2 + 1;
+  const int dist = localmesh->LocalNy * ncz;
 
-  // Loop over kz
-  for (int jz = 0; jz <= ncz / 2; jz++) {
+  auto result = Tensor<dcomplex>(localmesh->LocalNy, localmesh->LocalNx, nkz);
 
-    // No smoothing in the x direction
-    for (int jx = 2; jx < (localmesh->LocalNx - 2); jx++) {
-      // Perform x derivative
+  calcDelp2Coefs();
 
-      dcomplex a, b, c;
-      laplace_tridag_coefs(jx, jy, jz, a, b, c);
+  BOUT_OMP(parallel) {
+    auto ft = Matrix<dcomplex>(localmesh->LocalNx, nkz);
 
-      delft(jx, jz) = a * ft(jx - 1, jz) + b * ft(jx, jz) + c * ft(jx + 1, jz);
+    BOUT_OMP(for)
+    for (int jy = 0; jy < localmesh->LocalNy; jy++) {
+      delp2Slice(&f(0, jy, 0), dist, jy, &ft(0, 0), &result(jy, 0, 0));
     }
   }
 
-  // Reverse FFT
-  for (int jx = 1; jx < (localmesh->LocalNx - 1); jx++) {
-    irfft(&delft(jx, 0), ncz, &result(jx, 0));
-  }
+  return result;
+}
 
-  // Boundaries
-  for (int jz = 0; jz < ncz; jz++) {
-    result(0, jz) = 0.0;
-    result(localmesh->LocalNx - 1, jz) = 0.0;
-  }
+const Matrix<dcomplex> Coordinates::Delp2Fourier(const FieldPerp &f) {
+  TRACE("Coordinates::Delp2Fourier( FieldPerp )");
+  ASSERT1(f.getLocation() == location);
+  ASSERT2(localmesh->xstart > 0); // Need at least one guard cell
+
+  const int nkz = localmesh->LocalNz / 2 + 1;
+
+  auto ft = Matrix<dcomplex>(localmesh->LocalNx, nkz);
+  auto result = Matrix<dcomplex>(localmesh->LocalNx, nkz);
+
+  calcDelp2Coefs();
+
+  delp2Slice(&f(0, 0), localmesh->LocalNz, f.getIndex(), &ft(0, 0), &result(0, 0));
 
   return result;
 }
 
+const Field2D &Coordinates::getDJg22DY() {
+  if (!dJ_g_22_dy_valid) {
+    dJ_g_22_dy = DDY(J / g_22, location);
+    dJ_g_22_dy_valid = true;
+  }
+  return dJ_g_22_dy;
+}
+
 const Field2D Coordinates::Laplace_par(const Field2D &f, CELL_LOC outloc) {
   ASSERT1(location == outloc || outloc == CELL_DEFAULT);
-  return D2DY2(f, outloc) / g_22 + DDY(J / g_22, outloc) * DDY(f, outloc) / J;
+  return D2DY2(f, outloc) / g_22 + getDJg22DY() * DDY(f, outloc) / J;
 }
 
 const Field3D Coordinates::Laplace_par(const Field3D &f, CELL_LOC outloc) {
   ASSERT1(location == outloc || outloc == CELL_DEFAULT);
-  return D2DY2(f, outloc) / g_22 + DDY(J / g_22, outloc) * ::DDY(f, outloc) / J;
+  return D2DY2(f, outloc) / g_22 + getDJg22DY() * ::DDY(f, outloc) / J;
 }
 
 // Full Laplacian operator on scalar field
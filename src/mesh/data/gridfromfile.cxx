@@ -16,6 +16,9 @@
 
 #include <unused.hxx>
 
+#include <boutcomm.hxx>
+
+#include <algorithm>
 #include <utility>
 
 /*!
@@ -24,8 +27,10 @@
  * format     Pointer to DataFormat. This will be deleted in
  *            destructor
  */
-GridFile::GridFile(std::unique_ptr<DataFormat> format, string gridfilename)
-    : file(std::move(format)), filename(std::move(gridfilename)) {
+GridFile::GridFile(std::unique_ptr<DataFormat> format, string gridfilename,
+                   Options *opt)
+    : file(std::move(format)), filename(std::move(gridfilename)),
+      node_comm(MPI_COMM_NULL) {
   TRACE("GridFile constructor");
 
   if (! file->openr(filename) ) {
@@ -34,10 +39,28 @@ GridFile::GridFile(std::unique_ptr<DataFormat> format, string gridfilename)
 
   file->setGlobalOrigin(); // Set default global origin
 
+  if (opt == nullptr) {
+    opt = Options::getRoot()->getSection("mesh");
+  }
+
+  bool shared_read;
+  OPTION(opt, shared_read, false);
+  if (shared_read) {
+#if MPI_VERSION >= 3
+    // Group processors which can share memory
+    MPI_Comm_split_type(BoutComm::get(), MPI_COMM_TYPE_SHARED, BoutComm::rank(),
+                        MPI_INFO_NULL, &node_comm);
+#else
+    output_warn.write("\tWARNING: shared_read needs MPI-3. Reading on every processor\n");
+#endif
+  }
 }
 
 GridFile::~GridFile() {
   file->close();
+  if (node_comm != MPI_COMM_NULL) {
+    MPI_Comm_free(&node_comm);
+  }
 }
 
 /*!
@@ -52,7 +75,7 @@ bool GridFile::hasVar(const string &name) {
   }
   
   /// Get the size of the variable
-  vector<int> s = file->getSize(name);
+  const vector<int> &s = getSize(name);
   
   /// Test if the variable has zero size
   return s.size() != 0;
@@ -128,7 +151,7 @@ bool GridFile::get(Mesh *m, Field2D &var,   const string &name, BoutReal def) {
   if (!file->is_valid()) {
     throw BoutException("Could not read '%s' from file: File cannot be read", name.c_str());
   }
-  vector<int> size = file->getSize(name);
+  const vector<int> &size = getSize(name);
   
   switch(size.size()) {
   case 0: {
@@ -179,7 +202,7 @@ bool GridFile::get(Mesh *m, Field2D &var,   const string &name, BoutReal def) {
   ASSERT1((m->LocalNy - (m->yend - m->ystart + 1)) % 2 == 0);
 
   ///Global (x,y) dimensions of field
-  const vector<int> field_dimensions = file->getSize(name);
+  const vector<int> &field_dimensions = size;
 
   // Number of points to read.
   int nx_to_read = -1;
@@ -209,11 +232,14 @@ bool GridFile::get(Mesh *m, Field2D &var,   const string &name, BoutReal def) {
                 "nor ny-2*myg = %i ", name.c_str(), field_dimensions[1], m->GlobalNy, m->GlobalNy-2*myg);
   }
 
-  ///Now read data from file
-  for(int x=xs;x < xs+nx_to_read; x++) {
-    file->setGlobalOrigin(x,ys,0);
-    if (!file->read(&var(x-xs+xd, yd), name, 1, ny_to_read) ) {
-      throw BoutException("Could not fetch data for '%s'", name.c_str());
+  ///Now read data from file in a single block
+  Array<BoutReal> data(nx_to_read * ny_to_read);
+  if (!readBlock(name, xs, ys, 0, nx_to_read, ny_to_read, 0, std::begin(data))) {
+    throw BoutException("Could not fetch data for '%s'", name.c_str());
+  }
+  for (int x = 0; x < nx_to_read; x++) {
+    for (int y = 0; y < ny_to_read; y++) {
+      var(x + xd, y + yd) = data[x * ny_to_read + y];
     }
   }
 
@@ -227,7 +253,6 @@ bool GridFile::get(Mesh *m, Field2D &var,   const string &name, BoutReal def) {
         var(x, y) = var(x, m->yend);
     }
   }
-  file->setGlobalOrigin();
 
   return true;
 }
@@ -249,7 +274,7 @@ bool GridFile::get(Mesh *m, Field3D &var,   const string &name, BoutReal def) {
 
   // Check the size of the variable in the file
   
-  vector<int> size = file->getSize(name);
+  const vector<int> &size = getSize(name);
   switch(size.size()) {
   case 0: {
     // Variable not found
@@ -371,6 +396,95 @@ bool GridFile::get(Mesh *UNUSED(m), vector<BoutReal> &var, const string &name,
 /////////////////////////////////////////////////////////////
 // Private routines
 
+const vector<int> &GridFile::getSize(const string &name) {
+  auto it = var_sizes.find(name);
+  if (it == var_sizes.end()) {
+    it = var_sizes.emplace(name, file->getSize(name)).first;
+  }
+  return it->second;
+}
+
+bool GridFile::readBlock(const string &name, int x0, int y0, int z0, int nx, int ny,
+                         int nz, BoutReal *data) {
+  if (node_comm == MPI_COMM_NULL) {
+    // Every processor reads its own block
+    file->setGlobalOrigin(x0, y0, z0);
+    bool success = file->read(data, name, nx, ny, nz);
+    file->setGlobalOrigin();
+    return success;
+  }
+
+#if MPI_VERSION >= 3
+  int node_rank, node_size;
+  MPI_Comm_rank(node_comm, &node_rank);
+  MPI_Comm_size(node_comm, &node_size);
+
+  // Find the block needed by each processor on this node
+  int request[6] = {x0, y0, z0, nx, ny, nz};
+  vector<int> requests(6 * node_size);
+  MPI_Allgather(request, 6, MPI_INT, requests.data(), 6, MPI_INT, node_comm);
+
+  // Bounding box of all the requests
+  int bx0 = x0, by0 = y0, bz0 = z0;
+  int bx1 = x0 + nx, by1 = y0 + ny, bz1 = z0 + nz;
+  for (int p = 0; p < node_size; p++) {
+    const int *r = &requests[6 * p];
+    bx0 = std::min(bx0, r[0]);
+    by0 = std::min(by0, r[1]);
+    bz0 = std::min(bz0, r[2]);
+    bx1 = std::max(bx1, r[0] + r[3]);
+    by1 = std::max(by1, r[1] + r[4]);
+    bz1 = std::max(bz1, r[2] + r[5]);
+  }
+  int bnx = bx1 - bx0, bny = by1 - by0, bnz = bz1 - bz0;
+
+  // Only the first processor on the node allocates memory
+  MPI_Aint winsize = 0;
+  if (node_rank == 0) {
+    winsize = static_cast<MPI_Aint>(bnx) * bny * std::max(bnz, 1) * sizeof(BoutReal);
+  }
+  BoutReal *shared;
+  MPI_Win win;
+  MPI_Win_allocate_shared(winsize, sizeof(BoutReal), MPI_INFO_NULL, node_comm, &shared,
+                          &win);
+
+  MPI_Win_fence(0, win);
+  int success = 1;
+  if (node_rank == 0) {
+    file->setGlobalOrigin(bx0, by0, bz0);
+    success = file->read(shared, name, bnx, bny, bnz) ? 1 : 0;
+    file->setGlobalOrigin();
+  } else {
+    MPI_Aint size;
+    int disp_unit;
+    MPI_Win_shared_query(win, 0, &size, &disp_unit, &shared);
+  }
+  MPI_Bcast(&success, 1, MPI_INT, 0, node_comm);
+  MPI_Win_fence(0, win);
+
+  if (success) {
+    // Copy this processor's block out of the shared buffer
+    const int lz = std::max(nz, 1);
+    const int blz = std::max(bnz, 1);
+    for (int x = 0; x < nx; x++) {
+      for (int y = 0; y < ny; y++) {
+        const BoutReal *src =
+            shared + ((x + x0 - bx0) * bny + (y + y0 - by0)) * blz + (z0 - bz0);
+        std::copy(src, src + lz, data + (x * ny + y) * lz);
+      }
+    }
+  }
+
+  // Make sure everyone has finished with the buffer before freeing
+  MPI_Win_fence(0, win);
+  MPI_Win_free(&win);
+
+  return success == 1;
+#else
+  return false;
+#endif
+}
+
 /// Reads in a portion of the X-Y domain
 /*
   Data stored as toroidal FFTs in BoutReal space at each X-Y point.
@@ -391,7 +505,7 @@ bool GridFile::readgrid_3dvar_fft(Mesh *m, const string &name,
   }
   
   /// Check the size of the data
-  vector<int> size = file->getSize(name);
+  const vector<int> &size = getSize(name);
   
   if (size.size() != 3) {
     output_warn.write("\tWARNING: Number of dimensions of %s incorrect\n", name.c_str());
@@ -430,20 +544,17 @@ bool GridFile::readgrid_3dvar_fft(Mesh *m, const string &name,
 
   /// Data for FFT. Only positive frequencies
   Array<dcomplex> fdata(ncz / 2 + 1);
-  Array<BoutReal> zdata(size[2]);
 
-  for(int jx=xge;jx<xlt;jx++) {
-    // Set the global X index
+  /// Read the whole block of data at once
+  Array<BoutReal> data((xlt - xge) * ysize * size[2]);
+  if (!readBlock(name, xge + m->OffsetX, yread, 0, xlt - xge, ysize, size[2],
+                 std::begin(data))) {
+    return true;
+  }
 
+  for(int jx=xge;jx<xlt;jx++) {
     for(int jy=0; jy < ysize; jy++) {
-      /// Read data
-
-      int yind = yread + jy; // Global location to read from
-
-      file->setGlobalOrigin(jx + m->OffsetX, yind);
-      if (!file->read(std::begin(zdata), name, 1, 1, size[2])) {
-        return true;
-      }
+      const BoutReal *zdata = &data[((jx - xge) * ysize + jy) * size[2]];
 
       /// Load into dcomplex array
 
@@ -463,8 +574,6 @@ bool GridFile::readgrid_3dvar_fft(Mesh *m, const string &name,
     }
   }
 
-  file->setGlobalOrigin();
-  
   return true;
 }
 
@@ -481,28 +590,26 @@ bool GridFile::readgrid_3dvar_real(Mesh *m, const string &name,
   }
   
   /// Check the size of the data
-  vector<int> size = file->getSize(name);
+  const vector<int> &size = getSize(name);
   
   if (size.size() != 3) {
     output_warn.write("\tWARNING: Number of dimensions of %s incorrect\n", name.c_str());
     return false;
   }
-  
+
+  /// Read the whole block of data at once
+  Array<BoutReal> data((xlt - xge) * ysize * size[2]);
+  if (!readBlock(name, xge + m->OffsetX, yread, 0, xlt - xge, ysize, size[2],
+                 std::begin(data))) {
+    return false;
+  }
+
   for(int jx=xge;jx<xlt;jx++) {
-    // Set the global X index
-    
     for(int jy=0; jy < ysize; jy++) {
-      /// Read data
-      
-      int yind = yread + jy; // Global location to read from
-      
-      file->setGlobalOrigin(jx + m->OffsetX, yind);
-      if (!file->read(&var(jx,ydest+jy,0), name, 1, 1, size[2])) {
-        return false;
-      }
+      const BoutReal *zdata = &data[((jx - xge) * ysize + jy) * size[2]];
+      std::copy(zdata, zdata + size[2], &var(jx, ydest + jy, 0));
     }
   }
-  file->setGlobalOrigin();
   
   return true;
 }
@@ -38,8 +38,10 @@
 #include <interpolation.hxx>
 #include <unused.hxx>
 
+#include <algorithm>
 #include <math.h>
 #include <stdlib.h>
+#include <vector>
 
 /*******************************************************************************
 * Grad_par
@@ -1003,6 +1005,147 @@ const Field3D bracket(const Field2D &f, const Field3D &g, BRACKET_METHOD method,
   return result;
 }
 
+namespace {
+/// Arakawa bracket [f, g] for each field in \p gs, putting the result in
+/// the corresponding element of \p results, which must be allocated.
+///
+/// Each (y, block of x) is handled by one thread, marching in X. Z
+/// differences of f, and the diagonal differences between neighbouring
+/// X columns, are kept in a rolling window so that each is only
+/// calculated once. Lines are padded with one periodic point at each end
+/// so that the loops over Z have no branches and can be vectorised.
+/// Differences of f are shared between all the fields in \p gs
+void arakawaBracket(const Field3D &f, const std::vector<const Field3D *> &gs,
+                    const std::vector<Field3D *> &results, Coordinates *metric) {
+  Mesh *mesh = f.getMesh();
+  const int ncz = mesh->LocalNz;
+  const int nzp = ncz + 2; // Padded length
+  const int ng = gs.size();
+  const BoutReal partialFactor = 1.0 / (12 * metric->dz);
+
+  // Number of X columns handled in a block by one thread
+  const int xblock = 16;
+  const int nxint = mesh->xend - mesh->xstart + 1;
+  const int nxblocks = (nxint + xblock - 1) / xblock;
+
+  BOUT_OMP(parallel) {
+    // Rolling window of padded lines. Index k is z = k - 1
+    std::vector<BoutReal> storage((11 + 3 * ng) * nzp);
+    auto line = [&](int i) { return &storage[i * nzp]; };
+
+    BoutReal *F[3] = {line(0), line(1), line(2)};   ///< Copies of f in x-1, x, x+1
+    BoutReal *dzF[3] = {line(3), line(4), line(5)}; ///< F(z+1) - F(z-1) in x-1, x, x+1
+    BoutReal *D1[2] = {line(6), line(7)};           ///< F_c(z+1) - F_c+1(z), c = x-1, x
+    BoutReal *D2[2] = {line(8), line(9)};           ///< F_c+1(z+1) - F_c(z), c = x-1, x
+    BoutReal *dxF = line(10);                       ///< F_x+1(z) - F_x-1(z)
+    std::vector<BoutReal *> G(3 * ng);              ///< Copies of g in x-1, x, x+1
+    for (int i = 0; i < 3 * ng; i++) {
+      G[i] = line(11 + i);
+    }
+
+    // Padded periodic copy of a Z line
+    auto pad = [&](const BoutReal *in, BoutReal *out) {
+      out[0] = in[ncz - 1];
+      std::copy(in, in + ncz, out + 1);
+      out[ncz + 1] = in[0];
+    };
+    auto wrap = [&](BoutReal *out) {
+      out[0] = out[ncz];
+      out[ncz + 1] = out[1];
+    };
+    // Z differences of column c of f
+    auto columnF = [&](const BoutReal *Fc, BoutReal *dz) {
+      BOUT_OMP(simd)
+      for (int k = 1; k <= ncz; k++) {
+        dz[k] = Fc[k + 1] - Fc[k - 1];
+      }
+    };
+    // Diagonal differences between columns c and c+1 of f
+    auto pairF = [&](const BoutReal *Fc, const BoutReal *Fcp, BoutReal *d1, BoutReal *d2) {
+      BOUT_OMP(simd)
+      for (int k = 1; k <= ncz; k++) {
+        d1[k] = Fc[k + 1] - Fcp[k];
+        d2[k] = Fcp[k + 1] - Fc[k];
+      }
+      wrap(d1);
+      wrap(d2);
+    };
+
+    BOUT_OMP(for collapse(2) schedule(static))
+    for (int jy = mesh->ystart; jy <= mesh->yend; jy++) {
+      for (int block = 0; block < nxblocks; block++) {
+        const int xs = mesh->xstart + block * xblock;
+        const int xe = std::min(xs + xblock - 1, mesh->xend);
+
+        // Start the window with columns xs-1 and xs
+        pad(f(xs - 1, jy), F[0]);
+        pad(f(xs, jy), F[1]);
+        columnF(F[0], dzF[0]);
+        columnF(F[1], dzF[1]);
+        pairF(F[0], F[1], D1[0], D2[0]);
+        for (int i = 0; i < ng; i++) {
+          pad((*gs[i])(xs - 1, jy), G[3 * i]);
+          pad((*gs[i])(xs, jy), G[3 * i + 1]);
+        }
+
+        for (int jx = xs; jx <= xe; jx++) {
+          const BoutReal spacingFactor = partialFactor / metric->dx(jx, jy);
+
+          // Add column x+1 to the window
+          pad(f(jx + 1, jy), F[2]);
+          columnF(F[2], dzF[2]);
+          pairF(F[1], F[2], D1[1], D2[1]);
+          BOUT_OMP(simd)
+          for (int k = 1; k <= ncz; k++) {
+            dxF[k] = F[2][k] - F[0][k];
+          }
+          wrap(dxF);
+
+          const BoutReal *dzFm = dzF[0], *dzFx = dzF[1], *dzFp = dzF[2];
+          const BoutReal *D1m = D1[0], *D1x = D1[1];
+          const BoutReal *D2m = D2[0], *D2x = D2[1];
+
+          for (int i = 0; i < ng; i++) {
+            pad((*gs[i])(jx + 1, jy), G[3 * i + 2]);
+            const BoutReal *Gxm = G[3 * i], *Gx = G[3 * i + 1], *Gxp = G[3 * i + 2];
+            BoutReal *res = (*results[i])(jx, jy);
+
+            BOUT_OMP(simd)
+            for (int k = 1; k <= ncz; k++) {
+              // J++ = DDZ(f)*DDX(g) - DDX(f)*DDZ(g)
+              const BoutReal Jpp =
+                  (dzFx[k] * (Gxp[k] - Gxm[k]) - dxF[k] * (Gx[k + 1] - Gx[k - 1]));
+
+              // J+x
+              const BoutReal Jpx = (Gxp[k] * dzFp[k] - Gxm[k] * dzFm[k] -
+                                    Gx[k + 1] * dxF[k + 1] + Gx[k - 1] * dxF[k - 1]);
+
+              // Jx+
+              const BoutReal Jxp = (Gxp[k + 1] * D1x[k] - Gxm[k - 1] * D1m[k - 1] -
+                                    Gxm[k + 1] * D2m[k] + Gxp[k - 1] * D2x[k - 1]);
+
+              res[k - 1] = (Jpp + Jpx + Jxp) * spacingFactor;
+            }
+
+            // Move the window of g along in X
+            std::swap(G[3 * i], G[3 * i + 1]);
+            std::swap(G[3 * i + 1], G[3 * i + 2]);
+          }
+
+          // Move the window of f along in X
+          std::swap(F[0], F[1]);
+          std::swap(F[1], F[2]);
+          std::swap(dzF[0], dzF[1]);
+          std::swap(dzF[1], dzF[2]);
+          std::swap(D1[0], D1[1]);
+          std::swap(D2[0], D2[1]);
+        }
+      }
+    }
+  }
+}
+} // namespace
+
 const Field3D bracket(const Field3D &f, const Field3D &g, BRACKET_METHOD method,
                       CELL_LOC outloc, Solver *solver) {
   TRACE("Field3D, Field3D");
@@ -1129,93 +1272,8 @@ const Field3D bracket(const Field3D &f, const Field3D &g, BRACKET_METHOD method,
     
     result.allocate();
     result.setLocation(outloc);
-    
-    const int ncz = mesh->LocalNz;
-    const BoutReal partialFactor = 1.0/(12 * metric->dz);
-
-    // We need to discard const qualifier in order to manipulate
-    // storage array directly
-    Field3D f_temp = f;
-    Field3D g_temp = g;
-
-    BOUT_FOR(j2D, mesh->getRegion2D("RGN_NOBNDRY")) {
-      const BoutReal spacingFactor = partialFactor / metric->dx[j2D];
-      const int jy = j2D.y(), jx = j2D.x();
-      const int xm = jx - 1, xp = jx + 1;
-
-      const auto Fxm = f_temp(xm, jy), Fx = f_temp(jx, jy), Fxp = f_temp(xp, jy);
-      const auto Gxm = g_temp(xm, jy), Gx = g_temp(jx, jy), Gxp = g_temp(xp, jy);
-
-      // Here we split the loop over z into three parts; the first value, the middle block
-      // and the last value
-      // this is to allow the loop used in the middle block to vectorise.
-
-      {
-        const int jz = 0;
-        const int jzp = 1;
-        const int jzm = ncz - 1;
-
-        // J++ = DDZ(f)*DDX(g) - DDX(f)*DDZ(g)
-        const BoutReal Jpp = ((Fx[jzp] - Fx[jzm]) * (Gxp[jz] - Gxm[jz]) -
-                              (Fxp[jz] - Fxm[jz]) * (Gx[jzp] - Gx[jzm]));
-
-        // J+x
-        const BoutReal Jpx =
-            (Gxp[jz] * (Fxp[jzp] - Fxp[jzm]) - Gxm[jz] * (Fxm[jzp] - Fxm[jzm]) -
-             Gx[jzp] * (Fxp[jzp] - Fxm[jzp]) + Gx[jzm] * (Fxp[jzm] - Fxm[jzm]));
-
-        // Jx+
-        const BoutReal Jxp =
-            (Gxp[jzp] * (Fx[jzp] - Fxp[jz]) - Gxm[jzm] * (Fxm[jz] - Fx[jzm]) -
-             Gxm[jzp] * (Fx[jzp] - Fxm[jz]) + Gxp[jzm] * (Fxp[jz] - Fx[jzm]));
-
-        result(jx, jy, jz) = (Jpp + Jpx + Jxp) * spacingFactor;
-      }
-
-      for (int jz = 1; jz < ncz - 1; jz++) {
-        const int jzp = jz + 1;
-        const int jzm = jz - 1;
-
-        // J++ = DDZ(f)*DDX(g) - DDX(f)*DDZ(g)
-        const BoutReal Jpp = ((Fx[jzp] - Fx[jzm]) * (Gxp[jz] - Gxm[jz]) -
-                              (Fxp[jz] - Fxm[jz]) * (Gx[jzp] - Gx[jzm]));
-
-        // J+x
-        const BoutReal Jpx =
-            (Gxp[jz] * (Fxp[jzp] - Fxp[jzm]) - Gxm[jz] * (Fxm[jzp] - Fxm[jzm]) -
-             Gx[jzp] * (Fxp[jzp] - Fxm[jzp]) + Gx[jzm] * (Fxp[jzm] - Fxm[jzm]));
-
-        // Jx+
-        const BoutReal Jxp =
-            (Gxp[jzp] * (Fx[jzp] - Fxp[jz]) - Gxm[jzm] * (Fxm[jz] - Fx[jzm]) -
-             Gxm[jzp] * (Fx[jzp] - Fxm[jz]) + Gxp[jzm] * (Fxp[jz] - Fx[jzm]));
-
-        result(jx, jy, jz) = (Jpp + Jpx + Jxp) * spacingFactor;
-      }
-
-      {
-        const int jz = ncz - 1;
-        const int jzp = 0;
-        const int jzm = ncz - 2;
-
-        // J++ = DDZ(f)*DDX(g) - DDX(f)*DDZ(g)
-        const BoutReal Jpp = ((Fx[jzp] - Fx[jzm]) * (Gxp[jz] - Gxm[jz]) -
-                              (Fxp[jz] - Fxm[jz]) * (Gx[jzp] - Gx[jzm]));
-
-        // J+x
-        const BoutReal Jpx =
-            (Gxp[jz] * (Fxp[jzp] - Fxp[jzm]) - Gxm[jz] * (Fxm[jzp] - Fxm[jzm]) -
-             Gx[jzp] * (Fxp[jzp] - Fxm[jzp]) + Gx[jzm] * (Fxp[jzm] - Fxm[jzm]));
-
-        // Jx+
-        const BoutReal Jxp =
-            (Gxp[jzp] * (Fx[jzp] - Fxp[jz]) - Gxm[jzm] * (Fxm[jz] - Fx[jzm]) -
-             Gxm[jzp] * (Fx[jzp] - Fxm[jz]) + Gxp[jzm] * (Fxp[jz] - Fx[jzm]));
-
-        result(jx, jy, jz) = (Jpp + Jpx + Jxp) * spacingFactor;
-      }
-    }
 
+    arakawaBracket(f, {&g}, {&result}, metric);
     break;
   }
   case BRACKET_ARAKAWA_OLD: {
@@ -1283,3 +1341,45 @@ const Field3D bracket(const Field3D &f, const Field3D &g, BRACKET_METHOD method,
   
   return result;
 }
+
+std::vector<Field3D> bracket(const Field3D &f, const std::vector<Field3D> &gs,
+                             BRACKET_METHOD method, CELL_LOC outloc, Solver *solver) {
+  TRACE("bracket(Field3D, vector<Field3D>)");
+
+  std::vector<Field3D> results;
+  results.reserve(gs.size());
+
+  Mesh *mesh = f.getMesh();
+  if ((method != BRACKET_ARAKAWA) || gs.empty() || (mesh->GlobalNx == 1) ||
+      (mesh->GlobalNz == 1)) {
+    // Nothing to share between fields
+    for (const auto &g : gs) {
+      results.push_back(bracket(f, g, method, outloc, solver));
+    }
+    return results;
+  }
+
+  if (outloc == CELL_DEFAULT) {
+    outloc = gs.front().getLocation();
+  }
+
+  std::vector<const Field3D *> g_ptrs;
+  for (const auto &g : gs) {
+    ASSERT1(f.getMesh() == g.getMesh());
+    ASSERT1(f.getLocation() == g.getLocation() && outloc == f.getLocation());
+    g_ptrs.push_back(&g);
+
+    results.emplace_back(mesh);
+    results.back().allocate();
+    results.back().setLocation(outloc);
+  }
+
+  std::vector<Field3D *> result_ptrs;
+  for (auto &result : results) {
+    result_ptrs.push_back(&result);
+  }
+
+  arakawaBracket(f, g_ptrs, result_ptrs, f.getCoordinates(outloc));
+
+  return results;
+}
@@ -14,38 +14,53 @@ namespace FV {
 
     Mesh *mesh = a.getMesh();
 
-    Field3D result(mesh);
-    result = 0.0;
-
     Coordinates *coord = f.getCoordinates();
+
+    const int ncz = mesh->LocalNz;
+    const auto &region = mesh->getRegion2D("RGN_NOBNDRY");
     
     // Flux in x
-  
-    int xs = mesh->xstart-1;
-    int xe = mesh->xend;
-  
-    /*
-      if(mesh->firstX())
-      xs += 1;
-    */
-    /*
-      if(mesh->lastX())
-      xe -= 1;
-    */
-
-    for(int i=xs;i<=xe;i++)
-      for(int j=mesh->ystart;j<=mesh->yend;j++) {
-	for(int k=0;k<mesh->LocalNz;k++) {
-	  // Calculate flux from i to i+1
-	
-	  BoutReal fout = (coord->J(i,j)*a(i,j,k)*coord->g11(i,j) + coord->J(i+1,j)*a(i+1,j,k)*coord->g11(i+1,j)) *
-	    (f(i+1,j,k) - f(i,j,k))/(coord->dx(i,j) + coord->dx(i+1,j));
-                     
-	  result(i,j,k) += fout / (coord->dx(i,j)*coord->J(i,j));
-	  result(i+1,j,k) -= fout / (coord->dx(i+1,j)*coord->J(i+1,j));
-	}
+
+    // Flux from i to i.xp() at each z
+    auto x_flux = [&](const Ind2D &i, BoutReal *flux) {
+      const int x = i.x(), y = i.y();
+      const auto ip = i.xp();
+
+      const BoutReal *ac = a(x, y), *ap = a(x + 1, y);
+      const BoutReal *fc = f(x, y), *fp = f(x + 1, y);
+
+      const BoutReal Jg11c = coord->J[i] * coord->g11[i];
+      const BoutReal Jg11p = coord->J[ip] * coord->g11[ip];
+      const BoutReal dxsum = coord->dx[i] + coord->dx[ip];
+
+      for (int k = 0; k < ncz; k++) {
+        flux[k] = (Jg11c * ac[k] + Jg11p * ap[k]) * (fp[k] - fc[k]) / dxsum;
       }
-    
+    };
+
+    // Calculate each face flux once. The inner face of the
+    // domain is calculated in the guard cell
+    Field3D xflux(mesh);
+    xflux.allocate();
+
+    BOUT_FOR(i, region) {
+      x_flux(i, xflux(i.x(), i.y()));
+      if (i.x() == mesh->xstart) {
+        x_flux(i.xm(), xflux(i.x() - 1, i.y()));
+      }
+    }
+
+    Field3D result(0.0, mesh);
+
+    BOUT_FOR(i, region) {
+      const BoutReal *up = xflux(i.x(), i.y()), *down = xflux(i.x() - 1, i.y());
+      BoutReal *r = result(i.x(), i.y());
+
+      const BoutReal dxJ = coord->dx[i] * coord->J[i];
+      for (int k = 0; k < ncz; k++) {
+        r[k] = (up[k] - down[k]) / dxJ;
+      }
+    }
 
     // Y and Z fluxes require Y derivatives
     
@@ -78,82 +93,109 @@ namespace FV {
       aup = adown = ac = mesh->toFieldAligned(a);
     }
 
+    // Z flux
+    // Easier since all metrics constant in Z
+
+    // Flux between k and k+1
+    auto z_flux = [&](const Ind2D &i, BoutReal *flux) {
+      const int x = i.x(), y = i.y();
+      const auto iyp = i.yp(), iym = i.ym();
+
+      const BoutReal *a_c = ac(x, y), *f_c = fc(x, y);
+      const BoutReal *f_up = fup(x, y + 1), *f_down = fdown(x, y - 1);
+
+      // Coefficient in front of df/dy term
+      BoutReal coef = coord->g_23[i] /
+                      (coord->dy[iyp] + 2. * coord->dy[i] + coord->dy[iym]) /
+                      SQ(coord->J[i] * coord->Bxy[i]);
+
+      for (int k = 0; k < ncz; k++) {
+        int kp = (k + 1) % ncz;
+
+        flux[k] = 0.5 * (a_c[k] + a_c[kp]) * coord->g33[i] *
+                  (
+                      // df/dz
+                      (f_c[kp] - f_c[k]) / coord->dz
+
+                      // - g_yz * df/dy / SQ(J*B)
+                      - coef * (f_up[k] + f_up[kp] - f_down[k] - f_down[kp]));
+      }
+    };
+
     // Y flux
+    // The values along the magnetic field are different in each
+    // direction, so the flux through each Y face is calculated
+    // from both sides
+    auto y_flux = [&](const Ind2D &i, BoutReal *result) {
+      const int x = i.x(), y = i.y();
+      const auto iyp = i.yp(), iym = i.ym();
 
-    for (int i = mesh->xstart; i <= mesh->xend; i++) {
-      for (int j = mesh->ystart - 1; j <= mesh->yend; j++) {
+      const BoutReal *a_c = ac(x, y), *f_c = fc(x, y);
+      const BoutReal *a_up = aup(x, y + 1), *f_up = fup(x, y + 1);
+      const BoutReal *a_down = adown(x, y - 1), *f_down = fdown(x, y - 1);
 
-        BoutReal coef =
-            0.5 * (coord->g_23(i, j) / SQ(coord->J(i, j) * coord->Bxy(i, j)) +
-                   coord->g_23(i, j + 1) / SQ(coord->J(i, j + 1) * coord->Bxy(i, j + 1)));
+      const BoutReal coef_c = coord->g_23[i] / SQ(coord->J[i] * coord->Bxy[i]);
 
-        for (int k = 0; k < mesh->LocalNz; k++) {
-          // Calculate flux between j and j+1
-          int kp = (k + 1) % (mesh->LocalNz);
-          int km = (k - 1 + (mesh->LocalNz)) % (mesh->LocalNz);
+      // Between j and j+1
+      BoutReal coef_u =
+          0.5 * (coef_c + coord->g_23[iyp] / SQ(coord->J[iyp] * coord->Bxy[iyp]));
+      BoutReal dy_u = coord->dy[iyp] + coord->dy[i];
 
-          // Calculate Z derivative at y boundary
-          BoutReal dfdz = 0.25 * (fc(i, j, kp) - fc(i, j, km) + fup(i, j + 1, kp) -
-                                  fup(i, j + 1, km)) /
-                          coord->dz;
+      // Between j and j-1
+      BoutReal coef_d =
+          0.5 * (coef_c + coord->g_23[iym] / SQ(coord->J[iym] * coord->Bxy[iym]));
+      BoutReal dy_d = coord->dy[i] + coord->dy[iym];
 
-          // Y derivative
-          BoutReal dfdy = 2. * (fup(i, j + 1, k) - fc(i, j, k)) /
-                          (coord->dy(i, j + 1) + coord->dy(i, j));
+      const BoutReal Jg23c = coord->J[i] * coord->g23[i];
+      const BoutReal Jg23p = coord->J[iyp] * coord->g23[iyp];
+      const BoutReal Jg23m = coord->J[iym] * coord->g23[iym];
+      const BoutReal dyJ = coord->dy[i] * coord->J[i];
 
-          BoutReal fout = 0.5 *
-                          (coord->J(i, j) * ac(i, j, k) * coord->g23(i, j) +
-                           coord->J(i, j + 1) * aup(i, j + 1, k) * coord->g23(i, j + 1)) *
-                          (dfdz - coef * dfdy);
+      for (int k = 0; k < ncz; k++) {
+        int kp = (k + 1) % ncz;
+        int km = (k - 1 + ncz) % ncz;
 
-          yzresult(i, j, k) = fout / (coord->dy(i, j) * coord->J(i, j));
+        // Calculate flux between j and j+1
 
-          // Calculate flux between j and j-1
-          dfdz = 0.25 * (fc(i, j, kp) - fc(i, j, km) + fdown(i, j - 1, kp) -
-                         fdown(i, j - 1, km)) /
-                 coord->dz;
+        // Calculate Z derivative at y boundary
+        BoutReal dfdz = 0.25 * (f_c[kp] - f_c[km] + f_up[kp] - f_up[km]) / coord->dz;
 
-          dfdy = 2. * (fc(i, j, k) - fdown(i, j - 1, k)) /
-                 (coord->dy(i, j) + coord->dy(i, j - 1));
+        // Y derivative
+        BoutReal dfdy = 2. * (f_up[k] - f_c[k]) / dy_u;
 
-          fout = 0.5 * (coord->J(i, j) * ac(i, j, k) * coord->g23(i, j) +
-                        coord->J(i, j - 1) * aup(i, j + 1, k) * coord->g23(i, j + 1)) *
-                 (dfdz - coef * dfdy);
+        BoutReal fout = 0.5 * (Jg23c * a_c[k] + Jg23p * a_up[k]) * (dfdz - coef_u * dfdy);
 
-          yzresult(i, j, k) -= fout / (coord->dy(i, j) * coord->J(i, j));
-        }
+        result[k] = fout / dyJ;
+
+        // Calculate flux between j and j-1
+        dfdz = 0.25 * (f_c[kp] - f_c[km] + f_down[kp] - f_down[km]) / coord->dz;
+
+        dfdy = 2. * (f_c[k] - f_down[k]) / dy_d;
+
+        fout = 0.5 * (Jg23c * a_c[k] + Jg23m * a_down[k]) * (dfdz - coef_d * dfdy);
+
+        result[k] -= fout / dyJ;
       }
+    };
+
+    Field3D zflux(mesh);
+    zflux.allocate();
+
+    BOUT_FOR(i, region) {
+      z_flux(i, zflux(i.x(), i.y()));
     }
 
-    // Z flux
-    // Easier since all metrics constant in Z
+    BOUT_FOR(i, region) {
+      BoutReal *r = yzresult(i.x(), i.y());
+      y_flux(i, r);
 
-    for (int i = mesh->xstart; i <= mesh->xend; i++) {
-      for (int j = mesh->ystart; j <= mesh->yend; j++) {
-        // Coefficient in front of df/dy term
-        BoutReal coef = coord->g_23(i, j) / (coord->dy(i, j + 1) + 2. * coord->dy(i, j) +
-                                             coord->dy(i, j - 1)) /
-                        SQ(coord->J(i, j) * coord->Bxy(i, j));
-
-        for (int k = 0; k < mesh->LocalNz; k++) {
-          // Calculate flux between k and k+1
-          int kp = (k + 1) % mesh->LocalNz;
-
-          BoutReal fout = 0.5 * (ac(i, j, k) + ac(i, j, kp)) * coord->g33(i, j) *
-                          (
-                              // df/dz
-                              (fc(i, j, kp) - fc(i, j, k)) / coord->dz
-
-                              // - g_yz * df/dy / SQ(J*B)
-                              -
-                              coef * (fup(i, j + 1, k) + fup(i, j + 1, kp) -
-                                      fdown(i, j - 1, k) - fdown(i, j - 1, kp)));
-
-          yzresult(i, j, k) += fout / coord->dz;
-          yzresult(i, j, kp) -= fout / coord->dz;
-        }
+      // Z fluxes through both faces
+      const BoutReal *fz = zflux(i.x(), i.y());
+      for (int k = 0; k < ncz; k++) {
+        r[k] += (fz[k] - fz[(k - 1 + ncz) % ncz]) / coord->dz;
       }
     }
+
     // Check if we need to transform back
     if (f.hasYupYdown() && a.hasYupYdown()) {
       result += yzresult;
@@ -197,37 +239,54 @@ namespace FV {
     
     Coordinates *coord = fin.getCoordinates();
     
-    BOUT_FOR(i, mesh->getRegion3D("RGN_NOBNDRY")) {
-      // Calculate flux at upper surface
-      
+    const int ncz = mesh->LocalNz;
+
+    BOUT_FOR(i, mesh->getRegion2D("RGN_NOBNDRY")) {
+      const int x = i.x(), y = i.y();
       const auto iyp = i.yp();
       const auto iym = i.ym();
 
-      if (bndry_flux || !mesh->lastY() || (i.y() != mesh->yend)) {
+      const BoutReal *Kc = K(x, y), *fc = f(x, y);
+      BoutReal *r = result(x, y);
+
+      const BoutReal dyJ = coord->dy[i] * coord->J[i];
+
+      // Calculate flux at upper surface
+      if (bndry_flux || !mesh->lastY() || (y != mesh->yend)) {
+        const BoutReal *K_up = Kup(x, y + 1), *f_up = fup(x, y + 1);
 
-        BoutReal c = 0.5*(K[i] + Kup[iyp]); // K at the upper boundary
         BoutReal J = 0.5*(coord->J[i] + coord->J[iyp]); // Jacobian at boundary
         BoutReal g_22 = 0.5*(coord->g_22[i] + coord->g_22[iyp]);
-        
-        BoutReal gradient = 2.*(fup[iyp] - f[i]) / (coord->dy[i] + coord->dy[iyp]);
-        
-        BoutReal flux = c * J * gradient / g_22;
-            
-        result[i] += flux / (coord->dy[i] * coord->J[i]);
+        BoutReal dy = coord->dy[i] + coord->dy[iyp];
+
+        for (int k = 0; k < ncz; k++) {
+          BoutReal c = 0.5*(Kc[k] + K_up[k]); // K at the upper boundary
+
+          BoutReal gradient = 2.*(f_up[k] - fc[k]) / dy;
+
+          BoutReal flux = c * J * gradient / g_22;
+
+          r[k] += flux / dyJ;
+        }
       }
       
       // Calculate flux at lower surface
-      if (bndry_flux || !mesh->firstY() || (i.y() != mesh->ystart)) {
-        BoutReal c = 0.5*(K[i] + Kdown[iym]); // K at the lower boundary
+      if (bndry_flux || !mesh->firstY() || (y != mesh->ystart)) {
+        const BoutReal *K_down = Kdown(x, y - 1), *f_down = fdown(x, y - 1);
+
         BoutReal J = 0.5*(coord->J[i] + coord->J[iym]); // Jacobian at boundary
-        
         BoutReal g_22 = 0.5*(coord->g_22[i] + coord->g_22[iym]);
-        
-        BoutReal gradient = 2.*(f[i] - fdown[iym]) / (coord->dy[i] + coord->dy[iym]);
-        
-        BoutReal flux = c * J * gradient / g_22;
-        
-        result[i] -= flux / (coord->dy[i] * coord->J[i]);
+        BoutReal dy = coord->dy[i] + coord->dy[iym];
+
+        for (int k = 0; k < ncz; k++) {
+          BoutReal c = 0.5*(Kc[k] + K_down[k]); // K at the lower boundary
+
+          BoutReal gradient = 2.*(fc[k] - f_down[k]) / dy;
+
+          BoutReal flux = c * J * gradient / g_22;
+
+          r[k] -= flux / dyJ;
+        }
       }
     }
     
@@ -242,7 +301,9 @@ namespace FV {
   const Field3D D4DY4(const Field3D &d_in, const Field3D &f_in) {
     ASSERT2(d_in.getLocation() == f_in.getLocation());
 
-    Field3D result = 0.0;
+    Mesh *mesh = f_in.getMesh();
+
+    Field3D result(0.0, mesh);
     result.setLocation(f_in.getLocation());
     
     Coordinates *coord = f_in.getCoordinates();
@@ -250,149 +311,188 @@ namespace FV {
     // Convert to field aligned coordinates
     Field3D d = mesh->toFieldAligned(d_in);
     Field3D f = mesh->toFieldAligned(f_in);
-    
-    for(int i=mesh->xstart;i<=mesh->xend;i++)
-      for(int j=mesh->ystart;j<=mesh->yend;j++) {
-        BoutReal dy3 = SQ(coord->dy(i,j))*coord->dy(i,j);
-        for(int k=0;k<mesh->LocalNz;k++) {
-          
-          // 3rd derivative at right boundary
-          
-          BoutReal d3fdx3 = (
-                             f(i,j+2,k)
-                             - 3.*f(i,j+1,k)
-                             + 3.*f(i,j,  k)
-                             -    f(i,j-1,k)
-                             ) / dy3;
-          
-          BoutReal flux = 0.5*(d(i,j,k) + d(i,j+1,k))*(coord->J(i,j) + coord->J(i,j+1)) * d3fdx3;
-          
-          result(i,j,  k) += flux / (coord->J(i,j) * coord->dy(i,j));
-          result(i,j+1,k) -= flux / (coord->J(i,j+1) * coord->dy(i,j+1));
-          
-          if(j == mesh->ystart && (!mesh->firstY())) {
-            // Left cell boundary, no flux through boundaries
-            d3fdx3 = (
-                      f(i,j+1,k)
-                      - 3.*f(i,j,  k)
-                      + 3.*f(i,j-1,k)
-                      -    f(i,j-2,k)
-                      ) / dy3;
-            
-            flux = 0.5*(d(i,j,k) + d(i,j-1,k))*(coord->J(i,j) + coord->J(i,j-1)) * d3fdx3;
-            
-            result(i,j,  k) -= flux / (coord->J(i,j) * coord->dy(i,j));
-            result(i,j-1,k) += flux / (coord->J(i,j-1) * coord->dy(i,j-1));
+
+    const int ncz = mesh->LocalNz;
+
+    std::vector<bool> has_lower_boundary, has_upper_boundary;
+    yBoundaries(mesh, has_lower_boundary, has_upper_boundary);
+
+    // Flux through the face between i and i.yp() at each z. Faces
+    // between processors and across periodic Y boundaries use the
+    // guard cells
+    auto face_flux = [&](const Ind2D &i, BoutReal dy3, BoutReal *flux) {
+      const int x = i.x(), y = i.y();
+      const auto ip = i.yp();
+
+      if (has_upper_boundary[x] && (y == mesh->yend)) {
+        // Right cell boundary, no flux through boundaries.
+        // f(x, y + 2) may be outside the field
+        for (int k = 0; k < ncz; k++) {
+          flux[k] = 0.0;
+        }
+        return;
+      }
+
+      const BoutReal *fm = f(x, y - 1), *fc = f(x, y), *fp = f(x, y + 1),
+                     *fpp = f(x, y + 2);
+      const BoutReal *dc = d(x, y), *dp = d(x, y + 1);
+      const BoutReal Jsum = coord->J[i] + coord->J[ip];
+
+      for (int k = 0; k < ncz; k++) {
+        // 3rd derivative at the face
+        BoutReal d3fdx3 = (fpp[k] - 3. * fp[k] + 3. * fc[k] - fm[k]) / dy3;
+
+        flux[k] = 0.5 * (dc[k] + dp[k]) * Jsum * d3fdx3;
+      }
+    };
+
+    const auto &region = mesh->getRegion2D("RGN_NOBNDRY");
+
+    // Calculate each face flux once
+    Field3D flux(mesh);
+    flux.allocate();
+
+    BOUT_FOR(i, region) {
+      const int x = i.x(), y = i.y();
+      BoutReal dy3 = SQ(coord->dy[i]) * coord->dy[i];
+
+      face_flux(i, dy3, flux(x, y));
+
+      if (y == mesh->ystart) {
+        // Left cell boundary, no flux through boundaries
+        if (has_lower_boundary[x]) {
+          BoutReal *fl = flux(x, y - 1);
+          for (int k = 0; k < ncz; k++) {
+            fl[k] = 0.0;
           }
+        } else {
+          // Same dy as the cell below uses for this face
+          const auto im = i.ym();
+          face_flux(im, SQ(coord->dy[im]) * coord->dy[im], flux(x, y - 1));
         }
       }
+    }
+
+    BOUT_FOR(i, region) {
+      const BoutReal *up = flux(i.x(), i.y()), *down = flux(i.x(), i.y() - 1);
+      BoutReal *r = result(i.x(), i.y());
+
+      const BoutReal Jdy = coord->J[i] * coord->dy[i];
+      for (int k = 0; k < ncz; k++) {
+        r[k] = (up[k] - down[k]) / Jdy;
+      }
+    }
     
     // Convert result back to non-aligned coordinates
     return mesh->fromFieldAligned(result);
   }
 
   const Field3D D4DY4_Index(const Field3D &f_in, bool bndry_flux) {
-    Field3D result = 0.0;
+    Mesh *mesh = f_in.getMesh();
+
+    Field3D result(0.0, mesh);
     result.setLocation(f_in.getLocation());
     
     // Convert to field aligned coordinates
     Field3D f = mesh->toFieldAligned(f_in);
 
     Coordinates *coord = f_in.getCoordinates();
-    
-    for(int i=mesh->xstart;i<=mesh->xend;i++) {
-      bool yperiodic = mesh->periodicY(i);
-      
-      bool has_upper_boundary = !yperiodic && mesh->lastY(i);
-      bool has_lower_boundary = !yperiodic && mesh->firstY(i);
-      
-      for(int j=mesh->ystart;j<=mesh->yend;j++) {
-        
-        // Right boundary
-        
-        if (bndry_flux || (j != mesh->yend) || !has_upper_boundary) {
-          // Calculate the fluxes
-          
-          // Right boundary common factors
-          BoutReal common_factor = 0.25 *
-            (coord->dy(i, j) + coord->dy(i, j + 1)) *
-            (coord->J(i, j) + coord->J(i, j + 1));
-          
-          BoutReal factor_rc = common_factor / (coord->J(i,j) * coord->dy(i,j));
-          BoutReal factor_rp = common_factor / (coord->J(i,j+1) * coord->dy(i,j+1));
-          if ( j != mesh->yend || !has_upper_boundary ) {
-            for(int k=0;k<mesh->LocalNz;k++) {
-              // Not on domain boundary
-              // 3rd derivative at right cell boundary
-              
-              BoutReal d3fdx3 = (
-                                 f(i,j+2,k)
-                                 - 3.*f(i,j+1,k)
-                                 + 3.*f(i,j,  k)
-                                 -    f(i,j-1,k)
-                                 );
-              
-              result(i,j,  k) += d3fdx3 * factor_rc; 
-              result(i,j+1,k) -= d3fdx3 * factor_rp; 
-            }
-          } else {
-            // At a domain boundary
-            // Use a one-sided difference formula
-            
-            for(int k=0;k<mesh->LocalNz;k++) {
-
-              BoutReal d3fdx3 = -((16. / 5) * 0.5 *
-                                  (f(i, j + 1, k) + f(i, j, k)) // Boundary value f_b
-                                  - 6. * f(i, j, k)                 // f_0
-                                  + 4. * f(i, j - 1, k)             // f_1
-                                  - (6. / 5) * f(i, j - 2, k)       // f_2
-                                  );
-              
-              result(i,j,  k) += d3fdx3 * factor_rc; 
-              result(i,j+1,k) -= d3fdx3 * factor_rp;
-            }
-          }
+
+    const int ncz = mesh->LocalNz;
+
+    std::vector<bool> has_lower_boundary, has_upper_boundary;
+    yBoundaries(mesh, has_lower_boundary, has_upper_boundary);
+
+    // 3rd derivative at the face between i and i.yp(), at each z
+    auto face_d3fdx3 = [&](const Ind2D &i, BoutReal *d3fdx3) {
+      const int x = i.x(), y = i.y();
+
+      const BoutReal *fm = f(x, y - 1), *fc = f(x, y), *fp = f(x, y + 1);
+
+      if (has_upper_boundary[x] && (y == mesh->yend)) {
+        // At a domain boundary
+        // Use a one-sided difference formula
+        const BoutReal *fmm = f(x, y - 2);
+        for (int k = 0; k < ncz; k++) {
+          d3fdx3[k] = -((16. / 5) * 0.5 * (fp[k] + fc[k]) // Boundary value f_b
+                        - 6. * fc[k]                      // f_0
+                        + 4. * fm[k]                      // f_1
+                        - (6. / 5) * fmm[k]               // f_2
+                        );
         }
+        return;
+      }
 
-        // Left cell boundary
-        
-        if (bndry_flux || (j != mesh->ystart) || !has_lower_boundary) {
-          // Calculate the fluxes
-
-          BoutReal common_factor = 0.25 *
-            (coord->dy(i, j) + coord->dy(i, j + 1)) *
-            (coord->J(i, j) + coord->J(i, j - 1));
-
-          BoutReal factor_lc = common_factor / (coord->J(i, j) * coord->dy(i, j));
-          BoutReal factor_lm = common_factor / (coord->J(i, j - 1) * coord->dy(i, j - 1));
-            
-          if ( j != mesh->ystart || !has_lower_boundary ) {
-            for(int k=0;k<mesh->LocalNz;k++) {
-          
-              // Not on a domain boundary
-              BoutReal d3fdx3 = (f(i, j + 1, k)
-                                 - 3. * f(i, j, k)
-                                 + 3. * f(i, j - 1, k)
-                                 - f(i, j - 2, k));
-              
-              result(i, j    , k) -= d3fdx3 * factor_lc; 
-              result(i, j - 1, k) += d3fdx3 * factor_lm;
-            }
-          } else {
-            // On a domain (Y) boundary
-            for(int k=0;k<mesh->LocalNz;k++) {
-              BoutReal d3fdx3 = -(-(16. / 5) * 0.5 *
-                                  (f(i, j - 1, k) + f(i, j, k)) // Boundary value f_b
-                                  + 6. * f(i, j, k)                 // f_0
-                                  - 4. * f(i, j + 1, k)             // f_1
-                                  + (6. / 5) * f(i, j + 2, k)       // f_2
-                                  );
-
-              result(i, j    , k) -= d3fdx3 * factor_lc; 
-              result(i, j - 1, k) += d3fdx3 * factor_lm;
-            }
-          }
+      const BoutReal *fpp = f(x, y + 2);
+
+      if (has_lower_boundary[x] && (y == mesh->ystart - 1)) {
+        // On a domain (Y) boundary
+        const BoutReal *fppp = f(x, y + 3);
+        for (int k = 0; k < ncz; k++) {
+          d3fdx3[k] = -(-(16. / 5) * 0.5 * (fc[k] + fp[k]) // Boundary value f_b
+                        + 6. * fp[k]                       // f_0
+                        - 4. * fpp[k]                      // f_1
+                        + (6. / 5) * fppp[k]               // f_2
+                        );
         }
+        return;
+      }
+
+      // Not on domain boundary
+      for (int k = 0; k < ncz; k++) {
+        d3fdx3[k] = fpp[k] - 3. * fp[k] + 3. * fc[k] - fm[k];
+      }
+    };
+
+    const auto &region = mesh->getRegion2D("RGN_NOBNDRY");
+
+    // Calculate the derivative at each face once
+    Field3D d3fdx3(mesh);
+    d3fdx3.allocate();
+
+    BOUT_FOR(i, region) {
+      face_d3fdx3(i, d3fdx3(i.x(), i.y()));
+      if (i.y() == mesh->ystart) {
+        face_d3fdx3(i.ym(), d3fdx3(i.x(), i.y() - 1));
+      }
+    }
+
+    // Each cell includes the fluxes through its own right and left
+    // boundaries, and those calculated by its neighbours in Y
+    BOUT_FOR(i, region) {
+      const int x = i.x(), j = i.y();
+      const auto iyp = i.yp(), iym = i.ym();
+      const BoutReal Jdy = coord->J[i] * coord->dy[i];
+
+      // Factors multiplying the derivatives at the right and left faces
+      BoutReal factor_r = 0.0, factor_l = 0.0;
+
+      if (bndry_flux || (j != mesh->yend) || !has_upper_boundary[x]) {
+        // Right boundary common factors
+        factor_r += 0.25 * (coord->dy[i] + coord->dy[iyp]) *
+                    (coord->J[i] + coord->J[iyp]) / Jdy;
+      }
+      if (j != mesh->yend) {
+        // Left boundary of the cell above
+        factor_r += 0.25 * (coord->dy[iyp] + coord->dy[iyp.yp()]) *
+                    (coord->J[iyp] + coord->J[i]) / Jdy;
+      }
+
+      if (bndry_flux || (j != mesh->ystart) || !has_lower_boundary[x]) {
+        // Left cell boundary
+        factor_l += 0.25 * (coord->dy[i] + coord->dy[iyp]) *
+                    (coord->J[i] + coord->J[iym]) / Jdy;
+      }
+      if (j != mesh->ystart) {
+        // Right boundary of the cell below
+        factor_l += 0.25 * (coord->dy[iym] + coord->dy[i]) *
+                    (coord->J[iym] + coord->J[i]) / Jdy;
+      }
+
+      const BoutReal *right = d3fdx3(x, j), *left = d3fdx3(x, j - 1);
+      BoutReal *r = result(x, j);
+      for (int k = 0; k < ncz; k++) {
+        r[k] = right[k] * factor_r - left[k] * factor_l;
       }
     }
     
@@ -400,6 +500,16 @@ namespace FV {
     return mesh->fromFieldAligned(result);
   }
 
+  void yBoundaries(Mesh *mesh, std::vector<bool> &lower, std::vector<bool> &upper) {
+    lower.resize(mesh->LocalNx);
+    upper.resize(mesh->LocalNx);
+    for (int x = 0; x < mesh->LocalNx; x++) {
+      bool yperiodic = mesh->periodicY(x);
+      lower[x] = !yperiodic && mesh->firstY(x);
+      upper[x] = !yperiodic && mesh->lastY(x);
+    }
+  }
+
   void communicateFluxes(Field3D &f) {
 
     // Use X=0 as temporary buffer
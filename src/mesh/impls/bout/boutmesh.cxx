@@ -2567,6 +2567,7 @@ void BoutMesh::outputVars(Datafile &file) {
   file.add(jyseps1_2, "jyseps1_2", false);
   file.add(jyseps2_1, "jyseps2_1", false);
   file.add(jyseps2_2, "jyseps2_2", false);
+  file.add(maxregionblocksize, "maxregionblocksize", false);
 
   getCoordinates()->outputVars(file);
 }
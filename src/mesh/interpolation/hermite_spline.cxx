@@ -21,15 +21,20 @@
  **************************************************************************/
 
 #include "bout/mesh.hxx"
+#include "bout/openmpwrap.hxx"
 #include "globals.hxx"
 #include "interpolation.hxx"
+#include "options.hxx"
 
+#include <map>
 #include <vector>
 
 HermiteSpline::HermiteSpline(int y_offset, Mesh *mesh)
     : Interpolation(y_offset, mesh), h00_x(localmesh), h01_x(localmesh), h10_x(localmesh),
       h11_x(localmesh), h00_z(localmesh), h01_z(localmesh), h10_z(localmesh),
-      h11_z(localmesh) {
+      h11_z(localmesh), halo(false) {
+
+  sparse = Options::root()["interpolation"]["sparse"].withDefault(false);
 
   // Index arrays contain guard cells in order to get subscripts right
   i_corner = Tensor<int>(localmesh->LocalNx, localmesh->LocalNy, localmesh->LocalNz);
@@ -68,15 +73,26 @@ void HermiteSpline::calcWeights(const Field3D &delta_x, const Field3D &delta_z)
         t_z = delta_z(x, y, z) - static_cast<BoutReal>(k_corner(x, y, z));
 
         // NOTE: A (small) hack to avoid one-sided differences
-        if (i_corner(x, y, z) >= localmesh->xend) {
+        if (localmesh->lastX() && (i_corner(x, y, z) >= localmesh->xend)) {
           i_corner(x, y, z) = localmesh->xend - 1;
           t_x = 1.0;
         }
-        if (i_corner(x, y, z) < localmesh->xstart) {
+        if (localmesh->firstX() && (i_corner(x, y, z) < localmesh->xstart)) {
           i_corner(x, y, z) = localmesh->xstart;
           t_x = 0.0;
         }
 
+        // Check that the points used are available. The sparse operator
+        // uses f at i_corner - 1 to i_corner + 2, the dense method uses
+        // derivatives at i_corner and i_corner + 1
+        if (!halo) {
+          const int i_min = sparse ? 1 : 0;
+          const int i_max = localmesh->LocalNx - (sparse ? 3 : 2);
+          if ((i_corner(x, y, z) < i_min) || (i_corner(x, y, z) > i_max))
+            throw BoutException("x index %e out of the local range at (%d,%d,%d)",
+                                delta_x(x, y, z), x, y, z);
+        }
+
         // Check that t_x and t_z are in range
         if ((t_x < 0.0) || (t_x > 1.0))
           throw BoutException("t_x=%e out of range at (%d,%d,%d)", t_x, x, y, z);
@@ -98,6 +114,133 @@ void HermiteSpline::calcWeights(const Field3D &delta_x, const Field3D &delta_z)
       }
     }
   }
+
+  if (sparse) {
+    calcSparse();
+  }
+}
+
+void HermiteSpline::calcSparse() {
+  const int nx = localmesh->LocalNx;
+  const int ny = localmesh->LocalNy;
+  const int ncz = localmesh->LocalNz;
+  const int nlocal = nx * ny * ncz;
+
+  int nrows = 0;
+  for (int x = localmesh->xstart; x <= localmesh->xend; x++) {
+    for (int y = localmesh->ystart; y <= localmesh->yend; y++) {
+      for (int z = 0; z < ncz; z++) {
+        if (!skip_mask(x, y, z)) {
+          nrows++;
+        }
+      }
+    }
+  }
+
+  sparse_rows = Array<int>(nrows);
+  sparse_cols = Array<int>(nrows * sparse_width);
+  sparse_weights = Array<BoutReal>(nrows * sparse_width);
+
+  // Index of each halo line, numbered in the order they are first used
+  std::map<std::pair<int, int>, int> halo_index;
+  halo_lines.clear();
+
+  int row = 0;
+  for (int x = localmesh->xstart; x <= localmesh->xend; x++) {
+    for (int y = localmesh->ystart; y <= localmesh->yend; y++) {
+      const int y_next = y + y_offset;
+
+      for (int z = 0; z < ncz; z++) {
+
+        if (skip_mask(x, y, z))
+          continue;
+
+        // The derivatives fx, fz and fxz in interpolate() are second-order
+        // central differences, so each 1D Hermite spline is a weighted sum
+        // of four points, at offsets -1, 0, 1, 2 from the corner
+        const BoutReal cx[4] = {-0.5 * h10_x(x, y, z),
+                                h00_x(x, y, z) - 0.5 * h11_x(x, y, z),
+                                h01_x(x, y, z) + 0.5 * h10_x(x, y, z),
+                                0.5 * h11_x(x, y, z)};
+        const BoutReal cz[4] = {-0.5 * h10_z(x, y, z),
+                                h00_z(x, y, z) - 0.5 * h11_z(x, y, z),
+                                h01_z(x, y, z) + 0.5 * h10_z(x, y, z),
+                                0.5 * h11_z(x, y, z)};
+
+        const int z_mod = ((k_corner(x, y, z) % ncz) + ncz) % ncz;
+
+        sparse_rows[row] = (x * ny + y_next) * ncz + z;
+
+        int ind = row * sparse_width;
+        for (int i = 0; i < 4; i++) {
+          const int xi = i_corner(x, y, z) + i - 1;
+
+          // Start of the Z line, in the field or the halo
+          int line;
+          if ((xi >= 0) && (xi < nx)) {
+            line = (xi * ny + y_next) * ncz;
+          } else {
+            auto it = halo_index.find(std::make_pair(xi, y_next));
+            if (it == halo_index.end()) {
+              it = halo_index
+                       .insert(std::make_pair(std::make_pair(xi, y_next),
+                                              static_cast<int>(halo_lines.size())))
+                       .first;
+              halo_lines.push_back(std::make_pair(xi, y_next));
+            }
+            line = nlocal + it->second * ncz;
+          }
+
+          for (int k = 0; k < 4; k++) {
+            const int zk = (z_mod + k - 1 + ncz) % ncz;
+            sparse_cols[ind] = line + zk;
+            sparse_weights[ind] = cx[i] * cz[k];
+            ind++;
+          }
+        }
+        row++;
+      }
+    }
+  }
+}
+
+Field3D HermiteSpline::applySparse(const Field3D &f, const BoutReal *halo_values) const {
+  Field3D f_interp(f.getMesh());
+  f_interp.allocate();
+
+  const int nrows = sparse_rows.size();
+  const int nlocal = localmesh->LocalNx * localmesh->LocalNy * localmesh->LocalNz;
+  const BoutReal *fdata = &f(0, 0, 0);
+  BoutReal *result = &f_interp(0, 0, 0);
+
+  if (halo_values == nullptr) {
+    BOUT_OMP(parallel for)
+    for (int row = 0; row < nrows; row++) {
+      const int *cols = &sparse_cols[row * sparse_width];
+      const BoutReal *weights = &sparse_weights[row * sparse_width];
+      BoutReal sum = 0.0;
+      for (int i = 0; i < sparse_width; i++) {
+        sum += weights[i] * fdata[cols[i]];
+      }
+      result[sparse_rows[row]] = sum;
+      ASSERT2(finite(sum));
+    }
+  } else {
+    // Indices past the end of the field data are in the halo
+    BOUT_OMP(parallel for)
+    for (int row = 0; row < nrows; row++) {
+      const int *cols = &sparse_cols[row * sparse_width];
+      const BoutReal *weights = &sparse_weights[row * sparse_width];
+      BoutReal sum = 0.0;
+      for (int i = 0; i < sparse_width; i++) {
+        sum += weights[i] *
+               ((cols[i] < nlocal) ? fdata[cols[i]] : halo_values[cols[i] - nlocal]);
+      }
+      result[sparse_rows[row]] = sum;
+      ASSERT2(finite(sum));
+    }
+  }
+  return f_interp;
 }
 
 void HermiteSpline::calcWeights(const Field3D &delta_x, const Field3D &delta_z, const BoutMask &mask) {
@@ -108,6 +251,16 @@ void HermiteSpline::calcWeights(const Field3D &delta_x, const Field3D &delta_z,
 Field3D HermiteSpline::interpolate(const Field3D &f) const {
 
   ASSERT1(f.getMesh() == localmesh);
+
+  if (sparse) {
+    // Apply the precomputed operator. This uses the X guard cells of f
+    // directly, rather than communicating derivatives
+    if (!halo_lines.empty()) {
+      throw BoutException("HermiteSpline: Points outside the local X range need halo values");
+    }
+    return applySparse(f, nullptr);
+  }
+
   Field3D f_interp(f.getMesh());
   f_interp.allocate();
 
@@ -170,6 +323,19 @@ Field3D HermiteSpline::interpolate(const Field3D &f) const {
   return f_interp;
 }
 
+Field3D HermiteSpline::interpolate(const Field3D &f,
+                                   const std::vector<BoutReal> &halo_values) const {
+  ASSERT1(f.getMesh() == localmesh);
+  ASSERT1(sparse);
+
+  if (halo_values.size() != halo_lines.size() * localmesh->LocalNz) {
+    throw BoutException("HermiteSpline: Expected %d halo values, but got %d",
+                        static_cast<int>(halo_lines.size() * localmesh->LocalNz),
+                        static_cast<int>(halo_values.size()));
+  }
+  return applySparse(f, halo_values.data());
+}
+
 Field3D HermiteSpline::interpolate(const Field3D& f, const Field3D &delta_x, const Field3D &delta_z) {
   calcWeights(delta_x, delta_z);
   return interpolate(f);
@@ -5,8 +5,15 @@
 #include <utils.hxx>
 #include <derivs.hxx>
 #include <msg_stack.hxx>
+#include <boutcomm.hxx>
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "meshfactory.hxx"
 
@@ -20,6 +27,41 @@ Mesh* Mesh::create(GridDataSource *s, Options *opt) {
 
 Mesh *Mesh::create(Options *opt) { return create(nullptr, opt); }
 
+namespace {
+/// Set the schedule used by OpenMP loops with schedule(runtime), from
+/// a string of the form "kind" or "kind,chunk_size"
+void setOpenMPSchedule(const std::string &schedule) {
+#ifdef _OPENMP
+  const auto comma = schedule.find(',');
+  const std::string kind = lowercase(trim(schedule.substr(0, comma)));
+  const int chunk = (comma == std::string::npos)
+                        ? 0
+                        : stringToInt(trim(schedule.substr(comma + 1)));
+
+  omp_sched_t omp_kind;
+  if (kind == "static") {
+    omp_kind = omp_sched_static;
+  } else if (kind == "dynamic") {
+    omp_kind = omp_sched_dynamic;
+  } else if (kind == "guided") {
+    omp_kind = omp_sched_guided;
+  } else if (kind == "auto") {
+    omp_kind = omp_sched_auto;
+  } else {
+    throw BoutException("Unknown OpenMP schedule '%s'. Options are static, dynamic, "
+                        "guided or auto, optionally followed by ',chunk_size'",
+                        schedule.c_str());
+  }
+  omp_set_schedule(omp_kind, chunk);
+  output_info.write("\tOpenMP runtime schedule: %s\n", schedule.c_str());
+#else
+  output_warn.write("\tWARNING: openmp_schedule '%s' ignored, as BOUT++ was compiled "
+                    "without OpenMP\n",
+                    schedule.c_str());
+#endif
+}
+} // namespace
+
 Mesh::Mesh(GridDataSource *s, Options* opt) : source(s), options(opt) {
   if(s == nullptr)
     throw BoutException("GridDataSource passed to Mesh::Mesh() is NULL");
@@ -31,6 +73,16 @@ Mesh::Mesh(GridDataSource *s, Options* opt) : source(s), options(opt) {
   /// Get mesh options
   OPTION(options, StaggerGrids,   false); // Stagger grids
   OPTION(options, maxregionblocksize, MAXREGIONBLOCKSIZE);
+  OPTION(options, tune_regionblocksize, false);
+
+  // OpenMP schedule used by loops with schedule(runtime). This
+  // includes BOUT_FOR if configured with --with-openmp-schedule=runtime
+  std::string openmp_schedule;
+  OPTION(options, openmp_schedule, "");
+  if (!openmp_schedule.empty()) {
+    setOpenMPSchedule(openmp_schedule);
+  }
+
   // Initialise derivatives
   derivs_init(options);  // in index_derivs.cxx for now
 }
@@ -387,38 +439,114 @@ void Mesh::addRegionPerp(const std::string &region_name, const Region<IndPerp> &
   output_info << "\t" << region.getStats() << "\n";
 }
 
+int Mesh::getRegionBlockSize(const std::string &region_name) {
+  Options *mesh_options = (options == nullptr) ? Options::getRoot()->getSection("mesh")
+                                               : options;
+  Options *region_options = mesh_options->getSection("regionblocksize");
+  if (!region_options->isSet(region_name)) {
+    return maxregionblocksize;
+  }
+  int blocksize;
+  region_options->get(region_name, blocksize, maxregionblocksize);
+  if (blocksize <= 0) {
+    throw BoutException("Block size for region %s must be > 0, got %d",
+                        region_name.c_str(), blocksize);
+  }
+  return blocksize;
+}
+
+int Mesh::tuneRegionBlockSize() {
+  TRACE("Mesh::tuneRegionBlockSize");
+
+  std::vector<int> sizes;
+  for (int size = 8; size <= 1024; size *= 2) {
+    sizes.push_back(size);
+  }
+
+  const int npoints = LocalNx * LocalNy * LocalNz;
+  Array<BoutReal> a(npoints), b(npoints), c(npoints), result(npoints);
+  for (int i = 0; i < npoints; i++) {
+    a[i] = 1.0;
+    b[i] = 2.0;
+    c[i] = 3.0;
+  }
+
+  // Enough loops over the mesh that each timing is not too small
+  const int nloops = std::max(1, 1000000 / npoints);
+  const int nrepeat = 5;
+
+  std::vector<BoutReal> times;
+  for (int size : sizes) {
+    const Region<Ind3D> region(xstart, xend, ystart, yend, 0, LocalNz - 1, LocalNy,
+                               LocalNz, size);
+    // Take the fastest of several repeats, the first also warming up
+    BoutReal fastest = 0.0;
+    for (int repeat = 0; repeat <= nrepeat; repeat++) {
+      const BoutReal start = MPI_Wtime();
+      for (int loop = 0; loop < nloops; loop++) {
+        BOUT_FOR(i, region) { result[i.ind] = a[i.ind] * b[i.ind] + c[i.ind]; }
+      }
+      const BoutReal elapsed = MPI_Wtime() - start;
+      if ((repeat == 1) || ((repeat > 1) && (elapsed < fastest))) {
+        fastest = elapsed;
+      }
+    }
+    times.push_back(fastest);
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, times.data(), static_cast<int>(times.size()), MPI_DOUBLE,
+                MPI_SUM, BoutComm::get());
+
+  output_info.write("\tTiming region block sizes:\n");
+  int best = 0;
+  for (std::size_t i = 0; i < sizes.size(); i++) {
+    output_info.write("\t\t%5d : %e s\n", sizes[i], times[i]);
+    if (times[i] < times[best]) {
+      best = static_cast<int>(i);
+    }
+  }
+  return sizes[best];
+}
+
 void Mesh::createDefaultRegions(){
+  if (tune_regionblocksize) {
+    maxregionblocksize = tuneRegionBlockSize();
+  }
+  output_info.write("\tRegion block size: %d%s\n", maxregionblocksize,
+                    tune_regionblocksize ? " (tuned)" : "");
+
   //3D regions
   addRegion3D("RGN_ALL", Region<Ind3D>(0, LocalNx - 1, 0, LocalNy - 1, 0, LocalNz - 1,
-                                       LocalNy, LocalNz, maxregionblocksize));
-  addRegion3D("RGN_NOBNDRY", Region<Ind3D>(xstart, xend, ystart, yend, 0, LocalNz - 1,
-                                           LocalNy, LocalNz, maxregionblocksize));
+                                       LocalNy, LocalNz, getRegionBlockSize("RGN_ALL")));
+  addRegion3D("RGN_NOBNDRY",
+              Region<Ind3D>(xstart, xend, ystart, yend, 0, LocalNz - 1, LocalNy, LocalNz,
+                            getRegionBlockSize("RGN_NOBNDRY")));
   addRegion3D("RGN_NOX", Region<Ind3D>(xstart, xend, 0, LocalNy - 1, 0, LocalNz - 1,
-                                       LocalNy, LocalNz, maxregionblocksize));
+                                       LocalNy, LocalNz, getRegionBlockSize("RGN_NOX")));
   addRegion3D("RGN_NOY", Region<Ind3D>(0, LocalNx - 1, ystart, yend, 0, LocalNz - 1,
-                                       LocalNy, LocalNz, maxregionblocksize));
+                                       LocalNy, LocalNz, getRegionBlockSize("RGN_NOY")));
   addRegion3D("RGN_GUARDS", mask(getRegion3D("RGN_ALL"), getRegion3D("RGN_NOBNDRY")));
 
   //2D regions
   addRegion2D("RGN_ALL", Region<Ind2D>(0, LocalNx - 1, 0, LocalNy - 1, 0, 0, LocalNy, 1,
-                                       maxregionblocksize));
+                                       getRegionBlockSize("RGN_ALL")));
   addRegion2D("RGN_NOBNDRY", Region<Ind2D>(xstart, xend, ystart, yend, 0, 0, LocalNy, 1,
-                                           maxregionblocksize));
+                                           getRegionBlockSize("RGN_NOBNDRY")));
   addRegion2D("RGN_NOX", Region<Ind2D>(xstart, xend, 0, LocalNy - 1, 0, 0, LocalNy, 1,
-                                       maxregionblocksize));
+                                       getRegionBlockSize("RGN_NOX")));
   addRegion2D("RGN_NOY", Region<Ind2D>(0, LocalNx - 1, ystart, yend, 0, 0, LocalNy, 1,
-                                       maxregionblocksize));
+                                       getRegionBlockSize("RGN_NOY")));
   addRegion2D("RGN_GUARDS", mask(getRegion2D("RGN_ALL"), getRegion2D("RGN_NOBNDRY")));
 
   // Perp regions
   addRegionPerp("RGN_ALL", Region<IndPerp>(0, LocalNx - 1, 0, 0, 0, LocalNz - 1, 1,
-                                           LocalNz, maxregionblocksize));
+                                           LocalNz, getRegionBlockSize("RGN_ALL")));
   addRegionPerp("RGN_NOBNDRY", Region<IndPerp>(xstart, xend, 0, 0, 0, LocalNz - 1, 1,
-                                               LocalNz, maxregionblocksize));
+                                               LocalNz, getRegionBlockSize("RGN_NOBNDRY")));
   addRegionPerp("RGN_NOX", Region<IndPerp>(xstart, xend, 0, 0, 0, LocalNz - 1, 1, LocalNz,
-                                           maxregionblocksize)); // Same as NOBNDRY
+                                           getRegionBlockSize("RGN_NOX"))); // Same as NOBNDRY
   addRegionPerp("RGN_NOY", Region<IndPerp>(0, LocalNx - 1, 0, 0, 0, LocalNz - 1, 1,
-                                           LocalNz, maxregionblocksize)); // Same as ALL
+                                           LocalNz, getRegionBlockSize("RGN_NOY"))); // Same as ALL
   addRegionPerp("RGN_GUARDS", mask(getRegionPerp("RGN_ALL"), getRegionPerp("RGN_NOBNDRY")));
 
   // Construct index lookup for 3D-->2D
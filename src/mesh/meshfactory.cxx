@@ -40,7 +40,7 @@ Mesh* MeshFactory::createMesh(GridDataSource *source, Options *options) {
       /// Create a grid file
       source = static_cast<GridDataSource *>(new GridFile(
           data_format((grid_ext.empty()) ? grid_name.c_str() : grid_ext.c_str()),
-          grid_name.c_str()));
+          grid_name.c_str(), options));
     }else if(Options::getRoot()->isSet("grid")){
       // Get the global option
       Options::getRoot()->get("grid", grid_name, "");
@@ -50,7 +50,7 @@ Mesh* MeshFactory::createMesh(GridDataSource *source, Options *options) {
 
       source = static_cast<GridDataSource *>(new GridFile(
           data_format((grid_ext.empty()) ? grid_name.c_str() : grid_ext.c_str()),
-          grid_name.c_str()));
+          grid_name.c_str(), options));
     }else {
       output << "\nGetting grid data from options\n";
       source = static_cast<GridDataSource *>(new GridFromOptions(options));
@@ -46,6 +46,9 @@
 #include <msg_stack.hxx>
 #include <utils.hxx>
 
+#include <algorithm>
+#include <map>
+
 /**
  * Return the sign of val
  */
@@ -54,7 +57,8 @@ inline BoutReal sgn(BoutReal val) { return (BoutReal(0) < val) - (val < BoutReal
 // Calculate all the coefficients needed for the spline interpolation
 // dir MUST be either +1 or -1
 FCIMap::FCIMap(Mesh &mesh, int dir, bool zperiodic)
-  : dir(dir), boundary_mask(mesh), corner_boundary_mask(mesh), y_prime(&mesh) {
+  : remote(false), comm(mesh.getXcomm()), dir(dir), boundary_mask(mesh),
+    corner_boundary_mask(mesh), y_prime(&mesh) {
 
   interp = InterpolationFactory::getInstance()->create(&mesh);
   interp->setYOffset(dir);
@@ -76,7 +80,11 @@ FCIMap::FCIMap(Mesh &mesh, int dir, bool zperiodic)
   mesh.get(R, "R", 0.0, false);
   mesh.get(Z, "Z", 0.0, false);
 
-  // Load the floating point indices from the grid file
+  // Load the floating point indices from the grid file. The X indices
+  // are global, including guard cells (local index + mesh.OffsetX), so
+  // that field lines can end on other processors. With one processor in
+  // X these are the same as local indices. Negative values mark field
+  // lines which leave the domain
   // Future, higher order parallel derivatives could require maps to +/-2 slices
   if (dir == +1) {
     mesh.get(xt_prime, "forward_xt_prime", 0.0, false);
@@ -128,18 +136,6 @@ FCIMap::FCIMap(Mesh &mesh, int dir, bool zperiodic)
         0.25 * (zt_prime[i] + zt_prime[i_xplus] + zt_prime[i_zplus] + zt_prime[i_xzplus]);
   }
 
-  interp_corner->setMask(corner_boundary_mask);
-
-  {
-    TRACE("FCImap: calculating corner weights");
-    interp_corner->calcWeights(xt_prime_corner, zt_prime_corner);
-  }
-
-  {
-    TRACE("FCImap: calculating weights");
-    interp->calcWeights(xt_prime, zt_prime);
-  }
-  
   int ncz = mesh.LocalNz;
   BoutReal t_x, t_z;
 
@@ -239,17 +235,204 @@ FCIMap::FCIMap(Mesh &mesh, int dir, bool zperiodic)
     }
   }
 
-  interp->setMask(boundary_mask);
+  // The maps contain global X indices, which may be on other processors
+  Field3D xt_local = xt_prime - mesh.OffsetX;
+  Field3D xt_local_corner = xt_prime_corner - mesh.OffsetX;
+
+  // Are any points outside the local X range? This is the range
+  // needed by the sparse Hermite spline, after the boundary corrections
+  auto outside = [&mesh](BoutReal xt) {
+    int i = static_cast<int>(floor(xt));
+    if (mesh.firstX()) {
+      i = std::max(i, mesh.xstart);
+    }
+    if (mesh.lastX()) {
+      i = std::min(i, mesh.xend - 1);
+    }
+    return (i < 1) || (i > mesh.LocalNx - 3);
+  };
+  int local_outside = 0;
+  for (int x = mesh.xstart; x <= mesh.xend; x++) {
+    for (int y = mesh.ystart; y <= mesh.yend; y++) {
+      for (int z = 0; z < ncz; z++) {
+        if ((!boundary_mask(x, y, z) && outside(xt_local(x, y, z))) ||
+            (!corner_boundary_mask(x, y, z) && outside(xt_local_corner(x, y, z)))) {
+          local_outside = 1;
+        }
+      }
+    }
+  }
+  int any_outside;
+  MPI_Allreduce(&local_outside, &any_outside, 1, MPI_INT, MPI_MAX, comm);
+  remote = (any_outside != 0);
+
+  if (remote) {
+    auto hermite = dynamic_cast<HermiteSpline *>(interp);
+    auto hermite_corner = dynamic_cast<HermiteSpline *>(interp_corner);
+    if ((hermite == nullptr) || (hermite_corner == nullptr)) {
+      throw BoutException("FCI field lines end outside the local X range. This is only "
+                          "supported by hermitespline interpolation");
+    }
+    hermite->setHalo(true);
+    hermite_corner->setHalo(true);
+  }
+
+  {
+    TRACE("FCImap: calculating corner weights");
+    interp_corner->calcWeights(xt_local_corner, zt_prime_corner, corner_boundary_mask);
+  }
+
+  {
+    TRACE("FCImap: calculating weights");
+    interp->calcWeights(xt_local, zt_prime, boundary_mask);
+  }
+
+  if (remote) {
+    centre_schedule = calcSchedule(mesh, false);
+    both_schedule = calcSchedule(mesh, true);
+  }
+}
+
+FCIMap::HaloSchedule FCIMap::calcSchedule(Mesh &mesh, bool corners) const {
+  TRACE("FCIMap::calcSchedule");
+
+  HaloSchedule schedule;
+
+  const int nz = mesh.LocalNz;
+  const int nxpe = mesh.getNXPE();
+  const int mxsub = mesh.xend - mesh.xstart + 1;
+
+  const auto &centre = static_cast<HermiteSpline *>(interp)->getHaloLines();
+  const std::vector<std::pair<int, int>> no_lines;
+  const auto &corner =
+      corners ? static_cast<HermiteSpline *>(interp_corner)->getHaloLines() : no_lines;
+
+  // All lines needed, by global X index. Since this is sorted in X,
+  // lines are grouped by the processor they are received from
+  std::map<std::pair<int, int>, int> lines;
+  for (const auto &line : centre) {
+    lines[std::make_pair(line.first + mesh.OffsetX, line.second)] = 0;
+  }
+  for (const auto &line : corner) {
+    lines[std::make_pair(line.first + mesh.OffsetX, line.second)] = 0;
+  }
+
+  std::vector<int> nrecv(nxpe, 0);
+  std::vector<int> requests; // (x, y) indices on the processor sending the line
+  int index = 0;
+  for (auto &line : lines) {
+    const int gx = line.first.first;
+    if ((gx < 0) || (gx >= mesh.GlobalNx)) {
+      throw BoutException("FCI field line ends outside the domain, at global x index %d",
+                          gx);
+    }
+    const int proc = std::min(std::max((gx - mesh.xstart) / mxsub, 0), nxpe - 1);
+    nrecv[proc]++;
+    requests.push_back(gx - proc * mxsub);
+    requests.push_back(line.first.second);
+    line.second = index++;
+  }
+
+  // Tell each processor which lines to send
+  std::vector<int> nsend(nxpe);
+  MPI_Alltoall(nrecv.data(), 1, MPI_INT, nsend.data(), 1, MPI_INT, comm);
+
+  std::vector<int> request_counts(nxpe), request_displs(nxpe), send_line_counts(nxpe),
+      send_line_displs(nxpe);
+  schedule.send_counts.resize(nxpe);
+  schedule.send_displs.resize(nxpe);
+  schedule.recv_counts.resize(nxpe);
+  schedule.recv_displs.resize(nxpe);
+  int nrecv_total = 0, nsend_total = 0;
+  for (int proc = 0; proc < nxpe; proc++) {
+    request_counts[proc] = 2 * nrecv[proc];
+    request_displs[proc] = 2 * nrecv_total;
+    send_line_counts[proc] = 2 * nsend[proc];
+    send_line_displs[proc] = 2 * nsend_total;
+
+    schedule.recv_counts[proc] = nz * nrecv[proc];
+    schedule.recv_displs[proc] = nz * nrecv_total;
+    schedule.send_counts[proc] = nz * nsend[proc];
+    schedule.send_displs[proc] = nz * nsend_total;
+
+    nrecv_total += nrecv[proc];
+    nsend_total += nsend[proc];
+  }
+
+  schedule.send_lines.resize(2 * nsend_total);
+  MPI_Alltoallv(requests.data(), request_counts.data(), request_displs.data(), MPI_INT,
+                schedule.send_lines.data(), send_line_counts.data(),
+                send_line_displs.data(), MPI_INT, comm);
+
+  // Where the halo of each interpolation comes from in the received lines
+  for (const auto &line : centre) {
+    schedule.centre_lines.push_back(
+        lines[std::make_pair(line.first + mesh.OffsetX, line.second)]);
+  }
+  for (const auto &line : corner) {
+    schedule.corner_lines.push_back(
+        lines[std::make_pair(line.first + mesh.OffsetX, line.second)]);
+  }
+  return schedule;
+}
+
+void FCIMap::fetchHalo(const HaloSchedule &schedule, const Field3D &f,
+                       std::vector<BoutReal> &centre,
+                       std::vector<BoutReal> &corner) const {
+  TRACE("FCIMap::fetchHalo");
+
+  const int nz = f.getNz();
+
+  const auto &send_lines = schedule.send_lines;
+  std::vector<BoutReal> sendbuf(send_lines.size() / 2 * nz);
+  for (size_t line = 0; line < send_lines.size() / 2; line++) {
+    const BoutReal *data = &f(send_lines[2 * line], send_lines[2 * line + 1], 0);
+    std::copy(data, data + nz, sendbuf.begin() + line * nz);
+  }
+
+  std::vector<BoutReal> recvbuf(schedule.recv_displs.back() +
+                                schedule.recv_counts.back());
+  MPI_Alltoallv(sendbuf.data(), schedule.send_counts.data(), schedule.send_displs.data(),
+                MPI_DOUBLE, recvbuf.data(), schedule.recv_counts.data(),
+                schedule.recv_displs.data(), MPI_DOUBLE, comm);
+
+  centre.resize(schedule.centre_lines.size() * nz);
+  for (size_t line = 0; line < schedule.centre_lines.size(); line++) {
+    auto start = recvbuf.begin() + schedule.centre_lines[line] * nz;
+    std::copy(start, start + nz, centre.begin() + line * nz);
+  }
+  corner.resize(schedule.corner_lines.size() * nz);
+  for (size_t line = 0; line < schedule.corner_lines.size(); line++) {
+    auto start = recvbuf.begin() + schedule.corner_lines[line] * nz;
+    std::copy(start, start + nz, corner.begin() + line * nz);
+  }
+}
+
+const Field3D FCIMap::interpolate(Field3D &f) const {
+  if (!remote) {
+    return interp->interpolate(f);
+  }
+  std::vector<BoutReal> centre, corner;
+  fetchHalo(centre_schedule, f, centre, corner);
+  return static_cast<HermiteSpline *>(interp)->interpolate(f, centre);
 }
 
 const Field3D FCIMap::integrate(Field3D &f) const {
   TRACE("FCIMap::integrate");
   
-  // Cell centre values
-  Field3D centre = interp->interpolate(f);
-  
-  // Cell corner values (x+1/2, z+1/2)
-  Field3D corner = interp_corner->interpolate(f);
+  Field3D centre, corner;
+  if (remote) {
+    std::vector<BoutReal> centre_halo, corner_halo;
+    fetchHalo(both_schedule, f, centre_halo, corner_halo);
+    centre = static_cast<HermiteSpline *>(interp)->interpolate(f, centre_halo);
+    corner = static_cast<HermiteSpline *>(interp_corner)->interpolate(f, corner_halo);
+  } else {
+    // Cell centre values
+    centre = interp->interpolate(f);
+
+    // Cell corner values (x+1/2, z+1/2)
+    corner = interp_corner->interpolate(f);
+  }
 
   Field3D result;
   result.allocate();
@@ -33,6 +33,8 @@
 #include <parallel_boundary_region.hxx>
 #include <unused.hxx>
 
+#include <vector>
+
 /*!
  * Field line map - contains the coefficients for interpolation
  */
@@ -43,6 +45,37 @@ class FCIMap {
 
   /// Private constructor - must be initialised with mesh
   FCIMap();
+
+  // Field lines which end on other processors in X. The interpolation
+  // reads the values it needs from a halo of Z lines, which are
+  // exchanged over the X communicator
+
+  bool remote;                  ///< Are any halo lines needed in this X communicator?
+  MPI_Comm comm;                ///< X communicator
+
+  /// Which halo lines are sent to and received from each processor
+  struct HaloSchedule {
+    std::vector<int> send_lines; ///< Local (x, y) of lines to send, by processor
+    std::vector<int> send_counts, send_displs; ///< Number of values to send, offsets
+    std::vector<int> recv_counts, recv_displs; ///< Number of values to receive, offsets
+    std::vector<int> centre_lines; ///< Receive buffer line of each interp halo line
+    std::vector<int> corner_lines; ///< Receive buffer line of each corner halo line
+  };
+
+  /// interpolate() only needs the halo of interp, so exchanges fewer
+  /// lines than integrate(), which needs both halos
+  HaloSchedule centre_schedule; ///< Halo lines of interp
+  HaloSchedule both_schedule;   ///< Halo lines of interp and interp_corner
+
+  /// Build the communication schedule for the halo lines of interp,
+  /// and of interp_corner if \p corners is true
+  HaloSchedule calcSchedule(Mesh &mesh, bool corners) const;
+
+  /// Exchange halo lines of \p f using \p schedule, filling the halos
+  /// of the interpolations in it
+  void fetchHalo(const HaloSchedule &schedule, const Field3D &f,
+                 std::vector<BoutReal> &centre, std::vector<BoutReal> &corner) const;
+
 public:
   /// dir MUST be either +1 or -1
   FCIMap(Mesh& mesh, int dir, bool zperiodic);
@@ -58,7 +91,7 @@ public:
 
   BoundaryRegionPar* boundary; /**< boundary region */
 
-  const Field3D interpolate(Field3D &f) const { return interp->interpolate(f); }
+  const Field3D interpolate(Field3D &f) const;
 
   const Field3D integrate(Field3D &f) const;
 };
@@ -10,6 +10,7 @@
 #include <bout/mesh.hxx>
 #include <fft.hxx>
 #include <bout/constants.hxx>
+#include <bout/openmpwrap.hxx>
 
 #include <cmath>
 
@@ -41,49 +42,34 @@ ShiftedMetric::ShiftedMetric(Mesh &m) : mesh(m), zShift(&m) {
   //As we're attached to a mesh we can expect the z direction to
   //not change once we've been created so precalculate the complex
   //phases used in transformations
-  int nmodes = mesh.LocalNz/2 + 1;
+  nmodes = mesh.LocalNz/2 + 1;
   BoutReal zlength = mesh.getCoordinates()->zlength();
 
-  //Allocate storage for complex intermediate
-  cmplx.resize(nmodes);
-  std::fill(cmplx.begin(), cmplx.end(), 0.0);
+  //Allocate contiguous storage for the phases, indexed by (x, y, mode)
+  fromAlignedPhs = Tensor<dcomplex>(mesh.LocalNx, mesh.LocalNy, nmodes);
+  toAlignedPhs = Tensor<dcomplex>(mesh.LocalNx, mesh.LocalNy, nmodes);
 
-  //Allocate storage for our 3d vector structures.
-  //This could be made more succinct but this approach is fairly
-  //verbose --> transparent
-  fromAlignedPhs.resize(mesh.LocalNx);
-  toAlignedPhs.resize(mesh.LocalNx);
-  
-  yupPhs.resize(mesh.LocalNx);
-  ydownPhs.resize(mesh.LocalNx);
+  yupPhs = Tensor<dcomplex>(mesh.LocalNx, mesh.LocalNy, nmodes);
+  ydownPhs = Tensor<dcomplex>(mesh.LocalNx, mesh.LocalNy, nmodes);
 
-  for(int jx=0;jx<mesh.LocalNx;jx++){
-    fromAlignedPhs[jx].resize(mesh.LocalNy);
-    toAlignedPhs[jx].resize(mesh.LocalNy);
+  // Guard cells are not shifted in Y
+  yupPhs = 1.0;
+  ydownPhs = 1.0;
 
-    yupPhs[jx].resize(mesh.LocalNy);
-    ydownPhs[jx].resize(mesh.LocalNy);
-    for(int jy=0;jy<mesh.LocalNy;jy++){
-      fromAlignedPhs[jx][jy].resize(nmodes);
-      toAlignedPhs[jx][jy].resize(nmodes);
-      
-      yupPhs[jx][jy].resize(nmodes);
-      ydownPhs[jx][jy].resize(nmodes);
-    }
-  }
-	
   //To/From field aligned phases
+  BOUT_OMP(parallel for)
   for(int jx=0;jx<mesh.LocalNx;jx++){
     for(int jy=0;jy<mesh.LocalNy;jy++){
       for(int jz=0;jz<nmodes;jz++) {
   	BoutReal kwave=jz*2.0*PI/zlength; // wave number is 1/[rad]
-  	fromAlignedPhs[jx][jy][jz] = dcomplex(cos(kwave*zShift(jx,jy)) , -sin(kwave*zShift(jx,jy)));
-  	toAlignedPhs[jx][jy][jz] =   dcomplex(cos(kwave*zShift(jx,jy)) ,  sin(kwave*zShift(jx,jy)));
+  	fromAlignedPhs(jx,jy,jz) = dcomplex(cos(kwave*zShift(jx,jy)) , -sin(kwave*zShift(jx,jy)));
+  	toAlignedPhs(jx,jy,jz) =   dcomplex(cos(kwave*zShift(jx,jy)) ,  sin(kwave*zShift(jx,jy)));
       }
     }
   }
 
   //Yup/Ydown phases -- note we don't shift in the boundaries/guards
+  BOUT_OMP(parallel for)
   for(int jx=0;jx<mesh.LocalNx;jx++){
     for(int jy=mesh.ystart;jy<=mesh.yend;jy++){
       BoutReal yupShift = zShift(jx,jy) - zShift(jx,jy+1);
@@ -92,8 +78,8 @@ ShiftedMetric::ShiftedMetric(Mesh &m) : mesh(m), zShift(&m) {
       for(int jz=0;jz<nmodes;jz++) {
   	BoutReal kwave=jz*2.0*PI/zlength; // wave number is 1/[rad]
 
-  	yupPhs[jx][jy][jz] = dcomplex(cos(kwave*yupShift) , -sin(kwave*yupShift));
-  	ydownPhs[jx][jy][jz] = dcomplex(cos(kwave*ydownShift) , -sin(kwave*ydownShift));
+  	yupPhs(jx,jy,jz) = dcomplex(cos(kwave*yupShift) , -sin(kwave*yupShift));
+  	ydownPhs(jx,jy,jz) = dcomplex(cos(kwave*ydownShift) , -sin(kwave*ydownShift));
       }
     }
   }
@@ -102,6 +88,12 @@ ShiftedMetric::ShiftedMetric(Mesh &m) : mesh(m), zShift(&m) {
 
 /*!
  * Calculate the Y up and down fields
+ *
+ * yup at y+1 is the field at y+1 shifted by the yup phase at y,
+ * and ydown at y-1 the field at y-1 shifted by the ydown phase at y.
+ * Interior lines are needed for both, so each line is transformed
+ * once and both phases applied. The lines in each X plane are
+ * transformed together.
  */
 void ShiftedMetric::calcYUpDown(Field3D &f) {
   f.splitYupYdown();
@@ -109,18 +101,26 @@ void ShiftedMetric::calcYUpDown(Field3D &f) {
   Field3D& yup = f.yup();
   yup.allocate();
 
-  for(int jx=0;jx<mesh.LocalNx;jx++) {
-    for(int jy=mesh.ystart;jy<=mesh.yend;jy++) {
-      shiftZ(&(f(jx,jy+1,0)), yupPhs[jx][jy], &(yup(jx,jy+1,0)));
-    }
-  }
-
   Field3D& ydown = f.ydown();
   ydown.allocate();
 
-  for(int jx=0;jx<mesh.LocalNx;jx++) {
-    for(int jy=mesh.ystart;jy<=mesh.yend;jy++) {
-      shiftZ(&(f(jx,jy-1,0)), ydownPhs[jx][jy], &(ydown(jx,jy-1,0)));
+  // Lines from ystart-1 to yend+1 are transformed, and each phase
+  // applied to all but two of them
+  const int nlines = mesh.yend - mesh.ystart + 3;
+
+  BOUT_OMP(parallel)
+  {
+    // Per-thread work arrays
+    Array<dcomplex> fft(nlines * nmodes), cmplx(nlines * nmodes);
+
+    BOUT_OMP(for)
+    for(int jx=0;jx<mesh.LocalNx;jx++) {
+      rfft(&f(jx, mesh.ystart - 1, 0), mesh.LocalNz, nlines, mesh.LocalNz, fft.begin());
+
+      applyPhase(&fft[2 * nmodes], &yupPhs(jx, mesh.ystart, 0), nlines - 2,
+                 &yup(jx, mesh.ystart + 1, 0), cmplx);
+      applyPhase(&fft[0], &ydownPhs(jx, mesh.ystart, 0), nlines - 2,
+                 &ydown(jx, mesh.ystart - 1, 0), cmplx);
     }
   }
 }
@@ -141,17 +141,23 @@ const Field3D ShiftedMetric::fromFieldAligned(const Field3D &f) {
   return shiftZ(f, fromAlignedPhs);
 }
 
-const Field3D ShiftedMetric::shiftZ(const Field3D &f, const arr3Dvec &phs) {
+const Field3D ShiftedMetric::shiftZ(const Field3D &f, const Tensor<dcomplex> &phs) {
   ASSERT1(&mesh == f.getMesh());
   if(mesh.LocalNz == 1)
     return f; // Shifting makes no difference
 
   Field3D result(&mesh);
   result.allocate();
-  
-  for(int jx=0;jx<mesh.LocalNx;jx++) {
-    for(int jy=0;jy<mesh.LocalNy;jy++) {
-      shiftZ(f(jx,jy), phs[jx][jy], result(jx,jy));
+
+  BOUT_OMP(parallel)
+  {
+    // Fourier modes of all the Z lines in an X plane
+    Array<dcomplex> fft(mesh.LocalNy * nmodes), cmplx(mesh.LocalNy * nmodes);
+
+    BOUT_OMP(for)
+    for(int jx=0;jx<mesh.LocalNx;jx++) {
+      rfft(&f(jx, 0, 0), mesh.LocalNz, mesh.LocalNy, mesh.LocalNz, fft.begin());
+      applyPhase(fft.begin(), &phs(jx, 0, 0), mesh.LocalNy, &result(jx, 0, 0), cmplx);
     }
   }
   
@@ -159,21 +165,15 @@ const Field3D ShiftedMetric::shiftZ(const Field3D &f, const arr3Dvec &phs) {
 
 }
 
-void ShiftedMetric::shiftZ(const BoutReal *in, const std::vector<dcomplex> &phs, BoutReal *out) {
-  // Take forward FFT
-  rfft(in, mesh.LocalNz, &cmplx[0]);
-
-  //Following is an algorithm approach to write a = a*b where a and b are
-  //vectors of dcomplex.
-  //  std::transform(cmplxOneOff.begin(),cmplxOneOff.end(), ptr.begin(), 
-  //		 cmplxOneOff.begin(), std::multiplies<dcomplex>());
+void ShiftedMetric::applyPhase(const dcomplex *in, const dcomplex *phs, int nlines,
+                               BoutReal *out, Array<dcomplex> &cmplx) {
+  ASSERT1(!cmplx.empty() && cmplx.size() >= nlines * nmodes);
 
-  const int nmodes = cmplx.size();
-  for(int jz=1;jz<nmodes;jz++) {
-    cmplx[jz] *= phs[jz];
+  for(int i=0;i<nlines*nmodes;i++) {
+    cmplx[i] = in[i] * phs[i];
   }
 
-  irfft(&cmplx[0], mesh.LocalNz, out); // Reverse FFT
+  irfft(cmplx.begin(), mesh.LocalNz, nlines, out, mesh.LocalNz); // Reverse FFT
 }
 
 //Old approach retained so we can still specify a general zShift
@@ -185,30 +185,27 @@ const Field3D ShiftedMetric::shiftZ(const Field3D &f, const Field2D &zangle) {
   Field3D result(&mesh);
   result.allocate();
 
-  for(int jx=0;jx<mesh.LocalNx;jx++) {
-    for(int jy=0;jy<mesh.LocalNy;jy++) {
-      shiftZ(f(jx,jy), mesh.LocalNz, zangle(jx,jy), result(jx,jy));
+  BoutReal zlength = mesh.getCoordinates()->zlength();
+
+  BOUT_OMP(parallel)
+  {
+    Array<dcomplex> fft(mesh.LocalNy * nmodes), phs(mesh.LocalNy * nmodes),
+        cmplx(mesh.LocalNy * nmodes);
+
+    BOUT_OMP(for)
+    for(int jx=0;jx<mesh.LocalNx;jx++) {
+      for(int jy=0;jy<mesh.LocalNy;jy++) {
+        for(int jz=0;jz<nmodes;jz++) {
+          BoutReal kwave=jz*2.0*PI/zlength; // wave number is 1/[rad]
+          phs[jy * nmodes + jz] =
+              dcomplex(cos(kwave * zangle(jx, jy)), -sin(kwave * zangle(jx, jy)));
+        }
+      }
+
+      rfft(&f(jx, 0, 0), mesh.LocalNz, mesh.LocalNy, mesh.LocalNz, fft.begin());
+      applyPhase(fft.begin(), phs.begin(), mesh.LocalNy, &result(jx, 0, 0), cmplx);
     }
   }
   
   return result;
 }
-
-void ShiftedMetric::shiftZ(const BoutReal *in, int len, BoutReal zangle,  BoutReal *out) {
-  int nmodes = len/2 + 1;
-
-  // Complex array used for FFTs
-  cmplxLoc.resize(nmodes);
-  
-  // Take forward FFT
-  rfft(in, len, &cmplxLoc[0]);
-  
-  // Apply phase shift
-  BoutReal zlength = mesh.getCoordinates()->zlength();
-  for(int jz=1;jz<nmodes;jz++) {
-    BoutReal kwave=jz*2.0*PI/zlength; // wave number is 1/[rad]
-    cmplxLoc[jz] *= dcomplex(cos(kwave*zangle) , -sin(kwave*zangle));
-  }
-
-  irfft(&cmplxLoc[0], len, out); // Reverse FFT
-}
@@ -0,0 +1,179 @@
+/**************************************************************************
+ * Preconditioners built from the stiff terms in a model
+ *
+ **************************************************************************
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <bout/blockprecon.hxx>
+
+#include <bout/invert/laplacexy.hxx>
+#include <bout/mesh.hxx>
+#include <bout/sys/timer.hxx>
+#include <boutexception.hxx>
+#include <difops.hxx>
+#include <globals.hxx>
+#include <invert_laplace.hxx>
+#include <invert_parderiv.hxx>
+#include <msg_stack.hxx>
+#include <output.hxx>
+
+#include <cmath>
+
+BlockPreconditioner::Block::Block(BlockType type) : type(type) {}
+BlockPreconditioner::Block::Block(Block &&) = default;
+BlockPreconditioner::Block::~Block() = default;
+
+BlockPreconditioner::BlockPreconditioner(Options *opt)
+    : options(opt == nullptr ? Options::getRoot()->getSection("blockprecon") : opt) {
+  OPTION(options, bndry, "neumann");
+  OPTION(options, diagnose, false);
+  OPTION(options, gamma_rtol, 0.0);
+}
+
+BlockPreconditioner::~BlockPreconditioner() = default;
+
+void BlockPreconditioner::addParallelDiffusion(Field3D &f, const Field2D &D) {
+  Block block(BlockType::ParallelDiffusion);
+  block.f3d = &f;
+  block.a = D;
+  block.invpar.reset(InvertPar::Create());
+  blocks.push_back(std::move(block));
+}
+
+void BlockPreconditioner::addPerpDiffusion(Field3D &f, const Field2D &D) {
+  Block block(BlockType::PerpDiffusion);
+  block.f3d = &f;
+  block.a = D;
+  block.laplace.reset(Laplacian::create(options->getSection("laplace")));
+  blocks.push_back(std::move(block));
+}
+
+void BlockPreconditioner::addPerpDiffusion(Field2D &f, const Field2D &D) {
+  Block block(BlockType::PerpDiffusion2D);
+  block.f2d = &f;
+  block.a = D;
+  block.laplacexy.reset(new LaplaceXY(mesh, options->getSection("laplacexy")));
+  blocks.push_back(std::move(block));
+}
+
+void BlockPreconditioner::addParallelWave(Field3D &f, Field3D &g, const Field2D &a,
+                                          const Field2D &b) {
+  if (&f == &g) {
+    throw BoutException("BlockPreconditioner: wave coupling needs two different variables");
+  }
+  Block block(BlockType::ParallelWave);
+  block.f3d = &f;
+  block.g3d = &g;
+  block.a = a;
+  block.b = b;
+  block.invpar.reset(InvertPar::Create());
+  blocks.push_back(std::move(block));
+}
+
+int BlockPreconditioner::apply(BoutReal UNUSED(t), BoutReal gamma,
+                               BoutReal UNUSED(delta)) {
+  TRACE("BlockPreconditioner::apply");
+  Timer timer("blockprecon");
+
+  for (auto &block : blocks) {
+    applyBlock(block, gamma);
+  }
+  napply++;
+  return 0;
+}
+
+void BlockPreconditioner::applyBlock(Block &block, BoutReal new_gamma) {
+  // Keep using the inverters set up for the last gamma, unless it
+  // has changed by more than the tolerance
+  const bool update = (block.last_gamma < 0.0) ||
+                      (fabs(new_gamma - block.last_gamma) > gamma_rtol * block.last_gamma);
+  if (update) {
+    block.last_gamma = new_gamma;
+    nupdates++;
+  }
+  const BoutReal gamma = block.last_gamma;
+
+  switch (block.type) {
+  case BlockType::ParallelDiffusion: {
+    // (1 - gamma * D * Grad2_par2) x = r
+    if (update) {
+      block.invpar->setCoefA(1.0);
+      block.invpar->setCoefB(-gamma * block.a);
+    }
+    Field3D &r = ddt(*block.f3d);
+    r = block.invpar->solve(r);
+    break;
+  }
+  case BlockType::PerpDiffusion: {
+    // (1 - gamma * D * Delp2) x = r
+    if (update) {
+      block.laplace->setCoefA(1.0);
+      block.laplace->setCoefD(-gamma * block.a);
+    }
+    Field3D &r = ddt(*block.f3d);
+    r = block.laplace->solve(r);
+    break;
+  }
+  case BlockType::PerpDiffusion2D: {
+    // (1 - gamma * Div(D * Grad_perp)) x = r
+    if (update) {
+      block.laplacexy->setCoefs(-gamma * block.a, 1.0);
+    }
+    Field2D &r = ddt(*block.f2d);
+    r = block.laplacexy->solve(r, r);
+    break;
+  }
+  case BlockType::ParallelWave: {
+    // | 1                 -gamma a Grad_par | |x|   |rf|
+    // | -gamma b Grad_par  1                | |y| = |rg|
+    //
+    // Eliminating y gives the Schur complement for x, where the
+    // coefficients are assumed to vary slowly along the field
+    //   (1 - gamma^2 a b Grad2_par2) x = rf + gamma a Grad_par(rg)
+    //   y = rg + gamma b Grad_par(x)
+    if (update) {
+      block.invpar->setCoefA(1.0);
+      block.invpar->setCoefB(-SQ(gamma) * block.a * block.b);
+    }
+    Field3D &rf = ddt(*block.f3d);
+    Field3D &rg = ddt(*block.g3d);
+
+    mesh->communicate(rg);
+    rg.applyBoundary(bndry);
+    rf = block.invpar->solve(rf + gamma * block.a * Grad_par(rg));
+
+    mesh->communicate(rf);
+    rf.applyBoundary(bndry);
+    rg += gamma * block.b * Grad_par(rf);
+    break;
+  }
+  }
+}
+
+int BlockPreconditioner::call(Solver *UNUSED(solver), BoutReal UNUSED(time),
+                              int UNUSED(iter), int UNUSED(nout)) {
+  const BoutReal elapsed = Timer::resetTime("blockprecon");
+  if (diagnose) {
+    output.write("\nBlock preconditioner: %d blocks, %d applications, %d coefficient "
+                 "updates, %e s per application\n",
+                 size(), napply, nupdates, (napply > 0) ? elapsed / napply : 0.0);
+  }
+  napply = 0;
+  nupdates = 0;
+  return 0;
+}
@@ -0,0 +1,219 @@
+#include <bout/diagnostics.hxx>
+
+#include <boutcomm.hxx>
+#include <boutexception.hxx>
+#include <fft.hxx>
+#include <globals.hxx>
+#include <msg_stack.hxx>
+#include <output.hxx>
+#include <utils.hxx>
+#include <bout/sys/timer.hxx>
+
+#include <algorithm>
+#include <cmath>
+
+Diagnostics::Diagnostics(Options *opt) : t_out(0.0) {
+  TRACE("Diagnostics::Diagnostics");
+
+  if (opt == nullptr) {
+    opt = Options::getRoot()->getSection("diagnostics");
+  }
+
+  // Output file options, like the "output" section for dump files
+  file = Datafile(opt->getSection("output"));
+
+  BoutReal timestep;
+  OPTION(opt, timestep, -1.0);
+  if (timestep > 0.0) {
+    setTimestep(timestep);
+  }
+
+  std::string fields;
+  opt->get("fields", fields, "");
+  for (const auto &name : strsplit(fields, ',')) {
+    std::string trimmed = trim(name);
+    if (!trimmed.empty()) {
+      field_names.push_back(trimmed);
+    }
+  }
+
+  OPTION(opt, average, true);
+  OPTION(opt, rms, true);
+  OPTION(opt, fsa, false);
+  OPTION(opt, spectrum, false);
+
+  // Probes are x,y,z triples. Brackets can be used for readability
+  std::string probes;
+  opt->get("probes", probes, "");
+  probes.erase(std::remove_if(probes.begin(), probes.end(),
+                              [](char c) { return (c == '(') || (c == ')'); }),
+               probes.end());
+  std::vector<int> indices;
+  for (const auto &index : strsplit(probes, ',')) {
+    if (!trim(index).empty()) {
+      indices.push_back(stringToInt(trim(index)));
+    }
+  }
+  if (indices.size() % 3 != 0) {
+    throw BoutException("Diagnostics: probes must be a list of x,y,z indices");
+  }
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    Probe p;
+    p.x = indices[i];
+    p.y = indices[i + 1];
+    p.z = indices[i + 2];
+    if ((p.z < 0) || (p.z >= mesh->LocalNz)) {
+      throw BoutException("Diagnostics: Probe z index %d out of range", p.z);
+    }
+    // Convert to local indices
+    p.x -= mesh->OffsetX;
+    p.y += mesh->ystart - mesh->OffsetY;
+    p.local = (p.x >= mesh->xstart) && (p.x <= mesh->xend) && (p.y >= mesh->ystart) &&
+              (p.y <= mesh->yend);
+    probe_points.push_back(p);
+  }
+
+  if (!probe_points.empty()) {
+    // Each probe must be in the interior of exactly one processor
+    std::vector<int> local(probe_points.size()), count(probe_points.size());
+    for (size_t i = 0; i < probe_points.size(); i++) {
+      local[i] = probe_points[i].local ? 1 : 0;
+    }
+    MPI_Allreduce(local.data(), count.data(), local.size(), MPI_INT, MPI_SUM,
+                  BoutComm::get());
+    for (size_t i = 0; i < count.size(); i++) {
+      if (count[i] != 1) {
+        throw BoutException("Diagnostics: Probe %d is not in the domain interior",
+                            static_cast<int>(i));
+      }
+    }
+  }
+}
+
+bool Diagnostics::isEnabled(Options *opt) {
+  if (opt == nullptr) {
+    opt = Options::getRoot()->getSection("diagnostics");
+  }
+  bool enabled;
+  OPTION(opt, enabled, false);
+  return enabled;
+}
+
+void Diagnostics::add(Field3D &f, const std::string &name) {
+  TRACE("Diagnostics::add");
+
+  entries.emplace_back();
+  Entry &entry = entries.back();
+  entry.var = &f;
+  entry.name = name;
+  if (spectrum) {
+    entry.spectrum.resize(mesh->LocalNz / 2 + 1);
+  }
+  entry.probes.resize(probe_points.size());
+
+  // Add outputs to the file. Safe because entries is a list
+  if (average) {
+    file.add(entry.dc, (name + "_dc").c_str(), true);
+  }
+  if (rms) {
+    file.add(entry.rms, (name + "_rms").c_str(), true);
+  }
+  if (fsa) {
+    file.add(entry.fsa, (name + "_fsa").c_str(), true);
+  }
+  for (size_t k = 0; k < entry.spectrum.size(); k++) {
+    file.add(entry.spectrum[k], (name + "_kz" + toString(k)).c_str(), true);
+  }
+  for (size_t i = 0; i < entry.probes.size(); i++) {
+    file.add(entry.probes[i], (name + "_probe" + toString(i)).c_str(), true);
+  }
+}
+
+void Diagnostics::open(const std::string &filename, bool append) {
+  TRACE("Diagnostics::open");
+
+  if (append) {
+    file.opena("%s", filename.c_str());
+  } else {
+    file.openw("%s", filename.c_str());
+  }
+  file.add(t_out, "t_array", true);
+}
+
+int Diagnostics::call(Solver *UNUSED(solver), BoutReal time, int UNUSED(iter),
+                      int UNUSED(nout)) {
+  write(time);
+  return 0;
+}
+
+void Diagnostics::write(BoutReal time) {
+  TRACE("Diagnostics::write");
+  Timer timer("diagnostics");
+
+  t_out = time;
+
+  // Spectra and probes from all fields are reduced together
+  std::vector<BoutReal> local;
+
+  const int nz = mesh->LocalNz;
+  Array<dcomplex> fft(nz / 2 + 1);
+
+  for (auto &entry : entries) {
+    const Field3D &f = *entry.var;
+
+    if (average || rms) {
+      entry.dc = DC(f);
+    }
+    if (rms) {
+      entry.rms = sqrt(DC(SQ(f - entry.dc)));
+    }
+    if (fsa) {
+      // Finished below, overlapping with the spectra
+      surface.startFlux(f, entry.fsa);
+    }
+
+    if (!entry.spectrum.empty()) {
+      std::fill(entry.spectrum.begin(), entry.spectrum.end(), 0.0);
+      for (int x = mesh->xstart; x <= mesh->xend; x++) {
+        for (int y = mesh->ystart; y <= mesh->yend; y++) {
+          rfft(&f(x, y, 0), nz, fft.begin());
+          for (size_t k = 0; k < entry.spectrum.size(); k++) {
+            entry.spectrum[k] += std::norm(fft[k]);
+          }
+        }
+      }
+      local.insert(local.end(), entry.spectrum.begin(), entry.spectrum.end());
+    }
+
+    for (size_t i = 0; i < probe_points.size(); i++) {
+      const Probe &p = probe_points[i];
+      local.push_back(p.local ? f(p.x, p.y, p.z) : 0.0);
+    }
+  }
+
+  if (!local.empty()) {
+    std::vector<BoutReal> global(local.size());
+    MPI_Allreduce(local.data(), global.data(), local.size(), MPI_DOUBLE, MPI_SUM,
+                  BoutComm::get());
+
+    // Spectra are averaged over all interior points
+    const BoutReal npoints = static_cast<BoutReal>(mesh->GlobalNx - 2 * mesh->xstart) *
+                             static_cast<BoutReal>(mesh->GlobalNy - 2 * mesh->ystart);
+
+    auto it = global.begin();
+    for (auto &entry : entries) {
+      for (auto &power : entry.spectrum) {
+        power = *it++ / npoints;
+      }
+      for (auto &value : entry.probes) {
+        value = *it++;
+      }
+    }
+  }
+
+  surface.wait();
+
+  if (!file.write()) {
+    throw BoutException("Diagnostics: Failed to write output file");
+  }
+}
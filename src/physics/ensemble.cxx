@@ -0,0 +1,396 @@
+/**************************************************************************
+ * Several copies of a physics model evolved together
+ *
+ **************************************************************************
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <bout/ensemble.hxx>
+
+#include <boutcomm.hxx>
+#include <boutexception.hxx>
+#include <globals.hxx>
+#include <msg_stack.hxx>
+#include <output.hxx>
+
+/// Solver given to each member's init(). Variables of members evolved
+/// by this processor group are passed to the real solver, with the
+/// member's suffix added to their names. Variables of other members
+/// are kept by this solver, and only set at each output
+class EnsembleMemberSolver : public Solver {
+public:
+  EnsembleMemberSolver(Solver *solver, int index, bool owned)
+      : solver(solver), suffix("_" + std::to_string(index)), owned(owned) {}
+
+  int run() override {
+    throw BoutException("Ensemble members can't be run separately");
+  }
+
+  void add(Field2D &v, const std::string name) override {
+    if (owned) {
+      fields2d.push_back(&v);
+      solver->add(v, memberName(name));
+    } else {
+      addField(v, memberName(name));
+    }
+  }
+  void add(Field3D &v, const std::string name) override {
+    if (owned) {
+      fields3d.push_back(&v);
+      solver->add(v, memberName(name));
+    } else {
+      addField(v, memberName(name));
+    }
+  }
+  void add(Vector2D &v, const std::string name) override {
+    if (owned) {
+      fields2d.insert(fields2d.end(), {&v.x, &v.y, &v.z});
+      solver->add(v, memberVectorName(name, v.covariant));
+    } else {
+      addComponents(v, memberVectorName(name, v.covariant));
+    }
+  }
+  void add(Vector3D &v, const std::string name) override {
+    if (owned) {
+      fields3d.insert(fields3d.end(), {&v.x, &v.y, &v.z});
+      solver->add(v, memberVectorName(name, v.covariant));
+    } else {
+      addComponents(v, memberVectorName(name, v.covariant));
+    }
+  }
+
+  bool constraints() override { return solver->constraints(); }
+  void constraint(Field2D &v, Field2D &C_v, const std::string name) override {
+    checkOwned(name);
+    solver->constraint(v, C_v, memberName(name));
+  }
+  void constraint(Field3D &v, Field3D &C_v, const std::string name) override {
+    checkOwned(name);
+    solver->constraint(v, C_v, memberName(name));
+  }
+  void constraint(Vector2D &v, Vector2D &C_v, const std::string name) override {
+    checkOwned(name);
+    solver->constraint(v, C_v, memberVectorName(name, v.covariant));
+  }
+  void constraint(Vector3D &v, Vector3D &C_v, const std::string name) override {
+    checkOwned(name);
+    solver->constraint(v, C_v, memberVectorName(name, v.covariant));
+  }
+
+  void setMaxTimestep(BoutReal dt) override { solver->setMaxTimestep(dt); }
+  BoutReal getCurrentTimestep() override { return solver->getCurrentTimestep(); }
+
+  /// True if the member is evolved by this processor group
+  bool isOwned() const { return owned; }
+
+  /// Add the variables kept by this solver, of a member evolved by
+  /// another group, to \p outputfile
+  void outputOwnVars(Datafile &outputfile, bool save_repeat) {
+    for (const auto &f : f2d) {
+      outputfile.add(*(f.var), f.name.c_str(), save_repeat);
+    }
+    for (const auto &f : f3d) {
+      outputfile.add(*(f.var), f.name.c_str(), save_repeat);
+    }
+  }
+
+  /// Broadcast all the member's evolving variables over \p comm from \p root
+  void broadcast(int root, MPI_Comm comm) {
+    for (Field2D *f : fields2d) {
+      f->allocate(); // Ensure that f is unique
+      MPI_Bcast(&(*f)(0, 0), f->getMesh()->LocalNx * f->getMesh()->LocalNy, MPI_DOUBLE,
+                root, comm);
+    }
+    for (Field3D *f : fields3d) {
+      f->allocate();
+      MPI_Bcast(&(*f)(0, 0, 0),
+                f->getMesh()->LocalNx * f->getMesh()->LocalNy * f->getMesh()->LocalNz,
+                MPI_DOUBLE, root, comm);
+    }
+  }
+
+private:
+  Solver *solver;     ///< The solver evolving the ensemble
+  std::string suffix; ///< Added to variable names
+  bool owned;         ///< Variables are evolved by the real solver
+
+  /// All evolving fields of the member, including vector components
+  std::vector<Field2D *> fields2d;
+  std::vector<Field3D *> fields3d;
+
+  /// Keep the components of \p v, with the names the real solver
+  /// would give them. As in Solver::add, the time derivative of the
+  /// vector is created first, so that it contains the components'
+  template <typename T>
+  void addComponents(T &v, const std::string &name) {
+    v.setBoundary(name);
+    ddt(v).copyBoundary(v);
+
+    const std::string sep = v.covariant ? "_" : "";
+    for (auto component : {std::make_pair(&v.x, "x"), std::make_pair(&v.y, "y"),
+                           std::make_pair(&v.z, "z")}) {
+      addField(*component.first, name + sep + component.second);
+    }
+
+    v.applyBoundary(true);
+  }
+  void addField(Field2D &f, const std::string &name) {
+    fields2d.push_back(&f);
+    Solver::add(f, name);
+  }
+  void addField(Field3D &f, const std::string &name) {
+    fields3d.push_back(&f);
+    Solver::add(f, name);
+  }
+
+  /// Constraints are solved by the real solver, so can't be used by
+  /// members evolved by another group
+  void checkOwned(const std::string &name) {
+    if (!owned) {
+      throw BoutException("Constraint %s can't be used with ensemble:groups > 1",
+                          name.c_str());
+    }
+  }
+
+  /// Name of the variable in the solver. Options in the section for
+  /// \p name which are not set for this member are copied, so that
+  /// initial profiles and boundary conditions are the same as for a
+  /// single model unless set for each member
+  std::string memberName(const std::string &name) {
+    copyOptions(name, name + suffix);
+    return name + suffix;
+  }
+
+  /// As memberName, but also copies the options for each component
+  std::string memberVectorName(const std::string &name, bool covariant) {
+    const std::string sep = covariant ? "_" : "";
+    for (const char *component : {"x", "y", "z"}) {
+      copyOptions(name + sep + component, name + suffix + sep + component);
+    }
+    return memberName(name);
+  }
+
+  /// Copy values in section \p from which are not set in section \p to
+  static void copyOptions(const std::string &from, const std::string &to) {
+    Options *from_section = Options::getRoot()->getSection(from);
+    Options *to_section = Options::getRoot()->getSection(to);
+    for (const auto &it : from_section->values()) {
+      if (!to_section->isSet(it.first)) {
+        to_section->set(it.first, it.second.value, "ensemble");
+      }
+    }
+  }
+};
+
+/// Broadcasts the members' variables from the groups which evolve them
+/// each output, before the output and restart files are written
+class EnsembleMonitor : public Monitor {
+public:
+  EnsembleMonitor(EnsembleModel *model) : model(model) {}
+
+  int call(Solver *UNUSED(solver), BoutReal time, int UNUSED(iter),
+           int UNUSED(nout)) override {
+    return model->shareMembers(time);
+  }
+
+private:
+  EnsembleModel *model;
+};
+
+EnsembleModel::EnsembleModel() = default;
+EnsembleModel::~EnsembleModel() = default;
+
+int EnsembleModel::init(bool restarting) {
+  TRACE("EnsembleModel::init");
+
+  Options *options = Options::getRoot()->getSection("ensemble");
+
+  string parameter;
+  OPTION(options, parameter, "");
+  BoutReal start, end;
+  OPTION(options, start, 0.0);
+  OPTION(options, end, start);
+
+  // Section and name of the parameter option
+  Options *param_section = Options::getRoot();
+  string param_name = parameter;
+  size_t pos;
+  while ((pos = param_name.find(':')) != string::npos) {
+    param_section = param_section->getSection(param_name.substr(0, pos));
+    param_name = param_name.substr(pos + 1);
+  }
+
+  OPTION(options, groups, 1);
+  if (groups > 1) {
+    if (groups > size()) {
+      throw BoutException("More ensemble groups (%d) than members (%d)", groups, size());
+    }
+    if (BoutComm::groups() != groups) {
+      throw BoutException("ensemble:groups is %d, but processors are in %d groups",
+                          groups, BoutComm::groups());
+    }
+    group = BoutComm::group();
+  }
+
+  output.write("Ensemble of %d members\n", size());
+  if (groups > 1) {
+    output.write("\tProcessor group %d of %d\n", group, groups);
+  }
+
+  bool split = false;
+  for (int i = 0; i < size(); i++) {
+    PhysicsModel *member = members[i].get();
+
+    if (!parameter.empty()) {
+      BoutReal value = start + i * (end - start) / (size() - 1);
+      param_section->set(param_name, value, "ensemble", true);
+      output.write("\tMember %d: %s = %e\n", i, parameter.c_str(), value);
+    }
+
+    member_solvers.emplace_back(new EnsembleMemberSolver(solver, i, owner(i) == group));
+    member->solver = member_solvers.back().get();
+    member->initialised = true;
+
+    // Variables the member saves to the output file have the member
+    // suffix, like its evolving variables
+    dump.setNameSuffix("_" + std::to_string(i));
+    int status = member->init(restarting);
+    dump.setNameSuffix("");
+    if (status) {
+      throw BoutException("Couldn't initialise ensemble member %d", i);
+    }
+
+    if (i == 0) {
+      split = member->splitOperator();
+    } else if (member->splitOperator() != split) {
+      throw BoutException("Ensemble members must all be split operator, or none");
+    }
+    if (member->hasPrecon() || member->hasJacobian()) {
+      output_warn.write("\tWARNING: Preconditioner and Jacobian of ensemble members "
+                        "are not used\n");
+    }
+  }
+  setSplitOperator(split);
+
+  return 0;
+}
+
+int EnsembleModel::postInit(bool restarting) {
+  TRACE("EnsembleModel::postInit");
+
+  // Variables of members evolved by other groups are also saved, so
+  // that the files written by the first group contain all members
+  for (auto &member_solver : member_solvers) {
+    if (!member_solver->isOwned()) {
+      member_solver->outputOwnVars(dump, true);
+      member_solver->outputOwnVars(restart, false);
+    }
+  }
+
+  if (PhysicsModel::postInit(restarting)) {
+    return 1;
+  }
+
+  if (groups > 1) {
+    if (restarting) {
+      // Only the first group reads the restart file
+      BoutReal time = solver->getTime();
+      MPI_Bcast(&time, 1, MPI_DOUBLE, 0, BoutComm::acrossGroups());
+      solver->setTime(time);
+      for (auto &member_solver : member_solvers) {
+        member_solver->broadcast(0, BoutComm::acrossGroups());
+      }
+    }
+
+    monitor.reset(new EnsembleMonitor(this));
+    solver->addMonitor(monitor.get(), Solver::FRONT);
+  }
+  return 0;
+}
+
+int EnsembleModel::shareMembers(BoutReal time) {
+  TRACE("EnsembleModel::shareMembers");
+
+  for (int i = 0; i < size(); i++) {
+    member_solvers[i]->broadcast(owner(i), BoutComm::acrossGroups());
+  }
+
+  if (group == 0) {
+    // Calculate the quantities which other members save to the output file
+    for (int i = 0; i < size(); i++) {
+      if (member_solvers[i]->isOwned()) {
+        continue;
+      }
+      PhysicsModel *member = members[i].get();
+      int status = splitOperator()
+                       ? (member->runConvective(time) || member->runDiffusive(time, false))
+                       : member->runRHS(time);
+      if (status) {
+        return status;
+      }
+    }
+  }
+  return 0;
+}
+
+int EnsembleModel::rhs(BoutReal t) {
+  for (int i = 0; i < size(); i++) {
+    if (member_solvers[i]->isOwned() && members[i]->runRHS(t)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int EnsembleModel::convective(BoutReal t) {
+  for (int i = 0; i < size(); i++) {
+    if (member_solvers[i]->isOwned() && members[i]->runConvective(t)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int EnsembleModel::diffusive(BoutReal t, bool linear) {
+  for (int i = 0; i < size(); i++) {
+    if (member_solvers[i]->isOwned() && members[i]->runDiffusive(t, linear)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int EnsembleModel::outputMonitor(BoutReal simtime, int iter, int NOUT) {
+  // The first group has the variables of all members at outputs
+  int status = 0;
+  for (int i = 0; i < size(); i++) {
+    if (member_solvers[i]->isOwned() || (group == 0)) {
+      status |= members[i]->outputMonitor(simtime, iter, NOUT);
+    }
+  }
+  return status;
+}
+
+int EnsembleModel::timestepMonitor(BoutReal simtime, BoutReal dt) {
+  int status = 0;
+  for (int i = 0; i < size(); i++) {
+    if (member_solvers[i]->isOwned()) {
+      status |= members[i]->runTimestepMonitor(simtime, dt);
+    }
+  }
+  return status;
+}
@@ -31,6 +31,7 @@
 #include <difops.hxx>
 #include <gyro_average.hxx>
 #include <invert_laplace.hxx>
+#include <msg_stack.hxx>
 
 const Field3D gyroTaylor0(const Field3D &f, const Field3D &rho) {
   return f + SQ(rho) * Delp2(f);
@@ -108,3 +109,96 @@ const Field3D gyroPade2(const Field3D &f, const Field3D &rho, int flags) {
   return gyroPade2(f, DC(rho), flags);
 }
 
+GyroPade::GyroPade(BoutReal rho, int flags, Options *opt) : flags(flags), opt(opt) {
+  setRho(rho);
+}
+
+GyroPade::GyroPade(const Field2D &rho, int flags, Options *opt) : flags(flags), opt(opt) {
+  setRho(rho);
+}
+
+GyroPade::GyroPade(const Field3D &rho, int flags, Options *opt) : flags(flags), opt(opt) {
+  // Have to use Z average of rho for efficient inversion
+  setRho(DC(rho));
+}
+
+GyroPade::~GyroPade() = default;
+
+void GyroPade::setRho(BoutReal rho) {
+  setRho(Field2D(rho));
+}
+
+void GyroPade::setRho(const Field2D &rho) {
+  rho2 = rho * rho;
+
+  // Solvers which exist already need their coefficients updating
+  if (lap0) {
+    lap0->setCoefD(-rho2);
+  }
+  if (lap1) {
+    lap1->setCoefD(-0.5 * rho2);
+  }
+}
+
+Laplacian *GyroPade::getSolver(std::unique_ptr<Laplacian> &lap, BoutReal factor) {
+  if (!lap) {
+    lap.reset(Laplacian::create(opt));
+    lap->setFlags(flags);
+    lap->setCoefA(1.0);
+    lap->setCoefC(1.0);
+    lap->setCoefD(-factor * rho2);
+  }
+  return lap.get();
+}
+
+const Field3D GyroPade::pade0(const Field3D &f) {
+  TRACE("GyroPade::pade0");
+  return getSolver(lap0, 1.0)->solve(f);
+}
+
+const Field3D GyroPade::pade1(const Field3D &f) {
+  TRACE("GyroPade::pade1");
+  return getSolver(lap1, 0.5)->solve(f);
+}
+
+const Field3D GyroPade::pade2(const Field3D &f) {
+  Field3D gamma1, gamma2;
+  pade12(f, gamma1, gamma2);
+  return gamma2;
+}
+
+void GyroPade::pade12(const Field3D &f, Field3D &gamma1, Field3D &gamma2) {
+  TRACE("GyroPade::pade12");
+
+  Laplacian *lap = getSolver(lap1, 0.5);
+
+  gamma1 = lap->solve(f);
+
+  // With P = 1 - (rho^2/2) Delp2, Gamma_2 = (1 - P) P^{-2} f = P^{-1} gamma1 - gamma1
+  gamma2 = lap->solve(gamma1) - gamma1;
+  gamma2.applyBoundary("dirichlet");
+}
+
+std::vector<Field3D> GyroPade::pade0(const std::vector<Field3D> &f) {
+  TRACE("GyroPade::pade0(vector)");
+  return getSolver(lap0, 1.0)->solve(f);
+}
+
+std::vector<Field3D> GyroPade::pade1(const std::vector<Field3D> &f) {
+  TRACE("GyroPade::pade1(vector)");
+  return getSolver(lap1, 0.5)->solve(f);
+}
+
+std::vector<Field3D> GyroPade::pade2(const std::vector<Field3D> &f) {
+  TRACE("GyroPade::pade2(vector)");
+
+  Laplacian *lap = getSolver(lap1, 0.5);
+
+  std::vector<Field3D> gamma1 = lap->solve(f);
+  std::vector<Field3D> result = lap->solve(gamma1);
+  for (size_t i = 0; i < result.size(); i++) {
+    result[i] -= gamma1[i];
+    result[i].applyBoundary("dirichlet");
+  }
+  return result;
+}
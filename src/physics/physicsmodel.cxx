@@ -32,10 +32,14 @@
 
 PhysicsModel::PhysicsModel()
     : solver(nullptr), modelMonitor(this), splitop(false), userprecon(nullptr),
-      userjacobian(nullptr), initialised(false) {
+      blockprecon(nullptr), userjacobian(nullptr), initialised(false) {
 
   // Set up restart file
   restart = Datafile(Options::getRoot()->getSection("restart"));
+
+  if (Diagnostics::isEnabled()) {
+    diagnostics = std::unique_ptr<Diagnostics>(new Diagnostics());
+  }
 }
 
 PhysicsModel::~PhysicsModel() {
@@ -57,12 +61,24 @@ int PhysicsModel::runDiffusive(BoutReal time, bool linear) {
   return diffusive(time, linear);
 }
 
-bool PhysicsModel::hasPrecon() { return (userprecon != nullptr); }
+bool PhysicsModel::hasPrecon() { return (userprecon != nullptr) || (blockprecon != nullptr); }
 
 int PhysicsModel::runPrecon(BoutReal t, BoutReal gamma, BoutReal delta) {
-  if(!userprecon)
-    return 1;
-  return (*this.*userprecon)(t, gamma, delta);
+  if (userprecon) {
+    return (*this.*userprecon)(t, gamma, delta);
+  }
+  if (blockprecon) {
+    return blockprecon->apply(t, gamma, delta);
+  }
+  return 1;
+}
+
+void PhysicsModel::setPrecon(BlockPreconditioner &precon) {
+  blockprecon = &precon;
+  if (solver) {
+    // Report statistics at each output
+    solver->addMonitor(blockprecon, Solver::BACK);
+  }
 }
 
 bool PhysicsModel::hasJacobian() { return (userjacobian != nullptr); }
@@ -90,6 +106,17 @@ void PhysicsModel::bout_solve(Vector3D &var, const char *name) {
   solver->add(var, name);
 }
 
+int PhysicsModel::PhysicsModelMonitor::call(Solver *solver, BoutReal simtime, int iter,
+                                             int nout) {
+  // Save state to restart file, unless this is done by checkpoints
+  if (!model->checkpoint) {
+    solver->saveHistory();
+    model->restart.write();
+  }
+  // Call user output monitor
+  return model->outputMonitor(simtime, iter, nout);
+}
+
 int PhysicsModel::postInit(bool restarting) {
   TRACE("PhysicsModel::postInit");
   
@@ -116,12 +143,22 @@ int PhysicsModel::postInit(bool restarting) {
   if (restarting) {
     output.write("Loading restart file: %s\n", filename.c_str());
 
-    /// Load restart file
-    if (!restart.openr("%s",filename.c_str()))
-      throw BoutException("Error: Could not open restart file\n");
-    if (!restart.read())
-      throw BoutException("Error: Could not read restart file\n");
+    if (restart.decompositionChanged("%s", filename.c_str())) {
+      /// Restart files from a different number of processors
+      output.write("\tProcessor layout has changed. Redistributing restart data\n");
+      if (!restart.readRedistributed("%s", filename.c_str()))
+        throw BoutException("Error: Could not read restart file\n");
+    } else {
+      /// Load restart file
+      if (!restart.openr("%s",filename.c_str()))
+        throw BoutException("Error: Could not open restart file\n");
+      if (!restart.read())
+        throw BoutException("Error: Could not read restart file\n");
+    }
     restart.close();
+
+    // Internal state of the solver, if it was saved
+    solver->readHistory(filename);
   }
 
   // Add mesh information to restart file
@@ -130,10 +167,38 @@ int PhysicsModel::postInit(bool restarting) {
   mesh->outputVars(restart);
   // Version expected by collect routine
   restart.addOnce(const_cast<BoutReal &>(BOUT_VERSION), "BOUT_VERSION");
+  // Solver history, read separately as older files don't have it
+  solver->outputHistory(restart);
+
+  if (Checkpoint::isEnabled()) {
+    // Restart files are written as separate checkpoints,
+    // so the existing restart file is not opened for writing
+    checkpoint = std::unique_ptr<Checkpoint>(new Checkpoint(restart, restart_dir, restart_ext));
+    solver->addMonitor(checkpoint.get());
+  } else {
+    /// Open the restart file for writing
+    if (!restart.openw("%s",filename.c_str()))
+      throw BoutException("Error: Could not open restart file for writing\n");
+  }
 
-  /// Open the restart file for writing
-  if (!restart.openw("%s",filename.c_str()))
-    throw BoutException("Error: Could not open restart file for writing\n");
+  if (diagnostics) {
+    // Evolving variables listed in the options
+    for (const auto &name : diagnostics->getFieldNames()) {
+      Field3D *var = solver->getField3D(name);
+      if (var == nullptr) {
+        throw BoutException("Diagnostics: '%s' is not an evolving 3D variable",
+                            name.c_str());
+      }
+      diagnostics->add(*var, name);
+    }
+
+    string data_dir;
+    bool append;
+    options->get("datadir", data_dir, "data");
+    options->get("append", append, false);
+    diagnostics->open(data_dir + "/BOUT.diag." + dump_ext, append);
+    solver->addMonitor(diagnostics.get());
+  }
 
   // Add monitor to the solver which calls restart.write() and
   // PhysicsModel::outputMonitor()
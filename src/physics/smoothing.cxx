@@ -39,6 +39,8 @@
 
 #include <utils.hxx>
 #include <bout/constants.hxx>
+#include <bout/openmpwrap.hxx>
+#include <bout/surfaceaverage.hxx>
 
 // Smooth using simple 1-2-1 filter
 const Field3D smooth_x(const Field3D &f) {
@@ -100,8 +102,6 @@ const Field3D smooth_y(const Field3D &f) {
 
   Issues
   ======
-  
-  Assumes every processor has the same domain shape
 
   Will only work if X communicator is constant in Y
   so no processor/branch cuts in X
@@ -113,37 +113,32 @@ const Field2D averageX(const Field2D &f) {
   int ngx = mesh->LocalNx;
   int ngy = mesh->LocalNy;
 
-  Array<BoutReal> input(ngy), result(ngy);
-  
-  // Average on this processor
-  for(int y=0;y<ngy;y++) {
+  // Sums and the number of points, reduced together
+  Array<BoutReal> input(ngy + 1), result(ngy + 1);
+
+  // Sum on this processor, not including boundaries
+  BOUT_OMP(parallel for)
+  for (int y = 0; y < ngy; y++) {
     input[y] = 0.;
-    // Sum values, not including boundaries
-    for(int x=mesh->xstart;x<=mesh->xend;x++) {
-      input[y] += f(x,y);
+    for (int x = mesh->xstart; x <= mesh->xend; x++) {
+      input[y] += f(x, y);
     }
-    input[y] /= (mesh->xend - mesh->xstart + 1);
   }
+  input[ngy] = mesh->xend - mesh->xstart + 1;
+
+  MPI_Allreduce(std::begin(input), std::begin(result), ngy + 1, MPI_DOUBLE, MPI_SUM,
+                mesh->getXcomm());
 
   Field2D r(mesh);
   r.allocate();
 
-  MPI_Comm comm_x = mesh->getXcomm();
-
-  int np;
-  MPI_Comm_size(comm_x, &np);
-  
-  if(np == 1) {
-    for(int x=0;x<ngx;x++)
-      for(int y=0;y<ngy;y++)
-        r(x,y) = input[y];
-  }else {
-    MPI_Allreduce(input.begin(), result.begin(), ngy, MPI_DOUBLE, MPI_SUM, comm_x);
-    for(int x=0;x<ngx;x++)
-      for(int y=0;y<ngy;y++)
-        r(x,y) = result[y] / static_cast<BoutReal>(np);
+  BOUT_OMP(parallel for)
+  for (int x = 0; x < ngx; x++) {
+    for (int y = 0; y < ngy; y++) {
+      r(x, y) = result[y] / result[ngy];
+    }
   }
-  
+
   return r;
 }
 
@@ -152,15 +147,9 @@ const Field2D averageX(const Field2D &f) {
   Issues
   ======
 
-  Creates static arrays
-  
-  Not thread safe
-  
-  Assumes every processor has the same domain shape
-  
   Will only work if X communicator is constant in Y
   so no processor/branch cuts in X
-  
+
  */
 const Field3D averageX(const Field3D &f) {
   TRACE("averageX(Field3D)");
@@ -171,136 +160,57 @@ const Field3D averageX(const Field3D &f) {
   int ngy = mesh->LocalNy;
   int ngz = mesh->LocalNz;
 
-  auto input = Matrix<BoutReal>(ngy, ngz);
-  auto result = Matrix<BoutReal>(ngy, ngz);
+  // Sums and the number of points, reduced together
+  Array<BoutReal> input(ngy * ngz + 1), result(ngy * ngz + 1);
 
-  // Average on this processor
-  for(int y=0;y<ngy;y++)
-    for(int z=0;z<ngz;z++) {
-      input(y, z) = 0.;
-      // Sum values, not including boundaries
-      for(int x=mesh->xstart;x<=mesh->xend;x++) {
-        input(y, z) += f(x, y, z);
+  // Sum on this processor, not including boundaries
+  BOUT_OMP(parallel for)
+  for (int y = 0; y < ngy; y++) {
+    BoutReal *sum = &input[y * ngz];
+    for (int z = 0; z < ngz; z++) {
+      sum[z] = 0.;
+    }
+    for (int x = mesh->xstart; x <= mesh->xend; x++) {
+      const BoutReal *fxy = f(x, y);
+      for (int z = 0; z < ngz; z++) {
+        sum[z] += fxy[z];
       }
-      input(y, z) /= (mesh->xend - mesh->xstart + 1);
     }
+  }
+  input[ngy * ngz] = mesh->xend - mesh->xstart + 1;
+
+  MPI_Allreduce(std::begin(input), std::begin(result), ngy * ngz + 1, MPI_DOUBLE,
+                MPI_SUM, mesh->getXcomm());
 
   Field3D r(mesh);
   r.allocate();
-  
-  MPI_Comm comm_x = mesh->getXcomm();
- 
-  int np;
-  MPI_Comm_size(comm_x, &np);
-  if(np > 1) {
-    MPI_Allreduce(std::begin(input), std::begin(result), ngy*ngz, MPI_DOUBLE, MPI_SUM, comm_x);
-    
-    for(int x=0;x<ngx;x++)
-      for(int y=0;y<ngy;y++)
-        for(int z=0;z<ngz;z++) {
-          r(x, y, z) = result(y, z) / static_cast<BoutReal>(np);
-        }
-  }else {
-    for(int x=0;x<ngx;x++)
-      for(int y=0;y<ngy;y++)
-        for(int z=0;z<ngz;z++) {
-          r(x, y, z) = input(y, z);
-        }
-  }
-  
-  return r;
-}
-
-const Field2D averageY(const Field2D &f) {
-  TRACE("averageY(Field2D)");
 
-  Mesh *mesh = f.getMesh();
-  int ngx = mesh->LocalNx;
-  int ngy = mesh->LocalNy;
+  const BoutReal npoints = result[ngy * ngz];
 
-  Array<BoutReal> input(ngx), result(ngx);
-  
-  // Average on this processor
-  for(int x=0;x<ngx;x++) {
-    input[x] = 0.;
-    // Sum values, not including boundaries
-    for(int y=mesh->ystart;y<=mesh->yend;y++) {
-      input[x] += f(x,y);
+  BOUT_OMP(parallel for)
+  for (int x = 0; x < ngx; x++) {
+    for (int y = 0; y < ngy; y++) {
+      for (int z = 0; z < ngz; z++) {
+        r(x, y, z) = result[y * ngz + z] / npoints;
+      }
     }
-    input[x] /= (mesh->yend - mesh->ystart + 1);
   }
 
-  Field2D r(mesh);
-  r.allocate();
+  return r;
+}
 
-  /// NOTE: This only works if there are no branch-cuts
-  MPI_Comm comm_inner = mesh->getYcomm(0);
-  
-  int np;
-  MPI_Comm_size(comm_inner, &np);
-  
-  if(np == 1) {
-    for(int x=0;x<ngx;x++)
-      for(int y=0;y<ngy;y++)
-        r(x,y) = input[x];
-  }else {
-    MPI_Allreduce(input.begin(), result.begin(), ngx, MPI_DOUBLE, MPI_SUM, comm_inner);
-    for(int x=0;x<ngx;x++)
-      for(int y=0;y<ngy;y++)
-        r(x,y) = result[x] / static_cast<BoutReal>(np);
-  }
+const Field2D averageY(const Field2D &f) {
+  TRACE("averageY(Field2D)");
 
-  return r;
+  SurfaceAverage surface(f.getMesh());
+  return surface.averageY(f);
 }
 
 const Field3D averageY(const Field3D &f) {
   TRACE("averageY(Field3D)");
 
-  Mesh *mesh = f.getMesh();
-
-  int ngx = mesh->LocalNx;
-  int ngy = mesh->LocalNy;
-  int ngz = mesh->LocalNz;
-
-  auto input = Matrix<BoutReal>(ngx, ngz);
-  auto result = Matrix<BoutReal>(ngx, ngz);
-
-  // Average on this processor
-  for(int x=0;x<ngx;x++)
-    for(int z=0;z<ngz;z++) {
-      input(x, z) = 0.;
-      // Sum values, not including boundaries
-      for(int y=mesh->ystart;y<=mesh->yend;y++) {
-        input(x, z) += f(x, y, z);
-      }
-      input(x, z) /= (mesh->yend - mesh->ystart + 1);
-    }
-
-  Field3D r(mesh);
-  r.allocate();
-
-  /// NOTE: This only works if there are no branch-cuts
-  MPI_Comm comm_inner = mesh->getYcomm(0);
-  
-  int np;
-  MPI_Comm_size(comm_inner, &np);
-  if(np > 1) {
-    MPI_Allreduce(std::begin(input), std::begin(result), ngx*ngz, MPI_DOUBLE, MPI_SUM, comm_inner);
-    
-    for(int x=0;x<ngx;x++)
-      for(int y=0;y<ngy;y++)
-        for(int z=0;z<ngz;z++) {
-          r(x, y, z) = result(x, z) / static_cast<BoutReal>(np);
-        }
-  }else {
-    for(int x=0;x<ngx;x++)
-      for(int y=0;y<ngy;y++)
-        for(int z=0;z<ngz;z++) {
-          r(x, y, z) = input(x, z);
-        }
-  }
-  
-  return r;
+  SurfaceAverage surface(f.getMesh());
+  return surface.averageY(f);
 }
 
 
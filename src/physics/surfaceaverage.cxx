@@ -0,0 +1,275 @@
+/**************************************************************************
+ * Averages over Y, and flux-surface averages
+ *
+ **************************************************************************
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <bout/surfaceaverage.hxx>
+
+#include <bout/openmpwrap.hxx>
+#include <boutexception.hxx>
+#include <globals.hxx>
+#include <msg_stack.hxx>
+
+#include <algorithm>
+
+SurfaceAverage::SurfaceAverage(Mesh *mesh_in)
+    : localmesh(mesh_in == nullptr ? mesh : mesh_in) {
+  // Group X indices by the communicator of their surface. This only
+  // changes at the separatrices, so there are at most a few groups
+  for (int x = 0; x < localmesh->LocalNx; x++) {
+    MPI_Comm comm = localmesh->getYcomm(x);
+    if (!groups.empty() && (groups.back().comm == comm)) {
+      groups.back().xe = x;
+    } else {
+      groups.push_back({comm, x, x});
+    }
+  }
+}
+
+SurfaceAverage::~SurfaceAverage() {
+  // Outstanding requests must complete before the buffers are freed
+  for (auto &r : pending) {
+    if (!r.requests.empty()) {
+      MPI_Waitall(r.requests.size(), r.requests.data(), MPI_STATUSES_IGNORE);
+    }
+  }
+}
+
+const Field2D SurfaceAverage::averageY(const Field2D &f) {
+  Field2D result(localmesh);
+  startY(f, result);
+  wait();
+  return result;
+}
+
+const Field3D SurfaceAverage::averageY(const Field3D &f) {
+  Field3D result(localmesh);
+  startY(f, result);
+  wait();
+  return result;
+}
+
+const Field2D SurfaceAverage::fluxAverage(const Field2D &f) {
+  Field2D result(localmesh);
+  startFlux(f, result);
+  wait();
+  return result;
+}
+
+const Field2D SurfaceAverage::fluxAverage(const Field3D &f) {
+  Field2D result(localmesh);
+  startFlux(f, result);
+  wait();
+  return result;
+}
+
+void SurfaceAverage::startY(const Field2D &f, Field2D &result) {
+  TRACE("SurfaceAverage::startY(Field2D)");
+  pending.push_back(sumY(f, false));
+  pending.back().result2d = &result;
+  start(pending.back());
+}
+
+void SurfaceAverage::startY(const Field3D &f, Field3D &result) {
+  TRACE("SurfaceAverage::startY(Field3D)");
+  pending.push_back(sumY(f, false));
+  pending.back().result3d = &result;
+  start(pending.back());
+}
+
+void SurfaceAverage::startFlux(const Field2D &f, Field2D &result) {
+  TRACE("SurfaceAverage::startFlux(Field2D)");
+  pending.push_back(sumY(f, true));
+  pending.back().result2d = &result;
+  start(pending.back());
+}
+
+void SurfaceAverage::startFlux(const Field3D &f, Field2D &result) {
+  TRACE("SurfaceAverage::startFlux(Field3D)");
+  pending.push_back(sumY(f, true));
+  pending.back().result2d = &result;
+  start(pending.back());
+}
+
+SurfaceAverage::Reduction SurfaceAverage::sumY(const Field2D &f, bool weighted) {
+  ASSERT1(f.isAllocated());
+
+  const int nx = localmesh->LocalNx;
+  const int ys = localmesh->ystart, ye = localmesh->yend;
+
+  Reduction r{1, Array<BoutReal>(2 * nx), Array<BoutReal>(2 * nx), {}, nullptr, nullptr};
+
+  if (weighted) {
+    const Array<BoutReal> &vol = getVolume();
+    Coordinates *coord = localmesh->coordinates();
+
+    BOUT_OMP(parallel for)
+    for (int x = 0; x < nx; x++) {
+      BoutReal sum = 0.0;
+      for (int y = ys; y <= ye; y++) {
+        sum += f(x, y) * coord->J(x, y) * coord->dy(x, y);
+      }
+      r.local[2 * x] = sum;
+      r.local[2 * x + 1] = vol[x];
+    }
+  } else {
+    BOUT_OMP(parallel for)
+    for (int x = 0; x < nx; x++) {
+      BoutReal sum = 0.0;
+      for (int y = ys; y <= ye; y++) {
+        sum += f(x, y);
+      }
+      r.local[2 * x] = sum;
+      r.local[2 * x + 1] = ye - ys + 1;
+    }
+  }
+  return r;
+}
+
+SurfaceAverage::Reduction SurfaceAverage::sumY(const Field3D &f, bool weighted) {
+  ASSERT1(f.isAllocated());
+
+  const int nx = localmesh->LocalNx;
+  const int nz = localmesh->LocalNz;
+  const int ys = localmesh->ystart, ye = localmesh->yend;
+
+  // Flux-surface averages also average over Z, so need one value for each X
+  const int nvals = weighted ? 1 : nz;
+  const int stride = nvals + 1;
+
+  Reduction r{nvals, Array<BoutReal>(nx * stride), Array<BoutReal>(nx * stride), {},
+              nullptr, nullptr};
+
+  if (weighted) {
+    const Array<BoutReal> &vol = getVolume();
+    Coordinates *coord = localmesh->coordinates();
+
+    BOUT_OMP(parallel for)
+    for (int x = 0; x < nx; x++) {
+      BoutReal sum = 0.0;
+      for (int y = ys; y <= ye; y++) {
+        const BoutReal *fxy = f(x, y);
+        BoutReal zsum = 0.0;
+        for (int z = 0; z < nz; z++) {
+          zsum += fxy[z];
+        }
+        // dz is constant, so only J*dy is needed
+        sum += zsum * coord->J(x, y) * coord->dy(x, y);
+      }
+      r.local[stride * x] = sum / nz;
+      r.local[stride * x + 1] = vol[x];
+    }
+  } else {
+    BOUT_OMP(parallel for)
+    for (int x = 0; x < nx; x++) {
+      BoutReal *sum = &r.local[stride * x];
+      std::fill(sum, sum + nz, 0.0);
+      for (int y = ys; y <= ye; y++) {
+        const BoutReal *fxy = f(x, y);
+        for (int z = 0; z < nz; z++) {
+          sum[z] += fxy[z];
+        }
+      }
+      sum[nz] = ye - ys + 1;
+    }
+  }
+  return r;
+}
+
+void SurfaceAverage::start(Reduction &r) {
+  const int stride = r.nvals + 1;
+
+  for (const auto &g : groups) {
+    BoutReal *in = &r.local[stride * g.xs];
+    BoutReal *out = &r.global[stride * g.xs];
+    const int n = stride * (g.xe - g.xs + 1);
+
+    if (g.comm == MPI_COMM_NULL) {
+      // Not split in Y
+      std::copy(in, in + n, out);
+      continue;
+    }
+#if MPI_VERSION >= 3
+    MPI_Request request;
+    MPI_Iallreduce(in, out, n, MPI_DOUBLE, MPI_SUM, g.comm, &request);
+    r.requests.push_back(request);
+#else
+    MPI_Allreduce(in, out, n, MPI_DOUBLE, MPI_SUM, g.comm);
+#endif
+  }
+}
+
+void SurfaceAverage::wait() {
+  TRACE("SurfaceAverage::wait");
+
+  const int nx = localmesh->LocalNx;
+  const int ny = localmesh->LocalNy;
+
+  for (auto &r : pending) {
+    if (!r.requests.empty()) {
+      MPI_Waitall(r.requests.size(), r.requests.data(), MPI_STATUSES_IGNORE);
+    }
+
+    const int stride = r.nvals + 1;
+
+    if (r.result3d != nullptr) {
+      Field3D result(localmesh);
+      result.allocate();
+
+      BOUT_OMP(parallel for)
+      for (int x = 0; x < nx; x++) {
+        const BoutReal *sum = &r.global[stride * x];
+        for (int y = 0; y < ny; y++) {
+          for (int z = 0; z < r.nvals; z++) {
+            result(x, y, z) = sum[z] / sum[r.nvals];
+          }
+        }
+      }
+      *r.result3d = result;
+    } else {
+      Field2D result(localmesh);
+      result.allocate();
+
+      BOUT_OMP(parallel for)
+      for (int x = 0; x < nx; x++) {
+        const BoutReal avg = r.global[2 * x] / r.global[2 * x + 1];
+        for (int y = 0; y < ny; y++) {
+          result(x, y) = avg;
+        }
+      }
+      *r.result2d = result;
+    }
+  }
+  pending.clear();
+}
+
+const Array<BoutReal> &SurfaceAverage::getVolume() {
+  if (volume.empty()) {
+    Coordinates *coord = localmesh->coordinates();
+
+    volume = Array<BoutReal>(localmesh->LocalNx);
+    for (int x = 0; x < localmesh->LocalNx; x++) {
+      volume[x] = 0.0;
+      for (int y = localmesh->ystart; y <= localmesh->yend; y++) {
+        volume[x] += coord->J(x, y) * coord->dy(x, y);
+      }
+    }
+  }
+  return volume;
+}
@@ -0,0 +1,623 @@
+#include "bdf.hxx"
+
+#include <boutcomm.hxx>
+#include <utils.hxx>
+#include <boutexception.hxx>
+#include <msg_stack.hxx>
+#include <bout/openmpwrap.hxx>
+
+#include <algorithm>
+#include <cmath>
+
+#include <output.hxx>
+
+BDFSolver::BDFSolver(Options *options) : Solver(options) { canReset = true; }
+
+void BDFSolver::setMaxTimestep(BoutReal dt) {
+  if (dt > timestep)
+    return; // Already less than this
+
+  timestep = dt; // Won't be used this time, but next
+}
+
+int BDFSolver::init(int nout, BoutReal tstep) {
+
+  TRACE("Initialising BDF solver");
+
+  /// Call the generic initialisation first
+  if (Solver::init(nout, tstep))
+    return 1;
+
+  output << "\n\tBDF solver with Jacobian-free Newton-Krylov iterations\n";
+
+  nsteps = nout; // Save number of output steps
+  out_timestep = tstep;
+  max_dt = tstep;
+
+  // Calculate number of variables
+  nlocal = getLocalN();
+
+  // Get total problem size
+  int ntmp;
+  if (MPI_Allreduce(&nlocal, &ntmp, 1, MPI_INT, MPI_SUM, BoutComm::get())) {
+    throw BoutException("MPI_Allreduce failed!");
+  }
+  neq = ntmp;
+
+  output.write("\t3d fields = %d, 2d fields = %d neq=%d, local_N=%d\n", n3Dvars(),
+               n2Dvars(), neq, nlocal);
+
+  // Get options
+  OPTION(options, atol, 1.e-12);        // Absolute tolerance
+  OPTION(options, rtol, 1.e-5);         // Relative tolerance
+  OPTION(options, max_timestep, tstep); // Maximum timestep
+  OPTION(options, min_timestep, 1e-10 * tstep);
+  OPTION(options, timestep, -1.);       // Starting timestep. Estimated if negative
+  OPTION(options, mxstep, 500);         // Maximum number of steps between outputs
+  OPTION(options, max_order, 5);
+
+  OPTION(options, max_nonlinear_it, 4);
+  OPTION(options, newton_tol, 0.1);
+  OPTION(options, maxl, 20);
+  OPTION(options, max_restarts, 2);
+  OPTION(options, linear_rtol, 0.05);
+  OPTION(options, use_precon, false);
+  OPTION(options, diagnose, false);
+
+  if ((max_order < 1) || (max_order > 5)) {
+    throw BoutException("BDF solver: max_order must be between 1 and 5 (got %d)",
+                        max_order);
+  }
+  if (maxl < 1) {
+    throw BoutException("BDF solver: maxl must be at least 1 (got %d)", maxl);
+  }
+  if (use_precon && !have_user_precon()) {
+    output_warn.write("\tWARNING: use_precon set, but no preconditioner supplied\n");
+    use_precon = false;
+  }
+  output.write("\tMaximum order %d, %s preconditioner\n", max_order,
+               use_precon ? "user" : "no");
+
+  // Allocate memory
+  history.resize(max_order + 2);
+  for (auto &h : history) {
+    h = Array<BoutReal>(nlocal);
+  }
+  history_time.resize(max_order + 2);
+
+  fstart = Array<BoutReal>(nlocal);
+  y = Array<BoutReal>(nlocal);
+  ypred = Array<BoutReal>(nlocal);
+  rhs = Array<BoutReal>(nlocal);
+  f0 = Array<BoutReal>(nlocal);
+  f1 = Array<BoutReal>(nlocal);
+  residual = Array<BoutReal>(nlocal);
+  dy = Array<BoutReal>(nlocal);
+  weights = Array<BoutReal>(nlocal);
+  work = Array<BoutReal>(nlocal);
+
+  krylov.resize(maxl + 1);
+  for (auto &v : krylov) {
+    v = Array<BoutReal>(nlocal);
+  }
+  if (use_precon) {
+    precon_krylov.resize(maxl);
+    for (auto &v : precon_krylov) {
+      v = Array<BoutReal>(nlocal);
+    }
+  }
+  hessenberg = Matrix<BoutReal>(maxl + 1, maxl);
+  givens_c = Array<BoutReal>(maxl);
+  givens_s = Array<BoutReal>(maxl);
+  gmres_g = Array<BoutReal>(maxl + 1);
+  gmres_y = Array<BoutReal>(maxl);
+
+  nsteps_total = nfail_error = nfail_newton = nnewton = nlinear = nrhs = 0;
+
+  // Put starting values into the history
+  save_vars(std::begin(history[0]));
+  resetHistory();
+
+  if (timestep <= 0.0) {
+    // Choose a first step which changes the state by about the tolerance
+    setWeights(history[0]);
+    BoutReal fnorm = wrmsNorm(fstart);
+    timestep = (fnorm > 0.0) ? 0.1 / fnorm : max_timestep;
+  }
+  timestep = std::min(timestep, max_timestep);
+
+  return 0;
+}
+
+int BDFSolver::run() {
+  TRACE("BDFSolver::run()");
+
+  for (int s = 0; s < nsteps; s++) {
+    BoutReal target = simtime + out_timestep;
+
+    bool running = true;
+    int internal_steps = 0;
+    int failures = 0; // Consecutive failures of the current step
+    while (running) {
+      BoutReal dt = timestep;
+      bool last_step = false;
+      if ((simtime + dt) >= target) {
+        dt = target - simtime; // Make sure the last timestep is on the output
+        last_step = true;
+      }
+
+      internal_steps++;
+      if (internal_steps > mxstep) {
+        throw BoutException("ERROR: MXSTEP exceeded. timestep = %e, order = %d\n",
+                            timestep, order);
+      }
+
+      if (!takeStep(dt)) {
+        // Newton iteration didn't converge
+        nfail_newton++;
+        failures++;
+        timestep = 0.25 * dt;
+        if (timestep < min_timestep) {
+          throw BoutException("BDF solver: Newton iteration failed with timestep %e",
+                              dt);
+        }
+        continue;
+      }
+
+      // Estimate the local error from the difference to the predictor
+      const int degree = (nhistory == 1) ? 0 : order;
+      BOUT_OMP(parallel for)
+      for (int i = 0; i < nlocal; i++) {
+        work[i] = y[i] - ypred[i];
+      }
+      BoutReal err = wrmsNorm(work) * errorConstant(degree, simtime + dt);
+
+      if (err > 1.0) {
+        // Reject the step
+        nfail_error++;
+        failures++;
+        timestep = dt * std::max(0.2, 0.9 * pow(err, -1. / (order + 1)));
+        if ((failures >= 2) && (order > 1)) {
+          order--;
+          steps_at_order = 0;
+        }
+        if (timestep < min_timestep) {
+          throw BoutException("BDF solver: error test failed with timestep %e, err=%e",
+                              dt, err);
+        }
+        continue;
+      }
+
+      // Accept the step. Choose the next timestep, and possibly order
+      BoutReal eta = 1. / (1.2 * pow(err, 1. / (order + 1)) + 1e-6);
+      int new_order = order;
+
+      if ((steps_at_order > order) && (failures == 0)) {
+        if (order > 1) {
+          // Error if the order were reduced
+          predict(order - 1, simtime + dt, work);
+          BOUT_OMP(parallel for)
+          for (int i = 0; i < nlocal; i++) {
+            work[i] = y[i] - work[i];
+          }
+          BoutReal err_lower =
+              wrmsNorm(work) * errorConstant(order - 1, simtime + dt);
+          BoutReal eta_lower = 1. / (1.3 * pow(err_lower, 1. / order) + 1e-6);
+          if (eta_lower > eta) {
+            eta = eta_lower;
+            new_order = order - 1;
+          }
+        }
+        if ((order < max_order) && (nhistory > order + 1)) {
+          // Error if the order were increased
+          predict(order + 1, simtime + dt, work);
+          BOUT_OMP(parallel for)
+          for (int i = 0; i < nlocal; i++) {
+            work[i] = y[i] - work[i];
+          }
+          BoutReal err_higher =
+              wrmsNorm(work) * errorConstant(order + 1, simtime + dt);
+          BoutReal eta_higher = 1. / (1.4 * pow(err_higher, 1. / (order + 2)) + 1e-6);
+          if (eta_higher > eta) {
+            eta = eta_higher;
+            new_order = order + 1;
+          }
+        }
+      }
+
+      // Don't grow the step straight after a failure
+      eta = std::min(eta, (failures > 0) ? 1.0 : 10.0);
+      eta = std::max(eta, 0.2);
+
+      // Add the new state to the history. The oldest is overwritten
+      std::rotate(history.begin(), history.end() - 1, history.end());
+      std::rotate(history_time.begin(), history_time.end() - 1, history_time.end());
+      swap(history[0], y);
+      history_time[0] = simtime + dt;
+      nhistory = std::min(nhistory + 1, max_order + 2);
+
+      simtime += dt;
+      nsteps_total++;
+      failures = 0;
+
+      if (new_order != order) {
+        order = new_order;
+        steps_at_order = 0;
+      } else {
+        steps_at_order++;
+      }
+
+      running = !last_step;
+      if (running) {
+        timestep = dt * eta;
+      } else {
+        // Last step was shortened to reach the output time
+        timestep = std::max(timestep, dt * eta);
+      }
+      timestep = std::min(timestep, max_timestep);
+
+      call_timestep_monitors(simtime, dt);
+    }
+
+    if (diagnose) {
+      output.write("\nBDF: steps %d, order %d, timestep %e, error test failures %d, "
+                   "Newton failures %d\n"
+                   "     Newton iterations %d, linear iterations %d, RHS evaluations "
+                   "%d\n",
+                   nsteps_total, order, timestep, nfail_error, nfail_newton, nnewton,
+                   nlinear, nrhs);
+    }
+
+    load_vars(std::begin(history[0])); // Put result into variables
+    // Call rhs function to get extra variables at this time
+    run_rhs(simtime);
+
+    iteration++; // Advance iteration number
+
+    /// Call the monitor function
+
+    if (call_monitors(simtime, s, nsteps)) {
+      break; // Stop simulation
+    }
+  }
+
+  return 0;
+}
+
+void BDFSolver::resetInternalFields() {
+  // Copy fields into current step, and forget the history
+  save_vars(std::begin(history[0]));
+  resetHistory();
+}
+
+void BDFSolver::resetHistory() {
+  history_time[0] = simtime;
+  nhistory = 1;
+  order = 1;
+  steps_at_order = 0;
+
+  // Time derivative for the first predictor
+  evaluateRHS(simtime, history[0], fstart);
+}
+
+void BDFSolver::predict(int degree, BoutReal t, Array<BoutReal> &result) {
+  if (nhistory == 1) {
+    // Only one point, so extrapolate using the time derivative
+    const BoutReal dt = t - history_time[0];
+    BOUT_OMP(parallel for)
+    for (int i = 0; i < nlocal; i++) {
+      result[i] = history[0][i] + dt * fstart[i];
+    }
+    return;
+  }
+
+  ASSERT1(degree < nhistory);
+
+  // Lagrange polynomial through the newest degree+1 points
+  BoutReal coefs[7];
+  for (int j = 0; j <= degree; j++) {
+    coefs[j] = 1.0;
+    for (int k = 0; k <= degree; k++) {
+      if (k != j) {
+        coefs[j] *= (t - history_time[k]) / (history_time[j] - history_time[k]);
+      }
+    }
+  }
+
+  BOUT_OMP(parallel for)
+  for (int i = 0; i < nlocal; i++) {
+    BoutReal val = 0.0;
+    for (int j = 0; j <= degree; j++) {
+      val += coefs[j] * history[j][i];
+    }
+    result[i] = val;
+  }
+}
+
+BoutReal BDFSolver::errorConstant(int degree, BoutReal t) {
+  if (nhistory == 1) {
+    // Difference between backward and forward Euler
+    return 0.5;
+  }
+  // 1 / (degree + 1) for constant timesteps
+  return (t - history_time[0]) / (t - history_time[degree]);
+}
+
+bool BDFSolver::takeStep(BoutReal dt) {
+  TRACE("BDFSolver::takeStep");
+
+  implicit_time = simtime + dt;
+
+  // BDF coefficients from differentiating the polynomial through the
+  // new point and the last order points, at the new time
+  // alpha_0 y + sum_j alpha_j y_j = f(t, y)
+  BoutReal alpha[6];
+  alpha[0] = 0.0;
+  for (int k = 0; k < order; k++) {
+    alpha[0] += 1. / (implicit_time - history_time[k]);
+  }
+  for (int j = 0; j < order; j++) {
+    // Derivative of the Lagrange polynomial for history[j]
+    BoutReal num = 1.0, den = history_time[j] - implicit_time;
+    for (int k = 0; k < order; k++) {
+      if (k != j) {
+        num *= implicit_time - history_time[k];
+        den *= history_time[j] - history_time[k];
+      }
+    }
+    alpha[j + 1] = num / den;
+  }
+
+  gamma = 1. / alpha[0];
+  BOUT_OMP(parallel for)
+  for (int i = 0; i < nlocal; i++) {
+    BoutReal val = 0.0;
+    for (int j = 0; j < order; j++) {
+      val -= alpha[j + 1] * history[j][i];
+    }
+    rhs[i] = gamma * val;
+  }
+
+  // Starting guess from extrapolating the history
+  predict((nhistory == 1) ? 0 : order, implicit_time, ypred);
+  std::copy(std::begin(ypred), std::end(ypred), std::begin(y));
+
+  setWeights(history[0]);
+
+  return solveImplicit();
+}
+
+bool BDFSolver::solveImplicit() {
+  TRACE("BDFSolver::solveImplicit");
+
+  BoutReal last_update = 0.0;
+  for (int it = 0; it < max_nonlinear_it; it++) {
+    evaluateRHS(implicit_time, y, f0);
+
+    // Newton step solves (I - gamma J) dy = -(y - gamma f - rhs)
+    BOUT_OMP(parallel for)
+    for (int i = 0; i < nlocal; i++) {
+      residual[i] = rhs[i] + gamma * f0[i] - y[i];
+    }
+    state_norm = sqrt(dot(y, y));
+
+    BoutReal rnorm = sqrt(dot(residual, residual));
+    if (rnorm == 0.0) {
+      return true;
+    }
+
+    for (auto &val : dy) {
+      val = 0.0;
+    }
+    nlinear += gmres(f0, residual, dy, linear_rtol * rnorm);
+    nnewton++;
+
+    BOUT_OMP(parallel for)
+    for (int i = 0; i < nlocal; i++) {
+      y[i] += dy[i];
+    }
+
+    BoutReal update = wrmsNorm(dy);
+    if (update <= newton_tol) {
+      return true;
+    }
+    if ((it > 0) && (update > 2. * last_update)) {
+      // Diverging
+      return false;
+    }
+    last_update = update;
+  }
+  return false;
+}
+
+int BDFSolver::gmres(const Array<BoutReal> &fy, const Array<BoutReal> &b,
+                     Array<BoutReal> &x, BoutReal tol) {
+  TRACE("BDFSolver::gmres");
+
+  int iterations = 0;
+  for (int restart = 0; restart <= max_restarts; restart++) {
+    // Residual r = b - A x, in the first Krylov vector
+    Array<BoutReal> &r = krylov[0];
+    if (restart == 0) {
+      // Starting from x = 0
+      std::copy(std::begin(b), std::end(b), std::begin(r));
+    } else {
+      jacobianVector(fy, x, r);
+      BOUT_OMP(parallel for)
+      for (int i = 0; i < nlocal; i++) {
+        r[i] = b[i] - r[i];
+      }
+    }
+    const BoutReal beta = sqrt(dot(r, r));
+    if (beta <= tol) {
+      break;
+    }
+    BOUT_OMP(parallel for)
+    for (int i = 0; i < nlocal; i++) {
+      r[i] /= beta;
+    }
+
+    gmres_g[0] = beta;
+    for (int i = 1; i <= maxl; i++) {
+      gmres_g[i] = 0.0;
+    }
+
+    int k = 0; // Size of the Krylov space
+    bool converged = false;
+    while (k < maxl) {
+      // New vector w = A M^{-1} v_k
+      Array<BoutReal> &z = use_precon ? precon_krylov[k] : krylov[k];
+      if (use_precon) {
+        precondition(krylov[k], z);
+      }
+      Array<BoutReal> &w = krylov[k + 1];
+      jacobianVector(fy, z, w);
+      iterations++;
+
+      // Modified Gram-Schmidt
+      for (int j = 0; j <= k; j++) {
+        const BoutReal h = dot(w, krylov[j]);
+        hessenberg(j, k) = h;
+        const Array<BoutReal> &v = krylov[j];
+        BOUT_OMP(parallel for)
+        for (int i = 0; i < nlocal; i++) {
+          w[i] -= h * v[i];
+        }
+      }
+      const BoutReal wnorm = sqrt(dot(w, w));
+      hessenberg(k + 1, k) = wnorm;
+      if (wnorm > 0.0) {
+        BOUT_OMP(parallel for)
+        for (int i = 0; i < nlocal; i++) {
+          w[i] /= wnorm;
+        }
+      }
+
+      // Apply previous Givens rotations to the new column
+      for (int j = 0; j < k; j++) {
+        const BoutReal h0 = hessenberg(j, k), h1 = hessenberg(j + 1, k);
+        hessenberg(j, k) = givens_c[j] * h0 + givens_s[j] * h1;
+        hessenberg(j + 1, k) = -givens_s[j] * h0 + givens_c[j] * h1;
+      }
+      // New rotation to zero the subdiagonal
+      const BoutReal h0 = hessenberg(k, k), h1 = hessenberg(k + 1, k);
+      const BoutReal denom = sqrt(h0 * h0 + h1 * h1);
+      givens_c[k] = (denom > 0.0) ? h0 / denom : 1.0;
+      givens_s[k] = (denom > 0.0) ? h1 / denom : 0.0;
+      hessenberg(k, k) = denom;
+      hessenberg(k + 1, k) = 0.0;
+      gmres_g[k + 1] = -givens_s[k] * gmres_g[k];
+      gmres_g[k] = givens_c[k] * gmres_g[k];
+
+      k++;
+      if ((fabs(gmres_g[k]) <= tol) || (wnorm == 0.0)) {
+        converged = true;
+        break;
+      }
+    }
+
+    // Solve the upper triangular system H y = g
+    for (int j = k - 1; j >= 0; j--) {
+      BoutReal val = gmres_g[j];
+      for (int l = j + 1; l < k; l++) {
+        val -= hessenberg(j, l) * gmres_y[l];
+      }
+      gmres_y[j] = (hessenberg(j, j) != 0.0) ? val / hessenberg(j, j) : 0.0;
+    }
+
+    // Update the solution x += M^{-1} V y
+    for (int j = 0; j < k; j++) {
+      const Array<BoutReal> &z = use_precon ? precon_krylov[j] : krylov[j];
+      const BoutReal coef = gmres_y[j];
+      BOUT_OMP(parallel for)
+      for (int i = 0; i < nlocal; i++) {
+        x[i] += coef * z[i];
+      }
+    }
+
+    if (converged) {
+      break;
+    }
+  }
+  return iterations;
+}
+
+void BDFSolver::jacobianVector(const Array<BoutReal> &fy, const Array<BoutReal> &v,
+                               Array<BoutReal> &result) {
+  const BoutReal vnorm = sqrt(dot(v, v));
+  if (vnorm == 0.0) {
+    for (auto &val : result) {
+      val = 0.0;
+    }
+    return;
+  }
+
+  // Finite difference step, as used by PETSc's matrix-free Jacobian
+  const BoutReal eps = 1e-8 * sqrt(1. + state_norm) / vnorm;
+
+  BOUT_OMP(parallel for)
+  for (int i = 0; i < nlocal; i++) {
+    work[i] = y[i] + eps * v[i];
+  }
+  evaluateRHS(implicit_time, work, f1);
+
+  BOUT_OMP(parallel for)
+  for (int i = 0; i < nlocal; i++) {
+    result[i] = v[i] - gamma * (f1[i] - fy[i]) / eps;
+  }
+}
+
+void BDFSolver::precondition(Array<BoutReal> &v, Array<BoutReal> &result) {
+  // State at which the Jacobian is evaluated
+  load_vars(std::begin(y));
+
+  // Vector to be inverted goes in the time derivatives
+  load_derivs(std::begin(v));
+
+  run_precon(implicit_time, gamma, 0.0);
+
+  save_derivs(std::begin(result));
+}
+
+void BDFSolver::evaluateRHS(BoutReal t, Array<BoutReal> &u, Array<BoutReal> &result) {
+  load_vars(std::begin(u));
+  run_rhs(t);
+  save_derivs(std::begin(result));
+  nrhs++;
+}
+
+void BDFSolver::setWeights(const Array<BoutReal> &u) {
+  BOUT_OMP(parallel for)
+  for (int i = 0; i < nlocal; i++) {
+    weights[i] = 1. / (rtol * fabs(u[i]) + atol);
+  }
+}
+
+BoutReal BDFSolver::dot(const Array<BoutReal> &a, const Array<BoutReal> &b) {
+  BoutReal local = 0.0;
+  BOUT_OMP(parallel for reduction(+: local))
+  for (int i = 0; i < nlocal; i++) {
+    local += a[i] * b[i];
+  }
+
+  BoutReal result;
+  if (MPI_Allreduce(&local, &result, 1, MPI_DOUBLE, MPI_SUM, BoutComm::get())) {
+    throw BoutException("MPI_Allreduce failed");
+  }
+  return result;
+}
+
+BoutReal BDFSolver::wrmsNorm(const Array<BoutReal> &v) {
+  BoutReal local = 0.0;
+  BOUT_OMP(parallel for reduction(+: local))
+  for (int i = 0; i < nlocal; i++) {
+    const BoutReal val = v[i] * weights[i];
+    local += val * val;
+  }
+
+  BoutReal result;
+  if (MPI_Allreduce(&local, &result, 1, MPI_DOUBLE, MPI_SUM, BoutComm::get())) {
+    throw BoutException("MPI_Allreduce failed");
+  }
+  return sqrt(result / neq);
+}
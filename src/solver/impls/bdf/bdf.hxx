@@ -0,0 +1,161 @@
+/**************************************************************************
+ * Variable order, variable step BDF method with a Jacobian-free
+ * Newton-Krylov (JFNK) nonlinear solver
+ *
+ * Always available, since doesn't depend on external library
+ *
+ **************************************************************************
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class BDFSolver;
+
+#ifndef __BDF_SOLVER_H__
+#define __BDF_SOLVER_H__
+
+#include "mpi.h"
+
+#include <bout_types.hxx>
+#include <bout/solver.hxx>
+#include <utils.hxx>
+
+#include <vector>
+
+#include <bout/solverfactory.hxx>
+namespace {
+RegisterSolver<BDFSolver> registersolverbdf("bdf");
+}
+
+/// Implicit solver for stiff problems, which needs no external libraries
+///
+/// Each step solves the BDF equations of order 1 to max_order
+///
+///     y - gamma * f(t, y) = r
+///
+/// using Newton iterations. The linear systems are solved with
+/// restarted GMRES, where Jacobian-vector products are calculated by
+/// finite differences of the RHS. If use_precon is set, the user's
+/// preconditioner is applied on the right, and should approximately
+/// invert (I - gamma * J), as for CVODE.
+///
+/// The order and timestep are chosen to keep the estimated local
+/// error below the tolerances, similar to CVODE. Times in the
+/// history can be unequally spaced.
+class BDFSolver : public Solver {
+public:
+  BDFSolver(Options *options);
+  ~BDFSolver() = default;
+
+  void resetInternalFields() override;
+  void setMaxTimestep(BoutReal dt) override;
+  BoutReal getCurrentTimestep() override { return timestep; }
+
+  int init(int nout, BoutReal tstep) override;
+
+  int run() override;
+
+private:
+  BoutReal atol, rtol;   ///< Tolerances for adaptive timestepping
+  BoutReal max_timestep; ///< Maximum timestep
+  BoutReal min_timestep; ///< Minimum timestep, below which the solver fails
+  int mxstep;            ///< Maximum number of internal steps between outputs
+  int max_order;         ///< Maximum order of the BDF method, 1 to 5
+
+  int max_nonlinear_it; ///< Maximum Newton iterations per step
+  BoutReal newton_tol;  ///< Newton convergence, relative to the error tolerances
+  int maxl;             ///< Maximum linear iterations per restart
+  int max_restarts;     ///< Maximum number of GMRES restarts
+  BoutReal linear_rtol; ///< Linear solve tolerance, relative to the Newton residual
+  bool use_precon;      ///< Use the user-supplied preconditioner?
+  bool diagnose;        ///< Print statistics at each output
+
+  BoutReal out_timestep; ///< The output timestep
+  int nsteps;            ///< Number of output steps
+
+  BoutReal timestep; ///< The internal timestep
+  int order;         ///< Current order of the method
+  int steps_at_order; ///< Steps taken since the order last changed
+
+  int nlocal, neq; ///< Number of variables on local processor and in total
+
+  /// Previous solutions, newest first, and their times. At most
+  /// max_order + 2 are kept
+  std::vector<Array<BoutReal>> history;
+  std::vector<BoutReal> history_time;
+  int nhistory; ///< Number of valid entries in history
+
+  Array<BoutReal> fstart; ///< Time derivative at the first point in history
+
+  Array<BoutReal> y, ypred, rhs, f0, f1, residual, dy, weights, work; ///< Work arrays
+
+  /// Krylov basis vectors, and the preconditioned vectors (only if use_precon)
+  std::vector<Array<BoutReal>> krylov, precon_krylov;
+  Matrix<BoutReal> hessenberg;
+  Array<BoutReal> givens_c, givens_s, gmres_g, gmres_y;
+
+  BoutReal gamma;         ///< Coefficient of f(t,y) in the implicit equation
+  BoutReal implicit_time; ///< Time at which the implicit equation is solved
+  BoutReal state_norm;    ///< 2-norm of y, used to choose finite difference steps
+
+  // Statistics
+  int nsteps_total, nfail_error, nfail_newton, nnewton, nlinear, nrhs;
+
+  /// Restart the history from the current state, at first order
+  void resetHistory();
+
+  /// Extrapolate the history to time \p t with a polynomial of degree
+  /// \p degree, which must be less than nhistory. Degree 0 with only
+  /// one point in history uses fstart to extrapolate linearly
+  void predict(int degree, BoutReal t, Array<BoutReal> &result);
+
+  /// Error constant of the estimate from predictor of given degree
+  BoutReal errorConstant(int degree, BoutReal t);
+
+  /// Try to take a step of size dt at the current order.
+  /// Returns false if the Newton iteration failed to converge.
+  bool takeStep(BoutReal dt);
+
+  /// Solve y - gamma * f(t,y) = rhs with Newton iterations, starting
+  /// from the value in y
+  bool solveImplicit();
+
+  /// Solve (I - gamma J) x = b for x with GMRES, where J is the
+  /// Jacobian at y, and f(y) = fy. Returns the number of iterations
+  int gmres(const Array<BoutReal> &fy, const Array<BoutReal> &b, Array<BoutReal> &x,
+            BoutReal tol);
+
+  /// Calculate result = (I - gamma J) v by finite differencing the RHS
+  void jacobianVector(const Array<BoutReal> &fy, const Array<BoutReal> &v,
+                      Array<BoutReal> &result);
+
+  /// Apply the user preconditioner to v, or copy if not used
+  void precondition(Array<BoutReal> &v, Array<BoutReal> &result);
+
+  /// Evaluate the time derivative at state u
+  void evaluateRHS(BoutReal t, Array<BoutReal> &u, Array<BoutReal> &result);
+
+  /// Set the error weights 1 / (rtol * |u| + atol)
+  void setWeights(const Array<BoutReal> &u);
+
+  /// Global dot product
+  BoutReal dot(const Array<BoutReal> &a, const Array<BoutReal> &b);
+
+  /// Weighted root-mean-square norm using the error weights
+  BoutReal wrmsNorm(const Array<BoutReal> &v);
+};
+
+#endif // __BDF_SOLVER_H__
@@ -58,6 +58,11 @@ int EulerSolver::init(int nout, BoutReal tstep) {
   return 0;
 }
 
+void EulerSolver::resetInternalFields() {
+  // Copy fields into current step
+  save_vars(std::begin(f0));
+}
+
 int EulerSolver::run() {
   TRACE("EulerSolver::run()");
   
@@ -42,9 +42,10 @@ RegisterSolver<EulerSolver> registersolvereuler("euler");
 
 class EulerSolver : public Solver {
  public:
-  EulerSolver(Options *options) : Solver(options) {};
+  EulerSolver(Options *options) : Solver(options) { canReset = true; };
   ~EulerSolver(){};
   
+  void resetInternalFields() override;
   void setMaxTimestep(BoutReal dt) override;
   BoutReal getCurrentTimestep() override {return timestep; }
   
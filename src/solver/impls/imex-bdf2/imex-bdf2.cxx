@@ -9,7 +9,11 @@
 #include <msg_stack.hxx>
 #include <bout/assert.hxx>
 
+#include <algorithm>
 #include <cmath>
+#include <fstream>
+#include <set>
+#include <string>
 
 #include <output.hxx>
 
@@ -21,6 +25,12 @@ IMEXBDF2::IMEXBDF2(Options *opt)
       snesUse(nullptr), Jmf(nullptr) {
 
   has_constraints = true; ///< This solver can handle constraints
+
+  // Needed before init(), to read the history from restart files
+  OPTION(options, maxOrder, 2); //Maximum order of the scheme (1/2/3)
+  if(maxOrder > MAX_SUPPORTED_ORDER){
+    throw BoutException("Requested maxOrder greater than MAX_SUPPORTED_ORDER (%i)",MAX_SUPPORTED_ORDER);
+  }
 }
 
 IMEXBDF2::~IMEXBDF2() {
@@ -146,12 +156,6 @@ int IMEXBDF2::init(int nout, BoutReal tstep) {
   timestep = out_timestep / ninternal;
   output.write("\tUsing timestep = %e, %d internal steps per output\n", timestep, ninternal);
 
-
-  OPTION(options, maxOrder, 2); //Maximum order of the scheme (1/2/3)
-  if(maxOrder > MAX_SUPPORTED_ORDER){
-    throw BoutException("Requested maxOrder greater than MAX_SUPPORTED_ORDER (%i)",MAX_SUPPORTED_ORDER);
-  }
-
   // Allocate memory and initialise structures
   u = Array<BoutReal>{nlocal};
   for(int i=0;i<maxOrder;i++){
@@ -180,9 +184,18 @@ int IMEXBDF2::init(int nout, BoutReal tstep) {
 
   // Put starting values into u
   saveVars(std::begin(u));
-  for(int i=0; i<nlocal; i++){
-    for (auto& u_: uV) {
-      u_[i] = u[i];
+  if (history_steps > 0) {
+    // Continue from the solution history in the restart file
+    for (int i = 0; i < maxOrder; i++) {
+      save_state(uV_state[i], std::begin(uV[i]));
+      save_state(fV_state[i], std::begin(fV[i]));
+      timesteps[i] = timesteps_state[i];
+    }
+  } else {
+    for(int i=0; i<nlocal; i++){
+      for (auto& u_: uV) {
+        u_[i] = u[i];
+      }
     }
   }
 
@@ -246,346 +259,18 @@ void IMEXBDF2::constructSNES(SNES *snesIn){
     if(use_coloring) {
       // Use matrix coloring to calculate Jacobian
 
-      //////////////////////////////////////////////////
-      // Get the local indices by starting at 0
-      Field3D index = globalIndex(0);
-
-      //////////////////////////////////////////////////
-      // Pre-allocate PETSc storage
-
-      int localN = getLocalN(); // Number of rows on this processor
-      int n2d = f2d.size();
-      int n3d = f3d.size();
-
-      // Set size of Matrix on each processor to localN x localN
-      MatCreate( BoutComm::get(), &Jmf );                                
-      MatSetSizes( Jmf, localN, localN, PETSC_DETERMINE, PETSC_DETERMINE );
-      MatSetFromOptions(Jmf);
-      
-      PetscInt *d_nnz, *o_nnz;
-      PetscMalloc( (localN)*sizeof(PetscInt), &d_nnz );
-      PetscMalloc( (localN)*sizeof(PetscInt), &o_nnz );
-
-      // Set values for most points
-      if(mesh->LocalNz > 1) {
-        // A 3D mesh, so need points in Z
-
-        for(int i=0;i<localN;i++) {
-          // Non-zero elements on this processor
-          d_nnz[i] = 7*n3d + 5*n2d; // Star pattern in 3D
-          // Non-zero elements on neighboring processor
-          o_nnz[i] = 0;
-        }
-      }else {
-        // Only one point in Z
-        
-        for(int i=0;i<localN;i++) {
-          // Non-zero elements on this processor
-          d_nnz[i] = 5*(n3d+n2d); // Star pattern in 2D
-          // Non-zero elements on neighboring processor
-          o_nnz[i] = 0;
-        }
-      }
-
-      // X boundaries
-      if(mesh->firstX()) {
-        // Lower X boundary
-        for(int y=mesh->ystart;y<=mesh->yend;y++) {
-          for(int z=0;z<mesh->LocalNz;z++) {
-            int localIndex = ROUND(index(mesh->xstart, y, z));
-            ASSERT2( (localIndex >= 0) && (localIndex < localN) );
-            if(z == 0) {
-              // All 2D and 3D fields
-              for(int i=0;i<n2d+n3d;i++)
-                d_nnz[localIndex + i] -= (n3d + n2d);
-            }else {
-              // Only 3D fields
-              for(int i=0;i<n3d;i++)
-                d_nnz[localIndex + i] -= (n3d + n2d);
-            }
-          }
-        }
-      }else {
-        // On another processor
-        for(int y=mesh->ystart;y<=mesh->yend;y++) {
-          for(int z=0;z<mesh->LocalNz;z++) {
-            int localIndex = ROUND(index(mesh->xstart, y, z));
-            ASSERT2( (localIndex >= 0) && (localIndex < localN) );
-            if(z == 0) {
-              // All 2D and 3D fields
-              for(int i=0;i<n2d+n3d;i++) {
-                d_nnz[localIndex+i] -= (n3d + n2d);
-                o_nnz[localIndex+i] += (n3d + n2d);
-              }
-            }else {
-              // Only 3D fields
-              for(int i=0;i<n3d;i++) {
-                d_nnz[localIndex+i] -= (n3d + n2d);
-                o_nnz[localIndex+i] += (n3d + n2d);
-              }
-            }
-          }
-        }
-      }
-
-      if(mesh->lastX()) {
-        // Upper X boundary
-        for(int y=mesh->ystart;y<=mesh->yend;y++) {
-          for(int z=0;z<mesh->LocalNz;z++) {
-            int localIndex = ROUND(index(mesh->xend, y, z));
-            ASSERT2( (localIndex >= 0) && (localIndex < localN) );
-            if(z == 0) {
-              // All 2D and 3D fields
-              for(int i=0;i<n2d+n3d;i++)
-                d_nnz[localIndex + i] -= (n3d + n2d);
-            }else {
-              // Only 3D fields
-              for(int i=0;i<n3d;i++)
-                d_nnz[localIndex + i] -= (n3d + n2d);
-            }
-          }
-        }
-      }else {
-        // On another processor
-        for(int y=mesh->ystart;y<=mesh->yend;y++) {
-          for(int z=0;z<mesh->LocalNz;z++) {
-            int localIndex = ROUND(index(mesh->xend, y, z));
-            ASSERT2( (localIndex >= 0) && (localIndex < localN) );
-            if(z == 0) {
-              // All 2D and 3D fields
-              for(int i=0;i<n2d+n3d;i++) {
-                d_nnz[localIndex+i] -= (n3d + n2d);
-                o_nnz[localIndex+i] += (n3d + n2d);
-              }
-            }else {
-              // Only 3D fields
-              for(int i=0;i<n3d;i++) {
-                d_nnz[localIndex+i] -= (n3d + n2d);
-                o_nnz[localIndex+i] += (n3d + n2d);
-              }
-            }
-          }
-        }
-      }
-      
-      // Y boundaries
-  
-      for(int x=mesh->xstart; x <=mesh->xend; x++) {
-        // Default to no boundary
-        // NOTE: This assumes that communications in Y are to other
-        //   processors. If Y is communicated with this processor (e.g. NYPE=1)
-        //   then this will result in PETSc warnings about out of range allocations
-
-        // z = 0 case
-        int localIndex = ROUND(index(x, mesh->ystart, 0));
-        // All 2D and 3D fields
-        for(int i=0;i<n2d+n3d;i++) {
-          //d_nnz[localIndex+i] -= (n3d + n2d);
-          o_nnz[localIndex+i] += (n3d + n2d);
-        }
-        
-        for(int z=1;z<mesh->LocalNz;z++) {
-          localIndex = ROUND(index(x, mesh->ystart, z));
-          
-          // Only 3D fields
-          for(int i=0;i<n3d;i++) {
-            //d_nnz[localIndex+i] -= (n3d + n2d);
-            o_nnz[localIndex+i] += (n3d + n2d);
-          }
-        }
-
-        // z = 0 case
-        localIndex = ROUND(index(x, mesh->yend, 0));
-        // All 2D and 3D fields
-        for(int i=0;i<n2d+n3d;i++) {
-          //d_nnz[localIndex+i] -= (n3d + n2d);
-          o_nnz[localIndex+i] += (n3d + n2d);
-        }
-        
-        for(int z=1;z<mesh->LocalNz;z++) {
-          localIndex = ROUND(index(x, mesh->yend, z));
-          
-          // Only 3D fields
-          for(int i=0;i<n3d;i++) {
-            //d_nnz[localIndex+i] -= (n3d + n2d);
-            o_nnz[localIndex+i] += (n3d + n2d);
-          }
-        }
-      }
-
-      for(RangeIterator it=mesh->iterateBndryLowerY(); !it.isDone(); it++) {
-        // A boundary, so no communication
-
-        // z = 0 case
-        int localIndex = ROUND(index(it.ind, mesh->ystart, 0));
-        // All 2D and 3D fields
-        for(int i=0;i<n2d+n3d;i++) {
-          o_nnz[localIndex+i] -= (n3d + n2d);
-        }
-        
-        for(int z=1;z<mesh->LocalNz;z++) {
-          int localIndex = ROUND(index(it.ind, mesh->ystart, z));
-          
-          // Only 3D fields
-          for(int i=0;i<n3d;i++) {
-            o_nnz[localIndex+i] -= (n3d + n2d);
-          }
-        }
-      }
-
-      for(RangeIterator it=mesh->iterateBndryUpperY(); !it.isDone(); it++) {
-        // A boundary, so no communication
-
-        // z = 0 case
-        int localIndex = ROUND(index(it.ind, mesh->yend, 0));
-        // All 2D and 3D fields
-        for(int i=0;i<n2d+n3d;i++) {
-          o_nnz[localIndex+i] -= (n3d + n2d);
-        }
-        
-        for(int z=1;z<mesh->LocalNz;z++) {
-          int localIndex = ROUND(index(it.ind, mesh->yend, z));
-          
-          // Only 3D fields
-          for(int i=0;i<n3d;i++) {
-            o_nnz[localIndex+i] -= (n3d + n2d);
-          }
-        }
-      }
-      
-      // Pre-allocate
-      MatMPIAIJSetPreallocation( Jmf, 0, d_nnz, 0, o_nnz );
-      MatSetUp(Jmf); 
-      MatSetOption(Jmf,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_FALSE);      
-      PetscFree( d_nnz );
-      PetscFree( o_nnz );
-      
-      // Determine which row/columns of the matrix are locally owned
-      int Istart, Iend;
-      MatGetOwnershipRange( Jmf, &Istart, &Iend );
-      
-      // Convert local into global indices
-      index += Istart;
-      
-      // Now communicate to fill guard cells
-      mesh->communicate(index);
-
-      //////////////////////////////////////////////////
-      // Mark non-zero entries
-
-      
-      // Offsets for a 5-point pattern
-      const int xoffset[5] = {0,-1, 1, 0, 0};
-      const int yoffset[5] = {0, 0, 0,-1, 1};
-      
-      PetscScalar val = 1.0;
-      
-      for(int x=mesh->xstart; x <= mesh->xend; x++) {
-        for(int y=mesh->ystart;y<=mesh->yend;y++) {
-          
-          int ind0 = ROUND(index(x,y,0));
-
-          // 2D fields
-          for(int i=0;i<n2d;i++) {
-            PetscInt row = ind0 + i;
-
-            // Loop through each point in the 5-point stencil
-            for(int c=0;c<5;c++) {
-              int xi = x + xoffset[c];
-              int yi = y + yoffset[c];
-                
-              if( (xi < 0) || (yi < 0) ||
-                  (xi >= mesh->LocalNx) || (yi >= mesh->LocalNy) )
-                continue;
-              
-              int ind2 = ROUND(index(xi, yi, 0));
-              
-              if(ind2 < 0)
-                continue; // A boundary point
-              
-              // Depends on all variables on this cell
-              for(int j=0;j<n2d;j++) {
-                PetscInt col = ind2 + j;
-
-                //output.write("SETTING 1: %d, %d\n", row, col);
-                MatSetValues(Jmf, 1, &row, 1, &col, &val, INSERT_VALUES);
-              }
-            }
-          }
-          
-          // 3D fields
-          for(int z=0;z<mesh->LocalNz;z++) {
-            
-            int ind = ROUND(index(x,y,z));
-            
-            for(int i=0;i<n3d;i++) {
-              PetscInt row = ind + i;
-              if(z == 0)
-                row += n2d;
-              
-              // Depends on 2D fields
-              for(int j=0;j<n2d;j++) {
-                PetscInt col = ind0 + j;
-                //output.write("SETTING 2: %d, %d\n", row, col);
-                MatSetValues(Jmf, 1, &row, 1, &col, &val, INSERT_VALUES);
-              }
-              
-              // 5 point star pattern
-              for(int c=0;c<5;c++) {
-                int xi = x + xoffset[c];
-                int yi = y + yoffset[c];
-                
-                if( (xi < 0) || (yi < 0) ||
-                    (xi >= mesh->LocalNx) || (yi >= mesh->LocalNy) )
-                  continue;
-                
-                int ind2 = ROUND(index(xi, yi, z));
-                if(ind2 < 0)
-                  continue; // Boundary point
-                
-                if(z == 0)
-                  ind2 += n2d;
-                
-                // 3D fields on this cell
-                for(int j=0;j<n3d;j++) {
-                  PetscInt col = ind2 + j;
-                  //output.write("SETTING 3: %d, %d\n", row, col);
-                  MatSetValues(Jmf, 1, &row, 1, &col, &val, INSERT_VALUES);
-                }
-              }
-
-              int nz = mesh->LocalNz;
-              if(nz > 1) {
-                // Multiple points in z
-                
-                int zp = (z + 1) % nz;
-
-                int ind2 = ROUND(index(x, y, zp));
-                if(zp == 0)
-                  ind2 += n2d;
-                for(int j=0;j<n3d;j++) {
-                  PetscInt col = ind2 + j;
-                  //output.write("SETTING 4: %d, %d\n", row, col);
-                  MatSetValues(Jmf, 1, &row, 1, &col, &val, INSERT_VALUES);
-                }
-
-                int zm = (z - 1 + nz) % nz;
-                ind2 = ROUND(index(x, y, zm));
-                if(zm == 0)
-                  ind2 += n2d;
-                for(int j=0;j<n3d;j++) {
-                  PetscInt col = ind2 + j;
-                  //output.write("SETTING 5: %d, %d\n", row, col);
-                  MatSetValues(Jmf, 1, &row, 1, &col, &val, INSERT_VALUES);
-                }
-                
-              }
-              
-            }
-          }
-        }
+      std::string jacobian_pattern;
+      OPTION(options, jacobian_pattern, "star");
+      jacobian_pattern = lowercase(jacobian_pattern);
+      if (jacobian_pattern == "star") {
+        createJacobianStar();
+      } else if (jacobian_pattern == "probe") {
+        createJacobianProbe();
+      } else {
+        throw BoutException("IMEXBDF2: Unknown jacobian_pattern '%s'. "
+                            "Options are 'star' or 'probe'",
+                            jacobian_pattern.c_str());
       }
-      // Finished marking non-zero entries
       
       // Assemble Matrix
       MatAssemblyBegin( Jmf, MAT_FINAL_ASSEMBLY );
@@ -732,20 +417,645 @@ void IMEXBDF2::constructSNES(SNES *snesIn){
 
 };
 
+void IMEXBDF2::createJacobianStar() {
+  TRACE("IMEXBDF2::createJacobianStar");
+
+  //////////////////////////////////////////////////
+  // Get the local indices by starting at 0
+  Field3D index = globalIndex(0);
+
+  //////////////////////////////////////////////////
+  // Pre-allocate PETSc storage
+
+  int localN = getLocalN(); // Number of rows on this processor
+  int n2d = f2d.size();
+  int n3d = f3d.size();
+
+  // Set size of Matrix on each processor to localN x localN
+  MatCreate( BoutComm::get(), &Jmf );                                
+  MatSetSizes( Jmf, localN, localN, PETSC_DETERMINE, PETSC_DETERMINE );
+  MatSetFromOptions(Jmf);
+  
+  PetscInt *d_nnz, *o_nnz;
+  PetscMalloc( (localN)*sizeof(PetscInt), &d_nnz );
+  PetscMalloc( (localN)*sizeof(PetscInt), &o_nnz );
+
+  // Set values for most points
+  if(mesh->LocalNz > 1) {
+    // A 3D mesh, so need points in Z
+
+    for(int i=0;i<localN;i++) {
+      // Non-zero elements on this processor
+      d_nnz[i] = 7*n3d + 5*n2d; // Star pattern in 3D
+      // Non-zero elements on neighboring processor
+      o_nnz[i] = 0;
+    }
+  }else {
+    // Only one point in Z
+    
+    for(int i=0;i<localN;i++) {
+      // Non-zero elements on this processor
+      d_nnz[i] = 5*(n3d+n2d); // Star pattern in 2D
+      // Non-zero elements on neighboring processor
+      o_nnz[i] = 0;
+    }
+  }
+
+  // X boundaries
+  if(mesh->firstX()) {
+    // Lower X boundary
+    for(int y=mesh->ystart;y<=mesh->yend;y++) {
+      for(int z=0;z<mesh->LocalNz;z++) {
+        int localIndex = ROUND(index(mesh->xstart, y, z));
+        ASSERT2( (localIndex >= 0) && (localIndex < localN) );
+        if(z == 0) {
+          // All 2D and 3D fields
+          for(int i=0;i<n2d+n3d;i++)
+            d_nnz[localIndex + i] -= (n3d + n2d);
+        }else {
+          // Only 3D fields
+          for(int i=0;i<n3d;i++)
+            d_nnz[localIndex + i] -= (n3d + n2d);
+        }
+      }
+    }
+  }else {
+    // On another processor
+    for(int y=mesh->ystart;y<=mesh->yend;y++) {
+      for(int z=0;z<mesh->LocalNz;z++) {
+        int localIndex = ROUND(index(mesh->xstart, y, z));
+        ASSERT2( (localIndex >= 0) && (localIndex < localN) );
+        if(z == 0) {
+          // All 2D and 3D fields
+          for(int i=0;i<n2d+n3d;i++) {
+            d_nnz[localIndex+i] -= (n3d + n2d);
+            o_nnz[localIndex+i] += (n3d + n2d);
+          }
+        }else {
+          // Only 3D fields
+          for(int i=0;i<n3d;i++) {
+            d_nnz[localIndex+i] -= (n3d + n2d);
+            o_nnz[localIndex+i] += (n3d + n2d);
+          }
+        }
+      }
+    }
+  }
+
+  if(mesh->lastX()) {
+    // Upper X boundary
+    for(int y=mesh->ystart;y<=mesh->yend;y++) {
+      for(int z=0;z<mesh->LocalNz;z++) {
+        int localIndex = ROUND(index(mesh->xend, y, z));
+        ASSERT2( (localIndex >= 0) && (localIndex < localN) );
+        if(z == 0) {
+          // All 2D and 3D fields
+          for(int i=0;i<n2d+n3d;i++)
+            d_nnz[localIndex + i] -= (n3d + n2d);
+        }else {
+          // Only 3D fields
+          for(int i=0;i<n3d;i++)
+            d_nnz[localIndex + i] -= (n3d + n2d);
+        }
+      }
+    }
+  }else {
+    // On another processor
+    for(int y=mesh->ystart;y<=mesh->yend;y++) {
+      for(int z=0;z<mesh->LocalNz;z++) {
+        int localIndex = ROUND(index(mesh->xend, y, z));
+        ASSERT2( (localIndex >= 0) && (localIndex < localN) );
+        if(z == 0) {
+          // All 2D and 3D fields
+          for(int i=0;i<n2d+n3d;i++) {
+            d_nnz[localIndex+i] -= (n3d + n2d);
+            o_nnz[localIndex+i] += (n3d + n2d);
+          }
+        }else {
+          // Only 3D fields
+          for(int i=0;i<n3d;i++) {
+            d_nnz[localIndex+i] -= (n3d + n2d);
+            o_nnz[localIndex+i] += (n3d + n2d);
+          }
+        }
+      }
+    }
+  }
+  
+  // Y boundaries
+
+  for(int x=mesh->xstart; x <=mesh->xend; x++) {
+    // Default to no boundary
+    // NOTE: This assumes that communications in Y are to other
+    //   processors. If Y is communicated with this processor (e.g. NYPE=1)
+    //   then this will result in PETSc warnings about out of range allocations
+
+    // z = 0 case
+    int localIndex = ROUND(index(x, mesh->ystart, 0));
+    // All 2D and 3D fields
+    for(int i=0;i<n2d+n3d;i++) {
+      //d_nnz[localIndex+i] -= (n3d + n2d);
+      o_nnz[localIndex+i] += (n3d + n2d);
+    }
+    
+    for(int z=1;z<mesh->LocalNz;z++) {
+      localIndex = ROUND(index(x, mesh->ystart, z));
+      
+      // Only 3D fields
+      for(int i=0;i<n3d;i++) {
+        //d_nnz[localIndex+i] -= (n3d + n2d);
+        o_nnz[localIndex+i] += (n3d + n2d);
+      }
+    }
+
+    // z = 0 case
+    localIndex = ROUND(index(x, mesh->yend, 0));
+    // All 2D and 3D fields
+    for(int i=0;i<n2d+n3d;i++) {
+      //d_nnz[localIndex+i] -= (n3d + n2d);
+      o_nnz[localIndex+i] += (n3d + n2d);
+    }
+    
+    for(int z=1;z<mesh->LocalNz;z++) {
+      localIndex = ROUND(index(x, mesh->yend, z));
+      
+      // Only 3D fields
+      for(int i=0;i<n3d;i++) {
+        //d_nnz[localIndex+i] -= (n3d + n2d);
+        o_nnz[localIndex+i] += (n3d + n2d);
+      }
+    }
+  }
+
+  for(RangeIterator it=mesh->iterateBndryLowerY(); !it.isDone(); it++) {
+    // A boundary, so no communication
+
+    // z = 0 case
+    int localIndex = ROUND(index(it.ind, mesh->ystart, 0));
+    // All 2D and 3D fields
+    for(int i=0;i<n2d+n3d;i++) {
+      o_nnz[localIndex+i] -= (n3d + n2d);
+    }
+    
+    for(int z=1;z<mesh->LocalNz;z++) {
+      int localIndex = ROUND(index(it.ind, mesh->ystart, z));
+      
+      // Only 3D fields
+      for(int i=0;i<n3d;i++) {
+        o_nnz[localIndex+i] -= (n3d + n2d);
+      }
+    }
+  }
+
+  for(RangeIterator it=mesh->iterateBndryUpperY(); !it.isDone(); it++) {
+    // A boundary, so no communication
+
+    // z = 0 case
+    int localIndex = ROUND(index(it.ind, mesh->yend, 0));
+    // All 2D and 3D fields
+    for(int i=0;i<n2d+n3d;i++) {
+      o_nnz[localIndex+i] -= (n3d + n2d);
+    }
+    
+    for(int z=1;z<mesh->LocalNz;z++) {
+      int localIndex = ROUND(index(it.ind, mesh->yend, z));
+      
+      // Only 3D fields
+      for(int i=0;i<n3d;i++) {
+        o_nnz[localIndex+i] -= (n3d + n2d);
+      }
+    }
+  }
+  
+  // Pre-allocate
+  MatMPIAIJSetPreallocation( Jmf, 0, d_nnz, 0, o_nnz );
+  MatSetUp(Jmf); 
+  MatSetOption(Jmf,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_FALSE);      
+  PetscFree( d_nnz );
+  PetscFree( o_nnz );
+  
+  // Determine which row/columns of the matrix are locally owned
+  int Istart, Iend;
+  MatGetOwnershipRange( Jmf, &Istart, &Iend );
+  
+  // Convert local into global indices
+  index += Istart;
+  
+  // Now communicate to fill guard cells
+  mesh->communicate(index);
+
+  //////////////////////////////////////////////////
+  // Mark non-zero entries
+
+  
+  // Offsets for a 5-point pattern
+  const int xoffset[5] = {0,-1, 1, 0, 0};
+  const int yoffset[5] = {0, 0, 0,-1, 1};
+  
+  PetscScalar val = 1.0;
+  
+  for(int x=mesh->xstart; x <= mesh->xend; x++) {
+    for(int y=mesh->ystart;y<=mesh->yend;y++) {
+      
+      int ind0 = ROUND(index(x,y,0));
+
+      // 2D fields
+      for(int i=0;i<n2d;i++) {
+        PetscInt row = ind0 + i;
+
+        // Loop through each point in the 5-point stencil
+        for(int c=0;c<5;c++) {
+          int xi = x + xoffset[c];
+          int yi = y + yoffset[c];
+            
+          if( (xi < 0) || (yi < 0) ||
+              (xi >= mesh->LocalNx) || (yi >= mesh->LocalNy) )
+            continue;
+          
+          int ind2 = ROUND(index(xi, yi, 0));
+          
+          if(ind2 < 0)
+            continue; // A boundary point
+          
+          // Depends on all variables on this cell
+          for(int j=0;j<n2d;j++) {
+            PetscInt col = ind2 + j;
+
+            //output.write("SETTING 1: %d, %d\n", row, col);
+            MatSetValues(Jmf, 1, &row, 1, &col, &val, INSERT_VALUES);
+          }
+        }
+      }
+      
+      // 3D fields
+      for(int z=0;z<mesh->LocalNz;z++) {
+        
+        int ind = ROUND(index(x,y,z));
+        
+        for(int i=0;i<n3d;i++) {
+          PetscInt row = ind + i;
+          if(z == 0)
+            row += n2d;
+          
+          // Depends on 2D fields
+          for(int j=0;j<n2d;j++) {
+            PetscInt col = ind0 + j;
+            //output.write("SETTING 2: %d, %d\n", row, col);
+            MatSetValues(Jmf, 1, &row, 1, &col, &val, INSERT_VALUES);
+          }
+          
+          // 5 point star pattern
+          for(int c=0;c<5;c++) {
+            int xi = x + xoffset[c];
+            int yi = y + yoffset[c];
+            
+            if( (xi < 0) || (yi < 0) ||
+                (xi >= mesh->LocalNx) || (yi >= mesh->LocalNy) )
+              continue;
+            
+            int ind2 = ROUND(index(xi, yi, z));
+            if(ind2 < 0)
+              continue; // Boundary point
+            
+            if(z == 0)
+              ind2 += n2d;
+            
+            // 3D fields on this cell
+            for(int j=0;j<n3d;j++) {
+              PetscInt col = ind2 + j;
+              //output.write("SETTING 3: %d, %d\n", row, col);
+              MatSetValues(Jmf, 1, &row, 1, &col, &val, INSERT_VALUES);
+            }
+          }
+
+          int nz = mesh->LocalNz;
+          if(nz > 1) {
+            // Multiple points in z
+            
+            int zp = (z + 1) % nz;
+
+            int ind2 = ROUND(index(x, y, zp));
+            if(zp == 0)
+              ind2 += n2d;
+            for(int j=0;j<n3d;j++) {
+              PetscInt col = ind2 + j;
+              //output.write("SETTING 4: %d, %d\n", row, col);
+              MatSetValues(Jmf, 1, &row, 1, &col, &val, INSERT_VALUES);
+            }
+
+            int zm = (z - 1 + nz) % nz;
+            ind2 = ROUND(index(x, y, zm));
+            if(zm == 0)
+              ind2 += n2d;
+            for(int j=0;j<n3d;j++) {
+              PetscInt col = ind2 + j;
+              //output.write("SETTING 5: %d, %d\n", row, col);
+              MatSetValues(Jmf, 1, &row, 1, &col, &val, INSERT_VALUES);
+            }
+            
+          }
+          
+        }
+      }
+    }
+  }
+  // Finished marking non-zero entries
+}
+
+namespace {
+/// Read a Jacobian pattern saved by writeJacobianPattern. Returns false
+/// if the file doesn't exist or is for a different problem size
+bool readJacobianPattern(const std::string &filename, int nlocal, int neq, int Istart,
+                         vector<vector<PetscInt>> &pattern) {
+  std::ifstream file(filename);
+  if (!file.good()) {
+    return false;
+  }
+  std::string header;
+  std::getline(file, header);
+  int file_nlocal, file_neq, file_Istart;
+  file >> file_nlocal >> file_neq >> file_Istart;
+  if ((header != "BOUT++ Jacobian pattern") || (file_nlocal != nlocal) ||
+      (file_neq != neq) || (file_Istart != Istart)) {
+    output_warn.write("\tIgnoring Jacobian pattern in '%s': problem size has changed\n",
+                      filename.c_str());
+    return false;
+  }
+  pattern.resize(nlocal);
+  for (auto &row : pattern) {
+    int ncols;
+    file >> ncols;
+    row.resize(ncols);
+    for (auto &col : row) {
+      file >> col;
+    }
+  }
+  return !file.fail();
+}
+
+void writeJacobianPattern(const std::string &filename, int nlocal, int neq, int Istart,
+                          const vector<vector<PetscInt>> &pattern) {
+  std::ofstream file(filename);
+  file << "BOUT++ Jacobian pattern\n" << nlocal << " " << neq << " " << Istart << "\n";
+  for (const auto &row : pattern) {
+    file << row.size();
+    for (const auto &col : row) {
+      file << " " << col;
+    }
+    file << "\n";
+  }
+  if (!file.good()) {
+    throw BoutException("Failed to write Jacobian pattern to '%s'", filename.c_str());
+  }
+}
+} // namespace
+
+void IMEXBDF2::createJacobianProbe() {
+  TRACE("IMEXBDF2::createJacobianProbe");
+
+  const int localN = getLocalN(); // Number of rows on this processor
+
+  // PETSc numbers rows consecutively over processors in rank order
+  int Iend;
+  MPI_Scan(&localN, &Iend, 1, MPI_INT, MPI_SUM, BoutComm::get());
+  const int Istart = Iend - localN;
+
+  // Global row of each point, communicated so that guard cells contain
+  // the rows on other processors. Boundary cells stay -1
+  Field3D index = globalIndex(0);
+  for (const auto &i : index.getRegion(RGN_ALL)) {
+    if (index[i] >= 0) {
+      index[i] += Istart;
+    }
+  }
+  mesh->communicate(index);
+
+  if (probed_pattern.empty()) {
+    // A file is read or written by each processor
+    std::string jacobian_pattern_file;
+    OPTION(options, jacobian_pattern_file, "");
+    const std::string filename =
+        jacobian_pattern_file + "." + std::to_string(BoutComm::rank());
+
+    // All processors must probe together, as the RHS communicates
+    int have_pattern = 0, all_have_pattern;
+    if (!jacobian_pattern_file.empty()) {
+      have_pattern = readJacobianPattern(filename, localN, neq, Istart, probed_pattern);
+    }
+    MPI_Allreduce(&have_pattern, &all_have_pattern, 1, MPI_INT, MPI_MIN,
+                  BoutComm::get());
+
+    if (all_have_pattern) {
+      output.write("\tRead Jacobian pattern from '%s'\n", filename.c_str());
+    } else {
+      probed_pattern = probeJacobianPattern(index, Istart);
+      if (!jacobian_pattern_file.empty()) {
+        writeJacobianPattern(filename, localN, neq, Istart, probed_pattern);
+        output.write("\tSaved Jacobian pattern to '%s'\n", filename.c_str());
+      }
+    }
+  }
+
+  // Count the non-zeros on this processor, and on others
+  vector<PetscInt> d_nnz(localN), o_nnz(localN);
+  int nnz = 0;
+  for (int i = 0; i < localN; i++) {
+    for (const auto &col : probed_pattern[i]) {
+      if ((col >= Istart) && (col < Iend)) {
+        ++d_nnz[i];
+      } else {
+        ++o_nnz[i];
+      }
+    }
+    nnz += probed_pattern[i].size();
+  }
+  output.write("\tJacobian pattern has %e non-zeros per row\n",
+               static_cast<BoutReal>(nnz) / localN);
+
+  // Set size of Matrix on each processor to localN x localN
+  MatCreate(BoutComm::get(), &Jmf);
+  MatSetSizes(Jmf, localN, localN, PETSC_DETERMINE, PETSC_DETERMINE);
+  MatSetFromOptions(Jmf);
+
+  // Only the call matching the matrix type has an effect
+  MatSeqAIJSetPreallocation(Jmf, 0, d_nnz.data());
+  MatMPIAIJSetPreallocation(Jmf, 0, d_nnz.data(), 0, o_nnz.data());
+  MatSetUp(Jmf);
+
+  //////////////////////////////////////////////////
+  // Mark non-zero entries
+
+  for (int i = 0; i < localN; i++) {
+    const PetscInt row = Istart + i;
+    const auto &cols = probed_pattern[i];
+    const vector<PetscScalar> vals(cols.size(), 1.0);
+    MatSetValues(Jmf, 1, &row, static_cast<PetscInt>(cols.size()), cols.data(),
+                 vals.data(), INSERT_VALUES);
+  }
+}
+
+vector<vector<PetscInt>> IMEXBDF2::probeJacobianPattern(const Field3D &index,
+                                                        int Istart) {
+  TRACE("IMEXBDF2::probeJacobianPattern");
+
+  for (const auto &f : f2d) {
+    if (f.evolve_bndry) {
+      throw BoutException("IMEXBDF2: jacobian_pattern = probe can't be used when "
+                          "evolving boundaries (variable %s)",
+                          f.name.c_str());
+    }
+  }
+  for (const auto &f : f3d) {
+    if (f.evolve_bndry) {
+      throw BoutException("IMEXBDF2: jacobian_pattern = probe can't be used when "
+                          "evolving boundaries (variable %s)",
+                          f.name.c_str());
+    }
+  }
+
+  // Maximum distance in any direction over which points are coupled
+  int stencil_width;
+  OPTION(options, stencil_width, 2);
+  if ((stencil_width > mesh->xstart) || (stencil_width > mesh->ystart)) {
+    throw BoutException("IMEXBDF2: stencil_width (%d) can't be larger than the "
+                        "number of guard cells (%d in X, %d in Y)",
+                        stencil_width, mesh->xstart, mesh->ystart);
+  }
+
+  const int n2d = f2d.size();
+  const int nvars = n2d + f3d.size();
+  const int nz = mesh->LocalNz;
+
+  // Colour the points, so that points of the same colour are more
+  // than 2*stencil_width apart, using global indices so that the
+  // colours match across processors. In Z the number of colours must
+  // divide nz, since Z is periodic
+  const int ncolxy = 2 * stencil_width + 1;
+  int ncolz = nz;
+  for (int n = std::min(ncolxy, nz); n < nz; n++) {
+    if (nz % n == 0) {
+      ncolz = n;
+      break;
+    }
+  }
+
+  Field3D colour(-1.0, mesh);
+  for (int x = mesh->xstart; x <= mesh->xend; x++) {
+    for (int y = mesh->ystart; y <= mesh->yend; y++) {
+      for (int z = 0; z < nz; z++) {
+        colour(x, y, z) = (mesh->XGLOBAL(x) % ncolxy) +
+                          ncolxy * ((mesh->YGLOBAL(y) % ncolxy) + ncolxy * (z % ncolz));
+      }
+    }
+  }
+  mesh->communicate(colour);
+
+  // Offset of variable var from index(x,y,z). At z = 0 the 2D
+  // variables come first, followed by the 3D variables
+  auto offset = [n2d](int var, int z) { return (z == 0) ? var : var - n2d; };
+
+  Array<BoutReal> state(nlocal), perturbed(nlocal), f0(nlocal), f1(nlocal);
+  saveVars(std::begin(state));
+  run_diffusive(simtime, true);
+  saveDerivs(std::begin(f0));
+
+  // Relative size of the perturbations
+  const BoutReal delta = 1e-6;
+
+  vector<std::set<PetscInt>> columns(nlocal);
+  int nprobes = 0;
+
+  for (int var = 0; var < nvars; var++) {
+    const bool is2d = var < n2d;
+    // 2D variables only use the colours at z = 0
+    const int ncolours = ncolxy * ncolxy * (is2d ? 1 : ncolz);
+
+    for (int c = 0; c < ncolours; c++) {
+      // Perturb this variable at all points of colour c
+      std::copy(std::begin(state), std::end(state), std::begin(perturbed));
+      for (int x = mesh->xstart; x <= mesh->xend; x++) {
+        for (int y = mesh->ystart; y <= mesh->yend; y++) {
+          for (int z = 0; z < (is2d ? 1 : nz); z++) {
+            if (ROUND(colour(x, y, z)) == c) {
+              BoutReal &val = perturbed[ROUND(index(x, y, z)) - Istart + offset(var, z)];
+              val += delta * (1.0 + std::abs(val));
+            }
+          }
+        }
+      }
+
+      loadVars(std::begin(perturbed));
+      run_diffusive(simtime, true);
+      saveDerivs(std::begin(f1));
+      ++nprobes;
+
+      // Each changed time derivative depends on every point of colour c
+      // within stencil_width of it. Usually there is only one, but
+      // there can be more where global indices wrap around
+      for (int x = mesh->xstart; x <= mesh->xend; x++) {
+        for (int y = mesh->ystart; y <= mesh->yend; y++) {
+          for (int z = 0; z < nz; z++) {
+            for (int rowvar = (z == 0) ? 0 : n2d; rowvar < nvars; rowvar++) {
+              const int row = ROUND(index(x, y, z)) - Istart + offset(rowvar, z);
+              if (f1[row] == f0[row]) {
+                continue;
+              }
+
+              for (int xi = x - stencil_width; xi <= x + stencil_width; xi++) {
+                for (int yi = y - stencil_width; yi <= y + stencil_width; yi++) {
+                  if (is2d) {
+                    if ((ROUND(colour(xi, yi, 0)) == c) && (index(xi, yi, 0) >= 0)) {
+                      columns[row].insert(ROUND(index(xi, yi, 0)) + var);
+                    }
+                    continue;
+                  }
+                  // A 2D variable may depend on any Z point
+                  const int zfirst = (rowvar < n2d) ? 0 : z - stencil_width;
+                  const int zlast = (rowvar < n2d) ? nz - 1 : z + stencil_width;
+                  for (int zi = zfirst; zi <= zlast; zi++) {
+                    const int zp = ((zi % nz) + nz) % nz;
+                    if ((ROUND(colour(xi, yi, zp)) == c) && (index(xi, yi, zp) >= 0)) {
+                      columns[row].insert(ROUND(index(xi, yi, zp)) + offset(var, zp));
+                    }
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Restore the state
+  loadVars(std::begin(state));
+
+  output.write("\tFound Jacobian pattern using %d RHS evaluations\n", nprobes);
+
+  vector<vector<PetscInt>> pattern(nlocal);
+  for (int i = 0; i < nlocal; i++) {
+    // Always include the diagonal, as the SNES function contains the identity
+    columns[i].insert(Istart + i);
+    pattern[i].assign(columns[i].begin(), columns[i].end());
+  }
+  return pattern;
+}
+
 int IMEXBDF2::run() {
   TRACE("IMEXBDF2::run()");
 
-  // Multi-step scheme, so first steps are different
-  int order = 1;
+  // Multi-step scheme, so first steps are different. When restarting
+  // with history, the order increases as if there had been no restart
+  int order = BOUTMIN(history_steps + 1, maxOrder);
   int lastOrder = -1;
   BoutReal dt = timestep;
   vector<BoutReal> lastTimesteps = timesteps;
-  BoutReal dtNext = dt; //Timestep to try for next internal iteration
+  BoutReal dtNext = (history_steps > 0) ? dtNext_state : dt; //Timestep to try for next internal iteration
   
   //By default use the main snes object.
   snesUse = snes;
 
-  int internalCounter=0; //Cumulative number of successful internal iterations
+  int internalCounter = history_steps; //Cumulative number of successful internal iterations
 
   for(int s=0;s<nsteps;s++) {
     BoutReal cumulativeTime = 0.;
@@ -972,6 +1282,10 @@ int IMEXBDF2::run() {
 
     iteration++; // Advance iteration number
 
+    // State needed by saveHistory
+    history_steps = internalCounter;
+    dtNext_state = dtNext;
+
     /// Call the monitor function
 
     if(call_monitors(simtime, s, nsteps)) {
@@ -983,6 +1297,31 @@ int IMEXBDF2::run() {
   return 0;
 }
 
+void IMEXBDF2::outputHistoryVars(Datafile &outputfile) {
+  // Create all the fields first, since outputfile keeps pointers to them
+  uV_state.resize(maxOrder);
+  fV_state.resize(maxOrder);
+  timesteps_state.resize(maxOrder);
+
+  for (int i = 0; i < maxOrder; i++) {
+    add_state(uV_state[i], outputfile, "u" + std::to_string(i + 1));
+    add_state(fV_state[i], outputfile, "f" + std::to_string(i + 1));
+    outputfile.addOnce(timesteps_state[i], "history_dt" + std::to_string(i + 1));
+  }
+  outputfile.addOnce(dtNext_state, "history_dtnext");
+}
+
+void IMEXBDF2::saveHistory() {
+  if (history_steps <= 0) {
+    return;
+  }
+  for (int i = 0; i < maxOrder; i++) {
+    load_state(uV_state[i], std::begin(uV[i]));
+    load_state(fV_state[i], std::begin(fV[i]));
+    timesteps_state[i] = timesteps[i];
+  }
+}
+
 /*
  * Calculate the coefficients required for this order calculation
  * See: http://summit.sfu.ca/item/9862 for more details
@@ -80,6 +80,10 @@ class IMEXBDF2 : public Solver {
   /// Run the simulation
   int run() override;
 
+  /// Copy the solution history into the variables in the restart
+  /// file, so that a restarted simulation continues at the same order
+  void saveHistory() override;
+
   /// Nonlinear function. This is called by PETSc SNES object
   /// via a static C-style function. For implicit
   /// time integration this function calculates:
@@ -142,6 +146,28 @@ class IMEXBDF2 : public Solver {
   ///
   void constructSNES(SNES *snesIn);
 
+  /// Create the Jacobian matrix Jmf and mark the non-zero entries,
+  /// assuming a star stencil which couples all variables
+  void createJacobianStar();
+
+  /// Create the Jacobian matrix Jmf and mark the non-zero entries
+  /// found by probeJacobianPattern, or read from a file
+  void createJacobianProbe();
+
+  /// Find the non-zero pattern of the Jacobian of the implicit part,
+  /// by perturbing groups of points which are far enough apart that
+  /// each changed time derivative can only come from one of them
+  ///
+  /// @param[in] index   Global row of each point, including guard cells
+  /// @param[in] Istart  First global row on this processor
+  ///
+  /// Returns the sorted global columns for each local row
+  vector<vector<PetscInt>> probeJacobianPattern(const Field3D &index, int Istart);
+
+  /// Non-zero columns of each local row, kept as both snes and
+  /// snesAlt need it
+  vector<vector<PetscInt>> probed_pattern;
+
   /// Shuffle state along one step
   void shuffleState();
 
@@ -156,6 +182,14 @@ class IMEXBDF2 : public Solver {
   Array<BoutReal> rhs;
   Array<BoutReal> err;
 
+  /// Add the solution history to restart files
+  void outputHistoryVars(Datafile &outputfile) override;
+
+  // Solution history in restart files
+  vector<StateFields> uV_state, fV_state;
+  vector<BoutReal> timesteps_state;
+  BoutReal dtNext_state = 0.0; ///< Timestep to try for the next internal step
+
   // Implicit solver
   PetscErrorCode solve_implicit(BoutReal curtime, BoutReal gamma);
   BoutReal implicit_gamma;
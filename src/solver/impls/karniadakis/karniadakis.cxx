@@ -102,6 +102,20 @@ int KarniadakisSolver::init(int nout, BoutReal tstep) {
 
   timestep = tstep / static_cast<BoutReal>(nsubsteps);
 
+  if (history_steps > 0) {
+    // Continue from the previous time points in the restart file
+    if (history_timestep == timestep) {
+      save_state(fm1_state, std::begin(fm1));
+      save_state(fm2_state, std::begin(fm2));
+      save_state(Sm1_state, std::begin(Sm1));
+      save_state(Sm2_state, std::begin(Sm2));
+      first_time = false;
+    } else {
+      output.write("\tTimestep changed from %e. Not using restart history\n",
+                   history_timestep);
+    }
+  }
+
   return 0;
 }
 
@@ -155,6 +169,25 @@ void KarniadakisSolver::resetInternalFields(){
   save_vars(std::begin(f0));
 }
 
+void KarniadakisSolver::outputHistoryVars(Datafile &outputfile) {
+  outputfile.addOnce(history_timestep, "history_timestep");
+  add_state(fm1_state, outputfile, "fm1");
+  add_state(fm2_state, outputfile, "fm2");
+  add_state(Sm1_state, outputfile, "Sm1");
+  add_state(Sm2_state, outputfile, "Sm2");
+}
+
+void KarniadakisSolver::saveHistory() {
+  history_steps = first_time ? 0 : 2;
+  history_timestep = timestep;
+  if (history_steps > 0) {
+    load_state(fm1_state, std::begin(fm1));
+    load_state(fm2_state, std::begin(fm2));
+    load_state(Sm1_state, std::begin(Sm1));
+    load_state(Sm2_state, std::begin(Sm2));
+  }
+}
+
 void KarniadakisSolver::take_step(BoutReal dt) {
   // S0 = S(f0)
 
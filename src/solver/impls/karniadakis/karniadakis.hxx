@@ -57,7 +57,10 @@ class KarniadakisSolver : public Solver {
   int run() override;
   void resetInternalFields() override;
 
+  void saveHistory() override;
+
  private:
+  void outputHistoryVars(Datafile &outputfile) override;
   
   Array<BoutReal> f1, f0, fm1, fm2; // System state at current, and two previous time points
   Array<BoutReal> S0, Sm1, Sm2; // Convective part of the RHS equations
@@ -65,6 +68,10 @@ class KarniadakisSolver : public Solver {
   
   bool first_time; // Need to initialise values
 
+  // Previous time points, saved in restart files
+  StateFields fm1_state, fm2_state, Sm1_state, Sm2_state;
+  BoutReal history_timestep = 0.0; // The internal timestep used for the history
+
   BoutReal out_timestep; // The output timestep
   int nsteps; // Number of output steps
   
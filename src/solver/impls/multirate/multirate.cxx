@@ -0,0 +1,185 @@
+#include "multirate.hxx"
+
+#include <boutcomm.hxx>
+#include <utils.hxx>
+#include <boutexception.hxx>
+#include <msg_stack.hxx>
+#include <bout/openmpwrap.hxx>
+
+#include <output.hxx>
+
+MultirateSolver::MultirateSolver(Options *options) : Solver(options) { canReset = true; }
+
+void MultirateSolver::setMaxTimestep(BoutReal dt) {
+  if (dt > timestep)
+    return; // Already less than this
+
+  timestep = dt; // Won't be used this time, but next
+}
+
+int MultirateSolver::init(int nout, BoutReal tstep) {
+
+  TRACE("Initialising multirate solver");
+
+  /// Call the generic initialisation first
+  if (Solver::init(nout, tstep))
+    return 1;
+
+  output << "\n\tMultirate explicit solver\n";
+
+  nsteps = nout; // Save number of output steps
+  out_timestep = tstep;
+  max_dt = tstep;
+
+  // Calculate number of variables
+  nlocal = getLocalN();
+
+  // Get total problem size
+  if (MPI_Allreduce(&nlocal, &neq, 1, MPI_INT, MPI_SUM, BoutComm::get())) {
+    throw BoutException("MPI_Allreduce failed in MultirateSolver::init");
+  }
+
+  output.write("\t3d fields = %d, 2d fields = %d neq=%d, local_N=%d\n", n3Dvars(),
+               n2Dvars(), neq, nlocal);
+
+  split = splitOperator();
+  if (!split) {
+    output_warn.write("\tWARNING: Model is not split, so taking unsplit RK3-SSP steps\n");
+  }
+
+  // Allocate memory
+  f = Array<BoutReal>(nlocal);
+
+  // memory for taking a single time step
+  u1 = Array<BoutReal>(nlocal);
+  u2 = Array<BoutReal>(nlocal);
+  L = Array<BoutReal>(nlocal);
+
+  // Put starting values into f
+  save_vars(std::begin(f));
+
+  // Get options
+  OPTION(options, max_timestep, tstep); // Maximum timestep
+  OPTION(options, timestep, max_timestep); // Starting timestep
+  OPTION(options, mxstep, 500); // Maximum number of steps between outputs
+  OPTION(options, subcycles, 10); // Diffusive steps per convective step
+  OPTION(options, diagnose, false);
+
+  // Half of the diffusive steps are taken either side of the convective step
+  if ((subcycles < 2) || (subcycles % 2 != 0)) {
+    throw BoutException(
+        "Multirate solver: subcycles must be even and at least 2, not %d", subcycles);
+  }
+
+  nconvective = ndiffusive = 0;
+
+  return 0;
+}
+
+void MultirateSolver::resetInternalFields() {
+  // Copy fields into current step
+  save_vars(std::begin(f));
+}
+
+int MultirateSolver::run() {
+  TRACE("MultirateSolver::run()");
+
+  // Diffusive steps in each half of the convective step
+  const int nhalf = subcycles / 2;
+
+  for (int s = 0; s < nsteps; s++) {
+    BoutReal target = simtime + out_timestep;
+
+    bool running = true;
+    int internal_steps = 0;
+    do {
+      BoutReal dt = timestep;
+      if ((simtime + dt) >= target) {
+        dt = target - simtime; // Make sure the last timestep is on the output
+        running = false;
+      }
+
+      if (split) {
+        // Strang splitting, diffusive part either side of the convective step
+        subcycle(simtime, 0.5 * dt, nhalf, f);
+        take_step(simtime, dt, f, f, false);
+        subcycle(simtime + 0.5 * dt, 0.5 * dt, nhalf, f);
+      } else {
+        // The diffusive part of an unsplit model is the whole RHS
+        take_step(simtime, dt, f, f, true);
+      }
+
+      simtime += dt;
+
+      internal_steps++;
+      if (internal_steps > mxstep)
+        throw BoutException("ERROR: MXSTEP exceeded. simtime=%e, timestep = %e\n",
+                            simtime, timestep);
+
+      call_timestep_monitors(simtime, dt);
+    } while (running);
+
+    load_vars(std::begin(f)); // Put result into variables
+    // Call rhs function to get extra variables at this time
+    run_rhs(simtime);
+
+    iteration++; // Advance iteration number
+
+    if (diagnose) {
+      output.write("\nMultirate: %d convective, %d diffusive RHS calls\n", nconvective,
+                   ndiffusive);
+    }
+    nconvective = ndiffusive = 0;
+
+    /// Call the monitor function
+
+    if (call_monitors(simtime, s, nsteps)) {
+      // User signalled to quit
+      break;
+    }
+  }
+
+  return 0;
+}
+
+void MultirateSolver::subcycle(BoutReal curtime, BoutReal dt, int nsub,
+                               Array<BoutReal> &u) {
+  const BoutReal h = dt / nsub;
+  for (int i = 0; i < nsub; i++) {
+    take_step(curtime + i * h, h, u, u, true);
+  }
+}
+
+void MultirateSolver::take_step(BoutReal curtime, BoutReal dt, Array<BoutReal> &start,
+                                Array<BoutReal> &result, bool diffusive) {
+
+  evaluate(curtime, start, diffusive);
+
+  BOUT_OMP(parallel for)
+  for (int i = 0; i < nlocal; i++)
+    u1[i] = start[i] + dt * L[i];
+
+  evaluate(curtime + dt, u1, diffusive);
+
+  BOUT_OMP(parallel for)
+  for (int i = 0; i < nlocal; i++)
+    u2[i] = 0.75 * start[i] + 0.25 * u1[i] + 0.25 * dt * L[i];
+
+  evaluate(curtime + 0.5 * dt, u2, diffusive);
+
+  BOUT_OMP(parallel for)
+  for (int i = 0; i < nlocal; i++)
+    result[i] = (1. / 3) * start[i] + (2. / 3.) * (u2[i] + dt * L[i]);
+}
+
+void MultirateSolver::evaluate(BoutReal t, Array<BoutReal> &u, bool diffusive) {
+  load_vars(std::begin(u));
+  if (diffusive) {
+    run_diffusive(t, false);
+    ndiffusive++;
+  } else {
+    run_convective(t);
+    nconvective++;
+  }
+  save_derivs(std::begin(L));
+}
@@ -0,0 +1,101 @@
+/**************************************************************************
+ * Multirate explicit solver, subcycling the diffusive part
+ *
+ * Always available, since doesn't depend on external library
+ *
+ * Solves a system df/dt = S(f) + D(f)
+ *
+ * where S is the slow (convective) part, and D the fast (diffusive)
+ * part, which is advanced with several smaller steps in each step of S
+ *
+ **************************************************************************
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class MultirateSolver;
+
+#ifndef __MULTIRATE_SOLVER_H__
+#define __MULTIRATE_SOLVER_H__
+
+#include "mpi.h"
+
+#include <bout_types.hxx>
+#include <bout/solver.hxx>
+
+#include <bout/solverfactory.hxx>
+namespace {
+RegisterSolver<MultirateSolver> registersolvermultirate("multirate");
+}
+
+/// Explicit solver for split operator models, where the diffusive
+/// part has a much shorter timescale than the convective part.
+///
+/// Each step uses Strang splitting: the diffusive part is advanced for
+/// half a step with several small steps, then the convective part for
+/// a whole step, then the diffusive part for the other half. Both parts
+/// use the 3rd-order SSP Runge-Kutta method, so the convective part
+/// (and any field solves in it) is only calculated three times per
+/// step, while the timestep of the diffusive part is limited by its
+/// own stability.
+///
+/// If the model is not split, there is nothing to subcycle, so each
+/// step is a single RK3-SSP step of the whole RHS.
+class MultirateSolver : public Solver {
+public:
+  MultirateSolver(Options *options);
+  ~MultirateSolver() = default;
+
+  void resetInternalFields() override;
+  void setMaxTimestep(BoutReal dt) override;
+  BoutReal getCurrentTimestep() override { return timestep; }
+
+  int init(int nout, BoutReal tstep) override;
+
+  int run() override;
+
+private:
+  BoutReal max_timestep; ///< Maximum timestep
+  int mxstep;            ///< Maximum number of internal steps between outputs
+  int subcycles;         ///< Diffusive steps in each convective step. Must be even
+  bool split;            ///< Is the model split? If not, there is no subcycling
+  bool diagnose;         ///< Print the number of RHS calls at each output
+
+  Array<BoutReal> f;
+
+  BoutReal out_timestep; ///< The output timestep
+  int nsteps;            ///< Number of output steps
+
+  BoutReal timestep; ///< The internal (convective) timestep
+
+  int nlocal, neq; ///< Number of variables on local processor and in total
+
+  Array<BoutReal> u1, u2, L; ///< Time-stepping arrays
+
+  int nconvective, ndiffusive; ///< RHS calls since last output
+
+  /// Take a single RK3-SSP step of either part, from start to result
+  void take_step(BoutReal curtime, BoutReal dt, Array<BoutReal> &start,
+                 Array<BoutReal> &result, bool diffusive);
+
+  /// Advance the diffusive part of \p u over \p dt using \p nsub steps
+  void subcycle(BoutReal curtime, BoutReal dt, int nsub, Array<BoutReal> &u);
+
+  /// Evaluate one part of the time derivative at state \p u
+  void evaluate(BoutReal t, Array<BoutReal> &u, bool diffusive);
+};
+
+#endif // __MULTIRATE_SOLVER_H__
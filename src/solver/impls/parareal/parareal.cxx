@@ -0,0 +1,231 @@
+#include "parareal.hxx"
+
+#include <boutcomm.hxx>
+#include <msg_stack.hxx>
+#include <output.hxx>
+
+#include <algorithm>
+#include <cmath>
+
+PararealSolver::PararealSolver(Options *options) : Solver(options) {
+  // Sub-sections for the coarse and fine solvers, which default to
+  // solvers supporting resetInternalFields
+  Options *coarse_options = options->getSection("coarse");
+  SolverType coarse_type;
+  coarse_options->get("type", coarse_type, SOLVEREULER);
+  coarse.reset(SolverFactory::getInstance()->createSolver(coarse_type, coarse_options));
+
+  Options *fine_options = options->getSection("fine");
+  SolverType fine_type;
+  fine_options->get("type", fine_type, SOLVERRK4);
+  fine.reset(SolverFactory::getInstance()->createSolver(fine_type, fine_options));
+
+  if (!coarse->canReset || !fine->canReset) {
+    throw BoutException("Parareal: coarse (%s) and fine (%s) solvers must support "
+                        "resetInternalFields",
+                        coarse_type.c_str(), fine_type.c_str());
+  }
+}
+
+int PararealSolver::init(int nout, BoutReal tstep) {
+  TRACE("Initialising Parareal solver");
+
+  /// Call the generic initialisation first
+  if (Solver::init(nout, tstep))
+    return 1;
+
+  output << "\n\tParareal solver\n";
+
+  nsteps = nout; // Save number of output steps
+  out_timestep = tstep;
+
+  OPTION(options, atol, 1.e-5);
+  OPTION(options, rtol, 1.e-3);
+  OPTION(options, max_iterations, 10);
+  OPTION(options, diagnose, false);
+
+  slice = BoutComm::group();
+  nslices = BoutComm::groups();
+  time_comm = BoutComm::acrossGroups();
+
+  output.write("\tTime slices = %d\n", nslices);
+
+  // Each call to a sub-solver's run() advances one output interval
+  if (coarse->init(1, out_timestep) || fine->init(1, out_timestep)) {
+    return 1;
+  }
+
+  nlocal = getLocalN();
+
+  window_start = Array<BoutReal>(nlocal);
+  u_start = Array<BoutReal>(nlocal);
+  u_end = Array<BoutReal>(nlocal);
+  f_end = Array<BoutReal>(nlocal);
+  g_old = Array<BoutReal>(nlocal);
+  g_new = Array<BoutReal>(nlocal);
+
+  // Put starting values into window_start
+  save_vars(std::begin(window_start));
+
+  return 0;
+}
+
+int PararealSolver::run() {
+  TRACE("PararealSolver::run()");
+
+  const int tag = 2701;
+  int done = 0; // Output steps finished
+  while (done < nsteps) {
+    // Number of time slices used in this window
+    const int nactive = std::min(nslices, nsteps - done);
+    const bool active = slice < nactive;
+    const BoutReal window_time = simtime;
+    const BoutReal slice_time = window_time + slice * out_timestep;
+
+    // Predict the state at the start of each slice with the coarse solver
+    if (active && (nactive > 1)) {
+      if (slice == 0) {
+        std::copy(std::begin(window_start), std::end(window_start), std::begin(u_start));
+      } else {
+        MPI_Recv(std::begin(u_start), nlocal, MPI_DOUBLE, slice - 1, tag, time_comm,
+                 MPI_STATUS_IGNORE);
+      }
+      propagate(coarse.get(), slice_time, u_start, g_old);
+      std::copy(std::begin(g_old), std::end(g_old), std::begin(u_end));
+      if (slice < nactive - 1) {
+        MPI_Send(std::begin(u_end), nlocal, MPI_DOUBLE, slice + 1, tag, time_comm);
+      }
+    } else if (active) {
+      std::copy(std::begin(window_start), std::end(window_start), std::begin(u_start));
+    }
+
+    int niter;
+    for (niter = 1; niter <= std::min(max_iterations, nactive); niter++) {
+      // Slices before niter-1 have already converged, and slice niter-1
+      // has the final state at its start
+      const bool changing = active && (slice >= niter - 1);
+
+      // Fine solves, all slices in parallel
+      if (changing) {
+        propagate(fine.get(), slice_time, u_start, f_end);
+      }
+
+      // Coarse corrections, one slice after the other
+      BoutReal change = 0.0;
+      if (changing) {
+        Array<BoutReal> u_new(nlocal);
+        if (slice == niter - 1) {
+          // Start is unchanged, so correction is the fine solution
+          std::copy(std::begin(f_end), std::end(f_end), std::begin(u_new));
+        } else {
+          MPI_Recv(std::begin(u_start), nlocal, MPI_DOUBLE, slice - 1, tag, time_comm,
+                   MPI_STATUS_IGNORE);
+          propagate(coarse.get(), slice_time, u_start, g_new);
+          for (int i = 0; i < nlocal; i++) {
+            u_new[i] = g_new[i] + f_end[i] - g_old[i];
+          }
+          swap(g_old, g_new);
+        }
+        if (slice < nactive - 1) {
+          MPI_Send(std::begin(u_new), nlocal, MPI_DOUBLE, slice + 1, tag, time_comm);
+        }
+        swap(u_end, u_new);
+        change = maxChange(u_end, u_new, true);
+      } else {
+        change = maxChange(u_end, u_end, false);
+      }
+
+      if (change <= 1.0) {
+        break;
+      }
+    }
+    niter = std::min(niter, std::min(max_iterations, nactive));
+
+    if (diagnose) {
+      output.write("\nParareal: t = %e, %d slices, %d iterations\n", window_time,
+                   nactive, niter);
+    }
+
+    // The first slice calls the monitors for each output in the window
+    int stop = 0;
+    if (active && (slice > 0)) {
+      MPI_Send(std::begin(u_end), nlocal, MPI_DOUBLE, 0, tag, time_comm);
+    }
+    if (slice == 0) {
+      Array<BoutReal> u_out(nlocal);
+      for (int p = 0; p < nactive; p++) {
+        if (p == 0) {
+          std::copy(std::begin(u_end), std::end(u_end), std::begin(u_out));
+        } else {
+          MPI_Recv(std::begin(u_out), nlocal, MPI_DOUBLE, p, tag, time_comm,
+                   MPI_STATUS_IGNORE);
+        }
+        if (stop) {
+          continue; // Receive the remaining slices, but don't output
+        }
+
+        simtime = window_time + (p + 1) * out_timestep;
+        load_vars(std::begin(u_out));
+        // Call rhs function to get extra variables at this time
+        run_rhs(simtime);
+
+        iteration++; // Advance iteration number
+
+        /// Call the monitor function
+        stop = call_monitors(simtime, done + p, nsteps);
+      }
+    }
+    MPI_Bcast(&stop, 1, MPI_INT, 0, time_comm);
+    if (stop) {
+      break;
+    }
+
+    // Start of the next window is the end of the last slice
+    if (slice == nactive - 1) {
+      std::copy(std::begin(u_end), std::end(u_end), std::begin(window_start));
+    }
+    MPI_Bcast(std::begin(window_start), nlocal, MPI_DOUBLE, nactive - 1, time_comm);
+
+    simtime = window_time + nactive * out_timestep;
+    done += nactive;
+  }
+
+  if (slice != 0) {
+    // Leave the final state in the variables on every slice
+    load_vars(std::begin(window_start));
+  }
+
+  return 0;
+}
+
+void PararealSolver::propagate(Solver *solver, BoutReal t, Array<BoutReal> &u,
+                               Array<BoutReal> &result) {
+  load_vars(std::begin(u));
+  solver->setTime(t);
+  solver->resetInternalFields();
+  solver->run();
+  save_vars(std::begin(result));
+}
+
+BoutReal PararealSolver::maxChange(const Array<BoutReal> &a, const Array<BoutReal> &b,
+                                   bool include) {
+  // Weighted sum of squares on this processor
+  BoutReal local[2] = {0.0, 0.0};
+  if (include) {
+    for (int i = 0; i < nlocal; i++) {
+      BoutReal w = 1. / (rtol * fabs(a[i]) + atol);
+      local[0] += SQ((a[i] - b[i]) * w);
+    }
+    local[1] = nlocal;
+  }
+
+  // RMS over the processors in this slice
+  BoutReal global[2];
+  MPI_Allreduce(local, global, 2, MPI_DOUBLE, MPI_SUM, BoutComm::get());
+  BoutReal change = (global[1] > 0.0) ? sqrt(global[0] / global[1]) : 0.0;
+
+  // Largest over the slices
+  BoutReal result;
+  MPI_Allreduce(&change, &result, 1, MPI_DOUBLE, MPI_MAX, time_comm);
+  return result;
+}
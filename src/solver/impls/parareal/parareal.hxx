@@ -0,0 +1,162 @@
+/**************************************************************************
+ * Parareal parallel-in-time method, using two other solvers
+ *
+ * Always available, since doesn't depend on external library
+ *
+ **************************************************************************
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class PararealSolver;
+
+#ifndef __PARAREAL_SOLVER_H__
+#define __PARAREAL_SOLVER_H__
+
+#include "mpi.h"
+
+#include <bout_types.hxx>
+#include <bout/solver.hxx>
+#include <boutexception.hxx>
+#include <utils.hxx>
+
+#include <memory>
+
+#include <bout/solverfactory.hxx>
+namespace {
+RegisterSolver<PararealSolver> registersolverparareal("parareal");
+}
+
+/// Parallel-in-time solver for slowly evolving problems
+///
+/// The processors are split into solver:time_slices groups by
+/// BoutInitialise, each with a copy of the mesh. Each group (time
+/// slice) advances the solution over one output interval, so a window
+/// of time_slices outputs is calculated at once. A cheap "coarse"
+/// solver first predicts the state at the start of every slice; then
+/// in each iteration the accurate "fine" solver runs on all slices in
+/// parallel, and the coarse solver propagates the corrections:
+///
+///     U_{p+1} = G(U_p new) + F(U_p old) - G(U_p old)
+///
+/// Iterations stop when the change in the state at the end of every
+/// slice is within the tolerances, or after max_iterations. After k
+/// iterations the first k slices are the same as using the fine
+/// solver alone.
+///
+/// Both solvers must support resetInternalFields. Only the first time
+/// slice calls monitors and writes output and restart files.
+class PararealSolver : public Solver {
+public:
+  PararealSolver(Options *options);
+  ~PararealSolver() = default;
+
+  int init(int nout, BoutReal tstep) override;
+
+  int run() override;
+
+  // Pass the model and variables through to the coarse and fine solvers
+
+  void setModel(PhysicsModel *model) override {
+    Solver::setModel(model);
+    coarse->setModel(model);
+    fine->setModel(model);
+  }
+  void setRHS(rhsfunc f) override {
+    Solver::setRHS(f);
+    coarse->setRHS(f);
+    fine->setRHS(f);
+  }
+  void setSplitOperator(rhsfunc fC, rhsfunc fD) override {
+    Solver::setSplitOperator(fC, fD);
+    coarse->setSplitOperator(fC, fD);
+    fine->setSplitOperator(fC, fD);
+  }
+
+  void add(Field2D &v, const std::string name) override {
+    Solver::add(v, name);
+    coarse->add(v, name);
+    fine->add(v, name);
+  }
+  void add(Field3D &v, const std::string name) override {
+    Solver::add(v, name);
+    coarse->add(v, name);
+    fine->add(v, name);
+  }
+  void add(Vector2D &v, const std::string name) override {
+    Solver::add(v, name);
+    coarse->add(v, name);
+    fine->add(v, name);
+  }
+  void add(Vector3D &v, const std::string name) override {
+    Solver::add(v, name);
+    coarse->add(v, name);
+    fine->add(v, name);
+  }
+
+  void constraint(Field2D &UNUSED(v), Field2D &UNUSED(C_v),
+                  const std::string UNUSED(name)) override {
+    throw BoutException("Parareal solver does not support constraints");
+  }
+  void constraint(Field3D &UNUSED(v), Field3D &UNUSED(C_v),
+                  const std::string UNUSED(name)) override {
+    throw BoutException("Parareal solver does not support constraints");
+  }
+  void constraint(Vector2D &UNUSED(v), Vector2D &UNUSED(C_v),
+                  const std::string UNUSED(name)) override {
+    throw BoutException("Parareal solver does not support constraints");
+  }
+  void constraint(Vector3D &UNUSED(v), Vector3D &UNUSED(C_v),
+                  const std::string UNUSED(name)) override {
+    throw BoutException("Parareal solver does not support constraints");
+  }
+
+  void setMaxTimestep(BoutReal dt) override {
+    coarse->setMaxTimestep(dt);
+    fine->setMaxTimestep(dt);
+  }
+  BoutReal getCurrentTimestep() override { return fine->getCurrentTimestep(); }
+
+private:
+  std::unique_ptr<Solver> coarse, fine; ///< Solvers used on each time slice
+
+  BoutReal atol, rtol;  ///< Convergence tolerances
+  int max_iterations;   ///< Maximum number of Parareal iterations per window
+  bool diagnose;        ///< Print iterations in each window
+
+  BoutReal out_timestep; ///< The output timestep
+  int nsteps;            ///< Number of output steps
+
+  int nlocal; ///< Number of variables on local processor
+
+  int slice, nslices; ///< This time slice, and the number of slices
+  MPI_Comm time_comm; ///< Communicator between time slices
+
+  Array<BoutReal> window_start; ///< State at the start of the window
+  Array<BoutReal> u_start, u_end; ///< State at the start and end of this slice
+  Array<BoutReal> f_end, g_old, g_new; ///< Results of the fine and coarse solvers
+
+  /// Advance the state \p u from time \p t over one output interval
+  /// using \p solver, putting the result in \p result
+  void propagate(Solver *solver, BoutReal t, Array<BoutReal> &u,
+                 Array<BoutReal> &result);
+
+  /// Largest weighted RMS difference between \p a and \p b over the
+  /// slices for which \p include is true. Collective on all processors
+  BoutReal maxChange(const Array<BoutReal> &a, const Array<BoutReal> &b, bool include);
+};
+
+#endif // __PARAREAL_SOLVER_H__
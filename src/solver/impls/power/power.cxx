@@ -5,6 +5,7 @@
 #include <boutcomm.hxx>
 #include <msg_stack.hxx>
 
+#include <algorithm>
 #include <cmath>
 
 #include <output.hxx>
@@ -22,6 +23,10 @@ int PowerSolver::init(int nout, BoutReal tstep) {
   
   // Get options
   OPTION(options, curtime, 0.0);
+  OPTION(options, rtol, 1e-8); // Relative change in eigenvalue when scanning
+  OPTION(options, nscan, 0);
+  OPTION(options, scan_start, 0.0);
+  OPTION(options, scan_end, scan_start);
 
   // Calculate number of variables
   nlocal = getLocalN();
@@ -40,6 +45,13 @@ int PowerSolver::init(int nout, BoutReal tstep) {
   // Save the eigenvalue to the output
   dump.add(eigenvalue, "eigenvalue", true);
   eigenvalue = 0.0;
+
+  if (nscan > 0) {
+    output.write("\tScanning %d values from %e to %e in %d groups\n", nscan, scan_start,
+                 scan_end, BoutComm::groups());
+    dump.add(scan_parameter, "scan_parameter", true);
+    scan_parameter = scan_start;
+  }
   
   // Put starting values into f0
   save_vars(std::begin(f0));
@@ -49,6 +61,10 @@ int PowerSolver::init(int nout, BoutReal tstep) {
 
 int PowerSolver::run() {
   TRACE("PowerSolver::run()");
+
+  if (nscan > 0) {
+    return runScan();
+  }
   
   // Make sure that f0 has a norm of 1
   divide(f0, norm(f0));
@@ -79,6 +95,95 @@ int PowerSolver::run() {
   return 0;
 }
 
+int PowerSolver::iterate() {
+  // Make sure that f0 has a norm of 1
+  divide(f0, norm(f0));
+
+  BoutReal last = 0.0;
+  for (int s = 1; s <= nsteps; s++) {
+    load_vars(std::begin(f0));
+    run_rhs(curtime);
+    save_derivs(std::begin(f0));
+
+    eigenvalue = norm(f0);
+    divide(f0, eigenvalue);
+
+    if (fabs(eigenvalue - last) <= rtol * eigenvalue) {
+      return s;
+    }
+    last = eigenvalue;
+  }
+  return nsteps;
+}
+
+int PowerSolver::runScan() {
+  TRACE("PowerSolver::runScan()");
+
+  const int group = BoutComm::group();
+  const int ngroups = BoutComm::groups();
+  MPI_Comm scan_comm = BoutComm::acrossGroups();
+  const int tag = 2702;
+
+  Array<BoutReal> result(nlocal);
+
+  for (int first = 0; first < nscan; first += ngroups) {
+    // Number of groups solving in this round
+    const int nactive = std::min(ngroups, nscan - first);
+
+    // Parameter value, eigenvalue and number of iterations
+    BoutReal values[3];
+    if (group < nactive) {
+      const int point = first + group;
+      scan_parameter = (nscan > 1)
+                           ? scan_start + point * (scan_end - scan_start) / (nscan - 1)
+                           : scan_start;
+      set_scan_parameter(scan_parameter);
+
+      values[0] = scan_parameter;
+      values[2] = iterate();
+      values[1] = eigenvalue;
+
+      if (group > 0) {
+        MPI_Send(values, 3, MPI_DOUBLE, 0, tag, scan_comm);
+        MPI_Send(std::begin(f0), nlocal, MPI_DOUBLE, 0, tag, scan_comm);
+      }
+    }
+
+    // The first group writes the results in order
+    int stop = 0;
+    if (group == 0) {
+      for (int p = 0; p < nactive; p++) {
+        if (p == 0) {
+          std::copy(std::begin(f0), std::end(f0), std::begin(result));
+        } else {
+          MPI_Recv(values, 3, MPI_DOUBLE, p, tag, scan_comm, MPI_STATUS_IGNORE);
+          MPI_Recv(std::begin(result), nlocal, MPI_DOUBLE, p, tag, scan_comm,
+                   MPI_STATUS_IGNORE);
+        }
+        if (stop) {
+          continue; // Receive the remaining results, but don't output
+        }
+
+        scan_parameter = values[0];
+        eigenvalue = values[1];
+        output.write("\nScan %d: parameter = %e, eigenvalue = %e, %d iterations\n",
+                     first + p, scan_parameter, eigenvalue, static_cast<int>(values[2]));
+
+        // Write the eigenvector
+        load_vars(std::begin(result));
+        stop = call_monitors(scan_parameter, first + p, nscan);
+      }
+    }
+    MPI_Bcast(&stop, 1, MPI_INT, 0, scan_comm);
+    if (stop) {
+      output.write("Monitor signalled to quit. Returning\n");
+      break;
+    }
+  }
+
+  return 0;
+}
+
 BoutReal PowerSolver::norm(Array<BoutReal> &state) {
   BoutReal total = 0.0, result;
   
@@ -54,6 +54,13 @@ class PowerSolver : public Solver {
   
   BoutReal eigenvalue;
 
+  BoutReal rtol; // Stop iterating when the eigenvalue changes by less than this
+  
+  // Eigenvalue scans
+  int nscan; // Number of values of the scanned parameter. 0 if not scanning
+  BoutReal scan_start, scan_end; // Range of the scanned parameter
+  BoutReal scan_parameter; // Current value of the scanned parameter
+
   int nlocal, nglobal; // Number of variables
   Array<BoutReal> f0;  // The system state
   
@@ -61,6 +68,15 @@ class PowerSolver : public Solver {
   
   BoutReal norm(Array<BoutReal> &state);
   void divide(Array<BoutReal> &in, BoutReal value);
+
+  // Iterate from the state in f0 until converged or nsteps iterations.
+  // Returns the number of iterations
+  int iterate();
+
+  // Solve for each value of the scanned parameter in turn, starting
+  // from the previous eigenvector. If the processors are split into
+  // groups, each group solves for different values
+  int runScan();
 };
 
 #endif // __KARNIADAKIS_SOLVER_H__
@@ -10,7 +10,7 @@
 
 #include <output.hxx>
 
-RK3SSP::RK3SSP(Options *opt) : Solver(opt) {}
+RK3SSP::RK3SSP(Options *opt) : Solver(opt) { canReset = true; }
 
 void RK3SSP::setMaxTimestep(BoutReal dt) {
   if(dt > timestep)
@@ -66,6 +66,11 @@ int RK3SSP::init(int nout, BoutReal tstep) {
   return 0;
 }
 
+void RK3SSP::resetInternalFields() {
+  // Copy fields into current step
+  save_vars(std::begin(f));
+}
+
 int RK3SSP::run() {
   TRACE("RK3SSP::run()");
   
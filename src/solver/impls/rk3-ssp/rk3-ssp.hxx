@@ -51,6 +51,7 @@ class RK3SSP : public Solver {
   RK3SSP(Options *opt = nullptr);
   ~RK3SSP(){};
   
+  void resetInternalFields() override;
   void setMaxTimestep(BoutReal dt) override;
   BoutReal getCurrentTimestep() override {return timestep; }
   
@@ -628,6 +628,126 @@ void Solver::outputVars(Datafile &outputfile, bool save_repeat) {
   }
 }
 
+void Solver::outputHistory(Datafile &outputfile) {
+  outputfile.addOnce(history_steps, "history_steps");
+  outputHistoryVars(outputfile);
+}
+
+void Solver::readHistory(const std::string &filename) {
+  TRACE("Solver::readHistory");
+
+  history_steps = 0;
+
+  // Processors which don't write restart files (e.g. in groups other
+  // than the first) have no history of their own to read
+  Options *restart_options = Options::getRoot()->getSection("restart");
+  bool enabled;
+  restart_options->get("enabled", enabled, true);
+  if (!enabled) {
+    return;
+  }
+
+  // The number of steps is read with the same settings as the restart
+  // file, but is set to zero rather than being an error if missing
+  Options file_options;
+  for (const auto &it : restart_options->values()) {
+    file_options.set(it.first, it.second.value, it.second.source);
+  }
+  file_options.set("init_missing", true, "Solver::readHistory", true);
+
+  auto read = [&filename](Datafile &file) {
+    if (file.decompositionChanged("%s", filename.c_str())) {
+      return file.readRedistributed("%s", filename.c_str());
+    }
+    bool success = file.openr("%s", filename.c_str()) && file.read();
+    file.close();
+    return success;
+  };
+
+  Datafile steps_file(&file_options);
+  steps_file.addOnce(history_steps, "history_steps");
+  if (!read(steps_file) || (history_steps <= 0)) {
+    history_steps = 0;
+    return;
+  }
+
+  // All of the state must be there, but it may have been written
+  // with different settings, e.g. a different maximum order
+  output.write("\tReading %d steps of solver history\n", history_steps);
+  Datafile state_file(restart_options);
+  outputHistoryVars(state_file);
+  bool success;
+  try {
+    success = read(state_file);
+  } catch (const BoutException &e) {
+    output_warn.write("\t%s\n", e.what());
+    success = false;
+  }
+  if (!success) {
+    output_warn.write("\tWARNING: Could not read solver history. Starting without it\n");
+    history_steps = 0;
+  }
+}
+
+void Solver::add_state(StateFields &fields, Datafile &outputfile,
+                       const std::string &suffix) {
+  if ((fields.f2d.size() != f2d.size()) || (fields.f3d.size() != f3d.size())) {
+    // Create all the fields first, since outputfile keeps pointers to them
+    fields.f2d.clear();
+    for (const auto &f : f2d) {
+      fields.f2d.emplace_back(f.var->getMesh());
+      fields.f2d.back() = 0.0;
+    }
+    fields.f3d.clear();
+    for (const auto &f : f3d) {
+      fields.f3d.emplace_back(f.var->getMesh());
+      fields.f3d.back() = 0.0;
+      fields.f3d.back().setLocation(f.location);
+    }
+  }
+
+  for (std::size_t i = 0; i < f2d.size(); i++) {
+    outputfile.addOnce(fields.f2d[i], f2d[i].name + "_" + suffix);
+  }
+  for (std::size_t i = 0; i < f3d.size(); i++) {
+    outputfile.addOnce(fields.f3d[i], f3d[i].name + "_" + suffix);
+  }
+}
+
+void Solver::load_state(StateFields &fields, BoutReal *udata) {
+  loop_state(fields, udata, LOAD_VARS);
+}
+
+void Solver::save_state(StateFields &fields, BoutReal *udata) {
+  loop_state(fields, udata, SAVE_VARS);
+}
+
+void Solver::loop_state(StateFields &fields, BoutReal *udata, SOLVER_VAR_OP op) {
+  ASSERT1(fields.f2d.size() == f2d.size());
+  ASSERT1(fields.f3d.size() == f3d.size());
+
+  // Point the variables at the fields while looping
+  vector<Field2D *> vars2d;
+  for (std::size_t i = 0; i < f2d.size(); i++) {
+    vars2d.push_back(f2d[i].var);
+    f2d[i].var = &fields.f2d[i];
+  }
+  vector<Field3D *> vars3d;
+  for (std::size_t i = 0; i < f3d.size(); i++) {
+    vars3d.push_back(f3d[i].var);
+    f3d[i].var = &fields.f3d[i];
+  }
+
+  loop_vars(udata, op);
+
+  for (std::size_t i = 0; i < f2d.size(); i++) {
+    f2d[i].var = vars2d[i];
+  }
+  for (std::size_t i = 0; i < f3d.size(); i++) {
+    f3d[i].var = vars3d[i];
+  }
+}
+
 /////////////////////////////////////////////////////
 
 /// Method to add a Monitor to the Solver
@@ -676,7 +796,7 @@ void Solver::removeMonitor(Monitor * f) {
 extern bool user_requested_exit;
 int Solver::call_monitors(BoutReal simtime, int iter, int NOUT) {
   bool abort;
-  MPI_Allreduce(&user_requested_exit,&abort,1,MPI_C_BOOL,MPI_LOR,MPI_COMM_WORLD);
+  MPI_Allreduce(&user_requested_exit,&abort,1,MPI_C_BOOL,MPI_LOR,BoutComm::get());
   if(abort){
     NOUT=iter+1;
   }
@@ -705,7 +825,7 @@ int Solver::call_monitors(BoutReal simtime, int iter, int NOUT) {
   }
 
   // Check if any of the monitors has asked to quit
-  MPI_Allreduce(&user_requested_exit,&abort,1,MPI_C_BOOL,MPI_LOR,MPI_COMM_WORLD);
+  MPI_Allreduce(&user_requested_exit,&abort,1,MPI_C_BOOL,MPI_LOR,BoutComm::get());
 
   if ( iter == NOUT || abort ){
     for (const auto &it : monitors){
@@ -722,6 +842,15 @@ int Solver::call_monitors(BoutReal simtime, int iter, int NOUT) {
   return 0;
 }
 
+Field3D *Solver::getField3D(const std::string &name) {
+  for (const auto &f : f3d) {
+    if (f.name == name) {
+      return f.var;
+    }
+  }
+  return nullptr;
+}
+
 int Solver::resetRHSCounter() {
   int t = rhs_ncalls;
   rhs_ncalls = 0;
@@ -1248,6 +1377,15 @@ int Solver::run_diffusive(BoutReal t, bool linear) {
   return status;
 }
 
+void Solver::set_scan_parameter(BoutReal value) {
+  if (model == nullptr) {
+    throw BoutException("Eigenvalue scans need a PhysicsModel");
+  }
+  if (model->runScanParameter(value)) {
+    throw BoutException("Physics model doesn't support eigenvalue scans");
+  }
+}
+
 void Solver::pre_rhs(BoutReal t) {
 
   // Apply boundary conditions to the values
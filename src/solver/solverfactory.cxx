@@ -1,11 +1,14 @@
 #include "bout/solverfactory.hxx"
 
 #include "impls/arkode/arkode.hxx"
+#include "impls/bdf/bdf.hxx"
 #include "impls/cvode/cvode.hxx"
 #include "impls/euler/euler.hxx"
 #include "impls/ida/ida.hxx"
 #include "impls/imex-bdf2/imex-bdf2.hxx"
 #include "impls/karniadakis/karniadakis.hxx"
+#include "impls/multirate/multirate.hxx"
+#include "impls/parareal/parareal.hxx"
 #include "impls/petsc/petsc.hxx"
 #include "impls/power/power.hxx"
 #include "impls/pvode/pvode.hxx"
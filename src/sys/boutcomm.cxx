@@ -1,14 +1,19 @@
 #include <boutcomm.hxx>
 #include <bout_types.hxx>
+#include <boutexception.hxx>
 
 BoutComm* BoutComm::instance = nullptr;
 
 BoutComm::BoutComm()
-    : pargc(nullptr), pargv(nullptr), hasBeenSet(false), comm(MPI_COMM_NULL) {}
+    : pargc(nullptr), pargv(nullptr), hasBeenSet(false), comm(MPI_COMM_NULL),
+      ngroups(1), mygroup(0), across(MPI_COMM_NULL) {}
 
 BoutComm::~BoutComm() {
   if(comm != MPI_COMM_NULL)
     MPI_Comm_free(&comm);
+
+  if(across != MPI_COMM_NULL)
+    MPI_Comm_free(&across);
   
   if(!isSet()) {
     // If BoutComm was set, then assume that MPI_Finalize is called elsewhere
@@ -61,6 +66,47 @@ int BoutComm::size() {
   return NPES;
 }
 
+void BoutComm::split(int ngroups) {
+  BoutComm *bc = getInstance();
+  if (bc->ngroups != 1) {
+    throw BoutException("BoutComm::split: processors already split into groups");
+  }
+
+  int NPES = size();
+  int MYPE = rank();
+  if ((ngroups < 1) || (NPES % ngroups != 0)) {
+    throw BoutException("BoutComm::split: Number of processors (%d) not divisible by "
+                        "number of groups (%d)",
+                        NPES, ngroups);
+  }
+  int group_size = NPES / ngroups;
+
+  bc->ngroups = ngroups;
+  bc->mygroup = MYPE / group_size;
+
+  // Processors with the same rank in each group
+  MPI_Comm_split(bc->comm, MYPE % group_size, bc->mygroup, &bc->across);
+
+  // Processors in the same group replace the global communicator
+  MPI_Comm group_comm;
+  MPI_Comm_split(bc->comm, bc->mygroup, MYPE, &group_comm);
+  MPI_Comm_free(&bc->comm);
+  bc->comm = group_comm;
+}
+
+int BoutComm::group() {
+  return getInstance()->mygroup;
+}
+
+int BoutComm::groups() {
+  return getInstance()->ngroups;
+}
+
+MPI_Comm BoutComm::acrossGroups() {
+  BoutComm *bc = getInstance();
+  return (bc->across == MPI_COMM_NULL) ? MPI_COMM_SELF : bc->across;
+}
+
 BoutComm* BoutComm::getInstance() {
   if(instance == nullptr) {
     // Create the singleton object
@@ -23,6 +23,7 @@
  **************************************************************************/
 
 #include <bout/sys/expressionparser.hxx>
+#include <bout/sys/expressionprogram.hxx>
 
 #include <utils.hxx> // for lowercase
 
@@ -49,6 +50,10 @@ namespace { // These classes only visible in this file
                     double UNUSED(t)) override {
       return x;
     }
+    bool dependsOnTime() override { return false; }
+    int compile(ExpressionProgram &program) override {
+      return program.variable('x');
+    }
     const std::string str() override { return std::string("x"); }
   };
   
@@ -61,6 +66,10 @@ namespace { // These classes only visible in this file
                     double UNUSED(t)) override {
       return y;
     }
+    bool dependsOnTime() override { return false; }
+    int compile(ExpressionProgram &program) override {
+      return program.variable('y');
+    }
     const std::string str() override { return std::string("y"); }
   };
 
@@ -73,6 +82,10 @@ namespace { // These classes only visible in this file
                     double UNUSED(t)) override {
       return z;
     }
+    bool dependsOnTime() override { return false; }
+    int compile(ExpressionProgram &program) override {
+      return program.variable('z');
+    }
     const std::string str() override { return std::string("z"); }
   };
   
@@ -85,6 +98,9 @@ namespace { // These classes only visible in this file
                     double t) override {
       return t;
     }
+    int compile(ExpressionProgram &program) override {
+      return program.variable('t');
+    }
     const std::string str() override { return std::string("t"); }
   };
 }
@@ -111,6 +127,19 @@ BoutReal FieldBinary::generate(double x, double y, double z, double t) {
   throw ParseException("Unknown binary operator '%c'", op);
 }
 
+int FieldBinary::compile(ExpressionProgram &program) {
+  int lval = lhs->compile(program);
+  int rval = rhs->compile(program);
+  if (op == '^') {
+    return program.call(static_cast<double (*)(double, double)>(pow), lval, rval);
+  }
+  return program.binary(op, lval, rval);
+}
+
+int FieldValue::compile(ExpressionProgram &program) {
+  return program.constant(value);
+}
+
 /////////////////////////////////////////////
 
 ExpressionParser::ExpressionParser() {
@@ -0,0 +1,302 @@
+/**************************************************************************
+ * Compiles a tree of generators into a flat list of instructions
+ *
+ **************************************************************************
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <bout/sys/expressionprogram.hxx>
+
+#include <algorithm>
+#include <cstring>
+
+int FieldGenerator::compile(ExpressionProgram &program) {
+  // Not known to the compiler, so call at every point
+  return program.generate(this);
+}
+
+ExpressionProgram::ExpressionProgram(FieldGeneratorPtr gen) : root(std::move(gen)) {
+  if (!root) {
+    throw ParseException("ExpressionProgram: Can't compile a null generator");
+  }
+  result_register = root->compile(*this);
+
+  lookup.clear();
+
+  allocateSlots();
+}
+
+void ExpressionProgram::allocateSlots() {
+  // Remove instructions not needed for the result, such as
+  // constants which have been folded into others
+  std::vector<bool> live(size(), false);
+  live[result_register] = true;
+  for (int i = result_register; i >= 0; i--) {
+    if (live[i]) {
+      for (int r : {instructions[i].a, instructions[i].b}) {
+        if (r >= 0) {
+          live[r] = true;
+        }
+      }
+    }
+  }
+  std::vector<int> renumber(size(), -1);
+  std::vector<Instruction> needed;
+  for (int i = 0; i < size(); i++) {
+    if (live[i]) {
+      Instruction ins = instructions[i];
+      ins.a = (ins.a >= 0) ? renumber[ins.a] : -1;
+      ins.b = (ins.b >= 0) ? renumber[ins.b] : -1;
+      renumber[i] = static_cast<int>(needed.size());
+      needed.push_back(ins);
+    }
+  }
+  instructions = std::move(needed);
+  result_register = renumber[result_register];
+
+  const int nins = size();
+  std::vector<int> last_use(nins, -1);
+  for (int i = 0; i < nins; i++) {
+    for (int r : {instructions[i].a, instructions[i].b}) {
+      if (r >= 0) {
+        last_use[r] = i;
+      }
+    }
+  }
+
+  // Reuse the storage of registers after their last use
+  std::vector<int> free_slots;
+  nslots = 0;
+  for (int i = 0; i < nins; i++) {
+    Instruction &ins = instructions[i];
+    // Operands can be overwritten, since each point only depends on
+    // the same point in the operands
+    if ((ins.a >= 0) && (last_use[ins.a] == i)) {
+      free_slots.push_back(instructions[ins.a].slot);
+    }
+    if ((ins.b >= 0) && (ins.b != ins.a) && (last_use[ins.b] == i)) {
+      free_slots.push_back(instructions[ins.b].slot);
+    }
+    if (free_slots.empty()) {
+      ins.slot = nslots++;
+    } else {
+      ins.slot = free_slots.back();
+      free_slots.pop_back();
+    }
+  }
+}
+
+int ExpressionProgram::add(Instruction ins) {
+  // Fold operations on constants
+  auto is_constant = [this](int r) {
+    return (r >= 0) && (instructions[r].op == Op::Constant);
+  };
+  if ((ins.a >= 0) && is_constant(ins.a) && ((ins.b < 0) || is_constant(ins.b))) {
+    const double a = instructions[ins.a].value;
+    const double b = (ins.b >= 0) ? instructions[ins.b].value : 0.0;
+    switch (ins.op) {
+    case Op::Add:
+      return constant(a + b);
+    case Op::Sub:
+      return constant(a - b);
+    case Op::Mul:
+      return constant(a * b);
+    case Op::Div:
+      return constant(a / b);
+    case Op::Min:
+      return constant((b < a) ? b : a);
+    case Op::Max:
+      return constant((b > a) ? b : a);
+    case Op::Call1:
+      return constant(ins.func1(a));
+    case Op::Call2:
+      return constant(ins.func2(a, b));
+    default:
+      break;
+    }
+  }
+
+  // Look for an identical instruction. Constants are compared by bit
+  // pattern, so that NaN and -0 are handled
+  std::uint64_t bits = 0;
+  std::memcpy(&bits, &ins.value, sizeof(bits));
+  std::uintptr_t ptr = 0;
+  if (ins.op == Op::Call1) {
+    ptr = reinterpret_cast<std::uintptr_t>(ins.func1);
+  } else if (ins.op == Op::Call2) {
+    ptr = reinterpret_cast<std::uintptr_t>(ins.func2);
+  } else if (ins.op == Op::Generate) {
+    ptr = reinterpret_cast<std::uintptr_t>(ins.gen);
+  }
+  const Key key{static_cast<int>(ins.op), ins.a, ins.b, bits, ptr};
+
+  auto it = lookup.find(key);
+  if (it != lookup.end()) {
+    return it->second;
+  }
+
+  instructions.push_back(ins);
+  const int reg = size() - 1;
+  lookup[key] = reg;
+  return reg;
+}
+
+int ExpressionProgram::constant(double value) {
+  return add({Op::Constant, -1, -1, value, nullptr, nullptr, nullptr, -1});
+}
+
+int ExpressionProgram::variable(char name) {
+  Op op;
+  switch (name) {
+  case 'x':
+    op = Op::X;
+    break;
+  case 'y':
+    op = Op::Y;
+    break;
+  case 'z':
+    op = Op::Z;
+    break;
+  case 't':
+    op = Op::T;
+    break;
+  default:
+    throw ParseException("ExpressionProgram: Unknown variable '%c'", name);
+  }
+  return add({op, -1, -1, 0.0, nullptr, nullptr, nullptr, -1});
+}
+
+int ExpressionProgram::binary(char op, int a, int b) {
+  Op code;
+  switch (op) {
+  case '+':
+    code = Op::Add;
+    break;
+  case '-':
+    code = Op::Sub;
+    break;
+  case '*':
+    code = Op::Mul;
+    break;
+  case '/':
+    code = Op::Div;
+    break;
+  default:
+    throw ParseException("ExpressionProgram: Unknown binary operator '%c'", op);
+  }
+  return add({code, a, b, 0.0, nullptr, nullptr, nullptr, -1});
+}
+
+int ExpressionProgram::min(int a, int b) {
+  return add({Op::Min, a, b, 0.0, nullptr, nullptr, nullptr, -1});
+}
+
+int ExpressionProgram::max(int a, int b) {
+  return add({Op::Max, a, b, 0.0, nullptr, nullptr, nullptr, -1});
+}
+
+int ExpressionProgram::call(UnaryFunction func, int a) {
+  return add({Op::Call1, a, -1, 0.0, func, nullptr, nullptr, -1});
+}
+
+int ExpressionProgram::call(BinaryFunction func, int a, int b) {
+  return add({Op::Call2, a, b, 0.0, nullptr, func, nullptr, -1});
+}
+
+int ExpressionProgram::generate(FieldGenerator *gen) {
+  return add({Op::Generate, -1, -1, 0.0, nullptr, nullptr, gen, -1});
+}
+
+void ExpressionProgram::evaluate(int n, const double *x, const double *y,
+                                 const double *z, double t, double *result,
+                                 std::vector<double> &work) const {
+  if (work.size() < static_cast<size_t>(nslots * n)) {
+    work.resize(nslots * n);
+  }
+
+  const int nins = size();
+  for (int i = 0; i < nins; i++) {
+    const Instruction &ins = instructions[i];
+    // The last instruction writes directly to the result
+    double *out = (i == result_register) ? result : &work[ins.slot * n];
+    const double *a = (ins.a >= 0) ? &work[instructions[ins.a].slot * n] : nullptr;
+    const double *b = (ins.b >= 0) ? &work[instructions[ins.b].slot * n] : nullptr;
+
+    switch (ins.op) {
+    case Op::Constant:
+      std::fill(out, out + n, ins.value);
+      break;
+    case Op::X:
+      std::copy(x, x + n, out);
+      break;
+    case Op::Y:
+      std::copy(y, y + n, out);
+      break;
+    case Op::Z:
+      std::copy(z, z + n, out);
+      break;
+    case Op::T:
+      std::fill(out, out + n, t);
+      break;
+    case Op::Add:
+      for (int j = 0; j < n; j++) {
+        out[j] = a[j] + b[j];
+      }
+      break;
+    case Op::Sub:
+      for (int j = 0; j < n; j++) {
+        out[j] = a[j] - b[j];
+      }
+      break;
+    case Op::Mul:
+      for (int j = 0; j < n; j++) {
+        out[j] = a[j] * b[j];
+      }
+      break;
+    case Op::Div:
+      for (int j = 0; j < n; j++) {
+        out[j] = a[j] / b[j];
+      }
+      break;
+    case Op::Min:
+      for (int j = 0; j < n; j++) {
+        out[j] = (b[j] < a[j]) ? b[j] : a[j];
+      }
+      break;
+    case Op::Max:
+      for (int j = 0; j < n; j++) {
+        out[j] = (b[j] > a[j]) ? b[j] : a[j];
+      }
+      break;
+    case Op::Call1:
+      for (int j = 0; j < n; j++) {
+        out[j] = ins.func1(a[j]);
+      }
+      break;
+    case Op::Call2:
+      for (int j = 0; j < n; j++) {
+        out[j] = ins.func2(a[j], b[j]);
+      }
+      break;
+    case Op::Generate:
+      for (int j = 0; j < n; j++) {
+        out[j] = ins.gen->generate(x[j], y[j], z[j], t);
+      }
+      break;
+    }
+  }
+}
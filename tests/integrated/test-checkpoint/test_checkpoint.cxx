@@ -0,0 +1,96 @@
+/*
+ * Test restarting from checkpoints with a multistep solver
+ *
+ * If option test:interrupt is set, the process is killed while
+ * writing the checkpoint at that output, by limiting the size of
+ * files it can write. If test:reference is the directory containing
+ * the restart files of an uninterrupted run, the fields at the last
+ * output are compared with them, and the run stops with an error if
+ * they differ.
+ * As the solver history is saved in checkpoints, the restarted run
+ * should take exactly the same steps
+ */
+
+#include <bout/physicsmodel.hxx>
+
+#include <boutcomm.hxx>
+#include <datafile.hxx>
+
+#include <sys/resource.h>
+
+class CheckpointTest : public PhysicsModel {
+private:
+  Field3D f3d;
+  Field2D f2d;
+
+  int interrupt;         ///< Output at which to kill the process
+  int limit;             ///< File size limit in bytes when interrupting
+  std::string reference; ///< Directory of restart files to compare against
+  BoutReal tol;
+
+protected:
+  int init(bool UNUSED(restarting)) override {
+    Options *opt = Options::getRoot()->getSection("test");
+    OPTION(opt, interrupt, -1);
+    OPTION(opt, limit, 16384); // Restart files here are several times larger
+    OPTION(opt, reference, "");
+    OPTION(opt, tol, 1e-12);
+
+    SOLVE_FOR2(f3d, f2d);
+    return 0;
+  }
+
+  int rhs(BoutReal UNUSED(time)) override {
+    ddt(f3d) = -f3d;
+    ddt(f2d) = -0.5 * f2d;
+    return 0;
+  }
+
+  int outputMonitor(BoutReal simtime, int iter, int NOUT) override {
+    if ((interrupt >= 0) && (iter == interrupt)) {
+      // The checkpoint is written after this monitor. Stop logging to
+      // file, so that only the checkpoint exceeds the limit
+      output.write("\tInterrupting checkpoint at time %e\n", simtime);
+      output.close();
+      rlimit file_size;
+      file_size.rlim_cur = file_size.rlim_max = limit;
+      setrlimit(RLIMIT_FSIZE, &file_size);
+    }
+
+    if (reference.empty() || (iter != NOUT - 1)) {
+      return 0;
+    }
+
+    // Compare with the uninterrupted run
+    Field3D f3d_ref;
+    Field2D f2d_ref;
+    BoutReal time_ref;
+    std::string ext;
+    Options::getRoot()->get("dump_format", ext, "nc");
+    Datafile ref_file(Options::getRoot()->getSection("restart"));
+    ref_file.addOnce(f3d_ref, "f3d");
+    ref_file.addOnce(f2d_ref, "f2d");
+    ref_file.addOnce(time_ref, "tt");
+    if (!ref_file.openr("%s/BOUT.restart.%s", reference.c_str(), ext.c_str()) ||
+        !ref_file.read()) {
+      throw BoutException("Could not read reference in %s", reference.c_str());
+    }
+    ref_file.close();
+
+    BoutReal error = BOUTMAX(max(abs(f3d - f3d_ref)), max(abs(f2d - f2d_ref)));
+    BoutReal max_error;
+    MPI_Allreduce(&error, &max_error, 1, MPI_DOUBLE, MPI_MAX, BoutComm::get());
+
+    output.write("\tTime %e: difference from reference %e\n", simtime, max_error);
+    if (simtime != time_ref) {
+      throw BoutException("Time %e does not match reference time %e", simtime,
+                          time_ref);
+    }
+    if (!(max_error < tol)) {
+      throw BoutException("Fields do not match reference: difference %e", max_error);
+    }
+    return 0;
+  }
+};
+
+BOUTMAIN(CheckpointTest);
@@ -0,0 +1,66 @@
+/*
+ * Test evolving an ensemble of models
+ *
+ * Each member's field and vector decay exponentially at a different
+ * rate, and the member saves variables to the output file. Each output
+ * the solution is compared with the exact solution, and the run stops
+ * with an error if they don't match
+ */
+
+#include <bout/physicsmodel.hxx>
+
+#include <boutcomm.hxx>
+
+class EnsembleTest : public PhysicsModel {
+private:
+  Field3D f;
+  Vector2D v; ///< Decays like f, so the components are checked
+
+  BoutReal rate; ///< Decay rate, different in each member
+  Field3D f0;    ///< Initial value of f
+  Vector2D v0;   ///< Initial value of v
+  BoutReal error; ///< Maximum difference from the exact solution
+
+  BoutReal tol;
+
+protected:
+  int init(bool UNUSED(restarting)) override {
+    Options *options = Options::getRoot()->getSection("test");
+    OPTION(options, rate, 1.0);
+    OPTION(options, tol, 1e-8);
+
+    SOLVE_FOR(f);
+    f0 = f;
+    v.covariant = false;
+    SOLVE_FOR(v);
+    v0 = v;
+    error = 0.0;
+
+    // These have the member suffix in an ensemble, so don't clash
+    SAVE_ONCE(rate, f0);
+    SAVE_REPEAT(error);
+    return 0;
+  }
+
+  int rhs(BoutReal UNUSED(time)) override {
+    ddt(f) = -rate * f;
+    ddt(v) = -rate * v;
+    return 0;
+  }
+
+  int outputMonitor(BoutReal simtime, int UNUSED(iter), int UNUSED(NOUT)) override {
+    BoutReal local_error = max(abs(f - f0 * exp(-rate * simtime)));
+    Vector2D dv = v - v0 * exp(-rate * simtime);
+    local_error = BOUTMAX(local_error, max(abs(dv.x)), max(abs(dv.y)), max(abs(dv.z)));
+    MPI_Allreduce(&local_error, &error, 1, MPI_DOUBLE, MPI_MAX, BoutComm::get());
+
+    output.write("\tRate %e, time %e: error %e\n", rate, simtime, error);
+    if (!(error < tol)) {
+      throw BoutException("Solution with rate %e does not match at time %e: error %e",
+                          rate, simtime, error);
+    }
+    return 0;
+  }
+};
+
+BOUTMAIN(EnsembleTest);
@@ -0,0 +1,98 @@
+/*
+ * Test the finite volume 4th derivative in Y, FV::D4DY4
+ *
+ * The result is compared against a direct calculation of the fluxes
+ * through each cell face. There is no flux through Y boundaries, but
+ * on periodic surfaces the flux across the periodic boundary must be
+ * calculated on both sides, so the sum over the domain of the
+ * result times the volume is also checked to be zero
+ */
+
+#include <bout.hxx>
+
+#include <bout/fv_ops.hxx>
+#include <boutcomm.hxx>
+#include <field_factory.hxx>
+
+#include <vector>
+
+int main(int argc, char **argv) {
+  BoutInitialise(argc, argv);
+
+  BoutReal tol;
+  OPTION(Options::getRoot(), tol, 1e-10);
+
+  FieldFactory factory(mesh);
+  std::string function;
+  Options::getRoot()->getSection("f")->get("function", function, "0");
+  Field3D f = factory.create3D(function);
+  Options::getRoot()->getSection("d")->get("function", function, "1");
+  Field3D d = factory.create3D(function);
+  mesh->communicate(f, d);
+
+  Coordinates *coord = mesh->coordinates();
+
+  Field3D result = FV::D4DY4(d, f);
+
+  // Flux through the face between y and y+1
+  auto face_flux = [&](int x, int y, int z) {
+    const bool periodic = mesh->periodicY(x);
+    if (!periodic && mesh->lastY(x) && (y == mesh->yend)) {
+      return 0.0;
+    }
+    if (!periodic && mesh->firstY(x) && (y == mesh->ystart - 1)) {
+      return 0.0;
+    }
+    const BoutReal dy3 = pow(coord->dy(x, y), 3);
+    const BoutReal d3fdy3 =
+        (f(x, y + 2, z) - 3. * f(x, y + 1, z) + 3. * f(x, y, z) - f(x, y - 1, z)) / dy3;
+    return 0.5 * (d(x, y, z) + d(x, y + 1, z)) * (coord->J(x, y) + coord->J(x, y + 1))
+           * d3fdy3;
+  };
+
+  BoutReal error = 0.0;
+  BoutReal scale = 0.0; // Size of the terms in the volume integral
+  std::vector<BoutReal> local(mesh->GlobalNx, 0.0), global(local.size());
+  for (int x = mesh->xstart; x <= mesh->xend; x++) {
+    for (int y = mesh->ystart; y <= mesh->yend; y++) {
+      const BoutReal volume = coord->J(x, y) * coord->dy(x, y);
+      for (int z = 0; z < mesh->LocalNz; z++) {
+        const BoutReal expected = (face_flux(x, y, z) - face_flux(x, y - 1, z)) / volume;
+        error = BOUTMAX(error, fabs(result(x, y, z) - expected));
+        local[mesh->XGLOBAL(x)] += result(x, y, z) * volume;
+        scale = BOUTMAX(scale, fabs(expected * volume));
+      }
+    }
+  }
+
+  BoutReal max_error, max_scale;
+  MPI_Allreduce(&error, &max_error, 1, MPI_DOUBLE, MPI_MAX, BoutComm::get());
+  MPI_Allreduce(&scale, &max_scale, 1, MPI_DOUBLE, MPI_MAX, BoutComm::get());
+  MPI_Allreduce(local.data(), global.data(), local.size(), MPI_DOUBLE, MPI_SUM,
+                BoutComm::get());
+
+  // Each surface of constant X should conserve the integral
+  BoutReal max_sum = 0.0;
+  for (const auto &sum : global) {
+    max_sum = BOUTMAX(max_sum, fabs(sum));
+  }
+  max_sum /= max_scale;
+
+  int failures = 0;
+  bool passed = max_error < tol * max_scale;
+  output.write("\tDifference from face fluxes: %e %s\n", max_error,
+               passed ? "PASSED" : "FAILED");
+  if (!passed) {
+    failures++;
+  }
+  passed = max_sum < tol;
+  output.write("\tRelative volume integral: %e %s\n", max_sum,
+               passed ? "PASSED" : "FAILED");
+  if (!passed) {
+    failures++;
+  }
+
+  BoutFinalise();
+
+  return failures > 0 ? 1 : 0;
+}
@@ -113,6 +113,38 @@ int physics_init(bool restarting) {
       }
   output << "2D SCATTER TEST: " << scatter_pass3D << endl;
 
+  /////////////////////////////////////////////////////////////
+  // Gather onto every processor, and onto every node
+
+  GlobalField3D gAll3D(mesh), gNode3D(mesh);
+
+  gAll3D.allGather(localX3D);
+  gNode3D.gatherToNodes(localX3D);
+
+  bool allgather_pass = gAll3D.dataIsLocal();
+  for(int x=0;x<gAll3D.xSize();x++)
+    for(int y=0;y<gAll3D.ySize();y++)
+      for(int z=0;z<gAll3D.zSize();z++) {
+        if(ROUND(gAll3D(x,y,z)) != x + z) {
+          output.write("%d, %d, %d :  %e\n", x,y,z, gAll3D(x,y,z));
+          allgather_pass = false;
+        }
+      }
+  output << "3D ALLGATHER TEST: " << allgather_pass << endl;
+
+  if(gNode3D.dataIsLocal()) {
+    bool nodegather_pass = true;
+    for(int x=0;x<gNode3D.xSize();x++)
+      for(int y=0;y<gNode3D.ySize();y++)
+        for(int z=0;z<gNode3D.zSize();z++) {
+          if(ROUND(gNode3D(x,y,z)) != x + z) {
+            output.write("%d, %d, %d :  %e\n", x,y,z, gNode3D(x,y,z));
+            nodegather_pass = false;
+          }
+        }
+    output << "3D NODE GATHER TEST: " << nodegather_pass << endl;
+  }
+
 
   return 1; // Signal an error, so quits
 }
@@ -21,6 +21,12 @@ int main(int argc, char **argv) {
   Field3D pade1 = gyroPade1(input3d, 0.5);
   Field3D pade2 = gyroPade2(input3d, 0.5);
   SAVE_ONCE2(pade1, pade2);
+
+  // Gyro-average using an object which keeps its Laplacian solvers
+  GyroPade gyro(0.5);
+  Field3D gyro_pade1, gyro_pade2;
+  gyro.pade12(input3d, gyro_pade1, gyro_pade2);
+  SAVE_ONCE2(gyro_pade1, gyro_pade2);
   
   // Write data
   dump.write();
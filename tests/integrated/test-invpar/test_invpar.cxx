@@ -59,6 +59,35 @@ int main(int argc, char **argv) {
     }
   }
 
+  // Solve again with the same coefficients, which reuses the
+  // factorised matrices, then with a different A coefficient, then
+  // with a different metric
+  for (int i = 0; i < 3; i++) {
+    if (i == 1) {
+      A += 0.5;
+      inv->setCoefA(A);
+    }
+    if (i == 2) {
+      Coordinates *coord = mesh->getCoordinates();
+      coord->g_22 *= 1.5;
+      coord->g22 /= 1.5;
+      coord->geometry();
+    }
+    Field3D input2 = 2. * input + 1.;
+    Field3D result2 = inv->solve(input2);
+    mesh->communicate(result2);
+
+    Field3D deriv2 = A * result2 + B * Grad2_par2(result2) + C * D2DYDZ(result2) +
+                     D * D2DZ2(result2) + E * DDY(result2);
+
+    for (int y = 2; y < mesh->LocalNy - 2; y++) {
+      for (int z = 0; z < mesh->LocalNz; z++) {
+        if (abs(input2(2, y, z) - deriv2(2, y, z)) > tol)
+          passed = 0;
+      }
+    }
+  }
+
   int allpassed;
   MPI_Allreduce(&passed, &allpassed, 1, MPI_INT, MPI_MIN, BoutComm::get());
 
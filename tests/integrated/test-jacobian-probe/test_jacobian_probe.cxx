@@ -0,0 +1,183 @@
+/*
+ * Test of finding the IMEX-BDF2 Jacobian pattern by probing the RHS
+ *
+ * The implicit part is a 2nd order Laplacian in X, Y and Z, so the
+ * Jacobian has the same non-zeros as the star pattern. If
+ * solver:jacobian_pattern_file is set, the pattern saved by the solver
+ * is checked to contain the star pattern. If test:reference is the
+ * directory containing the restart files of a run with the star
+ * pattern, the fields at the last output are compared with them.
+ * The run stops with an error if either check fails
+ */
+
+#include <bout/physicsmodel.hxx>
+
+#include <boutcomm.hxx>
+#include <datafile.hxx>
+#include <derivs.hxx>
+
+#include <fstream>
+#include <set>
+#include <vector>
+
+class JacobianProbeTest : public PhysicsModel {
+private:
+  Field3D n;
+
+  std::string pattern_file; ///< Pattern saved by the solver
+  std::string reference;    ///< Directory of restart files to compare against
+  BoutReal tol;
+  bool checked_pattern = false;
+
+  /// Check that the pattern saved by this processor contains the star
+  /// pattern of the Laplacian
+  void checkPattern() {
+    const int nz = mesh->LocalNz;
+
+    // Global row of each point, numbered as in Solver::globalIndex
+    // with one 3D variable. Boundary cells stay -1
+    const int nlocal =
+        (mesh->xend - mesh->xstart + 1) * (mesh->yend - mesh->ystart + 1) * nz;
+    int Iend;
+    MPI_Scan(&nlocal, &Iend, 1, MPI_INT, MPI_SUM, BoutComm::get());
+    const int Istart = Iend - nlocal;
+
+    Field3D index(-1.0, mesh);
+    int ind = Istart;
+    for (const auto &i2d : mesh->getRegion2D("RGN_NOBNDRY")) {
+      for (int z = 0; z < nz; z++) {
+        index[mesh->ind2Dto3D(i2d, z)] = ind++;
+      }
+    }
+    mesh->communicate(index);
+
+    const std::string filename = pattern_file + "." + std::to_string(BoutComm::rank());
+    std::ifstream file(filename);
+    std::string header;
+    std::getline(file, header);
+    int file_nlocal, file_neq, file_Istart;
+    file >> file_nlocal >> file_neq >> file_Istart;
+    if (!file.good() || (file_nlocal != nlocal) || (file_Istart != Istart)) {
+      throw BoutException("Could not read the Jacobian pattern in '%s'", filename.c_str());
+    }
+    std::vector<std::set<int>> pattern(nlocal);
+    for (auto &row : pattern) {
+      int ncols;
+      file >> ncols;
+      for (int i = 0; i < ncols; i++) {
+        int col;
+        file >> col;
+        row.insert(col);
+      }
+    }
+    if (file.fail()) {
+      throw BoutException("Could not read the Jacobian pattern in '%s'", filename.c_str());
+    }
+
+    // Offsets of the star pattern
+    const int xoffset[7] = {0, -1, 1, 0, 0, 0, 0};
+    const int yoffset[7] = {0, 0, 0, -1, 1, 0, 0};
+    const int zoffset[7] = {0, 0, 0, 0, 0, -1, 1};
+
+    int missing = 0, extra = 0;
+    for (int x = mesh->xstart; x <= mesh->xend; x++) {
+      for (int y = mesh->ystart; y <= mesh->yend; y++) {
+        for (int z = 0; z < nz; z++) {
+          const auto &row = pattern[ROUND(index(x, y, z)) - Istart];
+          int found = 0;
+          for (int c = 0; c < 7; c++) {
+            const int col =
+                ROUND(index(x + xoffset[c], y + yoffset[c], (z + zoffset[c] + nz) % nz));
+            if (col < 0) {
+              continue; // Boundary point
+            }
+            if (row.count(col) == 0) {
+              ++missing;
+            } else {
+              ++found;
+            }
+          }
+          extra += row.size() - found;
+        }
+      }
+    }
+
+    int total_missing, total_extra;
+    MPI_Allreduce(&missing, &total_missing, 1, MPI_INT, MPI_SUM, BoutComm::get());
+    MPI_Allreduce(&extra, &total_extra, 1, MPI_INT, MPI_SUM, BoutComm::get());
+    output.write("\tJacobian pattern: %d star entries missing, %d extra entries\n",
+                 total_missing, total_extra);
+    if (total_missing > 0) {
+      throw BoutException("Probed Jacobian pattern is missing %d entries of the star "
+                          "pattern",
+                          total_missing);
+    }
+  }
+
+protected:
+  int init(bool UNUSED(restarting)) override {
+    Options *opt = Options::getRoot()->getSection("test");
+    OPTION(opt, reference, "");
+    OPTION(opt, tol, 1e-6); // Newton iterations may differ
+    Options::getRoot()->getSection("solver")->get("jacobian_pattern_file", pattern_file,
+                                                  "");
+
+    // The Laplacian is the implicit part
+    setSplitOperator();
+    SOLVE_FOR(n);
+    return 0;
+  }
+
+  int convective(BoutReal UNUSED(time)) override {
+    ddt(n) = 0.0;
+    return 0;
+  }
+
+  int diffusive(BoutReal UNUSED(time)) override {
+    mesh->communicate(n);
+    ddt(n) = D2DX2(n) + D2DY2(n) + D2DZ2(n);
+    return 0;
+  }
+
+  int outputMonitor(BoutReal simtime, int iter, int NOUT) override {
+    // The pattern is found when the solver is initialised
+    if (!pattern_file.empty() && !checked_pattern) {
+      checkPattern();
+      checked_pattern = true;
+    }
+
+    if (reference.empty() || (iter != NOUT - 1)) {
+      return 0;
+    }
+
+    // Compare with the run using the star pattern
+    Field3D n_ref;
+    BoutReal time_ref;
+    std::string ext;
+    Options::getRoot()->get("dump_format", ext, "nc");
+    Datafile ref_file(Options::getRoot()->getSection("restart"));
+    ref_file.addOnce(n_ref, "n");
+    ref_file.addOnce(time_ref, "tt");
+    if (!ref_file.openr("%s/BOUT.restart.%s", reference.c_str(), ext.c_str()) ||
+        !ref_file.read()) {
+      throw BoutException("Could not read reference in %s", reference.c_str());
+    }
+    ref_file.close();
+
+    BoutReal error = max(abs(n - n_ref));
+    BoutReal max_error;
+    MPI_Allreduce(&error, &max_error, 1, MPI_DOUBLE, MPI_MAX, BoutComm::get());
+
+    output.write("\tTime %e: difference from reference %e\n", simtime, max_error);
+    if (simtime != time_ref) {
+      throw BoutException("Time %e does not match reference time %e", simtime,
+                          time_ref);
+    }
+    if (!(max_error < tol)) {
+      throw BoutException("Fields do not match reference: difference %e", max_error);
+    }
+    return 0;
+  }
+};
+
+BOUTMAIN(JacobianProbeTest);
@@ -0,0 +1,177 @@
+/*
+ * Test solving several fields together with LaplaceCyclic
+ *
+ * Solving a vector of fields should give the same results as solving
+ * each field separately. The solves are repeated, so that both new
+ * and reused factorisations are checked, for the FFT and DST methods.
+ * A second solver with the same coefficients shares the factorisations,
+ * which must not be changed when its coefficients are changed. A solver
+ * on a mesh with different grid spacing must not share them, and
+ * changing the metric must factorise the matrices again
+ */
+
+#include <bout.hxx>
+
+#include <field_factory.hxx>
+#include <invert_laplace.hxx>
+
+#include <memory>
+#include <vector>
+
+/// Maximum difference between \p a and \p b, relative to the size of \p b
+BoutReal difference(const Field3D &a, const Field3D &b) {
+  return max(abs(a - b), true) / max(abs(b), true);
+}
+
+/// Check that \p result is the same as each field in \p expected.
+/// Returns the number of failures
+int check(const std::string &name, const std::vector<Field3D> &result,
+          const std::vector<Field3D> &expected, BoutReal tol) {
+  int failures = 0;
+  for (std::size_t i = 0; i < expected.size(); i++) {
+    BoutReal diff = difference(result[i], expected[i]);
+    bool passed = diff < tol;
+    output.write("\t%s %d: %e %s\n", name.c_str(), static_cast<int>(i), diff,
+                 passed ? "PASSED" : "FAILED");
+    if (!passed) {
+      failures++;
+    }
+  }
+  return failures;
+}
+
+/// Solve each field in \p rhs separately
+std::vector<Field3D> separate(Laplacian &lap, const std::vector<Field3D> &rhs) {
+  std::vector<Field3D> result;
+  for (const auto &f : rhs) {
+    result.push_back(lap.solve(f));
+  }
+  return result;
+}
+
+int main(int argc, char **argv) {
+  BoutInitialise(argc, argv);
+
+  BoutReal tol;
+  OPTION(Options::getRoot(), tol, 1e-10);
+
+  FieldFactory factory(mesh);
+
+  // Right hand sides, which are non-zero in the X boundaries so that
+  // the boundary conditions are set in the reused matrices
+  const std::vector<std::string> rhs_functions = {
+      "gauss(x-0.5,0.2)*sin(3*y - z)", "1 + x*cos(2*z)", "sin(2*pi*x)*(y + cos(z))"};
+  const std::string acoef_function = "-0.1 - x", dcoef_function = "1 + 0.1*x*y";
+
+  std::vector<Field3D> rhs;
+  for (const auto &f : rhs_functions) {
+    rhs.push_back(factory.create3D(f));
+  }
+  Field3D acoef = factory.create3D(acoef_function);
+  Field3D dcoef = factory.create3D(dcoef_function);
+  mesh->communicate(acoef, dcoef);
+
+  // A mesh with the same size but different grid spacing
+  Mesh *mesh1 = mesh;
+  Mesh *mesh2 = Mesh::create(Options::getRoot()->getSection("mesh2"));
+  mesh = mesh2;
+  mesh2->load();
+  mesh = mesh1;
+
+  int failures = 0;
+
+  const std::vector<std::string> sections = {"fft", "dst"};
+  for (const auto &section : sections) {
+    output.write("Testing %s\n", section.c_str());
+
+    std::unique_ptr<Laplacian> lap(Laplacian::create(Options::getRoot()->getSection(section)));
+    lap->setCoefA(acoef);
+    lap->setCoefD(dcoef);
+
+    // Separate solves, then the fields together, which changes the
+    // number of systems and so factorises the matrices again
+    std::vector<Field3D> expected = separate(*lap, rhs);
+    failures += check(section + " new", lap->solve(rhs), expected, tol);
+
+    // The second solve uses the factors from the first
+    failures += check(section + " reused", lap->solve(rhs), expected, tol);
+
+    // Separate solves after solving together
+    failures += check(section + " separate", separate(*lap, rhs), expected, tol);
+
+    // Changing the coefficients factorises the matrices again
+    lap->setCoefA(2. * acoef);
+    expected = separate(*lap, rhs);
+    failures += check(section + " changed", lap->solve(rhs), expected, tol);
+    failures += check(section + " changed reused", lap->solve(rhs), expected, tol);
+
+    // Another solver with the same options and coefficients shares the
+    // factors. Changing its coefficients must not change the first solver
+    std::unique_ptr<Laplacian> other(
+        Laplacian::create(Options::getRoot()->getSection(section)));
+    other->setCoefA(2. * acoef);
+    other->setCoefD(dcoef);
+    failures += check(section + " shared", other->solve(rhs), expected, tol);
+
+    other->setCoefA(acoef);
+    std::vector<Field3D> other_expected = separate(*other, rhs);
+    failures += check(section + " other", other->solve(rhs), other_expected, tol);
+    failures += check(section + " unshared", lap->solve(rhs), expected, tol);
+    failures += check(section + " unshared separate", separate(*lap, rhs), expected, tol);
+
+    // A solver with the same options and coefficient values as other,
+    // but on another mesh. Laplacian solvers are created on the global mesh
+    Mesh *mesh1 = mesh;
+    mesh = mesh2;
+    {
+      FieldFactory factory2(mesh2);
+      std::vector<Field3D> rhs2;
+      for (const auto &f : rhs_functions) {
+        rhs2.push_back(factory2.create3D(f));
+      }
+      Field3D acoef2 = factory2.create3D(acoef_function);
+      Field3D dcoef2 = factory2.create3D(dcoef_function);
+      mesh2->communicate(acoef2, dcoef2);
+
+      // The reference solver has its own options, so never shares factors
+      std::unique_ptr<Laplacian> lap2(
+          Laplacian::create(Options::getRoot()->getSection(section)));
+      std::unique_ptr<Laplacian> reference(
+          Laplacian::create(Options::getRoot()->getSection(section + "_reference")));
+      for (auto &solver : {lap2.get(), reference.get()}) {
+        solver->setCoefA(acoef2);
+        solver->setCoefD(dcoef2);
+      }
+      expected = separate(*reference, rhs2);
+      failures += check(section + " other mesh", lap2->solve(rhs2), expected, tol);
+      failures +=
+          check(section + " other mesh separate", separate(*lap2, rhs2), expected, tol);
+
+      // Changing the metric factorises the matrices again. A new
+      // reference solver is needed, since the old one has its own factors
+      Coordinates *coords2 = mesh2->getCoordinates();
+      coords2->g11 *= 1.5;
+      coords2->g_11 /= 1.5;
+      coords2->geometry();
+      std::unique_ptr<Laplacian> reference2(
+          Laplacian::create(Options::getRoot()->getSection(section + "_reference")));
+      reference2->setCoefA(acoef2);
+      reference2->setCoefD(dcoef2);
+      expected = separate(*reference2, rhs2);
+      failures += check(section + " other metric", lap2->solve(rhs2), expected, tol);
+      failures += check(section + " other metric separate", separate(*lap2, rhs2),
+                        expected, tol);
+    }
+    mesh = mesh1;
+  }
+
+  delete mesh2;
+
+  if (failures > 0) {
+    output.write("%d checks failed\n", failures);
+  }
+
+  BoutFinalise();
+
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * Test of eigenvalue scans with the power solver
+ *
+ * The right hand side is
+ *
+ *   ddt(f) = p*f + 0.5*g
+ *   ddt(g) = 0.5*f + p*g
+ *
+ * where p is the scanned parameter, so the largest eigenvalue is
+ * p + 0.5 with eigenvector f = g. Once the scan has finished, the
+ * eigenvalue and parameter written for each value are read back from
+ * the output file of the first group and checked.
+ */
+
+#include <bout/physicsmodel.hxx>
+
+#include <boutcomm.hxx>
+#include <dataformat.hxx>
+
+class PowerScanTest : public PhysicsModel {
+private:
+  Field3D f, g;
+  BoutReal p = 0.0; ///< The scanned parameter
+
+protected:
+  int init(bool UNUSED(restarting)) override {
+    SOLVE_FOR2(f, g);
+    return 0;
+  }
+
+  int rhs(BoutReal UNUSED(time)) override {
+    ddt(f) = p * f + 0.5 * g;
+    ddt(g) = 0.5 * f + p * g;
+    return 0;
+  }
+
+  int scanParameter(BoutReal value) override {
+    p = value;
+    return 0;
+  }
+};
+
+/// Check the eigenvalue and parameter of each scan value in the
+/// output file. Returns the number of failures
+int checkOutput() {
+  Options *options = Options::getRoot();
+  std::string data_dir, dump_ext;
+  options->get("datadir", data_dir, "data");
+  options->get("dump_format", dump_ext, "nc");
+  BoutReal tol;
+  OPTION(options->getSection("test"), tol, 1e-6);
+
+  Options *solver_options = options->getSection("solver");
+  int nscan;
+  BoutReal scan_start, scan_end;
+  solver_options->get("nscan", nscan, 0);
+  solver_options->get("scan_start", scan_start, 0.0);
+  solver_options->get("scan_end", scan_end, scan_start);
+
+  const std::string filename = data_dir + "/BOUT.dmp.0." + dump_ext;
+  auto file = data_format(filename.c_str());
+  if (!file->openr(filename)) {
+    output.write("\tCould not open %s\n", filename.c_str());
+    return 1;
+  }
+
+  // The first record is the initial state, then one for each value
+  int failures = 0;
+  const std::vector<int> size = file->getSize("eigenvalue");
+  if (size.empty() || (size[0] != nscan + 1)) {
+    output.write("\tExpected %d records in %s\n", nscan + 1, filename.c_str());
+    failures++;
+  } else {
+    for (int i = 0; i < nscan; i++) {
+      BoutReal eigenvalue, scan_parameter;
+      file->setRecord(i + 1);
+      if (!file->read_rec(&eigenvalue, "eigenvalue")
+          || !file->read_rec(&scan_parameter, "scan_parameter")) {
+        output.write("\tCould not read record %d of %s\n", i + 1, filename.c_str());
+        failures++;
+        continue;
+      }
+
+      const BoutReal expected_parameter =
+          scan_start + i * (scan_end - scan_start) / (nscan - 1);
+      const BoutReal expected_eigenvalue = expected_parameter + 0.5;
+      const bool passed = (fabs(scan_parameter - expected_parameter) < tol)
+                          && (fabs(eigenvalue - expected_eigenvalue) < tol);
+      output.write("\tParameter %e (expected %e), eigenvalue %e (expected %e) %s\n",
+                   scan_parameter, expected_parameter, eigenvalue,
+                   expected_eigenvalue, passed ? "PASSED" : "FAILED");
+      if (!passed) {
+        failures++;
+      }
+    }
+  }
+  file->close();
+
+  return failures;
+}
+
+int main(int argc, char **argv) {
+  int init_err = BoutInitialise(argc, argv);
+  if (init_err < 0) {
+    return 0;
+  } else if (init_err > 0) {
+    return init_err;
+  }
+
+  int failures = 0;
+  try {
+    PhysicsModel *model = new PowerScanTest();
+    Solver *solver = Solver::create();
+    solver->setModel(model);
+    Monitor *bout_monitor = new BoutMonitor();
+    solver->addMonitor(bout_monitor, Solver::BACK);
+    solver->outputVars(dump);
+    solver->solve();
+    delete model;
+    delete solver;
+    delete bout_monitor;
+
+    // The first group writes the results. The scalars are the same in
+    // each of its files, so one processor checks them
+    if ((BoutComm::group() == 0) && (BoutComm::rank() == 0)) {
+      failures = checkOutput();
+    }
+  } catch (BoutException &e) {
+    output << "Error encountered\n";
+    output << e.what() << endl;
+    MPI_Abort(BoutComm::get(), 1);
+  }
+
+  BoutFinalise();
+
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * Test restarting with a different processor layout
+ *
+ * The fields increase linearly in time from their initial profiles,
+ * so after restarting they should be the initial profile plus the
+ * simulation time. Each output the fields are compared with this,
+ * and the run stops with an error if they don't match.
+ * The Y guard cells read when restarting are also checked against
+ * the values communication gives, which are different where guard
+ * cells are across a branch cut
+ */
+
+#include <bout/physicsmodel.hxx>
+
+#include <boutcomm.hxx>
+#include <field_factory.hxx>
+
+class RestartRedistribute : public PhysicsModel {
+private:
+  Field3D f3d;
+  Field2D f2d;
+
+  /// Initial profiles
+  Field3D f3d_initial;
+  Field2D f2d_initial;
+
+  BoutReal tol;
+
+  /// Check that the Y guard cells of the restarted fields match
+  /// the values which communication sets
+  void checkGuards() {
+    Field3D f3d_comm = copy(f3d);
+    Field2D f2d_comm = copy(f2d);
+    mesh->communicate(f3d_comm, f2d_comm);
+
+    BoutReal error = 0.0;
+    for (int x = mesh->xstart; x <= mesh->xend; x++) {
+      for (int y = 0; y < mesh->LocalNy; y++) {
+        if ((y >= mesh->ystart) && (y <= mesh->yend)) {
+          continue;
+        }
+        error = BOUTMAX(error, fabs(f2d(x, y) - f2d_comm(x, y)));
+        for (int z = 0; z < mesh->LocalNz; z++) {
+          error = BOUTMAX(error, fabs(f3d(x, y, z) - f3d_comm(x, y, z)));
+        }
+      }
+    }
+    BoutReal max_error;
+    MPI_Allreduce(&error, &max_error, 1, MPI_DOUBLE, MPI_MAX, BoutComm::get());
+
+    output.write("\tY guard cells: error %e\n", max_error);
+    if (!(max_error < tol)) {
+      throw BoutException("Y guard cells do not match after restarting: error %e",
+                          max_error);
+    }
+  }
+
+protected:
+  int init(bool UNUSED(restarting)) override {
+    OPTION(Options::getRoot(), tol, 1e-10);
+
+    // The initial profiles, which are not used when restarting
+    FieldFactory factory(mesh);
+    std::string function;
+    Options::getRoot()->getSection("f3d")->get("function", function, "0");
+    f3d_initial = factory.create3D(function);
+    Options::getRoot()->getSection("f2d")->get("function", function, "0");
+    f2d_initial = factory.create2D(function);
+
+    SOLVE_FOR2(f3d, f2d);
+    return 0;
+  }
+
+  int postInit(bool restarting) override {
+    int status = PhysicsModel::postInit(restarting);
+    if (restarting) {
+      checkGuards();
+    }
+    return status;
+  }
+
+  int rhs(BoutReal UNUSED(time)) override {
+    // Keeps guard cells in the restart files up to date
+    mesh->communicate(f3d, f2d);
+    ddt(f3d) = 1.0;
+    ddt(f2d) = 1.0;
+    return 0;
+  }
+
+  int outputMonitor(BoutReal simtime, int UNUSED(iter), int UNUSED(NOUT)) override {
+    BoutReal error = BOUTMAX(max(abs(f3d - f3d_initial - simtime)),
+                             max(abs(f2d - f2d_initial - simtime)));
+    BoutReal max_error;
+    MPI_Allreduce(&error, &max_error, 1, MPI_DOUBLE, MPI_MAX, BoutComm::get());
+
+    output.write("\tTime %e: error %e\n", simtime, max_error);
+    if (!(max_error < tol)) {
+      throw BoutException("Fields do not match at time %e: error %e", simtime,
+                          max_error);
+    }
+    return 0;
+  }
+};
+
+BOUTMAIN(RestartRedistribute);
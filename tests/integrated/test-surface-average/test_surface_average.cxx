@@ -0,0 +1,173 @@
+/*
+ * Test averages over Y and flux-surface averages
+ *
+ * The averages from SurfaceAverage are compared against sums over
+ * the whole domain, with each X index and region (core, private
+ * flux, SOL) summed separately. The "<name>_fsa" output of
+ * Diagnostics is read back and checked against the same sums
+ */
+
+#include <bout.hxx>
+
+#include <bout/diagnostics.hxx>
+#include <bout/surfaceaverage.hxx>
+#include <boutcomm.hxx>
+#include <field_factory.hxx>
+#include <smoothing.hxx>
+
+#include <vector>
+
+int main(int argc, char **argv) {
+  BoutInitialise(argc, argv);
+
+  BoutReal tol;
+  OPTION(Options::getRoot(), tol, 1e-12);
+
+  // Position of the separatrix and branch cuts
+  int ixseps1, jyseps1_1, jyseps2_2;
+  Options *meshopt = Options::getRoot()->getSection("mesh");
+  meshopt->get("ixseps1", ixseps1, 0);
+  meshopt->get("jyseps1_1", jyseps1_1, -1);
+  meshopt->get("jyseps2_2", jyseps2_2, 0);
+
+  FieldFactory factory(mesh);
+  Field3D f3d = factory.create3D("x + sin(y)*cos(z) + 0.3*y*y");
+  Field2D f2d = factory.create2D("x*x + cos(y)");
+
+  Coordinates *coord = mesh->coordinates();
+
+  const int nx = mesh->GlobalNx, nz = mesh->LocalNz;
+
+  // X range on this processor, including boundaries but not guard cells
+  const int xs = mesh->firstX() ? 0 : mesh->xstart;
+  const int xe = mesh->lastX() ? mesh->LocalNx - 1 : mesh->xend;
+
+  // Region containing global index (x, y): 0 is the core, 1 private
+  // flux and 2 the SOL
+  auto region = [&](int x, int y) {
+    if (x >= ixseps1) {
+      return 2;
+    }
+    return (y <= jyseps1_1 || y > jyseps2_2) ? 1 : 0;
+  };
+
+  // Reference sums for each region and global X index. There are the
+  // sums of f3d for each Z, the sum of f2d, the number of points, the
+  // sums of f3d and f2d weighted by J*dy, and the sum of J*dy
+  const int nvals = nz + 5;
+  auto index = [&](int r, int x, int k) { return (r * nx + x) * nvals + k; };
+  std::vector<BoutReal> local(3 * nx * nvals, 0.0), global(local.size());
+
+  for (int x = xs; x <= xe; x++) {
+    const int xg = mesh->XGLOBAL(x);
+    for (int y = mesh->ystart; y <= mesh->yend; y++) {
+      const int r = region(xg, mesh->YGLOBAL(y));
+      const BoutReal weight = coord->J(x, y) * coord->dy(x, y);
+      BoutReal zmean = 0.0;
+      for (int z = 0; z < nz; z++) {
+        local[index(r, xg, z)] += f3d(x, y, z);
+        zmean += f3d(x, y, z) / nz;
+      }
+      local[index(r, xg, nz)] += f2d(x, y);
+      local[index(r, xg, nz + 1)] += 1;
+      local[index(r, xg, nz + 2)] += zmean * weight;
+      local[index(r, xg, nz + 3)] += f2d(x, y) * weight;
+      local[index(r, xg, nz + 4)] += weight;
+    }
+  }
+  MPI_Allreduce(local.data(), global.data(), local.size(), MPI_DOUBLE, MPI_SUM,
+                BoutComm::get());
+
+  SurfaceAverage surface(mesh);
+
+  // Start all the averages, then wait for them together
+  Field3D start_y3d;
+  Field2D start_y2d, start_flux3d, start_flux2d;
+  surface.startY(f3d, start_y3d);
+  surface.startY(f2d, start_y2d);
+  surface.startFlux(f3d, start_flux3d);
+  surface.startFlux(f2d, start_flux2d);
+  surface.wait();
+
+  // Maximum error in each of the averages
+  std::vector<std::string> names = {"averageY 3D",    "averageY 2D",
+                                    "fluxAverage 3D", "fluxAverage 2D",
+                                    "startY 3D",      "startY 2D",
+                                    "startFlux 3D",   "startFlux 2D",
+                                    "smoothing averageY", "diagnostics fsa"};
+  std::vector<BoutReal> error(names.size(), 0.0), max_error(names.size());
+
+  auto check = [&](int i, BoutReal value, BoutReal expected) {
+    error[i] = BOUTMAX(error[i], fabs(value - expected));
+  };
+
+  const Field3D y3d = surface.averageY(f3d);
+  const Field2D y2d = surface.averageY(f2d);
+  const Field2D flux3d = surface.fluxAverage(f3d);
+  const Field2D flux2d = surface.fluxAverage(f2d);
+  const Field3D smoothing_y3d = averageY(f3d);
+
+  // Write the flux-surface average with Diagnostics, then read it back
+  std::string ext, data_dir;
+  Options::getRoot()->get("dump_format", ext, "nc");
+  Options::getRoot()->get("datadir", data_dir, "data");
+  const std::string diag_name = data_dir + "/BOUT.diag." + ext;
+  {
+    Diagnostics diagnostics;
+    diagnostics.add(f3d, "f3d");
+    diagnostics.open(diag_name, false);
+    diagnostics.write(0.0);
+  }
+  Field2D diag_fsa;
+  Datafile diag_file(Options::getRoot()->getSection("diagnostics")->getSection("output"));
+  diag_file.add(diag_fsa, "f3d_fsa", true);
+  if (!diag_file.openr("%s", diag_name.c_str()) || !diag_file.read()) {
+    throw BoutException("Could not read %s", diag_name.c_str());
+  }
+  diag_file.close();
+
+  for (int x = xs; x <= xe; x++) {
+    const int xg = mesh->XGLOBAL(x);
+    // The whole of this processor is in one region in Y
+    const int r = region(xg, mesh->YGLOBAL(mesh->ystart));
+    const BoutReal count = global[index(r, xg, nz + 1)];
+    const BoutReal volume = global[index(r, xg, nz + 4)];
+
+    const BoutReal mean2d = global[index(r, xg, nz)] / count;
+    const BoutReal fluxmean3d = global[index(r, xg, nz + 2)] / volume;
+    const BoutReal fluxmean2d = global[index(r, xg, nz + 3)] / volume;
+
+    for (int y = 0; y < mesh->LocalNy; y++) {
+      for (int z = 0; z < nz; z++) {
+        const BoutReal mean3d = global[index(r, xg, z)] / count;
+        check(0, y3d(x, y, z), mean3d);
+        check(4, start_y3d(x, y, z), mean3d);
+        check(8, smoothing_y3d(x, y, z), mean3d);
+      }
+      check(1, y2d(x, y), mean2d);
+      check(2, flux3d(x, y), fluxmean3d);
+      check(3, flux2d(x, y), fluxmean2d);
+      check(5, start_y2d(x, y), mean2d);
+      check(6, start_flux3d(x, y), fluxmean3d);
+      check(7, start_flux2d(x, y), fluxmean2d);
+      check(9, diag_fsa(x, y), fluxmean3d);
+    }
+  }
+
+  MPI_Allreduce(error.data(), max_error.data(), error.size(), MPI_DOUBLE, MPI_MAX,
+                BoutComm::get());
+
+  int failures = 0;
+  for (std::size_t i = 0; i < names.size(); i++) {
+    bool passed = max_error[i] < tol;
+    output.write("\t%s: %e %s\n", names[i].c_str(), max_error[i],
+                 passed ? "PASSED" : "FAILED");
+    if (!passed) {
+      failures++;
+    }
+  }
+
+  BoutFinalise();
+
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,43 @@
+#include "gtest/gtest.h"
+
+#include "bout_types.hxx"
+#include "dcomplex.hxx"
+#include "fft.hxx"
+
+#include <cmath>
+#include <vector>
+
+TEST(FFTTest, BatchedMatchesSingle) {
+  const int length = 8;
+  const int nmodes = length / 2 + 1;
+  const int howmany = 3;
+  // Signals are separated by more than their length
+  const int dist = 11;
+
+  std::vector<BoutReal> in(howmany * dist, -1.0);
+  for (int i = 0; i < howmany; i++) {
+    for (int j = 0; j < length; j++) {
+      in[i * dist + j] = std::sin(0.3 * j + i) + 0.1 * i * j;
+    }
+  }
+
+  std::vector<dcomplex> batched(howmany * nmodes);
+  rfft(in.data(), length, howmany, dist, batched.data());
+
+  std::vector<dcomplex> single(nmodes);
+  for (int i = 0; i < howmany; i++) {
+    rfft(&in[i * dist], length, single.data());
+    for (int k = 0; k < nmodes; k++) {
+      EXPECT_NEAR(batched[i * nmodes + k].real(), single[k].real(), 1e-14);
+      EXPECT_NEAR(batched[i * nmodes + k].imag(), single[k].imag(), 1e-14);
+    }
+  }
+
+  // Transform back, leaving the gaps between signals untouched
+  std::vector<BoutReal> out(howmany * dist, -1.0);
+  irfft(batched.data(), length, howmany, out.data(), dist);
+
+  for (int i = 0; i < howmany * dist; i++) {
+    EXPECT_NEAR(out[i], in[i], 1e-14);
+  }
+}
@@ -0,0 +1,186 @@
+#include "gtest/gtest.h"
+
+#include "bout/constants.hxx"
+#include "bout/coordinates.hxx"
+#include "bout/mesh.hxx"
+#include "difops.hxx"
+#include "field3d.hxx"
+#include "invert_laplace.hxx"
+#include "options.hxx"
+#include "output.hxx"
+#include "test_extras.hxx"
+
+#include <cmath>
+
+/// Global mesh
+extern Mesh *mesh;
+
+/// Test fixture to make sure the global mesh is our fake one
+///
+/// The operators in Coordinates cache combinations of the metric
+/// (Delp2 coefficients, sqrt(g_22) and DDY(J/g_22)). Each test uses
+/// the operators, changes the metric, and checks that the results are
+/// the same as those of a Coordinates which has never used them
+class CoordinatesCacheTest : public ::testing::Test {
+protected:
+  static void SetUpTestCase() {
+    // Delete any existing mesh
+    if (mesh != nullptr) {
+      delete mesh;
+      mesh = nullptr;
+    }
+    mesh = new FakeMesh(nx, ny, nz);
+    output_info.disable();
+    output_progress.disable();
+    output_warn.disable();
+    // The Delp2 coefficients come from the default Laplacian. Use one
+    // which doesn't need MPI
+    Options::getRoot()->getSection("laplace")->set("type", "tri", "test");
+    mesh->createDefaultRegions();
+    mesh->setParallelTransform(
+        std::unique_ptr<ParallelTransform>(new ParallelTransformIdentity()));
+    Options derivs;
+    static_cast<FakeMesh *>(mesh)->initDerivs(&derivs);
+    mesh->StaggerGrids = false;
+    mesh->getCoordinates();
+  }
+
+  static void TearDownTestCase() {
+    Laplacian::cleanup();
+    delete mesh;
+    mesh = nullptr;
+    Options::cleanup();
+    output_warn.enable();
+    output_progress.enable();
+    output_info.enable();
+  }
+
+  CoordinatesCacheTest() : f(mesh) {
+    f.allocate();
+    for (int x = 0; x < nx; x++) {
+      for (int y = 0; y < ny; y++) {
+        for (int z = 0; z < nz; z++) {
+          f(x, y, z) = std::sin(0.7 * x + 0.3 * y) * std::cos(2.0 * PI * z / nz) +
+                       0.2 * std::sin(0.5 * x * y);
+        }
+      }
+    }
+  }
+
+  /// Set a non-uniform diagonal metric in \p coords, varying in X and Y
+  /// so that the connection terms are not zero
+  static void setMetric(Coordinates &coords, BoutReal scale) {
+    for (int x = 0; x < nx; x++) {
+      for (int y = 0; y < ny; y++) {
+        coords.g11(x, y) = scale * (1.0 + 0.1 * x);
+        coords.g22(x, y) = 1.0 / (scale * (2.0 + 0.2 * y + 0.05 * x));
+        coords.g33(x, y) = scale * (1.5 + 0.1 * x * y);
+        coords.g_11(x, y) = 1.0 / coords.g11(x, y);
+        coords.g_22(x, y) = 1.0 / coords.g22(x, y);
+        coords.g_33(x, y) = 1.0 / coords.g33(x, y);
+        coords.J(x, y) = 1.0 / std::sqrt(coords.g11(x, y) * coords.g22(x, y) *
+                                         coords.g33(x, y));
+      }
+    }
+    coords.g12 = coords.g13 = coords.g23 = 0.0;
+    coords.g_12 = coords.g_13 = coords.g_23 = 0.0;
+  }
+
+  /// Build the operators from scratch with the metric of the mesh
+  static std::unique_ptr<Coordinates> freshCoordinates() {
+    Coordinates *coords = mesh->getCoordinates();
+    std::unique_ptr<Coordinates> fresh(new Coordinates(mesh));
+    fresh->dz = coords->dz;
+    fresh->g11 = coords->g11;
+    fresh->g22 = coords->g22;
+    fresh->g33 = coords->g33;
+    fresh->g_11 = coords->g_11;
+    fresh->g_22 = coords->g_22;
+    fresh->g_33 = coords->g_33;
+    fresh->J = coords->J;
+    fresh->geometry();
+    return fresh;
+  }
+
+  /// Use each operator with a cached coefficient
+  static void useOperators(Coordinates &coords, const Field3D &f) {
+    coords.Delp2(f);
+    coords.Grad_par(f);
+    coords.Laplace_par(f);
+  }
+
+  /// Check the operators of the mesh Coordinates against \p expected
+  void checkOperators(Coordinates &expected) {
+    Coordinates *coords = mesh->getCoordinates();
+
+    EXPECT_TRUE(IsFieldClose(coords->Delp2(f), expected.Delp2(f)));
+    EXPECT_TRUE(IsFieldClose(coords->Grad_par(f), expected.Grad_par(f)));
+    EXPECT_TRUE(IsFieldClose(coords->Laplace_par(f), expected.Laplace_par(f)));
+    EXPECT_TRUE(
+        IsFieldClose(coords->Vpar_Grad_par(f, f), expected.Vpar_Grad_par(f, f)));
+    EXPECT_TRUE(IsFieldClose(coords->Grad2_par2(f), expected.Grad2_par2(f)));
+
+    // The free functions use the mesh Coordinates. Laplace_perp
+    // includes Laplace_par
+    EXPECT_TRUE(
+        IsFieldClose(Laplace_perp(f), expected.Laplace(f) - expected.Laplace_par(f)));
+  }
+
+  /// Are \p a and \p b the same in the domain?
+  static ::testing::AssertionResult IsFieldClose(const Field3D &a, const Field3D &b) {
+    for (const auto &i : a.region(RGN_NOBNDRY)) {
+      if (std::abs(a[i] - b[i]) > 1e-10 * (1.0 + std::abs(b[i]))) {
+        return ::testing::AssertionFailure() << "Fields differ at (" << i.x << ", " << i.y
+                                             << ", " << i.z << "): " << a[i]
+                                             << " != " << b[i];
+      }
+    }
+    return ::testing::AssertionSuccess();
+  }
+
+  Field3D f;
+
+public:
+  static const int nx;
+  static const int ny;
+  static const int nz;
+};
+
+const int CoordinatesCacheTest::nx = 7;
+const int CoordinatesCacheTest::ny = 6;
+const int CoordinatesCacheTest::nz = 8;
+
+TEST_F(CoordinatesCacheTest, UpdateAfterGeometry) {
+  Coordinates *coords = mesh->getCoordinates();
+
+  setMetric(*coords, 1.0);
+  coords->geometry();
+  useOperators(*coords, f);
+  const Field3D delp2_before = coords->Delp2(f);
+
+  setMetric(*coords, 2.0);
+  coords->geometry();
+
+  // Check that the change in metric changes the result
+  EXPECT_FALSE(IsFieldClose(coords->Delp2(f), delp2_before));
+
+  checkOperators(*freshCoordinates());
+}
+
+TEST_F(CoordinatesCacheTest, UpdateAfterInvalidateCache) {
+  Coordinates *coords = mesh->getCoordinates();
+
+  setMetric(*coords, 1.0);
+  coords->geometry();
+  useOperators(*coords, f);
+
+  // dz is not part of the metric, so changing it doesn't need geometry()
+  const BoutReal dz = coords->dz;
+  coords->dz = 0.5 * dz;
+  coords->invalidateCache();
+
+  checkOperators(*freshCoordinates());
+
+  coords->dz = dz;
+  coords->invalidateCache();
+}
@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+
+#include "bout/constants.hxx"
+#include "bout/mesh.hxx"
+#include "bout/solver.hxx"
+#include "difops.hxx"
+#include "field3d.hxx"
+#include "options.hxx"
+#include "output.hxx"
+#include "test_extras.hxx"
+
+#include <cmath>
+#include <vector>
+
+/// Global mesh
+extern Mesh *mesh;
+
+/// Solver which only provides a timestep, for the CTU bracket
+class FakeSolver : public Solver {
+public:
+  int run() override { return 0; }
+  BoutReal getCurrentTimestep() override { return 0.1; }
+};
+
+/// Test fixture to make sure the global mesh is our fake one, with
+/// enough X points that the Arakawa bracket uses several X blocks
+class BracketTest : public ::testing::Test {
+protected:
+  static void SetUpTestCase() {
+    // Delete any existing mesh
+    if (mesh != nullptr) {
+      delete mesh;
+      mesh = nullptr;
+    }
+    mesh = new FakeMesh(nx, ny, nz);
+    output_info.disable();
+    output_progress.disable();
+    output_warn.disable();
+    mesh->createDefaultRegions();
+    mesh->setParallelTransform(
+        std::unique_ptr<ParallelTransform>(new ParallelTransformIdentity()));
+    Options derivs;
+    static_cast<FakeMesh *>(mesh)->initDerivs(&derivs);
+    mesh->StaggerGrids = false;
+    // Non-uniform grid spacing in X
+    Coordinates *coords = mesh->getCoordinates();
+    for (int x = 0; x < nx; x++) {
+      for (int y = 0; y < ny; y++) {
+        coords->dx(x, y) = 1.0 + 0.1 * x;
+      }
+    }
+    output_warn.enable();
+    output_progress.enable();
+    output_info.enable();
+  }
+
+  static void TearDownTestCase() {
+    delete mesh;
+    mesh = nullptr;
+    Options::cleanup();
+  }
+
+  BracketTest() : f(mesh), g1(mesh), g2(mesh) {
+    f.allocate();
+    g1.allocate();
+    g2.allocate();
+
+    // Fill guard cells too. The fields are not periodic in Z, so any
+    // difference in how the Z index wraps changes the result
+    for (int x = 0; x < nx; x++) {
+      for (int y = 0; y < ny; y++) {
+        for (int z = 0; z < nz; z++) {
+          f(x, y, z) =
+              std::sin(0.7 * x + 0.3 * y) * std::cos(2.0 * PI * z / nz) + 0.1 * x * z;
+          g1(x, y, z) = std::cos(0.4 * x - 0.2 * y + 0.5 * z) + 0.05 * z * z;
+          g2(x, y, z) = 1.0 + 0.02 * x * x - 0.3 * y * z;
+        }
+      }
+    }
+  }
+
+  /// Check that each field of the multi-field bracket is the same as
+  /// the bracket of that field alone, at every point calculated,
+  /// including those next to X guard cells and the ends of Z
+  void checkMultiple(BRACKET_METHOD method, Solver *solver = nullptr) {
+    std::vector<Field3D> results = bracket(f, {g1, g2}, method, CELL_DEFAULT, solver);
+    ASSERT_EQ(results.size(), 2);
+
+    const Field3D expected[2] = {bracket(f, g1, method, CELL_DEFAULT, solver),
+                                 bracket(f, g2, method, CELL_DEFAULT, solver)};
+
+    for (int i = 0; i < 2; i++) {
+      EXPECT_EQ(results[i].getLocation(), expected[i].getLocation());
+      for (const auto &index : results[i].region(RGN_NOBNDRY)) {
+        EXPECT_DOUBLE_EQ(results[i][index], expected[i][index]) << "field " << i;
+      }
+    }
+  }
+
+  Field3D f, g1, g2;
+
+public:
+  static const int nx;
+  static const int ny;
+  static const int nz;
+};
+
+const int BracketTest::nx = 37;
+const int BracketTest::ny = 5;
+const int BracketTest::nz = 8;
+
+TEST_F(BracketTest, MultipleStd) { checkMultiple(BRACKET_STD); }
+
+TEST_F(BracketTest, MultipleSimple) { checkMultiple(BRACKET_SIMPLE); }
+
+TEST_F(BracketTest, MultipleArakawa) { checkMultiple(BRACKET_ARAKAWA); }
+
+TEST_F(BracketTest, MultipleArakawaOld) { checkMultiple(BRACKET_ARAKAWA_OLD); }
+
+TEST_F(BracketTest, MultipleCTU) {
+  output_info.disable();
+  FakeSolver solver;
+  output_info.enable();
+  checkMultiple(BRACKET_CTU, &solver);
+}
+
+TEST_F(BracketTest, MultipleEmpty) {
+  EXPECT_TRUE(bracket(f, std::vector<Field3D>{}, BRACKET_ARAKAWA).empty());
+}
+
+TEST_F(BracketTest, ArakawaMatchesOld) {
+  std::vector<Field3D> results = bracket(f, {g1, g2}, BRACKET_ARAKAWA);
+  const Field3D expected[2] = {bracket(f, g1, BRACKET_ARAKAWA_OLD),
+                               bracket(f, g2, BRACKET_ARAKAWA_OLD)};
+
+  for (int i = 0; i < 2; i++) {
+    for (const auto &index : results[i].region(RGN_NOBNDRY)) {
+      EXPECT_NEAR(results[i][index], expected[i][index], 1e-12) << "field " << i;
+    }
+  }
+}
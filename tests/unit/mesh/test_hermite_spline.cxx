@@ -0,0 +1,179 @@
+#include "gtest/gtest.h"
+
+#include "bout/constants.hxx"
+#include "bout/mesh.hxx"
+#include "field3d.hxx"
+#include "interpolation.hxx"
+#include "options.hxx"
+#include "output.hxx"
+#include "test_extras.hxx"
+
+#include <cmath>
+
+/// Global mesh
+extern Mesh *mesh;
+
+/// Test fixture to make sure the global mesh is our fake one
+class HermiteSplineTest : public ::testing::Test {
+protected:
+  static void SetUpTestCase() {
+    // Delete any existing mesh
+    if (mesh != nullptr) {
+      delete mesh;
+      mesh = nullptr;
+    }
+    mesh = new FakeMesh(nx, ny, nz);
+    output_info.disable();
+    mesh->createDefaultRegions();
+    Options derivs;
+    static_cast<FakeMesh *>(mesh)->initDerivs(&derivs);
+    mesh->StaggerGrids = false;
+    output_info.enable();
+  }
+
+  static void TearDownTestCase() {
+    delete mesh;
+    mesh = nullptr;
+    Options::cleanup();
+  }
+
+public:
+  static const int nx;
+  static const int ny;
+  static const int nz;
+};
+
+const int HermiteSplineTest::nx = 7;
+const int HermiteSplineTest::ny = 5;
+const int HermiteSplineTest::nz = 8;
+
+TEST_F(HermiteSplineTest, SparseMatchesDense) {
+  Field3D f(mesh), delta_x(mesh), delta_z(mesh);
+  f.allocate();
+  delta_x.allocate();
+  delta_z.allocate();
+
+  for (int x = 0; x < nx; x++) {
+    for (int y = 0; y < ny; y++) {
+      for (int z = 0; z < nz; z++) {
+        f(x, y, z) = std::sin(0.7 * x + 0.3 * y) * std::cos(2.0 * PI * z / nz) +
+                     0.1 * x * z;
+        // Field line end points, including ones crossing the Z periodic boundary
+        delta_x(x, y, z) = x + 0.3 * std::sin(0.5 * z + y);
+        delta_z(x, y, z) = z + 1.7 * std::cos(0.4 * x + y) - 0.2;
+      }
+    }
+  }
+
+  for (int y_offset : {-1, 0, 1}) {
+    Options::root()["interpolation"]["sparse"].force(false);
+    HermiteSpline dense(y_offset, mesh);
+    Options::root()["interpolation"]["sparse"].force(true);
+    HermiteSpline sparse(y_offset, mesh);
+
+    Field3D f_dense = dense.interpolate(f, delta_x, delta_z);
+    Field3D f_sparse = sparse.interpolate(f, delta_x, delta_z);
+
+    for (int x = mesh->xstart; x <= mesh->xend; x++) {
+      for (int y = mesh->ystart; y <= mesh->yend; y++) {
+        for (int z = 0; z < nz; z++) {
+          // The dense method uses derivatives in the guard cells, which
+          // are not calculated, so only compare away from them
+          const int i_corner = static_cast<int>(std::floor(delta_x(x, y, z)));
+          if ((i_corner <= mesh->xstart) || (i_corner >= mesh->xend - 1) ||
+              (y + y_offset < mesh->ystart) || (y + y_offset > mesh->yend)) {
+            continue;
+          }
+          EXPECT_NEAR(f_sparse(x, y + y_offset, z), f_dense(x, y + y_offset, z), 1e-12);
+        }
+      }
+    }
+  }
+}
+
+/// A processor with neighbours in X on both sides
+class InteriorFakeMesh : public FakeMesh {
+public:
+  InteriorFakeMesh(int nx, int ny, int nz) : FakeMesh(nx, ny, nz) {}
+  bool firstX() override { return false; }
+  bool lastX() override { return false; }
+};
+
+TEST_F(HermiteSplineTest, HaloMatchesLocal) {
+  // The local domain is part of a larger one, offset in X
+  const int offset = 2;
+  const int nx_global = nx + 2 * offset;
+  FakeMesh global_mesh(nx_global, ny, nz);
+  InteriorFakeMesh local_mesh(nx, ny, nz);
+
+  auto func = [](int x, int y, int z) {
+    return std::sin(0.7 * x + 0.3 * y) * std::cos(2.0 * PI * z / nz) + 0.1 * x * z;
+  };
+
+  Field3D f_global(&global_mesh), f_local(&local_mesh);
+  Field3D delta_x_global(&global_mesh), delta_z_global(&global_mesh);
+  Field3D delta_x_local(&local_mesh), delta_z_local(&local_mesh);
+  f_global.allocate();
+  f_local.allocate();
+  delta_x_global.allocate();
+  delta_z_global.allocate();
+  delta_x_local.allocate();
+  delta_z_local.allocate();
+
+  for (int x = 0; x < nx_global; x++) {
+    for (int y = 0; y < ny; y++) {
+      for (int z = 0; z < nz; z++) {
+        f_global(x, y, z) = func(x, y, z);
+      }
+    }
+  }
+  for (int x = 0; x < nx; x++) {
+    for (int y = 0; y < ny; y++) {
+      for (int z = 0; z < nz; z++) {
+        f_local(x, y, z) = func(x + offset, y, z);
+        // Field lines end up to two points outside the local domain
+        delta_x_local(x, y, z) = x + 1.9 * std::sin(0.5 * z + y);
+        delta_z_local(x, y, z) = z + 1.7 * std::cos(0.4 * x + y) - 0.2;
+        delta_x_global(x + offset, y, z) = delta_x_local(x, y, z) + offset;
+        delta_z_global(x + offset, y, z) = delta_z_local(x, y, z);
+      }
+    }
+  }
+
+  Options::root()["interpolation"]["sparse"].force(true);
+  HermiteSpline global_interp(1, &global_mesh);
+  HermiteSpline local_interp(1, &local_mesh);
+
+  // Without a halo, points outside the local domain are an error
+  EXPECT_THROW(local_interp.calcWeights(delta_x_local, delta_z_local, BoutMask(local_mesh)),
+               BoutException);
+
+  local_interp.setHalo(true);
+  local_interp.calcWeights(delta_x_local, delta_z_local, BoutMask(local_mesh));
+  global_interp.calcWeights(delta_x_global, delta_z_global, BoutMask(global_mesh));
+
+  const auto &lines = local_interp.getHaloLines();
+  EXPECT_FALSE(lines.empty());
+
+  std::vector<BoutReal> halo;
+  for (const auto &line : lines) {
+    EXPECT_TRUE((line.first < 0) || (line.first >= nx));
+    for (int z = 0; z < nz; z++) {
+      halo.push_back(func(line.first + offset, line.second, z));
+    }
+  }
+
+  EXPECT_THROW(local_interp.interpolate(f_local), BoutException);
+
+  Field3D result_local = local_interp.interpolate(f_local, halo);
+  Field3D result_global = global_interp.interpolate(f_global);
+
+  for (int x = local_mesh.xstart; x <= local_mesh.xend; x++) {
+    for (int y = local_mesh.ystart; y <= local_mesh.yend; y++) {
+      for (int z = 0; z < nz; z++) {
+        EXPECT_NEAR(result_local(x, y + 1, z), result_global(x + offset, y + 1, z),
+                    1e-12);
+      }
+    }
+  }
+}
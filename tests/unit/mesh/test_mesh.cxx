@@ -3,10 +3,13 @@
 #include "bout/mesh.hxx"
 #include "bout/region.hxx"
 #include "boutexception.hxx"
+#include "options.hxx"
 #include "output.hxx"
 
 #include "test_extras.hxx"
 
+#include <algorithm>
+
 /// Test fixture to make sure the global mesh is our fake one
 class MeshTest : public ::testing::Test {
 protected:
@@ -27,6 +30,22 @@ TEST_F(MeshTest, CreateDefaultRegions) {
   EXPECT_THROW(localmesh.createDefaultRegions(), BoutException);
 }
 
+TEST_F(MeshTest, RegionBlockSizeOverride) {
+  Options::root()["mesh"]["regionblocksize"]["RGN_NOBNDRY"] = 2;
+  localmesh.createDefaultRegions();
+  Options::cleanup();
+
+  EXPECT_EQ(localmesh.getRegionBlockSize("RGN_ALL"), localmesh.maxregionblocksize);
+
+  for (const auto &block : localmesh.getRegion3D("RGN_NOBNDRY").getBlocks()) {
+    EXPECT_LE(block.second.ind - block.first.ind, 2);
+  }
+  // Blocks in other regions are still as large as possible
+  const auto &blocks = localmesh.getRegion3D("RGN_ALL").getBlocks();
+  EXPECT_EQ(blocks.front().second.ind - blocks.front().first.ind,
+            std::min(nx * ny * nz, localmesh.maxregionblocksize));
+}
+
 TEST_F(MeshTest, GetRegionFromMesh) {
   localmesh.createDefaultRegions();
   EXPECT_NO_THROW(localmesh.getRegion("RGN_ALL"));
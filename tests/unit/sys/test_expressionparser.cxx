@@ -344,6 +344,13 @@ TEST_F(ExpressionParserTest, AddBinaryOp) {
   }
 }
 
+TEST_F(ExpressionParserTest, DependsOnTime) {
+  EXPECT_FALSE(parser.parseString("1 + 2")->dependsOnTime());
+  EXPECT_FALSE(parser.parseString("x * (y - z)")->dependsOnTime());
+  EXPECT_TRUE(parser.parseString("t")->dependsOnTime());
+  EXPECT_TRUE(parser.parseString("x + 2*t")->dependsOnTime());
+}
+
 TEST(ParseExceptionTest, WhatTest) {
   try {
     throw ParseException("%s", "test message");
@@ -0,0 +1,103 @@
+#include "gtest/gtest.h"
+
+#include "bout/sys/expressionparser.hxx"
+#include "bout/sys/expressionprogram.hxx"
+#include "bout_types.hxx"
+
+#include <vector>
+
+// Need to inherit from ExpressionParser in order to expose the
+// protected parseString and addGenerator as public methods
+class ProgramParser : public ExpressionParser {
+public:
+  using ExpressionParser::parseString;
+  using ExpressionParser::addGenerator;
+};
+
+/// A generator which can't be compiled, so is called at each point
+class SquareGenerator : public FieldGenerator {
+public:
+  SquareGenerator(std::shared_ptr<FieldGenerator> gen = nullptr) : gen(gen) {}
+
+  std::shared_ptr<FieldGenerator>
+  clone(const std::list<std::shared_ptr<FieldGenerator>> args) override {
+    return std::make_shared<SquareGenerator>(args.front());
+  }
+  BoutReal generate(BoutReal x, BoutReal y, BoutReal z, BoutReal t) override {
+    BoutReal val = gen->generate(x, y, z, t);
+    return val * val;
+  }
+
+private:
+  std::shared_ptr<FieldGenerator> gen;
+};
+
+class ExpressionProgramTest : public ::testing::Test {
+public:
+  ExpressionProgramTest() {
+    parser.addGenerator("square", std::make_shared<SquareGenerator>());
+    for (int i = 0; i < n; i++) {
+      x.push_back(-1. + 0.37 * i);
+      y.push_back(0.5 - 0.21 * i);
+      z.push_back(0.1 * i * i);
+    }
+  }
+
+  /// Check that the compiled expression gives the same result as the tree
+  void checkMatches(const std::string &expr, BoutReal t) {
+    auto gen = parser.parseString(expr);
+    ExpressionProgram program(gen);
+
+    std::vector<BoutReal> result(n), work;
+    program.evaluate(n, x.data(), y.data(), z.data(), t, result.data(), work);
+
+    for (int i = 0; i < n; i++) {
+      EXPECT_DOUBLE_EQ(result[i], gen->generate(x[i], y[i], z[i], t)) << expr;
+    }
+  }
+
+  ProgramParser parser;
+  const int n = 11;
+  std::vector<BoutReal> x, y, z;
+};
+
+TEST_F(ExpressionProgramTest, MatchesGenerate) {
+  checkMatches("x + y*z - t", 0.3);
+  checkMatches("(x - 2*y) / (1 + z^2)", 1.5);
+  checkMatches("-x * (t + 1)^x", 2.0);
+  checkMatches("2 * 3 + x", 0.0);
+  checkMatches("7", 0.0);
+  checkMatches("t", 4.0);
+}
+
+TEST_F(ExpressionProgramTest, GeneratorsNotCompiled) {
+  checkMatches("square(x + t) - square(y)", 0.5);
+  checkMatches("2*square(3)", 0.0);
+}
+
+TEST_F(ExpressionProgramTest, ConstantFolding) {
+  ExpressionProgram program(parser.parseString("(1 + 2) * 3^2 - 4/8"));
+  EXPECT_EQ(program.size(), 1);
+  EXPECT_TRUE(program.isConstant());
+
+  std::vector<BoutReal> result(n), work;
+  program.evaluate(n, x.data(), y.data(), z.data(), 0.0, result.data(), work);
+  for (auto val : result) {
+    EXPECT_DOUBLE_EQ(val, 26.5);
+  }
+
+  EXPECT_FALSE(ExpressionProgram(parser.parseString("x + 1")).isConstant());
+}
+
+TEST_F(ExpressionProgramTest, CommonSubexpressions) {
+  // x, y, x*y, and the sum
+  ExpressionProgram program(parser.parseString("x*y + x*y"));
+  EXPECT_EQ(program.size(), 4);
+
+  // Constants are also only added once: x, 2, x*2 and the sum
+  EXPECT_EQ(ExpressionProgram(parser.parseString("x*2 + 2")).size(), 4);
+}
+
+TEST_F(ExpressionProgramTest, NullGenerator) {
+  EXPECT_THROW(ExpressionProgram program(nullptr), ParseException);
+}